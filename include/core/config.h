@@ -22,6 +22,7 @@ struct SchedulerConfig {
     uint8_t base_samples_per_cycle = 3;
     uint32_t min_sample_spacing_ms = 100;
     uint32_t transaction_time_ms = 5;
+    uint32_t control_period_ms = 100;   // Control loop tick (MODBUS polled incrementally)
     bool bulk_read_enabled = true;
     bool fill_idle_windows = true;
 };
@@ -33,6 +34,7 @@ struct PIDTimingConfig {
     uint32_t calculation_interval_ms = 5000;
     uint32_t output_cycle_time_ms = 60000;
     uint32_t autotune_max_duration_min = 120;
+    uint32_t derivative_filter_ms = 0;      // PID derivative low-pass time constant (0 = off)
 };
 
 /**
@@ -133,6 +135,7 @@ struct RegisterDef {
     float filter_alpha = 0.3f;
     uint16_t min_raw = 0;           // Minimum valid raw value (4mA threshold)
     uint16_t max_raw = 65535;       // Maximum valid raw value (20mA threshold)
+    float deadband = 0.0f;          // WebSocket push deadband (0 = default for unit)
 };
 
 /**
@@ -189,6 +192,7 @@ struct FermenterDef {
     char pressure_sensor[MAX_NAME_LENGTH];
     char cooling_relay[MAX_NAME_LENGTH];
     char spunding_relay[MAX_NAME_LENGTH];
+    uint32_t pid_interval_ms = 0;           // 0 = timing.pid.calculation_interval_ms
 };
 
 /**
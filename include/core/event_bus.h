@@ -1,11 +1,14 @@
 #pragma once
 
 #include "types.h"
+#include <atomic>
 #include <functional>
 
 #ifdef ESP32_BUILD
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
 #else
 #include <mutex>
 #endif
@@ -15,24 +18,58 @@ namespace core {
 // Callback type for event handlers
 using EventCallback = std::function<void(const Event&)>;
 
+// Allocation-free handler: plain function plus caller context
+using EventHandler = void (*)(const Event& event, void* ctx);
+
 /**
  * Subscriber registration
+ * Node of an intrusive per-EventType list. Nodes are linked once and never
+ * unlinked: unsubscribe() only clears active, and a later subscribe() to
+ * the same type reuses the node. Publishers can therefore walk the lists
+ * without taking the lock. A publisher holds `busy` while it checks and
+ * calls a node, and a node is only reused once `busy` is 0, so its
+ * handler, context and callback are never rewritten under a running call.
  */
 struct Subscriber {
-    EventType type;
-    EventCallback callback;
-    bool active;
+    static constexpr uint8_t NONE = 0xFF;
 
-    Subscriber() : type(EventType::SENSOR_UPDATE), callback(nullptr), active(false) {}
+    EventType type;
+    EventHandler handler;
+    void* context;
+    EventCallback callback;         // Only set by subscribe(type, EventCallback)
+    std::atomic<bool> active;
+    std::atomic<uint8_t> busy;      // Publishers currently inside this node
+    std::atomic<uint8_t> next;      // Next node of the same type, NONE = end
+    bool linked;
+
+    Subscriber()
+        : type(EventType::SENSOR_UPDATE)
+        , handler(nullptr)
+        , context(nullptr)
+        , callback(nullptr)
+        , active(false)
+        , busy(0)
+        , next(NONE)
+        , linked(false) {}
 };
 
 /**
  * Event Bus - Publish/Subscribe communication system
  * Decouples modules from direct dependencies
+ *
+ * publish() dispatches synchronously on the caller's thread. It walks only
+ * the list for the event's type and takes no lock, so a sensor update costs
+ * one indirect call per subscriber. As before, a callback may still run once
+ * after unsubscribe() returns if a publish was already in flight.
+ *
+ * publish_deferred() queues an event (ISR-safe on ESP32); the queue is
+ * drained by dispatch_deferred() or the dispatcher task.
  */
 class EventBus {
 public:
     static constexpr uint8_t MAX_SUBSCRIBERS = 32;
+    static constexpr uint8_t EVENT_TYPE_COUNT = (uint8_t)EventType::SENSORS_UPDATED + 1;
+    static constexpr uint8_t DEFERRED_QUEUE_SIZE = 32;
 
     EventBus();
     ~EventBus();
@@ -44,7 +81,15 @@ public:
     /**
      * Subscribe to an event type
      * @param type Event type to subscribe to
-     * @param callback Function to call when event occurs
+     * @param handler Function to call when event occurs
+     * @param ctx Passed to handler unchanged
+     * @return Subscription ID (for unsubscribe), or -1 on failure
+     */
+    int subscribe(EventType type, EventHandler handler, void* ctx);
+
+    /**
+     * Subscribe with a std::function
+     * The callback is stored once in the slot and never copied on publish.
      * @return Subscription ID (for unsubscribe), or -1 on failure
      */
     int subscribe(EventType type, EventCallback callback);
@@ -61,6 +106,26 @@ public:
      */
     void publish(const Event& event);
 
+    /**
+     * Queue an event for the dispatcher (callable from an ISR on ESP32)
+     * @return false if the queue is full (counted in get_deferred_dropped())
+     */
+    bool publish_deferred(const Event& event);
+
+    /**
+     * Publish queued events on the calling thread
+     * @param max_events Upper bound per call (0 = until empty)
+     * @return Number of events dispatched
+     */
+    uint16_t dispatch_deferred(uint16_t max_events = 0);
+
+#ifdef ESP32_BUILD
+    /**
+     * Start a task that blocks on the deferred queue and publishes each event
+     */
+    bool start_dispatcher(UBaseType_t priority, uint32_t stack_size = 3072);
+#endif
+
     /**
      * Convenience method: publish sensor update
      */
@@ -81,23 +146,58 @@ public:
      */
     void publish_alarm(uint8_t source_id, uint32_t timestamp);
 
+    /**
+     * Convenience method: publish a batch of sensor updates
+     * @param sensor_mask Bit N set = sensor ID N has new values in StateManager
+     */
+    void publish_sensors_updated(uint32_t sensor_mask, uint32_t timestamp);
+
+    /**
+     * Check whether an event type has any active subscriber
+     * Lets publishers skip building events nobody listens to.
+     */
+    bool has_subscribers(EventType type) const;
+
     /**
      * Get number of active subscribers
      */
     uint8_t get_subscriber_count() const;
 
+    /**
+     * Events dropped because the deferred queue was full
+     */
+    uint32_t get_deferred_dropped() const { return deferred_dropped_.load(); }
+
 private:
     Subscriber subscribers_[MAX_SUBSCRIBERS];
+    std::atomic<uint8_t> heads_[EVENT_TYPE_COUNT];
     uint8_t subscriber_count_;
+    std::atomic<uint32_t> deferred_dropped_;
 
 #ifdef ESP32_BUILD
     SemaphoreHandle_t mutex_;
+    QueueHandle_t deferred_queue_;
+    StaticQueue_t deferred_queue_buf_;
+    uint8_t deferred_storage_[DEFERRED_QUEUE_SIZE * sizeof(Event)];
+    TaskHandle_t dispatcher_task_;
+
+    static void dispatcher_task(void* arg);
 #else
     std::mutex mutex_;
+    std::mutex deferred_mutex_;
+    Event deferred_[DEFERRED_QUEUE_SIZE];
+    uint8_t deferred_head_;
+    uint8_t deferred_count_;
 #endif
 
     void lock();
     void unlock();
+
+    int add_subscriber(EventType type, EventHandler handler, void* ctx,
+                       EventCallback* callback);
+    bool pop_deferred(Event& event);
+
+    static void call_function(const Event& event, void* ctx);
 };
 
 // Global event bus instance
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+
+namespace core {
+
+/**
+ * Signed Q16.16 fixed-point number
+ *
+ * Range is -32768 .. +32767.99998 with a resolution of 1/65536 (~1.5e-5).
+ * All arithmetic is integer: products and quotients go through int64,
+ * round to nearest (ties away from zero) and saturate at the range limits
+ * instead of wrapping. Results are therefore bit-identical on the ESP32 and
+ * the native builds, given the same inputs.
+ */
+class Q16_16 {
+public:
+    static constexpr int FRAC_BITS = 16;
+    static constexpr int32_t ONE = 1 << FRAC_BITS;
+    static constexpr int32_t RAW_MAX = INT32_MAX;
+    static constexpr int32_t RAW_MIN = INT32_MIN + 1;    // Keeps negation safe
+
+    constexpr Q16_16() : raw_(0) {}
+
+    /** Round a float to the nearest representable value (saturating) */
+    constexpr explicit Q16_16(float value) : raw_(saturate(round_scaled(value))) {}
+
+    static constexpr Q16_16 from_raw(int32_t raw) { return Q16_16(raw, RawTag()); }
+    static constexpr Q16_16 from_int(int32_t value) {
+        return Q16_16(saturate((int64_t)value * ONE), RawTag());
+    }
+
+    constexpr int32_t raw() const { return raw_; }
+    constexpr float to_float() const { return raw_ / (float)ONE; }
+
+    constexpr Q16_16 operator-() const { return from_raw(-raw_); }
+
+    constexpr Q16_16 operator+(Q16_16 o) const { return from_raw(saturate((int64_t)raw_ + o.raw_)); }
+    constexpr Q16_16 operator-(Q16_16 o) const { return from_raw(saturate((int64_t)raw_ - o.raw_)); }
+
+    constexpr Q16_16 operator*(Q16_16 o) const {
+        return from_raw(saturate(round_shift((int64_t)raw_ * o.raw_)));
+    }
+
+    /** Division by zero saturates towards the sign of the dividend */
+    constexpr Q16_16 operator/(Q16_16 o) const {
+        if (o.raw_ == 0) return from_raw(raw_ >= 0 ? RAW_MAX : RAW_MIN);
+        return from_raw(saturate(round_div((int64_t)raw_ * ONE, o.raw_)));
+    }
+
+    Q16_16& operator+=(Q16_16 o) { return *this = *this + o; }
+    Q16_16& operator-=(Q16_16 o) { return *this = *this - o; }
+    Q16_16& operator*=(Q16_16 o) { return *this = *this * o; }
+    Q16_16& operator/=(Q16_16 o) { return *this = *this / o; }
+
+    constexpr bool operator==(Q16_16 o) const { return raw_ == o.raw_; }
+    constexpr bool operator!=(Q16_16 o) const { return raw_ != o.raw_; }
+    constexpr bool operator<(Q16_16 o) const { return raw_ < o.raw_; }
+    constexpr bool operator<=(Q16_16 o) const { return raw_ <= o.raw_; }
+    constexpr bool operator>(Q16_16 o) const { return raw_ > o.raw_; }
+    constexpr bool operator>=(Q16_16 o) const { return raw_ >= o.raw_; }
+
+private:
+    struct RawTag {};
+    constexpr Q16_16(int32_t raw, RawTag) : raw_(raw) {}
+
+    int32_t raw_;
+
+    static constexpr int32_t saturate(int64_t v) {
+        return v > RAW_MAX ? RAW_MAX : (v < RAW_MIN ? RAW_MIN : (int32_t)v);
+    }
+
+    static constexpr int64_t round_scaled(float value) {
+        // Compare before converting: out-of-range float to int is undefined
+        return value >= 32768.0f ? (int64_t)RAW_MAX + 1
+             : value <= -32768.0f ? (int64_t)RAW_MIN - 1
+             : (int64_t)(value * ONE + (value >= 0.0f ? 0.5f : -0.5f));
+    }
+
+    static constexpr int64_t round_shift(int64_t v) {
+        return v >= 0 ? (v + (ONE / 2)) >> FRAC_BITS : -((-v + (ONE / 2)) >> FRAC_BITS);
+    }
+
+    static constexpr int64_t round_div(int64_t num, int64_t den) {
+        return ((num < 0) == (den < 0)) ? (num + den / 2) / den : (num - den / 2) / den;
+    }
+};
+
+/**
+ * Conversions between float and the DSP number types
+ * Filters and PID keep a float interface and convert at the boundary.
+ */
+template <typename T>
+constexpr T dsp_from_float(float value) { return T(value); }
+
+inline constexpr float dsp_to_float(float value) { return value; }
+inline constexpr float dsp_to_float(Q16_16 value) { return value.to_float(); }
+
+/**
+ * Number type of the default filter and PID instantiations
+ * Build with -DFIXED_POINT_DSP to run EMAFilter, MovingAverageFilter,
+ * MedianFilter and PIDController in Q16.16 instead of float.
+ */
+#ifdef FIXED_POINT_DSP
+using dsp_t = Q16_16;
+#else
+using dsp_t = float;
+#endif
+
+} // namespace core
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace core {
+
+/**
+ * Streaming JSON serializer with a fixed-size chunk buffer
+ *
+ * Output is staged in CHUNK_SIZE bytes and handed to a flush callback
+ * whenever the chunk fills, so a response of any length needs only the
+ * chunk on the stack. Commas between members/elements are inserted
+ * automatically and strings are escaped.
+ *
+ * Numbers are formatted without printf: integers digit by digit, floats
+ * as a rounded fixed-point integer (matches "%.*f" except for exact
+ * half-way ties). NaN and infinity are written as null.
+ *
+ * Once the callback fails, further output is dropped and finish()
+ * returns false.
+ */
+class JsonWriter {
+public:
+    /** @return false to abort (e.g. socket closed, buffer full) */
+    using FlushFn = bool (*)(void* ctx, const char* data, size_t len);
+
+    static constexpr size_t CHUNK_SIZE = 1024;
+    static constexpr uint8_t MAX_DEPTH = 31;
+    static constexpr int MAX_DECIMALS = 9;
+
+    JsonWriter(FlushFn flush, void* ctx)
+        : flush_(flush)
+        , ctx_(ctx)
+        , len_(0)
+        , flushed_bytes_(0)
+        , depth_(0)
+        , has_items_(0)
+        , after_key_(false)
+        , failed_(false) {}
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    JsonWriter& begin_object() { open('{'); return *this; }
+    JsonWriter& end_object() { close('}'); return *this; }
+    JsonWriter& begin_array() { open('['); return *this; }
+    JsonWriter& end_array() { close(']'); return *this; }
+
+    /** Member name; the next value or container belongs to it */
+    JsonWriter& key(const char* name) {
+        separate();
+        put_string(name);
+        put(':');
+        after_key_ = true;
+        return *this;
+    }
+
+    /** Escaped string; nullptr is written as null */
+    JsonWriter& value(const char* s) {
+        separate();
+        if (s) put_string(s); else put_literal("null");
+        return *this;
+    }
+
+    JsonWriter& value(bool b) {
+        separate();
+        put_literal(b ? "true" : "false");
+        return *this;
+    }
+
+    JsonWriter& value(int v) { return value((long long)v); }
+    JsonWriter& value(unsigned v) { return value((unsigned long long)v); }
+    JsonWriter& value(long v) { return value((long long)v); }
+    JsonWriter& value(unsigned long v) { return value((unsigned long long)v); }
+
+    JsonWriter& value(long long v) {
+        separate();
+        if (v < 0) {
+            put('-');
+            put_uint(0ULL - (unsigned long long)v);
+        } else {
+            put_uint((unsigned long long)v);
+        }
+        return *this;
+    }
+
+    JsonWriter& value(unsigned long long v) {
+        separate();
+        put_uint(v);
+        return *this;
+    }
+
+    /** Fixed-point decimal with the given number of decimals (0..9) */
+    JsonWriter& value(double v, int decimals) {
+        separate();
+        put_fixed(v, decimals);
+        return *this;
+    }
+
+    JsonWriter& null() {
+        separate();
+        put_literal("null");
+        return *this;
+    }
+
+    /** Pre-serialized JSON value, written verbatim */
+    JsonWriter& raw(const char* json) {
+        separate();
+        put_bytes(json, strlen(json));
+        return *this;
+    }
+
+    // key() + value() shorthands
+    template <typename T>
+    JsonWriter& field(const char* name, T v) { key(name); return value(v); }
+    JsonWriter& field(const char* name, double v, int decimals) {
+        key(name);
+        return value(v, decimals);
+    }
+
+    /**
+     * Hand the buffered tail to the flush callback
+     * @return true if all output was accepted
+     */
+    bool finish() {
+        flush();
+        return !failed_;
+    }
+
+    /** Start a new document on the same flush callback */
+    void reset() {
+        len_ = 0;
+        flushed_bytes_ = 0;
+        depth_ = 0;
+        has_items_ = 0;
+        after_key_ = false;
+        failed_ = false;
+    }
+
+    /** Bytes produced so far (flushed + buffered) */
+    size_t size() const { return flushed_bytes_ + len_; }
+
+    /** True until the first chunk has been flushed */
+    bool fits_in_chunk() const { return flushed_bytes_ == 0; }
+
+    /** Output not yet flushed (the whole document if fits_in_chunk()) */
+    const char* buffered() const { return buf_; }
+    size_t buffered_size() const { return len_; }
+
+    bool failed() const { return failed_; }
+
+private:
+    FlushFn flush_;
+    void* ctx_;
+    char buf_[CHUNK_SIZE];
+    size_t len_;
+    size_t flushed_bytes_;
+    uint8_t depth_;
+    uint32_t has_items_;        // Bit n: container at depth n has a member
+    bool after_key_;
+    bool failed_;
+
+    void flush() {
+        if (len_ == 0 || failed_) return;
+        if (!flush_ || !flush_(ctx_, buf_, len_)) {
+            failed_ = true;
+        }
+        flushed_bytes_ += len_;
+        len_ = 0;
+    }
+
+    void put(char c) {
+        if (len_ == CHUNK_SIZE) flush();
+        if (failed_) return;
+        buf_[len_++] = c;
+    }
+
+    void put_bytes(const char* data, size_t n) {
+        while (n > 0 && !failed_) {
+            if (len_ == CHUNK_SIZE) flush();
+            size_t room = CHUNK_SIZE - len_;
+            size_t take = n < room ? n : room;
+            memcpy(buf_ + len_, data, take);
+            len_ += take;
+            data += take;
+            n -= take;
+        }
+    }
+
+    void put_literal(const char* s) { put_bytes(s, strlen(s)); }
+
+    // Comma before every member/element but the first; none after a key
+    void separate() {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        uint32_t bit = (uint32_t)1 << depth_;
+        if (has_items_ & bit) put(',');
+        has_items_ |= bit;
+    }
+
+    void open(char c) {
+        separate();
+        put(c);
+        if (depth_ >= MAX_DEPTH) {
+            failed_ = true;
+            return;
+        }
+        depth_++;
+        has_items_ &= ~((uint32_t)1 << depth_);
+    }
+
+    void close(char c) {
+        if (depth_ > 0) depth_--;
+        after_key_ = false;
+        put(c);
+    }
+
+    void put_string(const char* s) {
+        static const char HEX[] = "0123456789abcdef";
+        put('"');
+        const char* run = s;
+        for (; *s; s++) {
+            unsigned char c = (unsigned char)*s;
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+            put_bytes(run, s - run);
+            run = s + 1;
+            put('\\');
+            switch (c) {
+                case '"':  put('"'); break;
+                case '\\': put('\\'); break;
+                case '\n': put('n'); break;
+                case '\r': put('r'); break;
+                case '\t': put('t'); break;
+                case '\b': put('b'); break;
+                case '\f': put('f'); break;
+                default:
+                    put_literal("u00");
+                    put(HEX[c >> 4]);
+                    put(HEX[c & 0xF]);
+                    break;
+            }
+        }
+        put_bytes(run, s - run);
+        put('"');
+    }
+
+    void put_uint(unsigned long long v) {
+        char digits[20];
+        int n = 0;
+        do {
+            digits[n++] = (char)('0' + v % 10);
+            v /= 10;
+        } while (v != 0);
+        while (n > 0) put(digits[--n]);
+    }
+
+    void put_fixed(double v, int decimals) {
+        static const unsigned long long POW10[MAX_DECIMALS + 1] = {
+            1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL,
+            1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL
+        };
+
+        if (!std::isfinite(v)) {
+            put_literal("null");
+            return;
+        }
+        if (decimals < 0) decimals = 0;
+        if (decimals > MAX_DECIMALS) decimals = MAX_DECIMALS;
+
+        bool negative = v < 0;
+        double magnitude = (negative ? -v : v) * POW10[decimals] + 0.5;
+        if (magnitude >= 9.0e15) {
+            // Beyond exact double integers: leave it to printf
+            char tmp[48];
+            int n = snprintf(tmp, sizeof(tmp), "%.*f", decimals, v);
+            put_bytes(tmp, n > 0 ? (size_t)n : 0);
+            return;
+        }
+
+        unsigned long long scaled = (unsigned long long)magnitude;
+        if (negative && scaled != 0) put('-');
+        put_uint(scaled / POW10[decimals]);
+        if (decimals == 0) return;
+
+        put('.');
+        unsigned long long frac = scaled % POW10[decimals];
+        char digits[MAX_DECIMALS];
+        for (int i = decimals - 1; i >= 0; i--) {
+            digits[i] = (char)('0' + frac % 10);
+            frac /= 10;
+        }
+        put_bytes(digits, decimals);
+    }
+};
+
+/**
+ * JsonWriter flush target that fills a caller-supplied buffer
+ * The buffer is kept NUL-terminated. Output past its end is cut off and
+ * fails the writer, like the snprintf chains this replaces but detectable.
+ */
+class JsonBufferSink {
+public:
+    JsonBufferSink(char* buffer, size_t size)
+        : buffer_(buffer), size_(size), len_(0), truncated_(false) {
+        if (buffer_ && size_ > 0) buffer_[0] = '\0';
+    }
+
+    static bool write(void* ctx, const char* data, size_t len) {
+        auto* self = static_cast<JsonBufferSink*>(ctx);
+        if (!self->buffer_ || self->size_ == 0) {
+            self->truncated_ = true;
+            return false;
+        }
+        size_t room = self->size_ - 1 - self->len_;
+        size_t take = len < room ? len : room;
+        memcpy(self->buffer_ + self->len_, data, take);
+        self->len_ += take;
+        self->buffer_[self->len_] = '\0';
+        if (take < len) self->truncated_ = true;
+        return !self->truncated_;
+    }
+
+    size_t length() const { return len_; }
+    bool truncated() const { return truncated_; }
+
+private:
+    char* buffer_;
+    size_t size_;
+    size_t len_;
+    bool truncated_;
+};
+
+} // namespace core
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+
+namespace core {
+
+/**
+ * Fixed-size sample ring with running aggregates
+ *
+ * push() updates sum, sum of squares, min and max without rescanning the
+ * ring. Min/max use monotonic queues of slot indices (amortized O(1)).
+ * Sums are kept relative to an anchor near the window mean, so the
+ * variance of a 20.00 +/- 0.01 °C signal doesn't cancel out in float. The
+ * anchor is moved to the current mean once per N pushes, which also
+ * re-sums the ring and drops accumulated rounding error.
+ */
+template <uint8_t N>
+class RunningWindow {
+public:
+    static_assert(N > 0, "window needs at least one slot");
+
+    RunningWindow()
+        : samples_{}
+        , index_(0)
+        , count_(0)
+        , anchor_(0.0f)
+        , sum_(0.0f)
+        , sum_sq_(0.0f)
+        , min_q_{}
+        , max_q_{}
+        , min_head_(0)
+        , min_len_(0)
+        , max_head_(0)
+        , max_len_(0) {}
+
+    void push(float value) {
+        if (count_ == 0) {
+            anchor_ = value;
+        }
+
+        if (count_ == N) {
+            // Evict the oldest sample, which lives in the slot we overwrite
+            float old = samples_[index_] - anchor_;
+            sum_ -= old;
+            sum_sq_ -= old * old;
+            if (min_len_ > 0 && min_q_[min_head_] == index_) pop_front(min_head_, min_len_);
+            if (max_len_ > 0 && max_q_[max_head_] == index_) pop_front(max_head_, max_len_);
+        } else {
+            count_++;
+        }
+
+        samples_[index_] = value;
+        float d = value - anchor_;
+        sum_ += d;
+        sum_sq_ += d * d;
+
+        while (min_len_ > 0 && samples_[back(min_q_, min_head_, min_len_)] >= value) min_len_--;
+        min_q_[(min_head_ + min_len_++) % N] = index_;
+        while (max_len_ > 0 && samples_[back(max_q_, max_head_, max_len_)] <= value) max_len_--;
+        max_q_[(max_head_ + max_len_++) % N] = index_;
+
+        index_ = (index_ + 1) % N;
+        if (index_ == 0) {
+            rebase();
+        }
+    }
+
+    void reset() { *this = RunningWindow(); }
+
+    uint8_t count() const { return count_; }
+    bool full() const { return count_ == N; }
+    static constexpr uint8_t capacity() { return N; }
+
+    /** Most recent sample (0 if empty) */
+    float latest() const { return count_ ? samples_[(index_ + N - 1) % N] : 0.0f; }
+
+    float sum() const { return sum_ + anchor_ * count_; }
+    float mean() const { return count_ ? anchor_ + sum_ / count_ : 0.0f; }
+    float min() const { return min_len_ ? samples_[min_q_[min_head_]] : 0.0f; }
+    float max() const { return max_len_ ? samples_[max_q_[max_head_]] : 0.0f; }
+
+    /** Population variance of the samples in the window */
+    float variance() const {
+        if (count_ < 2) return 0.0f;
+        float m = sum_ / count_;
+        float var = sum_sq_ / count_ - m * m;
+        return var > 0.0f ? var : 0.0f;
+    }
+
+    /**
+     * True if value lies further from the mean than both sigma standard
+     * deviations and min_deviation (needs min_samples in the window)
+     */
+    bool deviates(float value, float sigma, float min_deviation, uint8_t min_samples) const {
+        if (count_ < min_samples || count_ == 0) return false;
+        float dev = value - mean();
+        if (dev < 0.0f) dev = -dev;
+        return dev > min_deviation && dev * dev > sigma * sigma * variance();
+    }
+
+private:
+    float samples_[N];
+    uint8_t index_;         // Next slot to write
+    uint8_t count_;
+    float anchor_;
+    float sum_;             // Sum of (sample - anchor_)
+    float sum_sq_;          // Sum of (sample - anchor_)^2
+    uint8_t min_q_[N];      // Slots with increasing values, oldest first
+    uint8_t max_q_[N];      // Slots with decreasing values, oldest first
+    uint8_t min_head_;
+    uint8_t min_len_;
+    uint8_t max_head_;
+    uint8_t max_len_;
+
+    static uint8_t back(const uint8_t* q, uint8_t head, uint8_t len) {
+        return q[(head + len - 1) % N];
+    }
+
+    static void pop_front(uint8_t& head, uint8_t& len) {
+        head = (head + 1) % N;
+        len--;
+    }
+
+    void rebase() {
+        anchor_ = mean();
+        sum_ = 0.0f;
+        sum_sq_ = 0.0f;
+        for (uint8_t i = 0; i < count_; i++) {
+            float d = samples_[i] - anchor_;
+            sum_ += d;
+            sum_sq_ += d * d;
+        }
+    }
+};
+
+} // namespace core
@@ -0,0 +1,368 @@
+#pragma once
+
+#include "types.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+
+#ifdef ESP32_BUILD
+#include "sdkconfig.h"
+#include "esp_heap_caps.h"
+
+// The store is PSRAM-only, so a target sdkconfig without PSRAM would build
+// fine and ship with history disabled. Boards without PSRAM opt out.
+#if !defined(CONFIG_SPIRAM) && !defined(NO_PSRAM_BUILD)
+#error "Sensor history needs CONFIG_SPIRAM in sdkconfig.<env> (or build with -DNO_PSRAM_BUILD)"
+#endif
+#endif
+
+namespace core {
+
+/**
+ * Per-sensor time-series history with downsampled tiers
+ *
+ * Tier 0: 1 s samples for the last 10 minutes
+ * Tier 1: 1 min averages for the last 24 hours
+ * Tier 2: 15 min averages for the last 30 days
+ *
+ * All sensors share one time axis per tier, so advancing the clock is a
+ * single ring step per tier. Samples are stored as int16 fixed-point offsets
+ * from a per-sensor anchor (the first recorded value) at the sensor's native
+ * resolution, which keeps 30 days of 32 sensors at ~315 KB. On ESP32 the
+ * storage must come from PSRAM; without it history stays disabled rather
+ * than taking internal RAM that TLS and the HTTP server need.
+ *
+ * Tier 1/2 slots hold the running average of the tier 0 samples committed
+ * so far, so the newest slot of a coarse tier is always current.
+ *
+ * Not thread-safe; StateManager serializes access.
+ */
+class SensorHistory {
+public:
+    static constexpr uint8_t TIER_COUNT = 3;
+    static constexpr uint32_t TIER_INTERVAL_S[TIER_COUNT] = {1, 60, 900};
+    static constexpr uint16_t TIER_CAPACITY[TIER_COUNT] = {600, 1440, 2880};
+    static constexpr int16_t NO_DATA = INT16_MIN;       // Gap marker
+    static constexpr int16_t MAX_OFFSET = INT16_MAX;    // Saturation limit
+    static constexpr float DEFAULT_RESOLUTION = 0.01f;
+
+    SensorHistory()
+        : storage_(nullptr)
+        , sensor_count_(0)
+        , started_(false)
+        , clipped_(0) {
+        for (uint8_t t = 0; t < TIER_COUNT; t++) {
+            tier_[t] = nullptr;
+            head_slot_[t] = 0;
+            head_pos_[t] = 0;
+            count_[t] = 0;
+        }
+    }
+
+    ~SensorHistory() { release(); }
+
+    SensorHistory(const SensorHistory&) = delete;
+    SensorHistory& operator=(const SensorHistory&) = delete;
+
+    /**
+     * Allocate ring storage for sensor_count sensors
+     * PSRAM only on ESP32 (no internal RAM fallback)
+     * @return false if the allocation failed (history stays disabled)
+     */
+    bool allocate(uint8_t sensor_count) {
+        release();
+        if (sensor_count == 0 || sensor_count > MAX_SENSORS) return false;
+
+        size_t bytes = bytes_per_sensor() * sensor_count;
+#ifdef ESP32_BUILD
+        storage_ = static_cast<int16_t*>(heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+#else
+        storage_ = static_cast<int16_t*>(malloc(bytes));
+#endif
+        if (!storage_) return false;
+
+        sensor_count_ = sensor_count;
+        int16_t* p = storage_;
+        for (uint8_t t = 0; t < TIER_COUNT; t++) {
+            tier_[t] = p;
+            p += (size_t)TIER_CAPACITY[t] * sensor_count;
+        }
+        for (size_t i = 0; i < bytes / sizeof(int16_t); i++) {
+            storage_[i] = NO_DATA;
+        }
+        for (uint8_t s = 0; s < MAX_SENSORS; s++) {
+            channels_[s] = Channel();
+        }
+        started_ = false;
+        clipped_ = 0;
+        return true;
+    }
+
+    void release() {
+        if (storage_) {
+#ifdef ESP32_BUILD
+            heap_caps_free(storage_);
+#else
+            free(storage_);
+#endif
+        }
+        storage_ = nullptr;
+        sensor_count_ = 0;
+        started_ = false;
+        for (uint8_t t = 0; t < TIER_COUNT; t++) {
+            tier_[t] = nullptr;
+            count_[t] = 0;
+        }
+    }
+
+    bool is_allocated() const { return storage_ != nullptr; }
+    uint8_t get_sensor_count() const { return sensor_count_; }
+    size_t get_memory_bytes() const { return bytes_per_sensor() * sensor_count_; }
+    uint32_t get_clipped_count() const { return clipped_; }
+
+    static constexpr size_t bytes_per_sensor() {
+        return ((size_t)TIER_CAPACITY[0] + TIER_CAPACITY[1] + TIER_CAPACITY[2]) * sizeof(int16_t);
+    }
+
+    /**
+     * Set the fixed-point step for a sensor (engineering units per LSB)
+     * Must be set before the sensor's first sample.
+     */
+    void set_resolution(uint8_t sensor, float resolution) {
+        if (sensor >= MAX_SENSORS || resolution <= 0.0f) return;
+        channels_[sensor].resolution = resolution;
+    }
+
+    float get_resolution(uint8_t sensor) const {
+        return sensor < MAX_SENSORS ? channels_[sensor].resolution : DEFAULT_RESOLUTION;
+    }
+
+    /**
+     * Move the time axis to now_s (seconds)
+     * The sample at the previous head is committed into the coarse tiers and
+     * skipped seconds are left as gaps. Calling again within the same second
+     * is a no-op, so store() then overwrites the current slot.
+     */
+    void advance(uint32_t now_s) {
+        if (!storage_) return;
+
+        if (!started_) {
+            for (uint8_t t = 0; t < TIER_COUNT; t++) {
+                head_slot_[t] = now_s / TIER_INTERVAL_S[t];
+                head_pos_[t] = 0;
+                count_[t] = 1;
+            }
+            started_ = true;
+            return;
+        }
+
+        if (now_s <= head_slot_[0]) return;
+
+        commit_head();
+
+        for (uint8_t t = 1; t < TIER_COUNT; t++) {
+            uint32_t slot = now_s / TIER_INTERVAL_S[t];
+            if (slot != head_slot_[t]) {
+                step_tier(t, slot - head_slot_[t]);
+                for (uint8_t s = 0; s < sensor_count_; s++) {
+                    channels_[s].acc_sum[t] = 0;
+                    channels_[s].acc_count[t] = 0;
+                }
+            }
+        }
+        step_tier(0, now_s - head_slot_[0]);
+    }
+
+    /**
+     * Record a value for a sensor in the current second
+     */
+    void store(uint8_t sensor, float value) {
+        if (!storage_ || !started_ || sensor >= sensor_count_) return;
+        if (!std::isfinite(value)) {
+            store_gap(sensor);
+            return;
+        }
+
+        Channel& ch = channels_[sensor];
+        if (!ch.anchored) {
+            ch.anchor = value;
+            ch.anchored = true;
+        }
+
+        long q = lroundf((value - ch.anchor) / ch.resolution);
+        if (q > MAX_OFFSET) {
+            q = MAX_OFFSET;
+            clipped_++;
+        } else if (q < -MAX_OFFSET) {
+            q = -MAX_OFFSET;
+            clipped_++;
+        }
+        at(0, sensor, head_pos_[0]) = (int16_t)q;
+    }
+
+    /** Mark the current second as a gap (e.g. sensor quality BAD) */
+    void store_gap(uint8_t sensor) {
+        if (!storage_ || !started_ || sensor >= sensor_count_) return;
+        at(0, sensor, head_pos_[0]) = NO_DATA;
+    }
+
+    /** Number of retained slots in a tier (including gaps) */
+    uint16_t get_count(uint8_t tier) const {
+        return tier < TIER_COUNT ? count_[tier] : 0;
+    }
+
+    /** Start time (seconds) of the oldest retained slot in a tier */
+    uint32_t get_oldest_time(uint8_t tier) const {
+        if (tier >= TIER_COUNT || count_[tier] == 0) return 0;
+        return (head_slot_[tier] - (count_[tier] - 1)) * TIER_INTERVAL_S[tier];
+    }
+
+    /** Start time (seconds) of the newest slot in a tier */
+    uint32_t get_newest_time(uint8_t tier) const {
+        if (tier >= TIER_COUNT || count_[tier] == 0) return 0;
+        return head_slot_[tier] * TIER_INTERVAL_S[tier];
+    }
+
+    /**
+     * Finest tier that still covers the given start time
+     */
+    uint8_t select_tier(uint32_t from_s) const {
+        for (uint8_t t = 0; t < TIER_COUNT; t++) {
+            if (count_[t] > 0 && get_oldest_time(t) <= from_s) return t;
+        }
+        return TIER_COUNT - 1;
+    }
+
+    /**
+     * Locate the slot range covering [from_s, to_s] in a tier
+     * O(1): slot indices are derived from the shared time axis.
+     * @param first Receives the index (0 = oldest) of the first slot
+     * @return Number of slots in range
+     */
+    uint16_t find_range(uint8_t tier, uint32_t from_s, uint32_t to_s, uint16_t& first) const {
+        first = 0;
+        if (tier >= TIER_COUNT || count_[tier] == 0 || to_s < from_s) return 0;
+
+        uint32_t interval = TIER_INTERVAL_S[tier];
+        uint32_t oldest_slot = head_slot_[tier] - (count_[tier] - 1);
+        uint32_t from_slot = from_s / interval;
+        uint32_t to_slot = to_s / interval;
+
+        if (from_slot < oldest_slot) from_slot = oldest_slot;
+        if (to_slot > head_slot_[tier]) to_slot = head_slot_[tier];
+        if (to_slot < from_slot) return 0;
+
+        first = (uint16_t)(from_slot - oldest_slot);
+        return (uint16_t)(to_slot - from_slot + 1);
+    }
+
+    /**
+     * Read one slot (index 0 = oldest retained)
+     * @return false if the slot is a gap or out of range
+     */
+    bool get_value(uint8_t sensor, uint8_t tier, uint16_t index, float& value) const {
+        if (!storage_ || sensor >= sensor_count_ || tier >= TIER_COUNT || index >= count_[tier]) {
+            return false;
+        }
+        uint16_t cap = TIER_CAPACITY[tier];
+        uint16_t pos = (uint16_t)((head_pos_[tier] + cap - (count_[tier] - 1) + index) % cap);
+        int16_t q = at(tier, sensor, pos);
+        if (q == NO_DATA) return false;
+
+        const Channel& ch = channels_[sensor];
+        value = ch.anchor + q * ch.resolution;
+        return true;
+    }
+
+    /**
+     * Copy a time range into out[] (NAN for gaps)
+     * @param start_s Receives the start time of out[0]
+     * @return Number of values written
+     */
+    uint16_t query(uint8_t sensor, uint8_t tier, uint32_t from_s, uint32_t to_s,
+                   float* out, uint16_t max_count, uint32_t* start_s = nullptr) const {
+        uint16_t first;
+        uint16_t n = find_range(tier, from_s, to_s, first);
+        if (n > max_count) n = max_count;
+        if (start_s) *start_s = get_oldest_time(tier) + first * TIER_INTERVAL_S[tier];
+
+        for (uint16_t i = 0; i < n; i++) {
+            if (!get_value(sensor, tier, first + i, out[i])) {
+                out[i] = NAN;
+            }
+        }
+        return n;
+    }
+
+private:
+    struct Channel {
+        float anchor;
+        float resolution;
+        bool anchored;
+        int32_t acc_sum[TIER_COUNT];        // Tier 1/2 accumulators (index 0 unused)
+        uint16_t acc_count[TIER_COUNT];
+
+        Channel()
+            : anchor(0.0f)
+            , resolution(DEFAULT_RESOLUTION)
+            , anchored(false)
+            , acc_sum{}
+            , acc_count{} {}
+    };
+
+    int16_t* storage_;
+    int16_t* tier_[TIER_COUNT];             // Sensor-major: [sensor][slot]
+    uint8_t sensor_count_;
+    bool started_;
+    uint32_t clipped_;
+
+    uint32_t head_slot_[TIER_COUNT];        // Absolute slot number of the head
+    uint16_t head_pos_[TIER_COUNT];         // Ring position of the head
+    uint16_t count_[TIER_COUNT];
+    Channel channels_[MAX_SENSORS];
+
+    int16_t& at(uint8_t tier, uint8_t sensor, uint16_t pos) {
+        return tier_[tier][(size_t)sensor * TIER_CAPACITY[tier] + pos];
+    }
+
+    int16_t at(uint8_t tier, uint8_t sensor, uint16_t pos) const {
+        return tier_[tier][(size_t)sensor * TIER_CAPACITY[tier] + pos];
+    }
+
+    /**
+     * Fold the finished tier 0 sample into the running averages
+     */
+    void commit_head() {
+        for (uint8_t s = 0; s < sensor_count_; s++) {
+            int16_t q = at(0, s, head_pos_[0]);
+            if (q == NO_DATA) continue;
+
+            Channel& ch = channels_[s];
+            for (uint8_t t = 1; t < TIER_COUNT; t++) {
+                ch.acc_sum[t] += q;
+                ch.acc_count[t]++;
+                at(t, s, head_pos_[t]) = (int16_t)lroundf((float)ch.acc_sum[t] / ch.acc_count[t]);
+            }
+        }
+    }
+
+    /**
+     * Advance a tier by `slots`, marking the new slots as gaps
+     * Bounded by the tier capacity, so long outages cost at most one lap.
+     */
+    void step_tier(uint8_t t, uint32_t slots) {
+        uint16_t cap = TIER_CAPACITY[t];
+        uint32_t steps = slots < cap ? slots : cap;
+        for (uint32_t i = 0; i < steps; i++) {
+            head_pos_[t] = (uint16_t)((head_pos_[t] + 1) % cap);
+            for (uint8_t s = 0; s < sensor_count_; s++) {
+                at(t, s, head_pos_[t]) = NO_DATA;
+            }
+        }
+        head_slot_[t] += slots;
+        uint32_t count = (uint32_t)count_[t] + slots;
+        count_[t] = (uint16_t)(count < cap ? count : cap);
+    }
+};
+
+} // namespace core
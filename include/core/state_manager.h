@@ -4,6 +4,8 @@
 #include "config.h"
 #include "cpu_history.h"
 #include "network_history.h"
+#include "sensor_history.h"
+#include <atomic>
 #include <cstring>
 
 #ifdef ESP32_BUILD
@@ -15,6 +17,95 @@
 
 namespace core {
 
+/**
+ * Consistent copy of a sensor's live values (see StateManager::read_sensor)
+ * Name, unit and scale are fixed after registration and read directly.
+ */
+struct SensorSnapshot {
+    float raw_value;
+    float filtered_value;
+    float display_value;
+    uint32_t timestamp;
+    SensorQuality quality;
+};
+
+/**
+ * Consistent copy of a relay's live values (see StateManager::read_relay)
+ */
+struct RelaySnapshot {
+    bool state;
+    float duty_cycle;
+    uint32_t last_change;
+};
+
+/**
+ * One decoded reading for StateManager::ingest_sensor_batch()
+ */
+struct SensorSample {
+    uint8_t sensor_id;
+    bool has_value;             // false = quality change only (e.g. wire break)
+    float raw_value;
+    float filtered_value;
+    float display_value;
+    SensorQuality quality;
+    bool is_extra;              // Priority extra sample (extra ring), else base
+};
+
+/**
+ * Spike detector applied by ingest_sensor_batch()
+ * A GOOD reading is downgraded to SUSPECT when it lies further than sigma
+ * standard deviations from the mean of its ring, and further than
+ * min_steps register steps (SensorState::scale). The reading is still
+ * stored, so a real step change is accepted once the ring catches up.
+ */
+struct SuspectDetectorConfig {
+    float sigma;
+    float min_steps;
+    uint8_t min_samples;        // Ring fill before the detector arms
+
+    SuspectDetectorConfig()
+        : sigma(4.0f)
+        , min_steps(10.0f)
+        , min_samples(4) {}
+};
+
+static_assert(MAX_SENSORS <= 32, "sensor update masks are 32 bits");
+
+/**
+ * Live sensor values stored as a structure of arrays
+ * Control, safety and history scans touch one or two of these fields for
+ * every sensor; keeping each field contiguous puts all 32 sensors' values
+ * in a couple of cache lines instead of one ~200 byte SensorState each.
+ * Names, units, filter settings and sample rings stay in SensorState.
+ */
+struct SensorHotBlock {
+    float filtered_value[MAX_SENSORS];
+    float display_value[MAX_SENSORS];
+    float raw_value[MAX_SENSORS];
+    uint32_t timestamp[MAX_SENSORS];
+    SensorQuality quality[MAX_SENSORS];
+
+    SensorHotBlock()
+        : filtered_value{}
+        , display_value{}
+        , raw_value{}
+        , timestamp{} {
+        for (auto& q : quality) q = SensorQuality::UNKNOWN;
+    }
+};
+
+/**
+ * StateManager mutex and snapshot counters
+ */
+struct StateLockStats {
+    uint32_t acquisitions;          // Successful lock() calls
+    uint32_t contended;             // lock() calls that found the mutex held
+    uint32_t timeouts;              // lock() calls that gave up
+    uint32_t snapshot_reads;        // read_sensor()/read_relay() calls
+    uint32_t snapshot_retries;      // Reads repeated because a write overlapped
+    uint32_t snapshot_fallbacks;    // Reads that fell back to the mutex
+};
+
 /**
  * Centralized state manager
  * Thread-safe access to all system state
@@ -40,6 +131,45 @@ public:
     void update_sensor_filtered(uint8_t sensor_id, float filtered, float display);
     void set_sensor_quality(uint8_t sensor_id, SensorQuality quality);
 
+    /**
+     * Apply all readings of one MODBUS transaction under a single lock
+     * Equivalent to update_sensor_value + update_sensor_filtered +
+     * set_sensor_quality per sample (or just the quality when !has_value).
+     * @return Bitmask of sensor IDs whose values were updated, or 0 if the
+     *         lock could not be taken
+     */
+    uint32_t ingest_sensor_batch(const SensorSample* samples, uint8_t count, uint32_t timestamp);
+
+    void set_suspect_detector(const SuspectDetectorConfig& config) { suspect_config_ = config; }
+    const SuspectDetectorConfig& get_suspect_detector() const { return suspect_config_; }
+
+    /**
+     * Copy a sensor's live values without taking the mutex
+     * Each sensor has a sequence counter that writers make odd while
+     * updating; the copy is retried if it overlapped a write, so readers
+     * never block the MODBUS writer. After SNAPSHOT_SPIN_LIMIT attempts the
+     * read takes the mutex instead, so a reader cannot starve a preempted
+     * writer on the same core.
+     */
+    bool read_sensor(uint8_t sensor_id, SensorSnapshot& out) const;
+
+    /**
+     * Hot sensor fields for scans over all sensors
+     * The live values in SensorState are kept in step as a compatibility
+     * view for per-sensor callers; loops over sensors should read these.
+     * Single fields are read without the lock, like get_sensor_by_id().
+     */
+    const SensorHotBlock& get_sensor_hot() const { return hot_; }
+    float get_sensor_value(uint8_t sensor_id) const {
+        return sensor_id < sensor_count_ ? hot_.filtered_value[sensor_id] : 0.0f;
+    }
+    SensorQuality get_sensor_quality(uint8_t sensor_id) const {
+        return sensor_id < sensor_count_ ? hot_.quality[sensor_id] : SensorQuality::UNKNOWN;
+    }
+    uint32_t get_sensor_timestamp(uint8_t sensor_id) const {
+        return sensor_id < sensor_count_ ? hot_.timestamp[sensor_id] : 0;
+    }
+
     // Relay operations
     bool register_relay(const char* name, RelayType type, uint8_t gpio_pin = 0,
                        uint8_t modbus_addr = 0, uint16_t modbus_reg = 0);
@@ -49,6 +179,11 @@ public:
     void set_relay_state(uint8_t relay_id, bool state, uint32_t timestamp);
     void set_relay_duty_cycle(uint8_t relay_id, float duty_cycle);
 
+    /**
+     * Copy a relay's live values without taking the mutex (see read_sensor)
+     */
+    bool read_relay(uint8_t relay_id, RelaySnapshot& out) const;
+
     // Fermenter operations
     bool register_fermenter(const FermenterDef& def);
     FermenterState* get_fermenter(uint8_t id);
@@ -81,6 +216,12 @@ public:
     NetworkHistory& get_network_history() { return network_history_; }
     const NetworkHistory& get_network_history() const { return network_history_; }
 
+    // Per-sensor time-series history (call record once per second)
+    // Storage is allocated on first use, after sensors are registered
+    void record_sensor_history(uint32_t now_s);
+    SensorHistory& get_sensor_history() { return sensor_history_; }
+    const SensorHistory& get_sensor_history() const { return sensor_history_; }
+
     // Bulk access (with lock held)
     uint8_t get_sensor_count() const { return sensor_count_; }
     uint8_t get_relay_count() const { return relay_count_; }
@@ -92,6 +233,37 @@ public:
     bool lock(uint32_t timeout_ms = DEFAULT_LOCK_TIMEOUT_MS);
     void unlock();
 
+    // Contention counters for the mutex and snapshot reads
+    StateLockStats get_lock_stats() const;
+    void reset_lock_stats();
+
+    /**
+     * State generations, one per StateDomain, bumped when a stored value
+     * actually changes
+     * Serve as cheap validators (HTTP ETag): a value read before building
+     * a response is never newer than the state the response shows. The
+     * mutators compare and bump them themselves; code that writes through
+     * get_fermenter() must call mark_changed() afterwards, and only if it
+     * changed something.
+     * @param domains state_domain_bit() mask; the result is the sum of
+     *        their generations, so it moves whenever any of them does
+     */
+    uint32_t get_generation(uint8_t domains = STATE_DOMAINS_ALL) const {
+        uint32_t sum = 0;
+        for (uint8_t d = 0; d < (uint8_t)StateDomain::COUNT; d++) {
+            if (domains & (1u << d)) sum += generations_[d].load(std::memory_order_acquire);
+        }
+        return sum;
+    }
+    uint32_t get_generation(StateDomain domain) const {
+        return generations_[(uint8_t)domain].load(std::memory_order_acquire);
+    }
+    void mark_changed(StateDomain domain) {
+        generations_[(uint8_t)domain].fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    static constexpr uint8_t SNAPSHOT_SPIN_LIMIT = 8;
+
     /**
      * RAII lock guard for StateManager
      * Automatically unlocks on destruction
@@ -117,22 +289,54 @@ public:
     }
 
 private:
+    SensorHotBlock hot_;
     SensorState sensors_[MAX_SENSORS];
     RelayState relays_[MAX_RELAYS];
     FermenterState fermenters_[MAX_FERMENTERS];
     SystemState system_state_;
     CpuHistory cpu_history_;
     NetworkHistory network_history_;
+    SensorHistory sensor_history_;
+
+    SuspectDetectorConfig suspect_config_;
 
     uint8_t sensor_count_;
     uint8_t relay_count_;
     uint8_t fermenter_count_;
+    bool sensor_history_failed_;
+
+    // Seqlock counters: odd while a write is in progress
+    std::atomic<uint32_t> sensor_seq_[MAX_SENSORS];
+    std::atomic<uint32_t> relay_seq_[MAX_RELAYS];
+
+    std::atomic<uint32_t> lock_acquisitions_;
+    std::atomic<uint32_t> lock_contended_;
+    std::atomic<uint32_t> lock_timeouts_;
+    mutable std::atomic<uint32_t> snapshot_reads_;
+    mutable std::atomic<uint32_t> snapshot_retries_;
+    mutable std::atomic<uint32_t> snapshot_fallbacks_;
+
+    std::atomic<uint32_t> generations_[(uint8_t)StateDomain::COUNT];
 
 #ifdef ESP32_BUILD
     SemaphoreHandle_t mutex_;
 #else
     std::mutex mutex_;
 #endif
+
+    // Hot field writers (mutex and sequence held); mirror into SensorState
+    void apply_raw_value(uint8_t sensor_id, float raw_value, uint32_t timestamp,
+                         bool is_extra = false);
+    void apply_filtered(uint8_t sensor_id, float filtered, float display);
+    void apply_quality(uint8_t sensor_id, SensorQuality quality);
+    bool is_suspect(const SensorState& sensor, float raw_value, bool is_extra) const;
+
+    // Writers call these with the mutex held
+    static void begin_write(std::atomic<uint32_t>& seq);
+    static void end_write(std::atomic<uint32_t>& seq);
+
+    template <typename Copy>
+    bool read_consistent(const std::atomic<uint32_t>& seq, Copy copy) const;
 };
 
 } // namespace core
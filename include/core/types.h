@@ -1,5 +1,6 @@
 #pragma once
 
+#include "running_window.h"
 #include <cstdint>
 
 namespace core {
@@ -70,13 +71,11 @@ struct SensorState {
     char name[MAX_NAME_LENGTH];
 
     // Base samples (guaranteed rate)
-    float base_samples[8];      // Ring buffer
-    uint8_t base_index;
+    RunningWindow<8> base_samples;      // Ring with sum/min/max/variance
     float base_average;
 
     // Extra samples (priority-based)
-    float extra_samples[16];    // Ring buffer
-    uint8_t extra_index;
+    RunningWindow<16> extra_samples;
     float extra_average;
 
     // Filtered values
@@ -98,14 +97,13 @@ struct SensorState {
     char unit[8];               // "°C", "bar", etc.
     float scale;                // Raw to engineering unit scale
     float offset;               // Calibration offset
+    float deadband;             // WebSocket push deadband (0 = default for unit)
 
     SensorState()
         : name{}
-        , base_samples{}
-        , base_index(0)
+        , base_samples()
         , base_average(0.0f)
-        , extra_samples{}
-        , extra_index(0)
+        , extra_samples()
         , extra_average(0.0f)
         , filtered_value(0.0f)
         , display_value(0.0f)
@@ -118,7 +116,8 @@ struct SensorState {
         , alpha(0.3f)
         , unit{}
         , scale(0.0f)
-        , offset(0.0f) {}
+        , offset(0.0f)
+        , deadband(0.0f) {}
 };
 
 /**
@@ -283,6 +282,28 @@ struct SystemState {
         , modbus_errors(0) {}
 };
 
+/**
+ * Parts of the state with their own change generation
+ * Telemetry counters (uptime, free heap, CPU load, MODBUS counters) belong
+ * to none of them: they change every control tick, so validators fold in
+ * the clock for bodies that show them instead.
+ */
+enum class StateDomain : uint8_t {
+    SENSORS = 0,
+    RELAYS,
+    FERMENTERS,         // Setpoints, modes, plan progress, PID output and tuning
+    ALARMS,
+    SYSTEM,             // NTP, WiFi RSSI, CPU clock
+    COUNT
+};
+
+/** Bit for a domain in a StateManager::get_generation() mask */
+constexpr uint8_t state_domain_bit(StateDomain domain) {
+    return (uint8_t)(1u << (uint8_t)domain);
+}
+
+constexpr uint8_t STATE_DOMAINS_ALL = (uint8_t)((1u << (uint8_t)StateDomain::COUNT) - 1);
+
 /**
  * Event types for Event Bus
  */
@@ -293,7 +314,8 @@ enum class EventType : uint8_t {
     PLAN_COMPLETE,
     ALARM,
     CONFIG_CHANGE,
-    SYSTEM_STATUS
+    SYSTEM_STATUS,
+    SENSORS_UPDATED             // Batch ingest: data.mask = sensor IDs updated
 };
 
 /**
@@ -307,6 +329,7 @@ struct Event {
         float value;
         bool state;
         uint8_t step;
+        uint32_t mask;          // One bit per sensor ID (MAX_SENSORS <= 32)
     } data;
 
     Event()
@@ -0,0 +1,64 @@
+#pragma once
+
+#ifdef ESP32_BUILD
+
+#include "hal/interfaces.h"
+#include "esp_partition.h"
+#include "esp_log.h"
+
+namespace hal {
+namespace esp32 {
+
+/**
+ * Raw access to a data partition from partitions.csv
+ */
+class ESP32FlashPartition : public IFlashPartition {
+public:
+    static constexpr const char* TAG = "ESP32Flash";
+
+    ESP32FlashPartition() : partition_(nullptr) {}
+
+    /**
+     * Look up a data partition by subtype and label
+     */
+    bool initialize(uint8_t subtype, const char* label) {
+        partition_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+            (esp_partition_subtype_t)subtype, label);
+        if (!partition_) {
+            ESP_LOGE(TAG, "Partition '%s' not found", label);
+            return false;
+        }
+        ESP_LOGI(TAG, "Partition '%s' at 0x%lx, %lu KB", label,
+                 (unsigned long)partition_->address, (unsigned long)(partition_->size / 1024));
+        return true;
+    }
+
+    size_t size() const override {
+        return partition_ ? partition_->size : 0;
+    }
+
+    size_t sector_size() const override {
+        return SPI_FLASH_SEC_SIZE;
+    }
+
+    bool read(size_t offset, void* data, size_t len) override {
+        return partition_ && esp_partition_read(partition_, offset, data, len) == ESP_OK;
+    }
+
+    bool write(size_t offset, const void* data, size_t len) override {
+        return partition_ && esp_partition_write(partition_, offset, data, len) == ESP_OK;
+    }
+
+    bool erase_sector(size_t offset) override {
+        return partition_ &&
+               esp_partition_erase_range(partition_, offset, SPI_FLASH_SEC_SIZE) == ESP_OK;
+    }
+
+private:
+    const esp_partition_t* partition_;
+};
+
+} // namespace esp32
+} // namespace hal
+
+#endif // ESP32_BUILD
@@ -3,8 +3,14 @@
 #ifdef ESP32_BUILD
 
 #include "hal/interfaces.h"
+#include "hal/modbus_rtu.h"
 #include "driver/uart.h"
+#include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include <cstring>
 
 namespace hal {
@@ -12,9 +18,11 @@ namespace esp32 {
 
 /**
  * ESP32 MODBUS RTU Master implementation
- * Uses UART for serial communication with MODBUS slave devices
+ * Uses UART for serial communication with MODBUS slave devices.
+ * Frames are handled by ModbusRtuMaster; the calling task sleeps in the
+ * UART driver while a frame is on the wire.
  */
-class ESP32Modbus : public IModbusInterface {
+class ESP32Modbus : public IModbusInterface, private IRtuPort {
 public:
     static constexpr const char* TAG = "ESP32Modbus";
     static constexpr size_t BUF_SIZE = 256;
@@ -26,8 +34,9 @@ public:
         , rx_pin_(rx_pin)
         , de_pin_(de_pin)
         , initialized_(false)
-        , transaction_count_(0)
-        , error_count_(0) {}
+        , has_peek_(false)
+        , peek_(0)
+        , master_(this, 57600, TIMEOUT_MS) {}
 
     /**
      * Initialize MODBUS communication
@@ -77,6 +86,8 @@ public:
             gpio_set_level((gpio_num_t)de_pin_, 0);  // Start in receive mode
         }
 
+        master_.set_baudrate(baud);
+
         initialized_ = true;
         ESP_LOGI(TAG, "MODBUS initialized on UART%d at %lu baud", port_, (unsigned long)baud);
         return true;
@@ -85,201 +96,145 @@ public:
     bool read_holding_registers(uint8_t slave_addr, uint16_t start_reg,
                                 uint16_t count, uint16_t* data) override {
         if (!initialized_) return false;
-        if (!data) return false;
-        if (count == 0 || count > 125) return false;  // Max 125 registers per request
-
-        // Flush any stale data in RX buffer
-        uart_flush_input(port_);
-
-        // Build request: [slave][0x03][reg_hi][reg_lo][count_hi][count_lo][crc_lo][crc_hi]
-        uint8_t request[8];
-        request[0] = slave_addr;
-        request[1] = 0x03;  // Read holding registers
-        request[2] = (start_reg >> 8) & 0xFF;
-        request[3] = start_reg & 0xFF;
-        request[4] = (count >> 8) & 0xFF;
-        request[5] = count & 0xFF;
-
-        uint16_t crc = calculate_crc(request, 6);
-        request[6] = crc & 0xFF;
-        request[7] = (crc >> 8) & 0xFF;
-
-        // Send request
-        set_transmit_mode(true);
-        uart_write_bytes(port_, (const char*)request, 8);
-        uart_wait_tx_done(port_, pdMS_TO_TICKS(100));
-        set_transmit_mode(false);
-
-        // Receive response
-        uint8_t response[256];
-        size_t expected_len = 3 + (count * 2) + 2;  // slave + func + byte_count + data + crc
-
-        int len = uart_read_bytes(port_, response, expected_len, pdMS_TO_TICKS(TIMEOUT_MS));
-
-        transaction_count_++;
-
-        if (len < (int)expected_len) {
-            error_count_++;
-            ESP_LOGW(TAG, "Timeout reading from slave %d", slave_addr);
-            return false;
-        }
-
-        // Verify response
-        if (response[0] != slave_addr || response[1] != 0x03) {
-            error_count_++;
-            ESP_LOGW(TAG, "Invalid response from slave %d", slave_addr);
-            return false;
-        }
-
-        // Verify CRC
-        uint16_t response_crc = response[len - 2] | (response[len - 1] << 8);
-        if (calculate_crc(response, len - 2) != response_crc) {
-            error_count_++;
-            ESP_LOGW(TAG, "CRC error from slave %d", slave_addr);
-            return false;
-        }
-
-        // Extract data (big-endian)
-        for (uint16_t i = 0; i < count; i++) {
-            data[i] = (response[3 + i * 2] << 8) | response[4 + i * 2];
-        }
 
-        return true;
+        ModbusRequest req;
+        req.slave_addr = slave_addr;
+        req.function = ModbusFunction::READ_HOLDING_REGISTERS;
+        req.start_reg = start_reg;
+        req.count = count;
+        req.data = data;
+        return check(master_.execute(req), slave_addr);
     }
 
     bool write_register(uint8_t slave_addr, uint16_t reg, uint16_t value) override {
         if (!initialized_) return false;
 
-        // Flush any stale data in RX buffer
-        uart_flush_input(port_);
-
-        // Build request: [slave][0x06][reg_hi][reg_lo][val_hi][val_lo][crc_lo][crc_hi]
-        uint8_t request[8];
-        request[0] = slave_addr;
-        request[1] = 0x06;  // Write single register
-        request[2] = (reg >> 8) & 0xFF;
-        request[3] = reg & 0xFF;
-        request[4] = (value >> 8) & 0xFF;
-        request[5] = value & 0xFF;
-
-        uint16_t crc = calculate_crc(request, 6);
-        request[6] = crc & 0xFF;
-        request[7] = (crc >> 8) & 0xFF;
-
-        // Send request
-        set_transmit_mode(true);
-        uart_write_bytes(port_, (const char*)request, 8);
-        uart_wait_tx_done(port_, pdMS_TO_TICKS(100));
-        set_transmit_mode(false);
-
-        // Receive response (echo)
-        uint8_t response[8];
-        int len = uart_read_bytes(port_, response, 8, pdMS_TO_TICKS(TIMEOUT_MS));
-
-        transaction_count_++;
-
-        if (len < 8) {
-            error_count_++;
-            return false;
-        }
-
-        // Verify echo
-        if (memcmp(request, response, 6) != 0) {
-            error_count_++;
-            return false;
-        }
-
-        return true;
+        ModbusRequest req;
+        req.slave_addr = slave_addr;
+        req.function = ModbusFunction::WRITE_SINGLE_REGISTER;
+        req.start_reg = reg;
+        req.count = 1;
+        req.data = &value;
+        return check(master_.execute(req), slave_addr);
     }
 
     bool write_multiple_registers(uint8_t slave_addr, uint16_t start_reg,
                                   uint16_t count, const uint16_t* data) override {
         if (!initialized_) return false;
-        if (!data) return false;
-        if (count == 0 || count > 123) return false;  // Max 123 registers per request
 
-        // Flush any stale data in RX buffer
-        uart_flush_input(port_);
+        ModbusRequest req;
+        req.slave_addr = slave_addr;
+        req.function = ModbusFunction::WRITE_MULTIPLE_REGISTERS;
+        req.start_reg = start_reg;
+        req.count = count;
+        req.data = const_cast<uint16_t*>(data);  // Only read for writes
+        return check(master_.execute(req), slave_addr);
+    }
 
-        // Build request
-        uint8_t request[256];
-        request[0] = slave_addr;
-        request[1] = 0x10;  // Write multiple registers
-        request[2] = (start_reg >> 8) & 0xFF;
-        request[3] = start_reg & 0xFF;
-        request[4] = (count >> 8) & 0xFF;
-        request[5] = count & 0xFF;
-        request[6] = count * 2;  // Byte count
-
-        // Add data (big-endian)
-        for (uint16_t i = 0; i < count; i++) {
-            request[7 + i * 2] = (data[i] >> 8) & 0xFF;
-            request[8 + i * 2] = data[i] & 0xFF;
-        }
+    uint32_t get_transaction_count() const override { return master_.get_transaction_count(); }
+    uint32_t get_error_count() const override { return master_.get_error_count(); }
 
-        size_t request_len = 7 + count * 2;
-        uint16_t crc = calculate_crc(request, request_len);
-        request[request_len] = crc & 0xFF;
-        request[request_len + 1] = (crc >> 8) & 0xFF;
-        request_len += 2;
+private:
+    uart_port_t port_;
+    int tx_pin_;
+    int rx_pin_;
+    int de_pin_;
+    bool initialized_;
+    bool has_peek_;             // Byte taken by wait_event(), returned by read()
+    uint8_t peek_;
+    ModbusRtuMaster master_;
+
+    bool check(ModbusStatus status, uint8_t slave_addr) {
+        switch (status) {
+            case ModbusStatus::OK:
+                return true;
+            case ModbusStatus::TIMEOUT:
+                ESP_LOGW(TAG, "Timeout reading from slave %d", slave_addr);
+                break;
+            case ModbusStatus::CRC_ERROR:
+                ESP_LOGW(TAG, "CRC error from slave %d", slave_addr);
+                break;
+            default:
+                ESP_LOGW(TAG, "Invalid response from slave %d", slave_addr);
+                break;
+        }
+        return false;
+    }
 
-        // Send request
-        set_transmit_mode(true);
-        uart_write_bytes(port_, (const char*)request, request_len);
-        uart_wait_tx_done(port_, pdMS_TO_TICKS(100));
-        set_transmit_mode(false);
+    // IRtuPort implementation (UART driver, zero-timeout calls)
 
-        // Receive response
-        uint8_t response[8];
-        int len = uart_read_bytes(port_, response, 8, pdMS_TO_TICKS(TIMEOUT_MS));
+    size_t write(const uint8_t* data, size_t len) override {
+        int n = uart_write_bytes(port_, (const char*)data, len);
+        return n > 0 ? (size_t)n : 0;
+    }
 
-        transaction_count_++;
+    bool tx_done() override {
+        return uart_wait_tx_done(port_, 0) == ESP_OK;
+    }
 
-        if (len < 8) {
-            error_count_++;
-            return false;
+    size_t read(uint8_t* buffer, size_t size) override {
+        if (size == 0) return 0;
+        size_t copied = 0;
+        if (has_peek_) {
+            buffer[copied++] = peek_;
+            has_peek_ = false;
         }
 
-        // Verify response
-        if (response[0] != slave_addr || response[1] != 0x10) {
-            error_count_++;
-            return false;
+        size_t available = 0;
+        uart_get_buffered_data_len(port_, &available);
+        if (available > size - copied) available = size - copied;
+        if (available > 0) {
+            int n = uart_read_bytes(port_, buffer + copied, available, 0);
+            if (n > 0) copied += n;
         }
-
-        return true;
+        return copied;
     }
 
-    uint32_t get_transaction_count() const override { return transaction_count_; }
-    uint32_t get_error_count() const override { return error_count_; }
-
-private:
-    uart_port_t port_;
-    int tx_pin_;
-    int rx_pin_;
-    int de_pin_;
-    bool initialized_;
-    uint32_t transaction_count_;
-    uint32_t error_count_;
+    void flush_input() override {
+        has_peek_ = false;
+        uart_flush_input(port_);
+    }
 
-    void set_transmit_mode(bool transmit) {
+    void set_transmit(bool transmit) override {
         if (de_pin_ >= 0) {
             gpio_set_level((gpio_num_t)de_pin_, transmit ? 1 : 0);
         }
     }
 
-    uint16_t calculate_crc(const uint8_t* data, size_t len) {
-        uint16_t crc = 0xFFFF;
-        for (size_t i = 0; i < len; i++) {
-            crc ^= data[i];
-            for (int j = 0; j < 8; j++) {
-                if (crc & 1) {
-                    crc = (crc >> 1) ^ 0xA001;
-                } else {
-                    crc >>= 1;
-                }
-            }
+    uint32_t micros() const override {
+        return (uint32_t)esp_timer_get_time();
+    }
+
+    void wait_us(uint32_t us) override {
+        // Character times are sub-millisecond; only yield for long waits
+        if (us >= 1000) {
+            vTaskDelay(1);
+        } else {
+            esp_rom_delay_us(us);
+        }
+    }
+
+    void wait_event(uint32_t timeout_us, uint32_t step_us) override {
+        (void)step_us;
+        if (timeout_us == 0) return;
+        // Block in the driver instead of spinning: the control task sleeps
+        // through the frame and a dead slave costs no CPU until the timeout
+        TickType_t ticks = pdMS_TO_TICKS((timeout_us + 999) / 1000);
+        if (ticks == 0) ticks = 1;
+
+        if (uart_wait_tx_done(port_, 0) != ESP_OK) {
+            uart_wait_tx_done(port_, ticks);
+            return;
+        }
+
+        size_t available = 0;
+        uart_get_buffered_data_len(port_, &available);
+        if (available > 0 || has_peek_) return;
+
+        // Wake on the first response byte and keep it for read()
+        if (uart_read_bytes(port_, &peek_, 1, ticks) == 1) {
+            has_peek_ = true;
         }
-        return crc;
     }
 };
 
@@ -0,0 +1,145 @@
+#pragma once
+
+#ifdef ESP32_BUILD
+
+#include "hal/interfaces.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "mqtt_client.h"
+#include "esp_log.h"
+#include <cstdint>
+#include <cstring>
+
+namespace hal {
+namespace esp32 {
+
+/**
+ * ESP32 MQTT client using esp-mqtt
+ * esp-mqtt runs its own task and reconnects by itself; publishes are
+ * enqueued (never block the caller) and PUBACKs come back through a
+ * FreeRTOS queue drained by poll_ack().
+ *
+ * The caller owns QoS 1 retransmission (see IMqttClient): esp-mqtt's own
+ * retransmit timer is pushed out of reach and its outbox is capped at
+ * MqttConnectOptions::outbox_limit, so it holds each publish only until
+ * the PUBACK (or its outbox expiry) instead of keeping a second resending
+ * copy of the caller's backlog.
+ */
+class ESP32Mqtt : public IMqttClient {
+public:
+    static constexpr int ACK_QUEUE_LEN = 16;
+
+    ESP32Mqtt() : client_(nullptr), acks_(nullptr), connected_(false),
+                  host_{}, client_id_{}, username_{}, password_{},
+                  will_topic_{}, will_message_{} {}
+
+    ~ESP32Mqtt() {
+        disconnect();
+        if (acks_) vQueueDelete(acks_);
+    }
+
+    bool connect(const MqttConnectOptions& options) override {
+        if (client_) return true;       // esp-mqtt retries on its own
+        if (!acks_) acks_ = xQueueCreate(ACK_QUEUE_LEN, sizeof(uint16_t));
+        if (!acks_) return false;
+
+        // esp-mqtt keeps pointers to the config strings
+        copy(host_, options.host, sizeof(host_));
+        copy(client_id_, options.client_id, sizeof(client_id_));
+        copy(username_, options.username, sizeof(username_));
+        copy(password_, options.password, sizeof(password_));
+        copy(will_topic_, options.will_topic, sizeof(will_topic_));
+        copy(will_message_, options.will_message, sizeof(will_message_));
+
+        esp_mqtt_client_config_t cfg = {};
+        cfg.broker.address.hostname = host_;
+        cfg.broker.address.port = options.port;
+        cfg.broker.address.transport = MQTT_TRANSPORT_OVER_TCP;
+        cfg.credentials.client_id = client_id_;
+        if (username_[0]) cfg.credentials.username = username_;
+        if (password_[0]) cfg.credentials.authentication.password = password_;
+        cfg.session.keepalive = options.keepalive_s;
+        cfg.session.message_retransmit_timeout = INT32_MAX;
+        cfg.outbox.limit = options.outbox_limit;
+        if (will_topic_[0]) {
+            cfg.session.last_will.topic = will_topic_;
+            cfg.session.last_will.msg = will_message_;
+            cfg.session.last_will.qos = 1;
+            cfg.session.last_will.retain = 1;
+        }
+
+        client_ = esp_mqtt_client_init(&cfg);
+        if (!client_) return false;
+        esp_mqtt_client_register_event(client_, MQTT_EVENT_ANY, event_handler, this);
+        if (esp_mqtt_client_start(client_) != ESP_OK) {
+            esp_mqtt_client_destroy(client_);
+            client_ = nullptr;
+            return false;
+        }
+        ESP_LOGI("MQTT", "Connecting to %s:%u", host_, options.port);
+        return true;
+    }
+
+    void disconnect() override {
+        if (!client_) return;
+        esp_mqtt_client_stop(client_);
+        esp_mqtt_client_destroy(client_);
+        client_ = nullptr;
+        connected_ = false;
+    }
+
+    bool is_connected() const override { return connected_; }
+
+    int publish(const char* topic, const void* payload, size_t len,
+                uint8_t qos, bool retain) override {
+        if (!client_ || !connected_) return -1;
+        return esp_mqtt_client_enqueue(client_, topic, static_cast<const char*>(payload),
+                                       (int)len, qos, retain ? 1 : 0, true);
+    }
+
+    bool poll_ack(uint16_t& msg_id) override {
+        return acks_ && xQueueReceive(acks_, &msg_id, 0) == pdTRUE;
+    }
+
+private:
+    esp_mqtt_client_handle_t client_;
+    QueueHandle_t acks_;
+    volatile bool connected_;
+    char host_[64];
+    char client_id_[32];
+    char username_[32];
+    char password_[64];
+    char will_topic_[96];
+    char will_message_[16];
+
+    static void copy(char* dst, const char* src, size_t size) {
+        strncpy(dst, src ? src : "", size - 1);
+        dst[size - 1] = '\0';
+    }
+
+    static void event_handler(void* arg, esp_event_base_t base, int32_t event_id, void* data) {
+        (void)base;
+        auto* self = static_cast<ESP32Mqtt*>(arg);
+        auto* event = static_cast<esp_mqtt_event_handle_t>(data);
+        switch ((esp_mqtt_event_id_t)event_id) {
+            case MQTT_EVENT_CONNECTED:
+                self->connected_ = true;
+                break;
+            case MQTT_EVENT_DISCONNECTED:
+                self->connected_ = false;
+                break;
+            case MQTT_EVENT_PUBLISHED: {
+                uint16_t id = (uint16_t)event->msg_id;
+                xQueueSend(self->acks_, &id, 0);    // Full: publisher resends
+                break;
+            }
+            default:
+                break;
+        }
+    }
+};
+
+} // namespace esp32
+} // namespace hal
+
+#endif // ESP32_BUILD
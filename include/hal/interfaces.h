@@ -57,7 +57,8 @@ public:
     ) = 0;
 
     /**
-     * Get total number of successful transactions
+     * Get total number of completed transactions, failed ones included
+     * (get_error_count() of them failed)
      */
     virtual uint32_t get_transaction_count() const = 0;
 
@@ -160,6 +161,34 @@ public:
     virtual bool commit() = 0;
 };
 
+/**
+ * Raw flash partition (NOR semantics)
+ * Writes can only clear bits; a sector must be erased (all 0xFF) before
+ * its bytes can be written again.
+ */
+class IFlashPartition {
+public:
+    virtual ~IFlashPartition() = default;
+
+    /**
+     * Total partition size in bytes (multiple of sector_size)
+     */
+    virtual size_t size() const = 0;
+
+    /**
+     * Erase unit in bytes
+     */
+    virtual size_t sector_size() const = 0;
+
+    virtual bool read(size_t offset, void* data, size_t len) = 0;
+    virtual bool write(size_t offset, const void* data, size_t len) = 0;
+
+    /**
+     * Erase the sector containing offset (offset must be sector aligned)
+     */
+    virtual bool erase_sector(size_t offset) = 0;
+};
+
 /**
  * Network interface for WiFi connectivity
  */
@@ -290,4 +319,61 @@ public:
     virtual void stop() = 0;
 };
 
+/**
+ * MQTT connection parameters
+ * Strings must stay valid until disconnect().
+ */
+struct MqttConnectOptions {
+    const char* host;
+    uint16_t port;
+    const char* client_id;
+    const char* username;       // nullptr or "" for none
+    const char* password;
+    uint16_t keepalive_s;
+    const char* will_topic;     // Retained last will, nullptr for none
+    const char* will_message;
+    size_t outbox_limit;        // Bytes of unacknowledged publishes to buffer, 0 = no limit
+};
+
+/**
+ * MQTT 3.1.1 client (publish only)
+ * The implementation keeps the connection; the caller keeps undelivered
+ * messages and retries them (QoS 1 is acknowledged via poll_ack()).
+ * Implementations send each publish once and never retransmit on their
+ * own, so a message is not delivered twice by client and caller.
+ */
+class IMqttClient {
+public:
+    virtual ~IMqttClient() = default;
+
+    /**
+     * Connect (or start connecting) to the broker
+     * @return true if the attempt was started
+     */
+    virtual bool connect(const MqttConnectOptions& options) = 0;
+
+    /**
+     * Close the connection
+     */
+    virtual void disconnect() = 0;
+
+    /**
+     * Check if the broker session is up (CONNACK received)
+     */
+    virtual bool is_connected() const = 0;
+
+    /**
+     * Queue a PUBLISH without waiting for the network
+     * @return Packet id (> 0) for QoS 1, 0 for QoS 0, -1 on failure
+     */
+    virtual int publish(const char* topic, const void* payload, size_t len,
+                        uint8_t qos, bool retain) = 0;
+
+    /**
+     * Service the connection and report the next acknowledged packet id
+     * @return true if msg_id was set; call until it returns false
+     */
+    virtual bool poll_ack(uint16_t& msg_id) = 0;
+};
+
 } // namespace hal
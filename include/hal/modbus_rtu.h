@@ -0,0 +1,473 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace hal {
+
+/**
+ * MODBUS function codes used by the controller
+ */
+enum class ModbusFunction : uint8_t {
+    READ_HOLDING_REGISTERS = 0x03,
+    READ_INPUT_REGISTERS = 0x04,
+    WRITE_SINGLE_REGISTER = 0x06,
+    WRITE_MULTIPLE_REGISTERS = 0x10
+};
+
+/**
+ * Completion status of a MODBUS RTU request
+ */
+enum class ModbusStatus : uint8_t {
+    PENDING = 0,
+    OK,
+    TIMEOUT,
+    CRC_ERROR,
+    INVALID_RESPONSE,
+    EXCEPTION       // Slave answered with an exception frame
+};
+
+struct ModbusRequest;
+
+/**
+ * Completion callback of a queued ModbusRtuMaster request
+ * Called exactly once per accepted request, from process() (never from
+ * an ISR).
+ */
+typedef void (*ModbusCallback)(const ModbusRequest& request, ModbusStatus status, void* ctx);
+
+/**
+ * MODBUS RTU request descriptor
+ * Buffers are owned by the caller and must stay valid until completion.
+ */
+struct ModbusRequest {
+    uint8_t slave_addr;
+    ModbusFunction function;
+    uint16_t start_reg;
+    uint16_t count;
+    uint16_t* data;             // Read destination / write source
+    ModbusCallback callback;    // Optional
+    void* ctx;                  // Passed to callback
+
+    ModbusRequest()
+        : slave_addr(0)
+        , function(ModbusFunction::READ_HOLDING_REGISTERS)
+        , start_reg(0)
+        , count(0)
+        , data(nullptr)
+        , callback(nullptr)
+        , ctx(nullptr) {}
+};
+
+/**
+ * Byte-level port used by the MODBUS RTU master
+ * All calls except wait_us() and wait_event() must be non-blocking.
+ */
+class IRtuPort {
+public:
+    virtual ~IRtuPort() = default;
+
+    /**
+     * Queue bytes for transmission
+     * @return Number of bytes accepted
+     */
+    virtual size_t write(const uint8_t* data, size_t len) = 0;
+
+    /**
+     * Check whether the last queued byte has left the transmitter
+     */
+    virtual bool tx_done() = 0;
+
+    /**
+     * Read whatever bytes are already received
+     * @return Number of bytes copied (0 if none)
+     */
+    virtual size_t read(uint8_t* buffer, size_t size) = 0;
+
+    /**
+     * Discard any stale received bytes
+     */
+    virtual void flush_input() {}
+
+    /**
+     * Switch RS485 driver enable (true = transmit)
+     */
+    virtual void set_transmit(bool transmit) { (void)transmit; }
+
+    /**
+     * Monotonic microsecond clock (wraps at 2^32)
+     */
+    virtual uint32_t micros() const = 0;
+
+    /**
+     * Sleep/yield while waiting; only used by blocking helpers
+     */
+    virtual void wait_us(uint32_t us) = 0;
+
+    /**
+     * Wait while a frame is on the wire; only used by blocking helpers
+     * Returns once the transmitter is done or bytes were received, at the
+     * latest after timeout_us. Ports with a driver that can block on these
+     * events should override this; the default sleeps one step_us.
+     * @param timeout_us Time until the master gives up waiting
+     * @param step_us Polling step (one character time)
+     */
+    virtual void wait_event(uint32_t timeout_us, uint32_t step_us) {
+        wait_us(step_us < timeout_us ? step_us : timeout_us);
+    }
+};
+
+/**
+ * MODBUS RTU master state machine
+ *
+ * The drivers call execute(), which runs one request to completion and
+ * sleeps in the port while the frame is on the wire. Underneath, requests
+ * are queued with submit() and driven by process(), which never blocks. End-of-frame is detected from the 3.5-character silent interval
+ * (or as soon as the expected length has arrived), and the next queued
+ * request goes out as soon as the inter-frame gap has elapsed, so requests
+ * to several slaves run back-to-back without fixed sleeps.
+ *
+ * RTU is half-duplex with a single master, so frames never overlap on the
+ * wire; the queue only removes the idle time between them.
+ */
+class ModbusRtuMaster {
+public:
+    static constexpr uint8_t QUEUE_SIZE = 16;
+    static constexpr size_t MAX_FRAME = 256;
+    static constexpr uint16_t MAX_READ_REGISTERS = 125;
+    static constexpr uint16_t MAX_WRITE_REGISTERS = 123;
+
+    /**
+     * @param port Byte port (not owned)
+     * @param baud Line baud rate, used for frame timing
+     * @param response_timeout_ms Max wait for the first response byte
+     */
+    explicit ModbusRtuMaster(IRtuPort* port, uint32_t baud = 9600,
+                             uint32_t response_timeout_ms = 100)
+        : port_(port)
+        , response_timeout_us_(response_timeout_ms * 1000)
+        , state_(State::IDLE)
+        , head_(0)
+        , count_(0)
+        , tx_len_(0)
+        , rx_len_(0)
+        , expected_len_(0)
+        , tx_end_us_(0)
+        , last_rx_us_(0)
+        , bus_idle_since_us_(0)
+        , transaction_count_(0)
+        , error_count_(0) {
+        set_baudrate(baud);
+    }
+
+    /**
+     * Update frame timing for a new baud rate
+     * Per the MODBUS serial line spec, rates above 19200 use a fixed
+     * 1750us silent interval.
+     */
+    void set_baudrate(uint32_t baud) {
+        if (baud == 0) baud = 9600;
+        // 11 bits per character (start + 8 data + parity/stop + stop)
+        char_time_us_ = (11000000UL + baud - 1) / baud;
+        silent_interval_us_ = baud > 19200 ? 1750 : (char_time_us_ * 7 + 1) / 2;
+    }
+
+    void set_response_timeout_ms(uint32_t ms) { response_timeout_us_ = ms * 1000; }
+
+    uint32_t get_char_time_us() const { return char_time_us_; }
+    uint32_t get_silent_interval_us() const { return silent_interval_us_; }
+
+    /**
+     * Queue a request
+     * @return false if invalid or the queue is full
+     */
+    bool submit(const ModbusRequest& request) {
+        if (!is_valid(request) || count_ >= QUEUE_SIZE) return false;
+
+        queue_[(head_ + count_) % QUEUE_SIZE] = request;
+        count_++;
+        process();
+        return true;
+    }
+
+    /**
+     * Advance the state machine; never blocks
+     */
+    void process() {
+        if (!port_) return;
+
+        // Bounded: a completed frame may immediately start the next one
+        for (uint8_t step = 0; step < 3; step++) {
+            uint32_t now = port_->micros();
+            State before = state_;
+
+            switch (state_) {
+                case State::IDLE:
+                    if (count_ > 0 && now - bus_idle_since_us_ >= silent_interval_us_) {
+                        start_transmit(now);
+                    }
+                    break;
+
+                case State::TRANSMIT:
+                    if (port_->tx_done()) {
+                        port_->set_transmit(false);
+                        tx_end_us_ = now;
+                        last_rx_us_ = now;
+                        rx_len_ = 0;
+                        state_ = State::RECEIVE;
+                    }
+                    break;
+
+                case State::RECEIVE:
+                    receive(now);
+                    break;
+            }
+
+            if (state_ == before) break;
+        }
+    }
+
+    /**
+     * Run one request to completion (blocking helper for sync callers)
+     * Other queued requests are serviced first in FIFO order.
+     */
+    ModbusStatus execute(const ModbusRequest& request) {
+        ModbusRequest req = request;
+        ModbusStatus status = ModbusStatus::PENDING;
+        req.callback = on_sync_complete;
+        req.ctx = &status;
+
+        if (!is_valid(req)) {
+            return ModbusStatus::INVALID_RESPONSE;  // Rejected, nothing sent
+        }
+        while (!submit(req)) {
+            wait_step();  // Queue full - drain
+        }
+
+        while (status == ModbusStatus::PENDING) {
+            wait_step();
+        }
+
+        if (request.callback) {
+            request.callback(request, status, request.ctx);
+        }
+        return status;
+    }
+
+    uint8_t pending() const { return count_; }
+    bool is_idle() const { return count_ == 0 && state_ == State::IDLE; }
+
+    uint32_t get_transaction_count() const { return transaction_count_; }
+    uint32_t get_error_count() const { return error_count_; }
+
+    /**
+     * MODBUS CRC-16 (poly 0xA001, init 0xFFFF)
+     */
+    static uint16_t crc16(const uint8_t* data, size_t len) {
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 0; i < len; i++) {
+            crc ^= data[i];
+            for (int j = 0; j < 8; j++) {
+                if (crc & 1) {
+                    crc = (crc >> 1) ^ 0xA001;
+                } else {
+                    crc >>= 1;
+                }
+            }
+        }
+        return crc;
+    }
+
+private:
+    enum class State : uint8_t {
+        IDLE,       // Waiting for a request and the inter-frame gap
+        TRANSMIT,   // Request frame being shifted out
+        RECEIVE     // Collecting response bytes until silence
+    };
+
+    IRtuPort* port_;
+    uint32_t char_time_us_;
+    uint32_t silent_interval_us_;
+    uint32_t response_timeout_us_;
+    State state_;
+
+    ModbusRequest queue_[QUEUE_SIZE];
+    uint8_t head_;
+    uint8_t count_;
+
+    uint8_t tx_buf_[MAX_FRAME];
+    uint8_t rx_buf_[MAX_FRAME];
+    size_t tx_len_;
+    size_t rx_len_;
+    size_t expected_len_;
+
+    uint32_t tx_end_us_;
+    uint32_t last_rx_us_;
+    uint32_t bus_idle_since_us_;
+
+    uint32_t transaction_count_;
+    uint32_t error_count_;
+
+    static bool is_read(ModbusFunction fn) {
+        return fn == ModbusFunction::READ_HOLDING_REGISTERS ||
+               fn == ModbusFunction::READ_INPUT_REGISTERS;
+    }
+
+    bool is_valid(const ModbusRequest& request) const {
+        if (!port_ || !request.data || request.count == 0) return false;
+        if (is_read(request.function) && request.count > MAX_READ_REGISTERS) return false;
+        if (request.function == ModbusFunction::WRITE_MULTIPLE_REGISTERS &&
+            request.count > MAX_WRITE_REGISTERS) return false;
+        return true;
+    }
+
+    static void on_sync_complete(const ModbusRequest& request, ModbusStatus status, void* ctx) {
+        (void)request;
+        *static_cast<ModbusStatus*>(ctx) = status;
+    }
+
+    void wait_step() {
+        process();
+
+        // Inter-frame gap is sub-millisecond; a frame in flight can take up
+        // to the response timeout, so let the port sleep until it progresses
+        uint32_t now = port_->micros();
+        switch (state_) {
+            case State::IDLE:
+                port_->wait_us(char_time_us_);
+                break;
+            case State::TRANSMIT:
+                port_->wait_event(response_timeout_us_, char_time_us_);
+                break;
+            case State::RECEIVE: {
+                uint32_t elapsed = now - (rx_len_ == 0 ? tx_end_us_ : last_rx_us_);
+                uint32_t limit = rx_len_ == 0 ? response_timeout_us_ : silent_interval_us_;
+                port_->wait_event(elapsed < limit ? limit - elapsed : 0, char_time_us_);
+                break;
+            }
+        }
+    }
+
+    void start_transmit(uint32_t now) {
+        const ModbusRequest& req = queue_[head_];
+
+        tx_buf_[0] = req.slave_addr;
+        tx_buf_[1] = static_cast<uint8_t>(req.function);
+        tx_buf_[2] = (req.start_reg >> 8) & 0xFF;
+        tx_buf_[3] = req.start_reg & 0xFF;
+
+        switch (req.function) {
+            case ModbusFunction::READ_HOLDING_REGISTERS:
+            case ModbusFunction::READ_INPUT_REGISTERS:
+                tx_buf_[4] = (req.count >> 8) & 0xFF;
+                tx_buf_[5] = req.count & 0xFF;
+                tx_len_ = 6;
+                expected_len_ = 5 + req.count * 2;  // addr + fn + byte_count + data + crc
+                break;
+
+            case ModbusFunction::WRITE_SINGLE_REGISTER:
+                tx_buf_[4] = (req.data[0] >> 8) & 0xFF;
+                tx_buf_[5] = req.data[0] & 0xFF;
+                tx_len_ = 6;
+                expected_len_ = 8;  // Echo
+                break;
+
+            case ModbusFunction::WRITE_MULTIPLE_REGISTERS:
+                tx_buf_[4] = (req.count >> 8) & 0xFF;
+                tx_buf_[5] = req.count & 0xFF;
+                tx_buf_[6] = req.count * 2;
+                for (uint16_t i = 0; i < req.count; i++) {
+                    tx_buf_[7 + i * 2] = (req.data[i] >> 8) & 0xFF;
+                    tx_buf_[8 + i * 2] = req.data[i] & 0xFF;
+                }
+                tx_len_ = 7 + req.count * 2;
+                expected_len_ = 8;  // addr + fn + start + count + crc
+                break;
+        }
+
+        uint16_t crc = crc16(tx_buf_, tx_len_);
+        tx_buf_[tx_len_++] = crc & 0xFF;
+        tx_buf_[tx_len_++] = (crc >> 8) & 0xFF;
+
+        port_->flush_input();
+        port_->set_transmit(true);
+        port_->write(tx_buf_, tx_len_);
+        tx_end_us_ = now;
+        state_ = State::TRANSMIT;
+    }
+
+    void receive(uint32_t now) {
+        if (rx_len_ < MAX_FRAME) {
+            size_t n = port_->read(rx_buf_ + rx_len_, MAX_FRAME - rx_len_);
+            if (n > 0) {
+                rx_len_ += n;
+                last_rx_us_ = now;
+            }
+        }
+
+        if (rx_len_ == 0) {
+            if (now - tx_end_us_ >= response_timeout_us_) {
+                complete(ModbusStatus::TIMEOUT, now);
+            }
+            return;
+        }
+
+        // Exception frames are always 5 bytes
+        bool exception = rx_len_ >= 2 && (rx_buf_[1] & 0x80);
+        if (rx_len_ >= expected_len_ || (exception && rx_len_ >= 5) ||
+            now - last_rx_us_ >= silent_interval_us_) {
+            complete(parse_response(), now);
+        }
+    }
+
+    ModbusStatus parse_response() {
+        const ModbusRequest& req = queue_[head_];
+        uint8_t fn = static_cast<uint8_t>(req.function);
+
+        if (rx_len_ < 5) return ModbusStatus::INVALID_RESPONSE;
+
+        uint16_t recv_crc = rx_buf_[rx_len_ - 2] | (rx_buf_[rx_len_ - 1] << 8);
+        if (crc16(rx_buf_, rx_len_ - 2) != recv_crc) return ModbusStatus::CRC_ERROR;
+
+        if (rx_buf_[0] != req.slave_addr) return ModbusStatus::INVALID_RESPONSE;
+        if (rx_buf_[1] == (fn | 0x80)) return ModbusStatus::EXCEPTION;
+        if (rx_buf_[1] != fn || rx_len_ != expected_len_) return ModbusStatus::INVALID_RESPONSE;
+
+        if (is_read(req.function)) {
+            if (rx_buf_[2] != req.count * 2) return ModbusStatus::INVALID_RESPONSE;
+            for (uint16_t i = 0; i < req.count; i++) {
+                req.data[i] = (rx_buf_[3 + i * 2] << 8) | rx_buf_[4 + i * 2];
+            }
+        } else if (req.function == ModbusFunction::WRITE_SINGLE_REGISTER) {
+            if (memcmp(tx_buf_, rx_buf_, 6) != 0) return ModbusStatus::INVALID_RESPONSE;
+        } else {
+            if (memcmp(tx_buf_ + 2, rx_buf_ + 2, 4) != 0) return ModbusStatus::INVALID_RESPONSE;
+        }
+
+        return ModbusStatus::OK;
+    }
+
+    void complete(ModbusStatus status, uint32_t now) {
+        ModbusRequest req = queue_[head_];
+        head_ = (head_ + 1) % QUEUE_SIZE;
+        count_--;
+
+        // Every completion counts, as in the synchronous drivers; the error
+        // rate is error_count_ / transaction_count_
+        transaction_count_++;
+        if (status != ModbusStatus::OK) {
+            error_count_++;
+        }
+
+        // Gap before the next frame counts from the end of this one
+        bus_idle_since_us_ = now;
+        state_ = State::IDLE;
+
+        if (req.callback) {
+            req.callback(req, status, req.ctx);
+        }
+    }
+};
+
+} // namespace hal
@@ -225,6 +225,61 @@ private:
     std::map<std::string, int32_t> ints_;
 };
 
+/**
+ * Simulated flash partition with NOR write semantics
+ * Tracks erase counts per sector for wear checks.
+ */
+class SimulatorFlash : public IFlashPartition {
+public:
+    explicit SimulatorFlash(size_t size = 64 * 4096, size_t sector_size = 4096)
+        : sector_size_(sector_size)
+        , data_(size, 0xFF)
+        , erase_counts_(size / sector_size, 0)
+        , write_limit_(SIZE_MAX) {}
+
+    size_t size() const override { return data_.size(); }
+    size_t sector_size() const override { return sector_size_; }
+
+    bool read(size_t offset, void* data, size_t len) override {
+        if (offset + len > data_.size()) return false;
+        memcpy(data, data_.data() + offset, len);
+        return true;
+    }
+
+    bool write(size_t offset, const void* data, size_t len) override {
+        if (offset + len > data_.size()) return false;
+        const uint8_t* src = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < len; i++) {
+            if (write_limit_ == 0) return false;  // Simulated power loss
+            if (write_limit_ != SIZE_MAX) write_limit_--;
+            data_[offset + i] &= src[i];
+        }
+        return true;
+    }
+
+    bool erase_sector(size_t offset) override {
+        if (offset % sector_size_ != 0 || offset >= data_.size()) return false;
+        memset(data_.data() + offset, 0xFF, sector_size_);
+        erase_counts_[offset / sector_size_]++;
+        return true;
+    }
+
+    // Test helpers
+
+    /** Fail writes after `bytes` more bytes (torn write on power loss) */
+    void fail_after(size_t bytes) { write_limit_ = bytes; }
+    void restore_power() { write_limit_ = SIZE_MAX; }
+
+    uint32_t get_erase_count(size_t sector) const { return erase_counts_[sector]; }
+    const std::vector<uint8_t>& get_data() const { return data_; }
+
+private:
+    size_t sector_size_;
+    std::vector<uint8_t> data_;
+    std::vector<uint32_t> erase_counts_;
+    size_t write_limit_;
+};
+
 /**
  * Simulated network interface for testing
  */
@@ -266,6 +321,79 @@ private:
     int rssi_;
 };
 
+/**
+ * Simulated MQTT client for testing
+ * Records publishes; the broker can be taken down and acks held back.
+ */
+class SimulatorMqtt : public IMqttClient {
+public:
+    struct Published {
+        std::string topic;
+        std::string payload;
+        uint8_t qos;
+        bool retain;
+        uint16_t msg_id;
+    };
+
+    SimulatorMqtt()
+        : connected_(false), broker_up_(true), auto_ack_(true),
+          next_id_(1), connect_count_(0) {}
+
+    bool connect(const MqttConnectOptions& options) override {
+        connect_count_++;
+        will_topic_ = options.will_topic ? options.will_topic : "";
+        connected_ = broker_up_;
+        return true;
+    }
+
+    void disconnect() override { connected_ = false; }
+
+    bool is_connected() const override { return connected_; }
+
+    int publish(const char* topic, const void* payload, size_t len,
+                uint8_t qos, bool retain) override {
+        if (!connected_) return -1;
+        uint16_t id = qos ? next_id_++ : 0;
+        if (next_id_ == 0) next_id_ = 1;
+        published_.push_back({topic, std::string(static_cast<const char*>(payload), len),
+                              qos, retain, id});
+        if (qos && auto_ack_) acks_.push(id);
+        return id;
+    }
+
+    bool poll_ack(uint16_t& msg_id) override {
+        if (!connected_ || acks_.empty()) return false;
+        msg_id = acks_.front();
+        acks_.pop();
+        return true;
+    }
+
+    // Test helpers
+    void set_broker_up(bool up) {
+        broker_up_ = up;
+        if (!up) {
+            connected_ = false;
+            acks_ = std::queue<uint16_t>();     // Lost with the connection
+        }
+    }
+    void set_auto_ack(bool enabled) { auto_ack_ = enabled; }
+    void ack(uint16_t msg_id) { acks_.push(msg_id); }
+    const std::vector<Published>& get_published() const { return published_; }
+    void clear_published() { published_.clear(); }
+    int get_connect_count() const { return connect_count_; }
+    const std::string& get_will_topic() const { return will_topic_; }
+
+private:
+    bool connected_;
+    bool broker_up_;
+    bool auto_ack_;
+    uint16_t next_id_;
+    int connect_count_;
+    std::string will_topic_;
+    std::vector<Published> published_;
+    std::queue<uint16_t> acks_;
+};
+
 /**
  * Simulated time interface for testing
  * Allows manual time control for deterministic tests
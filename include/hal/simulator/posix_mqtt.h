@@ -0,0 +1,251 @@
+#pragma once
+
+#include "hal/interfaces.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace hal {
+namespace simulator {
+
+/**
+ * Minimal MQTT 3.1.1 publish client over POSIX sockets
+ * Lets the simulator and native tests talk to a real local broker
+ * (e.g. mosquitto). CONNECT waits for CONNACK; PUBLISH is written
+ * directly; PUBACK and PINGRESP are read without blocking in poll_ack(),
+ * which also sends PINGREQ at half the keepalive.
+ */
+class PosixMqtt : public IMqttClient {
+public:
+    static constexpr int IO_TIMEOUT_MS = 2000;
+
+    PosixMqtt() : fd_(-1), connected_(false), next_id_(1), keepalive_s_(0),
+                  last_tx_ms_(0), rx_len_(0), rx_{} {}
+
+    ~PosixMqtt() { close_socket(); }
+
+    bool connect(const MqttConnectOptions& options) override {
+        close_socket();
+        if (!open_socket(options.host, options.port)) return false;
+
+        std::vector<uint8_t> body;
+        put_string(body, "MQTT");
+        body.push_back(4);                              // Protocol level 3.1.1
+        uint8_t flags = 0x02;                           // Clean session
+        if (options.will_topic) flags |= 0x04 | 0x08 | 0x20;   // Will, QoS 1, retain
+        bool user = options.username && options.username[0];
+        if (user) flags |= 0x80;
+        if (user && options.password && options.password[0]) flags |= 0x40;
+        body.push_back(flags);
+        body.push_back(options.keepalive_s >> 8);
+        body.push_back(options.keepalive_s & 0xFF);
+        put_string(body, options.client_id ? options.client_id : "");
+        if (options.will_topic) {
+            put_string(body, options.will_topic);
+            put_string(body, options.will_message ? options.will_message : "");
+        }
+        if (flags & 0x80) put_string(body, options.username);
+        if (flags & 0x40) put_string(body, options.password);
+
+        uint8_t connack[4];
+        if (!send_packet(0x10, body) || !recv_exact(connack, sizeof(connack)) ||
+            connack[0] != 0x20 || connack[3] != 0) {
+            printf("MQTT: connect to %s:%u failed\n", options.host, options.port);
+            close_socket();
+            return false;
+        }
+        keepalive_s_ = options.keepalive_s;
+        connected_ = true;
+        return true;
+    }
+
+    void disconnect() override {
+        if (connected_) {
+            std::vector<uint8_t> empty;
+            send_packet(0xE0, empty);
+        }
+        close_socket();
+    }
+
+    bool is_connected() const override { return connected_; }
+
+    int publish(const char* topic, const void* payload, size_t len,
+                uint8_t qos, bool retain) override {
+        if (!connected_) return -1;
+        std::vector<uint8_t> body;
+        put_string(body, topic);
+        uint16_t id = 0;
+        if (qos > 0) {
+            id = next_id_++;
+            if (next_id_ == 0) next_id_ = 1;
+            body.push_back(id >> 8);
+            body.push_back(id & 0xFF);
+        }
+        const uint8_t* p = static_cast<const uint8_t*>(payload);
+        body.insert(body.end(), p, p + len);
+        uint8_t type = 0x30 | ((qos > 0 ? 1 : 0) << 1) | (retain ? 1 : 0);
+        if (!send_packet(type, body)) {
+            close_socket();
+            return -1;
+        }
+        return id;
+    }
+
+    bool poll_ack(uint16_t& msg_id) override {
+        if (!connected_) return false;
+
+        if (keepalive_s_ && now_ms() - last_tx_ms_ >= keepalive_s_ * 500u) {
+            std::vector<uint8_t> empty;
+            if (!send_packet(0xC0, empty)) {
+                close_socket();
+                return false;
+            }
+        }
+
+        for (;;) {
+            if (take_packet(msg_id)) return true;
+            if (rx_len_ == sizeof(rx_)) {               // Oversized packet
+                close_socket();
+                return false;
+            }
+            ssize_t n = recv(fd_, rx_ + rx_len_, sizeof(rx_) - rx_len_, MSG_DONTWAIT);
+            if (n > 0) {
+                rx_len_ += n;
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) close_socket();
+            return false;
+        }
+    }
+
+private:
+    int fd_;
+    bool connected_;
+    uint16_t next_id_;
+    uint16_t keepalive_s_;
+    uint32_t last_tx_ms_;
+    size_t rx_len_;
+    uint8_t rx_[512];
+
+    static uint32_t now_ms() {
+        using namespace std::chrono;
+        return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool open_socket(const char* host, uint16_t port) {
+        char service[8];
+        snprintf(service, sizeof(service), "%u", port);
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* result = nullptr;
+        if (!host || getaddrinfo(host, service, &hints, &result) != 0) return false;
+
+        for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+            fd_ = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+            if (fd_ < 0) continue;
+            timeval tv = {IO_TIMEOUT_MS / 1000, (IO_TIMEOUT_MS % 1000) * 1000};
+            setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+            setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+            int one = 1;
+            setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            if (::connect(fd_, ai->ai_addr, ai->ai_addrlen) == 0) break;
+            close(fd_);
+            fd_ = -1;
+        }
+        freeaddrinfo(result);
+        rx_len_ = 0;
+        return fd_ >= 0;
+    }
+
+    void close_socket() {
+        if (fd_ >= 0) close(fd_);
+        fd_ = -1;
+        connected_ = false;
+        rx_len_ = 0;
+    }
+
+    static void put_string(std::vector<uint8_t>& out, const char* s) {
+        size_t len = strlen(s);
+        out.push_back(len >> 8);
+        out.push_back(len & 0xFF);
+        out.insert(out.end(), s, s + len);
+    }
+
+    bool send_packet(uint8_t type, const std::vector<uint8_t>& body) {
+        std::vector<uint8_t> packet;
+        packet.reserve(body.size() + 5);
+        packet.push_back(type);
+        size_t remaining = body.size();
+        do {                                            // Variable-length encoding
+            uint8_t digit = remaining % 128;
+            remaining /= 128;
+            packet.push_back(remaining ? digit | 0x80 : digit);
+        } while (remaining);
+        packet.insert(packet.end(), body.begin(), body.end());
+
+        size_t sent = 0;
+        while (sent < packet.size()) {
+            ssize_t n = send(fd_, packet.data() + sent, packet.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += n;
+        }
+        last_tx_ms_ = now_ms();
+        return true;
+    }
+
+    bool recv_exact(uint8_t* out, size_t len) {
+        size_t got = 0;
+        while (got < len) {
+            ssize_t n = recv(fd_, out + got, len - got, 0);
+            if (n <= 0) return false;
+            got += n;
+        }
+        return true;
+    }
+
+    /**
+     * Consume complete packets from rx_; stops at a PUBACK
+     * @return true if msg_id was set
+     */
+    bool take_packet(uint16_t& msg_id) {
+        while (rx_len_ >= 2) {
+            size_t remaining = 0;
+            size_t header = 1;
+            int shift = 0;
+            for (;;) {
+                if (header >= rx_len_) return false;    // Length incomplete
+                uint8_t digit = rx_[header++];
+                remaining |= (size_t)(digit & 0x7F) << shift;
+                shift += 7;
+                if (!(digit & 0x80)) break;
+                if (shift > 21) {
+                    close_socket();
+                    return false;
+                }
+            }
+            size_t total = header + remaining;
+            if (rx_len_ < total) return false;
+
+            bool puback = (rx_[0] >> 4) == 4 && remaining >= 2;
+            if (puback) msg_id = (uint16_t)((rx_[header] << 8) | rx_[header + 1]);
+            memmove(rx_, rx_ + total, rx_len_ - total);
+            rx_len_ -= total;
+            if (puback) return true;
+            // PINGRESP or anything else: skip
+        }
+        return false;
+    }
+};
+
+} // namespace simulator
+} // namespace hal
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "hal/modbus_rtu.h"
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace hal {
+namespace simulator {
+
+/**
+ * Simulated RS485 line with MODBUS RTU slaves
+ * Models byte timing at the configured baud rate on a virtual microsecond
+ * clock, so transport timing can be measured deterministically.
+ */
+class SimulatorRtuLine : public IRtuPort {
+public:
+    explicit SimulatorRtuLine(uint32_t baud = 9600)
+        : now_us_(0)
+        , tx_end_us_(0)
+        , tx_pending_(false)
+        , corrupt_next_(false)
+        , frames_sent_(0)
+        , event_waits_(0) {
+        set_baudrate(baud);
+    }
+
+    void set_baudrate(uint32_t baud) {
+        char_time_us_ = (11000000UL + baud - 1) / baud;
+    }
+
+    /**
+     * Add a slave that answers after response_delay_us of processing
+     */
+    void add_slave(uint8_t addr, uint32_t response_delay_us = 1000) {
+        slaves_[addr] = response_delay_us;
+    }
+
+    void set_register(uint8_t addr, uint16_t reg, uint16_t value) {
+        registers_[((uint32_t)addr << 16) | reg] = value;
+    }
+
+    uint16_t get_register(uint8_t addr, uint16_t reg) const {
+        auto it = registers_.find(((uint32_t)addr << 16) | reg);
+        return it != registers_.end() ? it->second : 0;
+    }
+
+    /** Flip a bit in the next response so its CRC fails */
+    void corrupt_next_response() { corrupt_next_ = true; }
+
+    void advance_us(uint32_t us) { now_us_ += us; }
+    uint32_t get_frames_sent() const { return frames_sent_; }
+    uint32_t get_event_waits() const { return event_waits_; }
+
+    /** Start time (us) of each request frame, for gap checks */
+    const std::vector<uint32_t>& get_frame_starts() const { return frame_starts_; }
+
+    // IRtuPort implementation
+
+    size_t write(const uint8_t* data, size_t len) override {
+        uint32_t start = tx_pending_ && tx_end_us_ > now_us_ ? tx_end_us_ : now_us_;
+        frame_starts_.push_back(start);
+        frames_sent_++;
+
+        tx_frame_.assign(data, data + len);
+        tx_end_us_ = start + len * char_time_us_;
+        tx_pending_ = true;
+        return len;
+    }
+
+    bool tx_done() override {
+        update();
+        return now_us_ >= tx_end_us_;
+    }
+
+    size_t read(uint8_t* buffer, size_t size) override {
+        update();
+        size_t n = 0;
+        while (n < size && !rx_.empty() && rx_.front().at_us <= now_us_) {
+            buffer[n++] = rx_.front().value;
+            rx_.erase(rx_.begin());
+        }
+        return n;
+    }
+
+    void flush_input() override {
+        update();
+        while (!rx_.empty() && rx_.front().at_us <= now_us_) {
+            rx_.erase(rx_.begin());
+        }
+    }
+
+    uint32_t micros() const override { return now_us_; }
+
+    void wait_us(uint32_t us) override { now_us_ += us; }
+
+    /**
+     * Jump to the next line event (transmit done, a byte received or the
+     * timeout), like a driver that blocks on UART events
+     */
+    void wait_event(uint32_t timeout_us, uint32_t step_us) override {
+        (void)step_us;
+        event_waits_++;
+        update();
+        uint32_t until = now_us_ + timeout_us;
+        if (tx_pending_ && tx_end_us_ < until) until = tx_end_us_;
+        if (!rx_.empty() && rx_.front().at_us < until) until = rx_.front().at_us;
+        if (until > now_us_) now_us_ = until;
+    }
+
+private:
+    struct TimedByte {
+        uint8_t value;
+        uint32_t at_us;
+    };
+
+    uint32_t now_us_;
+    uint32_t char_time_us_;
+    uint32_t tx_end_us_;
+    bool tx_pending_;
+    bool corrupt_next_;
+    uint32_t frames_sent_;
+    uint32_t event_waits_;
+
+    std::map<uint8_t, uint32_t> slaves_;
+    std::map<uint32_t, uint16_t> registers_;
+    std::vector<uint8_t> tx_frame_;
+    std::vector<TimedByte> rx_;
+    std::vector<uint32_t> frame_starts_;
+
+    /**
+     * Once the request has been fully transmitted, schedule the slave reply
+     */
+    void update() {
+        if (!tx_pending_ || now_us_ < tx_end_us_) return;
+        tx_pending_ = false;
+
+        if (tx_frame_.size() < 8) return;
+        uint8_t addr = tx_frame_[0];
+        auto slave = slaves_.find(addr);
+        if (slave == slaves_.end()) return;  // No one answers
+
+        uint16_t crc = tx_frame_[tx_frame_.size() - 2] | (tx_frame_[tx_frame_.size() - 1] << 8);
+        if (ModbusRtuMaster::crc16(tx_frame_.data(), tx_frame_.size() - 2) != crc) return;
+
+        std::vector<uint8_t> reply;
+        build_reply(reply);
+
+        uint16_t reply_crc = ModbusRtuMaster::crc16(reply.data(), reply.size());
+        reply.push_back(reply_crc & 0xFF);
+        reply.push_back((reply_crc >> 8) & 0xFF);
+
+        if (corrupt_next_) {
+            reply[reply.size() / 2] ^= 0x01;
+            corrupt_next_ = false;
+        }
+
+        uint32_t t = tx_end_us_ + slave->second;
+        for (uint8_t b : reply) {
+            t += char_time_us_;
+            rx_.push_back({b, t});
+        }
+    }
+
+    void build_reply(std::vector<uint8_t>& reply) {
+        uint8_t addr = tx_frame_[0];
+        uint8_t fn = tx_frame_[1];
+        uint16_t start = (tx_frame_[2] << 8) | tx_frame_[3];
+        uint16_t count = (tx_frame_[4] << 8) | tx_frame_[5];
+
+        reply.push_back(addr);
+
+        switch (fn) {
+            case 0x03:
+            case 0x04:
+                for (uint16_t i = 0; i < count; i++) {
+                    if (registers_.find(((uint32_t)addr << 16) | (start + i)) == registers_.end()) {
+                        reply.push_back(fn | 0x80);
+                        reply.push_back(0x02);  // Illegal data address
+                        return;
+                    }
+                }
+                reply.push_back(fn);
+                reply.push_back(count * 2);
+                for (uint16_t i = 0; i < count; i++) {
+                    uint16_t v = get_register(addr, start + i);
+                    reply.push_back(v >> 8);
+                    reply.push_back(v & 0xFF);
+                }
+                break;
+
+            case 0x06:
+                set_register(addr, start, count);  // Value sits in the count field
+                reply.assign(tx_frame_.begin(), tx_frame_.begin() + 6);
+                break;
+
+            case 0x10:
+                for (uint16_t i = 0; i < count; i++) {
+                    set_register(addr, start + i, (tx_frame_[7 + i * 2] << 8) | tx_frame_[8 + i * 2]);
+                }
+                reply.assign(tx_frame_.begin(), tx_frame_.begin() + 6);
+                break;
+
+            default:
+                reply.push_back(fn | 0x80);
+                reply.push_back(0x01);  // Illegal function
+                break;
+        }
+    }
+};
+
+} // namespace simulator
+} // namespace hal
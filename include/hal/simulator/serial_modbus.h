@@ -1,11 +1,14 @@
 #pragma once
 
 #include "hal/interfaces.h"
+#include "hal/modbus_rtu.h"
 #include <cstdint>
 #include <string>
 #include <termios.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <time.h>
+#include <sys/ioctl.h>
 #include <cstring>
 #include <cstdio>
 
@@ -15,14 +18,15 @@ namespace simulator {
 /**
  * Serial MODBUS RTU implementation for native Linux builds.
  * Communicates with external MODBUS simulator via virtual serial port.
+ * Frames are handled by ModbusRtuMaster; end-of-frame is detected from
+ * line silence instead of fixed sleeps.
  */
-class SerialModbus : public IModbusInterface {
+class SerialModbus : public IModbusInterface, private IRtuPort {
 public:
     SerialModbus()
         : fd_(-1)
         , timeout_ms_(1000)
-        , transaction_count_(0)
-        , error_count_(0) {}
+        , master_(this, 9600, 1000) {}
 
     ~SerialModbus() {
         close_port();
@@ -90,6 +94,9 @@ public:
         // Flush buffers
         tcflush(fd_, TCIOFLUSH);
 
+        master_.set_baudrate(baudrate);
+        master_.set_response_timeout_ms(timeout_ms_);
+
         printf("Opened serial port: %s at %d baud\n", port, baudrate);
         return true;
     }
@@ -107,83 +114,18 @@ public:
 
     bool read_holding_registers(uint8_t slave_id, uint16_t start_reg,
                                 uint16_t count, uint16_t* values) override {
-        if (!is_open() || count == 0 || count > 125) {
+        if (!is_open()) {
             return false;
         }
 
-        transaction_count_++;
-
-        // Build MODBUS RTU request for Read Input Registers (0x04)
         // Note: Using function code 0x04 for input registers
-        uint8_t request[8];
-        request[0] = slave_id;
-        request[1] = 0x04;  // Function code: Read Input Registers
-        request[2] = (start_reg >> 8) & 0xFF;
-        request[3] = start_reg & 0xFF;
-        request[4] = (count >> 8) & 0xFF;
-        request[5] = count & 0xFF;
-
-        // Calculate CRC
-        uint16_t crc = calculate_crc(request, 6);
-        request[6] = crc & 0xFF;
-        request[7] = (crc >> 8) & 0xFF;
-
-        // Send request
-        if (write(fd_, request, 8) != 8) {
-            error_count_++;
-            return false;
-        }
-
-        // Wait for response (small delay for device to process)
-        usleep(10000);  // 10ms
-
-        // Read response
-        uint8_t response[256];
-        size_t expected_len = 3 + (count * 2) + 2;  // slave + func + byte_count + data + crc
-        size_t bytes_read = 0;
-        int retries = 100;  // 1 second total timeout
-
-        while (bytes_read < expected_len && retries > 0) {
-            ssize_t n = read(fd_, response + bytes_read, expected_len - bytes_read);
-            if (n > 0) {
-                bytes_read += n;
-            } else {
-                usleep(10000);  // 10ms
-                retries--;
-            }
-        }
-
-        if (bytes_read < expected_len) {
-            error_count_++;
-            return false;
-        }
-
-        // Verify response
-        if (response[0] != slave_id || response[1] != 0x04) {
-            error_count_++;
-            return false;
-        }
-
-        // Verify CRC
-        uint16_t recv_crc = response[bytes_read - 2] | (response[bytes_read - 1] << 8);
-        uint16_t calc_crc = calculate_crc(response, bytes_read - 2);
-        if (recv_crc != calc_crc) {
-            error_count_++;
-            return false;
-        }
-
-        // Extract register values (big-endian)
-        uint8_t byte_count = response[2];
-        if (byte_count != count * 2) {
-            error_count_++;
-            return false;
-        }
-
-        for (uint16_t i = 0; i < count; i++) {
-            values[i] = (response[3 + i*2] << 8) | response[4 + i*2];
-        }
-
-        return true;
+        ModbusRequest req;
+        req.slave_addr = slave_id;
+        req.function = ModbusFunction::READ_INPUT_REGISTERS;
+        req.start_reg = start_reg;
+        req.count = count;
+        req.data = values;
+        return master_.execute(req) == ModbusStatus::OK;
     }
 
     bool write_register(uint8_t slave_id, uint16_t reg, uint16_t value) override {
@@ -191,143 +133,75 @@ public:
             return false;
         }
 
-        transaction_count_++;
-
-        // Build MODBUS RTU request for Write Single Register (0x06)
-        uint8_t request[8];
-        request[0] = slave_id;
-        request[1] = 0x06;  // Function code
-        request[2] = (reg >> 8) & 0xFF;
-        request[3] = reg & 0xFF;
-        request[4] = (value >> 8) & 0xFF;
-        request[5] = value & 0xFF;
-
-        uint16_t crc = calculate_crc(request, 6);
-        request[6] = crc & 0xFF;
-        request[7] = (crc >> 8) & 0xFF;
-
-        // Send request
-        if (write(fd_, request, 8) != 8) {
-            error_count_++;
-            return false;
-        }
-
-        // Read echo response
-        uint8_t response[8];
-        usleep(10000);
-
-        size_t bytes_read = 0;
-        int retries = 100;
-        while (bytes_read < 8 && retries > 0) {
-            ssize_t n = read(fd_, response + bytes_read, 8 - bytes_read);
-            if (n > 0) {
-                bytes_read += n;
-            } else {
-                usleep(10000);
-                retries--;
-            }
-        }
-
-        if (bytes_read < 8) {
-            error_count_++;
-            return false;
-        }
-
-        // Verify echo
-        return memcmp(request, response, 8) == 0;
+        ModbusRequest req;
+        req.slave_addr = slave_id;
+        req.function = ModbusFunction::WRITE_SINGLE_REGISTER;
+        req.start_reg = reg;
+        req.count = 1;
+        req.data = &value;
+        return master_.execute(req) == ModbusStatus::OK;
     }
 
     bool write_multiple_registers(uint8_t slave_id, uint16_t start_reg,
                                    uint16_t count, const uint16_t* values) override {
-        if (!is_open() || count == 0 || count > 123) {
-            return false;
-        }
-
-        transaction_count_++;
-
-        // Build MODBUS RTU request for Write Multiple Registers (0x10)
-        size_t request_len = 7 + count * 2 + 2;  // header + data + crc
-        uint8_t request[256];
-        request[0] = slave_id;
-        request[1] = 0x10;  // Function code
-        request[2] = (start_reg >> 8) & 0xFF;
-        request[3] = start_reg & 0xFF;
-        request[4] = (count >> 8) & 0xFF;
-        request[5] = count & 0xFF;
-        request[6] = count * 2;  // Byte count
-
-        for (uint16_t i = 0; i < count; i++) {
-            request[7 + i*2] = (values[i] >> 8) & 0xFF;
-            request[8 + i*2] = values[i] & 0xFF;
-        }
-
-        uint16_t crc = calculate_crc(request, 7 + count * 2);
-        request[7 + count * 2] = crc & 0xFF;
-        request[8 + count * 2] = (crc >> 8) & 0xFF;
-
-        // Send request
-        if (write(fd_, request, request_len) != (ssize_t)request_len) {
-            error_count_++;
-            return false;
-        }
-
-        // Read response (8 bytes: slave + func + start_reg + count + crc)
-        uint8_t response[8];
-        usleep(10000);
-
-        size_t bytes_read = 0;
-        int retries = 100;
-        while (bytes_read < 8 && retries > 0) {
-            ssize_t n = read(fd_, response + bytes_read, 8 - bytes_read);
-            if (n > 0) {
-                bytes_read += n;
-            } else {
-                usleep(10000);
-                retries--;
-            }
-        }
-
-        if (bytes_read < 8) {
-            error_count_++;
+        if (!is_open()) {
             return false;
         }
 
-        // Verify response
-        return response[0] == slave_id && response[1] == 0x10;
+        ModbusRequest req;
+        req.slave_addr = slave_id;
+        req.function = ModbusFunction::WRITE_MULTIPLE_REGISTERS;
+        req.start_reg = start_reg;
+        req.count = count;
+        req.data = const_cast<uint16_t*>(values);  // Only read for writes
+        return master_.execute(req) == ModbusStatus::OK;
     }
 
     uint32_t get_transaction_count() const override {
-        return transaction_count_;
+        return master_.get_transaction_count();
     }
 
     uint32_t get_error_count() const override {
-        return error_count_;
+        return master_.get_error_count();
     }
 
 private:
     int fd_;
     uint32_t timeout_ms_;
-    uint32_t transaction_count_;
-    uint32_t error_count_;
+    ModbusRtuMaster master_;
 
-    /**
-     * Calculate MODBUS CRC-16
-     */
-    uint16_t calculate_crc(const uint8_t* data, size_t len) {
-        uint16_t crc = 0xFFFF;
-
-        for (size_t i = 0; i < len; i++) {
-            crc ^= data[i];
-            for (int j = 0; j < 8; j++) {
-                if (crc & 0x0001) {
-                    crc = (crc >> 1) ^ 0xA001;
-                } else {
-                    crc >>= 1;
-                }
-            }
+    // IRtuPort implementation (non-blocking fd)
+
+    size_t write(const uint8_t* data, size_t len) override {
+        ssize_t n = ::write(fd_, data, len);
+        return n > 0 ? (size_t)n : 0;
+    }
+
+    bool tx_done() override {
+        int queued = 0;
+        if (ioctl(fd_, TIOCOUTQ, &queued) != 0) {
+            return true;  // Not supported (e.g. some ptys) - assume sent
         }
+        return queued == 0;
+    }
+
+    size_t read(uint8_t* buffer, size_t size) override {
+        ssize_t n = ::read(fd_, buffer, size);
+        return n > 0 ? (size_t)n : 0;
+    }
+
+    void flush_input() override {
+        tcflush(fd_, TCIFLUSH);
+    }
+
+    uint32_t micros() const override {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint32_t)(ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+    }
 
-        return crc;
+    void wait_us(uint32_t us) override {
+        usleep(us);
     }
 };
 
@@ -7,6 +7,8 @@
 #include "core/config.h"
 #include "modules/safety_controller.h"
 #include "modules/fermentation_plan.h"
+#include "modules/http_cache.h"
+#include "modules/modbus_module.h"
 #include "modules/wifi_provisioning.h"
 #include "modules/status_led.h"
 #ifdef OTA_ENABLED
@@ -15,6 +17,9 @@
 #ifdef CAN_ENABLED
 #include "modules/can_module.h"
 #endif
+#ifdef MQTT_ENABLED
+#include "modules/mqtt_publisher.h"
+#endif
 #include <cstring>
 #include <cstdio>
 #include <cstdarg>
@@ -80,6 +85,9 @@ public:
         , ethernet_(ethernet)
         , http_server_(nullptr)
         , ota_manager_(nullptr)
+        , modbus_module_(nullptr)
+        , http_cache_(nullptr)
+        , mqtt_(nullptr)
         , cmd_index_(0)
         , echo_enabled_(true)
         , log_events_(false)
@@ -105,6 +113,27 @@ public:
         http_server_ = http_server;
     }
 
+    /**
+     * Set HTTP conditional GET counters for the status command
+     */
+    void set_http_cache(const HttpCache* cache) {
+        http_cache_ = cache;
+    }
+
+    /**
+     * Set MODBUS module reference for poll engine statistics
+     */
+    void set_modbus_module(ModbusModule* modbus_module) {
+        modbus_module_ = modbus_module;
+    }
+
+    /**
+     * Set MQTT publisher reference for the mqtt command
+     */
+    void set_mqtt_publisher(void* mqtt) {
+        mqtt_ = mqtt;
+    }
+
     /**
      * Set OTA manager reference for firmware commands
      */
@@ -177,6 +206,9 @@ private:
     void* ethernet_;    // ESP32Ethernet* when ETHERNET_ENABLED
     void* http_server_; // HttpServer* when HTTP_ENABLED
     void* ota_manager_; // OtaManager* when OTA_ENABLED
+    ModbusModule* modbus_module_;
+    const HttpCache* http_cache_;
+    void* mqtt_;        // MqttPublisher* when MQTT_ENABLED
 
     char cmd_buffer_[MAX_CMD_LENGTH];
     size_t cmd_index_;
@@ -319,6 +351,8 @@ private:
             cmd_ssl(argc, args);
         } else if (strcmp(args[0], "ws") == 0) {
             cmd_ws(argc, args);
+        } else if (strcmp(args[0], "mqtt") == 0) {
+            cmd_mqtt();
         } else if (strcmp(args[0], "firmware") == 0) {
             cmd_firmware(argc, args);
         } else {
@@ -351,6 +385,7 @@ private:
         serial_->println("");
         serial_->println("  alarms              - Active alarms");
         serial_->println("  modbus stats        - MODBUS statistics");
+        serial_->println("  modbus plan         - Poll plan and bus occupancy");
         serial_->println("  modbus read <addr> <reg> [count]");
         serial_->println("  modbus scan [start] [end] - Scan for devices");
         serial_->println("  modbus autodetect <addr> - Detect PT1000 sensors");
@@ -383,6 +418,8 @@ private:
         serial_->println("  ws clients          - List connected clients");
         serial_->println("  ws broadcast <msg>  - Send message to all clients");
         serial_->println("");
+        serial_->println("  mqtt                - MQTT connection and spool status");
+        serial_->println("");
         serial_->println("  firmware            - Current version and partition info");
         serial_->println("  firmware status     - OTA update status (during update)");
         serial_->println("  firmware download [url] - Download from URL (or default)");
@@ -491,6 +528,33 @@ private:
                (unsigned long)(sys.free_heap / 1024));
 #endif
 
+        // State lock contention (snapshot readers don't take the mutex)
+        core::StateLockStats lock_stats = state_->get_lock_stats();
+        printf("  State lock: %lu acquired, %lu contended, %lu timeouts | "
+               "Snapshots: %lu reads, %lu retries, %lu fallbacks\r\n",
+               (unsigned long)lock_stats.acquisitions, (unsigned long)lock_stats.contended,
+               (unsigned long)lock_stats.timeouts, (unsigned long)lock_stats.snapshot_reads,
+               (unsigned long)lock_stats.snapshot_retries, (unsigned long)lock_stats.snapshot_fallbacks);
+
+        // Conditional GET hit ratio (304 / requests) per state endpoint
+        if (http_cache_) {
+            bool any = false;
+            for (int i = 0; i < HttpCache::ENDPOINT_COUNT; i++) {
+                uint32_t requests = http_cache_->requests(i);
+                if (requests == 0) continue;
+                if (!any) {
+                    serial_->println("  HTTP cache (304/requests):");
+                    any = true;
+                }
+                const HttpCache::Endpoint& ep = HttpCache::ENDPOINTS[i];
+                uint32_t hits = http_cache_->hits(i);
+                printf("    %s%-*s %lu/%lu (%lu%%)\r\n", ep.path,
+                       (int)(20 - strlen(ep.path)), ep.prefix ? "*" : "",
+                       (unsigned long)hits, (unsigned long)requests,
+                       (unsigned long)((uint64_t)hits * 100 / requests));
+            }
+        }
+
         // Connectivity section
         serial_->println("");
         serial_->println("Connectivity:");
@@ -722,6 +786,7 @@ private:
         } else if (argc >= 4 && strcmp(args[2], "setpoint") == 0) {
             float temp = atof(args[3]);
             ferm->target_temp = temp;
+            state_->mark_changed(core::StateDomain::FERMENTERS);
             printf("Fermenter %d setpoint set to %.1f C\r\n", id, temp);
         } else if (argc >= 4 && strcmp(args[2], "mode") == 0) {
             if (strcmp(args[3], "off") == 0) {
@@ -731,6 +796,7 @@ private:
             } else if (strcmp(args[3], "plan") == 0) {
                 ferm->mode = core::FermenterMode::PLAN;
             }
+            state_->mark_changed(core::StateDomain::FERMENTERS);
             printf("Fermenter %d mode set to %s\r\n", id, args[3]);
         }
     }
@@ -763,6 +829,7 @@ private:
             ferm->pid_params.kp = atof(args[3]);
             ferm->pid_params.ki = atof(args[4]);
             ferm->pid_params.kd = argc > 5 ? atof(args[5]) : ferm->pid_params.kd;
+            state_->mark_changed(core::StateDomain::FERMENTERS);
             printf("PID tuned: Kp=%.3f Ki=%.3f Kd=%.3f\r\n",
                    ferm->pid_params.kp, ferm->pid_params.ki, ferm->pid_params.kd);
         }
@@ -801,6 +868,7 @@ private:
         if (argc < 2) {
             serial_->println("Usage:");
             serial_->println("  modbus stats");
+            serial_->println("  modbus plan");
             serial_->println("  modbus read <addr> <reg> [count]");
             serial_->println("  modbus scan [start] [end]");
             serial_->println("  modbus autodetect <addr>");
@@ -816,6 +884,57 @@ private:
                 float error_rate = 100.0f * sys.modbus_errors / sys.modbus_transactions;
                 printf("  Error rate: %.2f%%\r\n", error_rate);
             }
+            if (modbus_module_) {
+                const auto& poll = modbus_module_->get_poll_stats();
+                printf("Poll engine:\r\n");
+                printf("  Cycles: %lu (overruns: %lu)\r\n",
+                       (unsigned long)poll.cycles, (unsigned long)poll.overruns);
+                printf("  Jitter: last %lu ms, max %lu ms, avg %lu ms\r\n",
+                       (unsigned long)poll.last_jitter_ms, (unsigned long)poll.max_jitter_ms,
+                       (unsigned long)(poll.cycles > 0 ? poll.jitter_sum_ms / poll.cycles : 0));
+                printf("  Last cycle: %lu ms | Max poll call: %lu ms\r\n",
+                       (unsigned long)poll.last_cycle_ms, (unsigned long)poll.max_call_ms);
+
+                const auto& plan = modbus_module_->get_bus_plan();
+                printf("  Planned bus: %.1f ms/cycle (%.1f%% occupancy)\r\n",
+                       plan.bus_us_per_cycle / 1000.0f, plan.occupancy_pct);
+
+                // Sampling latency per priority: planned bound vs measured
+                static const char* const prio_names[] = {"low", "normal", "high", "critical"};
+                for (int p = 3; p >= 0; p--) {
+                    if (plan.max_gap_ms[p] == 0) continue;
+                    printf("  Sample gap (%s): planned %lu ms, measured max %lu ms\r\n",
+                           prio_names[p], (unsigned long)plan.max_gap_ms[p],
+                           (unsigned long)poll.max_sample_gap_ms[p]);
+                }
+            }
+        } else if (strcmp(args[1], "plan") == 0) {
+            if (!modbus_module_) {
+                serial_->println("MODBUS module not available");
+                return;
+            }
+            const auto& plan = modbus_module_->get_bus_plan();
+            if (modbus_module_->get_schedule_error()[0] != '\0') {
+                if (modbus_module_->get_transaction_count() == 0) {
+                    printf("Schedule rejected: %s\r\n", modbus_module_->get_schedule_error());
+                    return;
+                }
+                printf("Schedule degraded: %s\r\n", modbus_module_->get_schedule_error());
+            }
+            printf("Poll plan:\r\n");
+            printf("  Transactions: %u per cycle (%u bulk reads per sample)\r\n",
+                   plan.transactions, plan.spans_per_sample);
+            printf("  Registers: %u read, %u used\r\n",
+                   plan.registers_read, plan.registers_used);
+            printf("  Bus time: %.1f ms/cycle (%.1f%% occupancy)\r\n",
+                   plan.bus_us_per_cycle / 1000.0f, plan.occupancy_pct);
+            printf("  %-6s %-5s %-6s %-6s %-8s %s\r\n", "t(ms)", "addr", "start", "count", "sensors", "bus(us)");
+            for (uint8_t i = 0; i < modbus_module_->get_transaction_count(); i++) {
+                const auto* t = modbus_module_->get_transaction(i);
+                printf("  %-6lu %-5u %-6u %-6u %-8u %lu\r\n",
+                       (unsigned long)t->time_ms, t->device_addr, t->start_reg,
+                       t->count, t->sensor_count, (unsigned long)t->cost_us);
+            }
         } else if (strcmp(args[1], "read") == 0 && argc >= 4) {
             uint8_t addr = atoi(args[2]);
             uint16_t reg = atoi(args[3]);
@@ -1712,6 +1831,35 @@ private:
         }
     }
 
+    void cmd_mqtt() {
+#ifdef MQTT_ENABLED
+        if (!mqtt_) {
+            serial_->println("MQTT not configured (mqtt.enabled / mqtt.broker)");
+            return;
+        }
+        auto* mqtt = static_cast<MqttPublisher*>(mqtt_);
+        const auto& stats = mqtt->get_stats();
+        const auto& spool = mqtt->get_spool();
+
+        serial_->println("MQTT Status:");
+        printf("  Broker: %s:%u (%s)\r\n", config_->mqtt.broker, config_->mqtt.port,
+               mqtt->is_connected() ? "connected" : "disconnected");
+        printf("  Topics: %s/...\r\n", config_->mqtt.topic_prefix);
+        printf("  Spool: %lu msgs, %lu/%lu bytes, %lu dropped\r\n",
+               (unsigned long)spool.count(), (unsigned long)spool.bytes(),
+               (unsigned long)spool.capacity(), (unsigned long)spool.dropped());
+        printf("  In flight: %d\r\n", mqtt->get_inflight());
+        printf("  Spooled: %lu  Published: %lu  Acked: %lu  Retries: %lu  Connects: %lu\r\n",
+               (unsigned long)stats.batches, (unsigned long)stats.published,
+               (unsigned long)stats.acked, (unsigned long)stats.retries,
+               (unsigned long)stats.connects);
+        printf("  Not spooled: %lu too large, %lu refused by the spool\r\n",
+               (unsigned long)stats.truncated, (unsigned long)stats.dropped);
+#else
+        serial_->println("MQTT not enabled in this build");
+#endif
+    }
+
     void cmd_ws(int argc, char** args) {
 #if defined(ESP32_BUILD) && defined(WEBSOCKET_ENABLED)
         if (!http_server_) {
@@ -1732,6 +1880,9 @@ private:
             serial_->println("WebSocket Status:");
             printf("  Enabled: Yes\r\n");
             printf("  Clients: %d/%d\r\n", ws_mgr->get_client_count(), ws_mgr->get_max_clients());
+            printf("  Resyncs (slow clients): %lu\r\n", (unsigned long)ws_mgr->get_overruns());
+            printf("  Updates: %lu samples -> %lu frames\r\n",
+                   (unsigned long)ws_mgr->get_delta_samples(), (unsigned long)ws_mgr->get_delta_frames());
             printf("  Initialized: %s\r\n", ws_mgr->is_initialized() ? "Yes" : "No");
             return;
         }
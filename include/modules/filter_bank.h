@@ -0,0 +1,196 @@
+#pragma once
+
+#include "filters.h"
+#include "core/types.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace modules {
+
+/**
+ * Fixed-capacity store for all sensor filters of one module
+ *
+ * Filters are placement-constructed back to back in one arena, each
+ * tagged with its FilterType. update() switches on the tag and calls the
+ * concrete (final) class, so the per-sample path has no virtual call and
+ * is inlined. clear() only resets the arena, so re-initialization never
+ * touches the heap.
+ *
+ * NONE filters keep their last value in the entry and use no arena
+ * space. The arena holds CAPACITY of the largest filter, so add() only
+ * fails (and the filter degrades to NONE) once the bank is full.
+ */
+class FilterBank {
+public:
+    static constexpr uint8_t CAPACITY = core::MAX_SENSORS;
+
+    /** Largest filter, rounded up so back-to-back packing never overflows */
+    static constexpr size_t SLOT_BYTES = [] {
+        size_t size = sizeof(EMAFilter);
+        if (sizeof(MovingAverageFilter) > size) size = sizeof(MovingAverageFilter);
+        if (sizeof(MedianFilter) > size) size = sizeof(MedianFilter);
+        if (sizeof(DualRateFilter) > size) size = sizeof(DualRateFilter);
+        return (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+    }();
+    static constexpr size_t ARENA_BYTES = CAPACITY * SLOT_BYTES;
+    static_assert(ARENA_BYTES <= UINT16_MAX, "Entry::offset is 16 bits");
+
+    FilterBank() : count_(0), used_(0) {}
+    ~FilterBank() { clear(); }
+
+    FilterBank(const FilterBank&) = delete;
+    FilterBank& operator=(const FilterBank&) = delete;
+
+    /**
+     * Destroy all filters and release the arena
+     */
+    void clear() {
+        for (uint8_t i = 0; i < count_; i++) {
+            Entry& e = entries_[i];
+            switch (e.type) {
+                case core::FilterType::EMA:            at<EMAFilter>(e)->~EMAFilter(); break;
+                case core::FilterType::MOVING_AVERAGE: at<MovingAverageFilter>(e)->~MovingAverageFilter(); break;
+                case core::FilterType::MEDIAN:         at<MedianFilter>(e)->~MedianFilter(); break;
+                case core::FilterType::DUAL_RATE:      at<DualRateFilter>(e)->~DualRateFilter(); break;
+                default: break;
+            }
+        }
+        count_ = 0;
+        used_ = 0;
+    }
+
+    /**
+     * Append a filter; its index is the number of filters added before it
+     * @param alpha EMA alpha (base alpha for DUAL_RATE)
+     * @param window Moving average / median window
+     * @return false if the bank is full or the filter fell back to NONE
+     */
+    bool add(core::FilterType type, float alpha, uint8_t window) {
+        if (count_ >= CAPACITY) return false;
+
+        Entry& e = entries_[count_++];
+        e.type = type;
+        e.offset = 0;
+        e.value = 0.0f;
+
+        switch (type) {
+            case core::FilterType::EMA:
+                return emplace<EMAFilter>(e, alpha);
+            case core::FilterType::MOVING_AVERAGE:
+                return emplace<MovingAverageFilter>(e, window);
+            case core::FilterType::MEDIAN:
+                return emplace<MedianFilter>(e, window);
+            case core::FilterType::DUAL_RATE:
+                return emplace<DualRateFilter>(e, alpha);
+            default:
+                e.type = core::FilterType::NONE;
+                return true;
+        }
+    }
+
+    /**
+     * Feed one sample
+     * @param is_extra Priority extra sample (only DUAL_RATE tells them apart)
+     */
+    float update(uint8_t idx, float value, bool is_extra = false) {
+        if (idx >= count_) return value;
+        Entry& e = entries_[idx];
+        switch (e.type) {
+            case core::FilterType::EMA:
+                return at<EMAFilter>(e)->update(value);
+            case core::FilterType::MOVING_AVERAGE:
+                return at<MovingAverageFilter>(e)->update(value);
+            case core::FilterType::MEDIAN:
+                return at<MedianFilter>(e)->update(value);
+            case core::FilterType::DUAL_RATE:
+                return is_extra ? at<DualRateFilter>(e)->update_extra(value)
+                                : at<DualRateFilter>(e)->update_base(value);
+            default:
+                e.value = value;
+                return value;
+        }
+    }
+
+    float get_value(uint8_t idx) const {
+        if (idx >= count_) return 0;
+        const Entry& e = entries_[idx];
+        const IFilter* filter = get(idx);
+        return filter ? filter->get_value() : e.value;
+    }
+
+    bool is_ready(uint8_t idx) const {
+        if (idx >= count_) return false;
+        const IFilter* filter = get(idx);
+        return filter ? filter->is_ready() : true;
+    }
+
+    void reset(uint8_t idx) {
+        if (idx >= count_) return;
+        IFilter* filter = const_cast<IFilter*>(get(idx));
+        if (filter) {
+            filter->reset();
+        } else {
+            entries_[idx].value = 0.0f;
+        }
+    }
+
+    /**
+     * Filter object for diagnostics (nullptr for NONE)
+     */
+    const IFilter* get(uint8_t idx) const {
+        if (idx >= count_) return nullptr;
+        const Entry& e = entries_[idx];
+        switch (e.type) {
+            case core::FilterType::EMA:            return at<EMAFilter>(e);
+            case core::FilterType::MOVING_AVERAGE: return at<MovingAverageFilter>(e);
+            case core::FilterType::MEDIAN:         return at<MedianFilter>(e);
+            case core::FilterType::DUAL_RATE:      return at<DualRateFilter>(e);
+            default:                               return nullptr;
+        }
+    }
+
+    core::FilterType get_type(uint8_t idx) const {
+        return idx < count_ ? entries_[idx].type : core::FilterType::NONE;
+    }
+
+    uint8_t size() const { return count_; }
+    size_t get_arena_used() const { return used_; }
+
+private:
+    struct Entry {
+        core::FilterType type;
+        uint16_t offset;            // Byte offset into arena_
+        float value;                // Last sample for NONE
+    };
+
+    alignas(std::max_align_t) uint8_t arena_[ARENA_BYTES];
+    Entry entries_[CAPACITY];
+    uint8_t count_;
+    size_t used_;
+
+    template <typename T, typename... Args>
+    bool emplace(Entry& e, Args... args) {
+        size_t offset = (used_ + alignof(T) - 1) & ~(alignof(T) - 1);
+        if (offset + sizeof(T) > ARENA_BYTES) {
+            e.type = core::FilterType::NONE;
+            return false;
+        }
+        new (arena_ + offset) T(args...);
+        e.offset = (uint16_t)offset;
+        used_ = offset + sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    T* at(const Entry& e) {
+        return std::launder(reinterpret_cast<T*>(arena_ + e.offset));
+    }
+
+    template <typename T>
+    const T* at(const Entry& e) const {
+        return std::launder(reinterpret_cast<const T*>(arena_ + e.offset));
+    }
+};
+
+} // namespace modules
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <algorithm>
 #include "core/utils.h"
+#include "core/fixed_point.h"
 
 namespace modules {
 
@@ -21,59 +22,79 @@ public:
 /**
  * Exponential Moving Average filter
  * Filtered = alpha * new_value + (1 - alpha) * old_filtered
+ *
+ * The filters below are templated on the number type they compute in
+ * (float or core::Q16_16). The IFilter interface stays float; values are
+ * converted on the way in and out. EMAFilter, MovingAverageFilter and
+ * MedianFilter use core::dsp_t (float unless built with FIXED_POINT_DSP).
  */
-class EMAFilter : public IFilter {
+template <typename T>
+class BasicEMAFilter final : public IFilter {
 public:
-    explicit EMAFilter(float alpha = 0.3f)
-        : alpha_(alpha), value_(0), initialized_(false) {}
+    explicit BasicEMAFilter(float alpha = 0.3f)
+        : alpha_(core::dsp_from_float<T>(alpha)), value_(), initialized_(false) {}
 
     float update(float value) override {
+        return core::dsp_to_float(update_value(core::dsp_from_float<T>(value)));
+    }
+
+    T update_value(T value) {
         if (!initialized_) {
             value_ = value;
             initialized_ = true;
         } else {
-            value_ = alpha_ * value + (1.0f - alpha_) * value_;
+            value_ = alpha_ * value + (core::dsp_from_float<T>(1.0f) - alpha_) * value_;
         }
         return value_;
     }
 
-    float get_value() const override { return value_; }
+    float get_value() const override { return core::dsp_to_float(value_); }
 
     void reset() override {
-        value_ = 0;
+        value_ = T();
         initialized_ = false;
     }
 
     bool is_ready() const override { return initialized_; }
 
-    void set_alpha(float alpha) { alpha_ = alpha; }
-    float get_alpha() const { return alpha_; }
+    void set_alpha(float alpha) { alpha_ = core::dsp_from_float<T>(alpha); }
+    float get_alpha() const { return core::dsp_to_float(alpha_); }
 
 private:
-    float alpha_;
-    float value_;
+    T alpha_;
+    T value_;
     bool initialized_;
 };
 
 /**
  * Moving Average filter
  * Simple average of last N samples
+ * With Q16.16 the running sum must stay below 32768 (16 samples of up to
+ * 2048 units); it saturates rather than wraps.
  */
-class MovingAverageFilter : public IFilter {
+template <typename T>
+class BasicMovingAverageFilter final : public IFilter {
 public:
     static constexpr uint8_t MAX_WINDOW = 16;
 
-    explicit MovingAverageFilter(uint8_t window_size = 5)
+    explicit BasicMovingAverageFilter(uint8_t window_size = 5)
         : window_size_(window_size > MAX_WINDOW ? MAX_WINDOW : window_size)
         , index_(0)
         , count_(0)
-        , sum_(0) {
+        , sum_() {
+        if (window_size_ == 0) {
+            window_size_ = 1;
+        }
         for (uint8_t i = 0; i < MAX_WINDOW; i++) {
-            buffer_[i] = 0;
+            buffer_[i] = T();
         }
     }
 
     float update(float value) override {
+        return core::dsp_to_float(update_value(core::dsp_from_float<T>(value)));
+    }
+
+    T update_value(T value) {
         // Remove oldest value from sum
         if (count_ == window_size_) {
             sum_ -= buffer_[index_];
@@ -91,20 +112,17 @@ public:
             count_++;
         }
 
-        return get_value();
+        return value_of();
     }
 
-    float get_value() const override {
-        if (count_ == 0) return 0;
-        return sum_ / count_;
-    }
+    float get_value() const override { return core::dsp_to_float(value_of()); }
 
     void reset() override {
         index_ = 0;
         count_ = 0;
-        sum_ = 0;
+        sum_ = T();
         for (uint8_t i = 0; i < MAX_WINDOW; i++) {
-            buffer_[i] = 0;
+            buffer_[i] = T();
         }
     }
 
@@ -116,22 +134,33 @@ public:
     uint8_t get_sample_count() const { return count_; }
 
 private:
-    float buffer_[MAX_WINDOW];
+    T buffer_[MAX_WINDOW];
     uint8_t window_size_;
     uint8_t index_;
     uint8_t count_;
-    float sum_;
+    T sum_;
+
+    T value_of() const {
+        if (count_ == 0) return T();
+        return sum_ / core::dsp_from_float<T>((float)count_);
+    }
 };
 
 /**
  * Median filter
  * Returns median of last N samples (excellent for outlier rejection)
+ *
+ * Keeps the window twice: in arrival order (to know which sample leaves)
+ * and sorted. update() binary-searches both positions and shifts at most
+ * one window of values, and get_value() just reads the middle element, so
+ * wide windows (up to 31) on noisy pressure transducers stay cheap.
  */
-class MedianFilter : public IFilter {
+template <typename T>
+class BasicMedianFilter final : public IFilter {
 public:
-    static constexpr uint8_t MAX_WINDOW = 9;
+    static constexpr uint8_t MAX_WINDOW = 31;
 
-    explicit MedianFilter(uint8_t window_size = 5)
+    explicit BasicMedianFilter(uint8_t window_size = 5)
         : window_size_(window_size > MAX_WINDOW ? MAX_WINDOW : window_size)
         , index_(0)
         , count_(0) {
@@ -143,40 +172,45 @@ public:
             window_size_ = 3;
         }
         for (uint8_t i = 0; i < MAX_WINDOW; i++) {
-            buffer_[i] = 0;
+            buffer_[i] = T();
+            sorted_[i] = T();
         }
     }
 
     float update(float value) override {
-        buffer_[index_] = value;
-        index_ = (index_ + 1) % window_size_;
+        return core::dsp_to_float(update_value(core::dsp_from_float<T>(value)));
+    }
 
-        if (count_ < window_size_) {
-            count_++;
+    T update_value(T value) {
+        if (count_ == window_size_) {
+            // Drop the oldest sample from the sorted copy
+            T* pos = std::lower_bound(sorted_, sorted_ + count_, buffer_[index_]);
+            std::copy(pos + 1, sorted_ + count_, pos);
+            count_--;
         }
 
-        return get_value();
+        T* pos = std::upper_bound(sorted_, sorted_ + count_, value);
+        std::copy_backward(pos, sorted_ + count_, sorted_ + count_ + 1);
+        *pos = value;
+        count_++;
+
+        buffer_[index_] = value;
+        index_ = (index_ + 1) % window_size_;
+
+        return sorted_[count_ / 2];
     }
 
     float get_value() const override {
         if (count_ == 0) return 0;
-
-        // Copy buffer for sorting
-        float sorted[MAX_WINDOW];
-        for (uint8_t i = 0; i < count_; i++) {
-            sorted[i] = buffer_[i];
-        }
-
-        core::bubble_sort(sorted, count_);
-
-        return sorted[count_ / 2];
+        return core::dsp_to_float(sorted_[count_ / 2]);
     }
 
     void reset() override {
         index_ = 0;
         count_ = 0;
         for (uint8_t i = 0; i < MAX_WINDOW; i++) {
-            buffer_[i] = 0;
+            buffer_[i] = T();
+            sorted_[i] = T();
         }
     }
 
@@ -184,18 +218,25 @@ public:
         return count_ == window_size_;
     }
 
+    uint8_t get_window_size() const { return window_size_; }
+
 private:
-    float buffer_[MAX_WINDOW];
+    T buffer_[MAX_WINDOW];      // Arrival order (ring)
+    T sorted_[MAX_WINDOW];      // Ascending, count_ valid entries
     uint8_t window_size_;
     uint8_t index_;
     uint8_t count_;
 };
 
+using EMAFilter = BasicEMAFilter<core::dsp_t>;
+using MovingAverageFilter = BasicMovingAverageFilter<core::dsp_t>;
+using MedianFilter = BasicMedianFilter<core::dsp_t>;
+
 /**
  * Dual-rate filter
  * Combines base samples (quality) with extra samples (speed)
  */
-class DualRateFilter : public IFilter {
+class DualRateFilter final : public IFilter {
 public:
     DualRateFilter(float base_alpha = 0.3f, float extra_alpha = 0.7f, float blend_ratio = 0.7f)
         : base_filter_(base_alpha)
@@ -258,7 +299,7 @@ private:
 /**
  * No-op filter (passthrough)
  */
-class NoFilter : public IFilter {
+class NoFilter final : public IFilter {
 public:
     float update(float value) override {
         value_ = value;
@@ -0,0 +1,453 @@
+#pragma once
+
+#include "hal/interfaces.h"
+#include "core/state_manager.h"
+#include "core/config.h"
+#include <cstring>
+#include <cmath>
+
+namespace modules {
+
+/**
+ * Persistent append-only history log
+ *
+ * Log-structured ring on a dedicated flash partition ("histlog" in
+ * partitions.csv). Records are batched in RAM into 256-byte blocks and a
+ * block is programmed only when full, so flash sees one page write per
+ * batch. Sectors are erased just before reuse and the ring visits every
+ * sector once per lap, which levels wear across the partition.
+ *
+ * Block layout (little endian):
+ *   magic u16 | length u16 | sequence u32 | crc32 u32 | payload[244]
+ * The sequence increases by one per block; crc32 covers the first 8
+ * header bytes and the payload.
+ *
+ * Record layout inside a payload:
+ *   type u8 | length u8 | timestamp u32 | data[length]
+ * The timestamp is Unix time, or seconds since boot when the clock is not
+ * set (TIME_UPTIME flag in type).
+ *
+ * Recovery: the position of the first block of the current sector is
+ * checkpointed to NVS on each sector change. At boot the log walks forward
+ * from that checkpoint while sequence and CRC stay valid; without a usable
+ * checkpoint it scans the first block of every sector.
+ *
+ * At most one unwritten block of records is lost on power failure.
+ * tools/histlog_reader.py decodes a partition dump.
+ */
+class HistoryLog {
+public:
+    static constexpr uint8_t PARTITION_SUBTYPE = 0x40;
+    static constexpr const char* PARTITION_LABEL = "histlog";
+    static constexpr const char* CHECKPOINT_KEY = "hlog_ckpt";
+
+    static constexpr size_t BLOCK_SIZE = 256;
+    static constexpr size_t HEADER_SIZE = 12;
+    static constexpr size_t MAX_PAYLOAD = BLOCK_SIZE - HEADER_SIZE;
+    static constexpr size_t RECORD_HEADER_SIZE = 6;
+    static constexpr uint16_t BLOCK_MAGIC = 0x4C48;     // "HL"
+    static constexpr uint32_t MIN_VALID_UNIX_TIME = 1600000000;
+
+    enum RecordType : uint8_t {
+        RECORD_BOOT = 1,            // Log opened after reset
+        RECORD_NAME = 2,            // kind u8, id u8, name chars
+        RECORD_SENSORS = 3,         // first id u8, float32 per sensor (NaN = no reading)
+        RECORD_RELAY = 4,           // relay id u8, state u8
+        RECORD_PLAN_STEP = 5,       // fermenter id u8, step u8 (0xFF = plan stopped)
+        TIME_UPTIME = 0x80          // Flag: timestamp is seconds since boot
+    };
+
+    enum NameKind : uint8_t {
+        NAME_SENSOR = 0,
+        NAME_RELAY = 1
+    };
+
+    struct Stats {
+        uint32_t blocks_written;
+        uint32_t records_written;
+        uint32_t sectors_erased;
+        uint32_t write_errors;
+        uint32_t recovered_blocks;      // Valid blocks found walking from the checkpoint
+        bool recovered_from_checkpoint;
+    };
+
+    HistoryLog(hal::IFlashPartition* flash, hal::IStorageInterface* storage,
+               hal::ITimeInterface* time, core::StateManager* state)
+        : flash_(flash)
+        , storage_(storage)
+        , time_(time)
+        , state_(state)
+        , ready_(false)
+        , block_count_(0)
+        , blocks_per_sector_(0)
+        , head_(0)
+        , sequence_(0)
+        , fill_(0)
+        , snapshot_interval_ms_(60000)
+        , last_snapshot_ms_(0)
+        , stats_{}
+        , relay_known_(false)
+        , last_relay_state_{}
+        , last_plan_step_{} {
+        memset(page_, 0xFF, sizeof(page_));
+    }
+
+    /**
+     * Recover the write position and log a boot marker plus the name table
+     * @return false if the partition is missing or unusable
+     */
+    bool initialize(const core::SystemConfig& config) {
+        ready_ = false;
+        snapshot_interval_ms_ = config.persistence.state_snapshot_interval_ms;
+
+        if (!flash_ || flash_->sector_size() < BLOCK_SIZE || flash_->size() < 2 * flash_->sector_size()) {
+            return false;
+        }
+        blocks_per_sector_ = flash_->sector_size() / BLOCK_SIZE;
+        block_count_ = flash_->size() / BLOCK_SIZE;
+
+        recover();
+        ready_ = true;
+
+        fill_ = 0;
+        append(RECORD_BOOT, nullptr, 0);
+        for (uint8_t i = 0; i < state_->get_sensor_count(); i++) {
+            append_name(NAME_SENSOR, i, state_->get_sensor_by_id(i)->name);
+        }
+        for (uint8_t i = 0; i < state_->get_relay_count(); i++) {
+            append_name(NAME_RELAY, i, state_->get_relay_by_id(i)->name);
+        }
+
+        last_snapshot_ms_ = time_->millis();
+        relay_known_ = false;
+        for (uint8_t i = 0; i <= core::MAX_FERMENTERS; i++) {
+            last_plan_step_[i] = 0xFF;
+        }
+        return true;
+    }
+
+    /**
+     * Record state changes and periodic sensor snapshots
+     * Call from the control loop; only touches flash when a block fills.
+     */
+    void update() {
+        if (!ready_) return;
+
+        // Relay transitions (compared against the last seen state so that
+        // changes from any source are captured)
+        for (uint8_t i = 0; i < state_->get_relay_count(); i++) {
+            bool on = state_->get_relay_by_id(i)->state;
+            if (!relay_known_ || on != last_relay_state_[i]) {
+                uint8_t data[2] = {i, (uint8_t)(on ? 1 : 0)};
+                append(RECORD_RELAY, data, sizeof(data));
+                last_relay_state_[i] = on;
+            }
+        }
+        relay_known_ = true;
+
+        // Plan step changes
+        for (uint8_t id = 1; id <= core::MAX_FERMENTERS; id++) {
+            auto* ferm = state_->get_fermenter(id);
+            if (!ferm) continue;
+            uint8_t step = ferm->plan_active ? ferm->current_step : 0xFF;
+            if (step != last_plan_step_[id]) {
+                uint8_t data[2] = {id, step};
+                append(RECORD_PLAN_STEP, data, sizeof(data));
+                last_plan_step_[id] = step;
+            }
+        }
+
+        uint32_t now = time_->millis();
+        if (now - last_snapshot_ms_ >= snapshot_interval_ms_) {
+            log_sensor_snapshot();
+            last_snapshot_ms_ = now;
+        }
+    }
+
+    /**
+     * Append one sensor snapshot record (all sensors)
+     */
+    void log_sensor_snapshot() {
+        uint8_t data[1 + core::MAX_SENSORS * sizeof(float)];
+        uint8_t count = state_->get_sensor_count();
+        data[0] = 0;
+        const core::SensorHotBlock& hot = state_->get_sensor_hot();
+        for (uint8_t i = 0; i < count; i++) {
+            float value = (hot.quality[i] == core::SensorQuality::BAD ||
+                           hot.quality[i] == core::SensorQuality::UNKNOWN) ?
+                          NAN : hot.filtered_value[i];
+            memcpy(&data[1 + i * sizeof(float)], &value, sizeof(float));
+        }
+        append(RECORD_SENSORS, data, 1 + count * sizeof(float));
+    }
+
+    /**
+     * Append a raw record; flushes the current block first if it won't fit
+     */
+    bool append(uint8_t type, const uint8_t* data, uint8_t len) {
+        if (!ready_ || RECORD_HEADER_SIZE + len > MAX_PAYLOAD) return false;
+
+        if (fill_ + RECORD_HEADER_SIZE + len > MAX_PAYLOAD) {
+            flush();
+        }
+
+        uint32_t ts = time_->get_unix_time();
+        if (ts < MIN_VALID_UNIX_TIME) {
+            ts = time_->millis() / 1000;
+            type |= TIME_UPTIME;
+        }
+
+        uint8_t* p = page_ + HEADER_SIZE + fill_;
+        p[0] = type;
+        p[1] = len;
+        put_u32(p + 2, ts);
+        if (len > 0) {
+            memcpy(p + RECORD_HEADER_SIZE, data, len);
+        }
+        fill_ += RECORD_HEADER_SIZE + len;
+        stats_.records_written++;
+        return true;
+    }
+
+    /**
+     * Program the pending block to flash (no-op when empty)
+     */
+    bool flush() {
+        if (!ready_ || fill_ == 0) return true;
+
+        // Erase a sector on first use in this lap
+        if (head_ % blocks_per_sector_ == 0) {
+            if (!flash_->erase_sector(head_ * BLOCK_SIZE)) {
+                stats_.write_errors++;
+                fill_ = 0;
+                memset(page_, 0xFF, sizeof(page_));
+                return false;
+            }
+            stats_.sectors_erased++;
+        }
+
+        put_u16(page_, BLOCK_MAGIC);
+        put_u16(page_ + 2, (uint16_t)fill_);
+        put_u32(page_ + 4, sequence_);
+        put_u32(page_ + 8, block_crc(page_, fill_));
+
+        bool ok = flash_->write(head_ * BLOCK_SIZE, page_, BLOCK_SIZE);
+        if (ok) {
+            stats_.blocks_written++;
+            if (head_ % blocks_per_sector_ == 0) {
+                save_checkpoint(head_, sequence_);
+            }
+        } else {
+            stats_.write_errors++;
+        }
+
+        // A failed block is left behind; its CRC keeps readers from using it
+        sequence_++;
+        head_ = (head_ + 1) % block_count_;
+        fill_ = 0;
+        memset(page_, 0xFF, sizeof(page_));
+        return ok;
+    }
+
+    /**
+     * Visit every valid record from oldest to newest
+     * Callback signature: void(uint8_t type, uint32_t timestamp, const uint8_t* data, uint8_t len)
+     * type has the TIME_UPTIME flag cleared; uptime stamps are reported as-is.
+     * @return Number of records visited
+     */
+    template<typename Fn>
+    uint32_t read_records(Fn fn) {
+        if (!ready_) return 0;
+
+        uint8_t block[BLOCK_SIZE];
+        uint32_t visited = 0;
+        uint32_t oldest_seq = sequence_ > block_count_ ? sequence_ - block_count_ : 0;
+
+        for (uint32_t n = 0; n < block_count_; n++) {
+            uint32_t idx = (head_ + n) % block_count_;
+            uint32_t seq;
+            uint16_t len;
+            if (!read_block(idx, block, seq, len)) continue;
+            if (seq < oldest_seq || seq >= sequence_) continue;
+
+            size_t off = HEADER_SIZE;
+            while (off + RECORD_HEADER_SIZE <= HEADER_SIZE + len) {
+                uint8_t type = block[off];
+                uint8_t rec_len = block[off + 1];
+                if (off + RECORD_HEADER_SIZE + rec_len > HEADER_SIZE + len) break;
+                fn((uint8_t)(type & ~TIME_UPTIME), get_u32(block + off + 2),
+                   block + off + RECORD_HEADER_SIZE, rec_len);
+                visited++;
+                off += RECORD_HEADER_SIZE + rec_len;
+            }
+        }
+        return visited;
+    }
+
+    bool is_ready() const { return ready_; }
+    uint32_t get_block_count() const { return block_count_; }
+    uint32_t get_head() const { return head_; }
+    uint32_t get_sequence() const { return sequence_; }
+    size_t get_pending_bytes() const { return fill_; }
+    const Stats& get_stats() const { return stats_; }
+
+    static uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0xFFFFFFFF) {
+        for (size_t i = 0; i < len; i++) {
+            crc ^= data[i];
+            for (uint8_t b = 0; b < 8; b++) {
+                crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+            }
+        }
+        return crc;
+    }
+
+private:
+    hal::IFlashPartition* flash_;
+    hal::IStorageInterface* storage_;
+    hal::ITimeInterface* time_;
+    core::StateManager* state_;
+
+    bool ready_;
+    uint32_t block_count_;
+    uint32_t blocks_per_sector_;
+    uint32_t head_;                 // Next block to program
+    uint32_t sequence_;             // Sequence number of the next block
+    size_t fill_;                   // Payload bytes pending in page_
+    uint8_t page_[BLOCK_SIZE];
+
+    uint32_t snapshot_interval_ms_;
+    uint32_t last_snapshot_ms_;
+    Stats stats_;
+
+    bool relay_known_;
+    bool last_relay_state_[core::MAX_RELAYS];
+    uint8_t last_plan_step_[core::MAX_FERMENTERS + 1];   // By fermenter id
+
+    struct Checkpoint {
+        uint32_t block;
+        uint32_t sequence;
+    };
+
+    static void put_u16(uint8_t* p, uint16_t v) {
+        p[0] = v & 0xFF;
+        p[1] = v >> 8;
+    }
+
+    static void put_u32(uint8_t* p, uint32_t v) {
+        for (uint8_t i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xFF;
+    }
+
+    static uint16_t get_u16(const uint8_t* p) {
+        return p[0] | (p[1] << 8);
+    }
+
+    static uint32_t get_u32(const uint8_t* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    static uint32_t block_crc(const uint8_t* block, size_t len) {
+        uint32_t crc = crc32(block, 8);
+        return ~crc32(block + HEADER_SIZE, len, crc);
+    }
+
+    void append_name(uint8_t kind, uint8_t id, const char* name) {
+        uint8_t data[2 + core::MAX_NAME_LENGTH];
+        size_t len = strnlen(name, core::MAX_NAME_LENGTH);
+        data[0] = kind;
+        data[1] = id;
+        memcpy(data + 2, name, len);
+        append(RECORD_NAME, data, (uint8_t)(2 + len));
+    }
+
+    /**
+     * Read and validate a block
+     * @return false if erased, torn or corrupt
+     */
+    bool read_block(uint32_t idx, uint8_t* block, uint32_t& seq, uint16_t& len) {
+        if (!flash_->read(idx * BLOCK_SIZE, block, BLOCK_SIZE)) return false;
+        if (get_u16(block) != BLOCK_MAGIC) return false;
+        len = get_u16(block + 2);
+        if (len > MAX_PAYLOAD) return false;
+        seq = get_u32(block + 4);
+        return get_u32(block + 8) == block_crc(block, len);
+    }
+
+    bool is_erased(uint32_t idx) {
+        uint8_t block[BLOCK_SIZE];
+        if (!flash_->read(idx * BLOCK_SIZE, block, BLOCK_SIZE)) return false;
+        for (size_t i = 0; i < BLOCK_SIZE; i++) {
+            if (block[i] != 0xFF) return false;
+        }
+        return true;
+    }
+
+    void save_checkpoint(uint32_t block, uint32_t sequence) {
+        if (!storage_) return;
+        Checkpoint cp = {block, sequence};
+        storage_->write_blob(CHECKPOINT_KEY, &cp, sizeof(cp));
+    }
+
+    /**
+     * Find the newest valid block and position the head after it
+     */
+    void recover() {
+        uint8_t block[BLOCK_SIZE];
+        uint32_t seq;
+        uint16_t len;
+        bool found = false;
+        uint32_t start = 0;
+        uint32_t start_seq = 0;
+
+        stats_ = Stats();
+
+        // Fast path: walk from the checkpointed sector start
+        Checkpoint cp;
+        size_t cp_len = sizeof(cp);
+        if (storage_ && storage_->read_blob(CHECKPOINT_KEY, &cp, &cp_len) && cp_len == sizeof(cp) &&
+            cp.block < block_count_ && read_block(cp.block, block, seq, len) && seq == cp.sequence) {
+            start = cp.block;
+            start_seq = seq;
+            found = true;
+            stats_.recovered_from_checkpoint = true;
+        }
+
+        // Slow path: newest sector by its first block
+        if (!found) {
+            for (uint32_t s = 0; s < block_count_; s += blocks_per_sector_) {
+                if (read_block(s, block, seq, len) && (!found || seq > start_seq)) {
+                    start = s;
+                    start_seq = seq;
+                    found = true;
+                }
+            }
+        }
+
+        if (!found) {
+            head_ = 0;
+            sequence_ = 0;
+            return;
+        }
+
+        uint32_t last = start;
+        uint32_t last_seq = start_seq;
+        stats_.recovered_blocks = 1;
+        for (uint32_t n = 1; n < block_count_; n++) {
+            uint32_t idx = (start + n) % block_count_;
+            if (!read_block(idx, block, seq, len) || seq != last_seq + 1) break;
+            last = idx;
+            last_seq = seq;
+            stats_.recovered_blocks++;
+        }
+
+        head_ = (last + 1) % block_count_;
+        sequence_ = last_seq + 1;
+
+        // A torn write leaves a programmed but invalid block at the head;
+        // skip to the next sector, which is erased before use
+        if (head_ % blocks_per_sector_ != 0 && !is_erased(head_)) {
+            head_ = ((head_ / blocks_per_sector_ + 1) * blocks_per_sector_) % block_count_;
+        }
+    }
+};
+
+} // namespace modules
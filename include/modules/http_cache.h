@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "core/types.h"
+
+namespace modules {
+
+/**
+ * Conditional GET (ETag / If-None-Match) for the state endpoints
+ *
+ * ETags are derived from StateManager's generations of the state domains
+ * an endpoint renders, so answering an unchanged poll with 304 builds no
+ * JSON at all, and a relay poll is not invalidated by sensor traffic.
+ * Endpoints whose body carries telemetry (uptime, heap, CPU, MODBUS
+ * counters) fold in the current second instead, and the dashboard folds
+ * in a fingerprint of the peripheral readings it reports live (GPIO,
+ * network, CAN).
+ *
+ * Per-endpoint counters give the 304 hit ratio for the debug console.
+ */
+class HttpCache {
+public:
+    static constexpr uint8_t PER_SECOND = 0x01;    // Body has uptime/clock fields
+    static constexpr uint8_t PERIPHERALS = 0x02;   // Body reads hardware live
+
+    struct Endpoint {
+        const char* path;
+        bool prefix;        // Matches path + "<id>" (single segment)
+        uint8_t domains;    // core::state_domain_bit() mask of what the body shows
+        uint8_t flags;
+    };
+
+    static constexpr int ENDPOINT_COUNT = 10;
+    static constexpr size_t ETAG_SIZE = 48;
+
+    static constexpr uint8_t SENSORS = core::state_domain_bit(core::StateDomain::SENSORS);
+    static constexpr uint8_t RELAYS = core::state_domain_bit(core::StateDomain::RELAYS);
+    static constexpr uint8_t FERMENTERS = core::state_domain_bit(core::StateDomain::FERMENTERS);
+    static constexpr uint8_t ALARMS = core::state_domain_bit(core::StateDomain::ALARMS);
+    static constexpr uint8_t SYSTEM = core::state_domain_bit(core::StateDomain::SYSTEM);
+
+    static constexpr Endpoint ENDPOINTS[ENDPOINT_COUNT] = {
+        // Status shows the sensor and fermenter counts
+        {"/api/status",       false, SENSORS | FERMENTERS | SYSTEM, PER_SECOND},
+        {"/api/sensors",      false, SENSORS, 0},
+        {"/api/sensor/",      true,  SENSORS, PER_SECOND},      // Reading timestamp
+        {"/api/relays",       false, RELAYS, 0},
+        {"/api/fermenters",   false, FERMENTERS, 0},
+        {"/api/fermenter/",   true,  FERMENTERS, 0},
+        {"/api/alarms",       false, ALARMS, 0},
+        {"/api/modbus/stats", false, 0, PER_SECOND},
+        {"/api/state",        false, core::STATE_DOMAINS_ALL, PER_SECOND},
+        {"/api/dashboard",    false, core::STATE_DOMAINS_ALL, PER_SECOND | PERIPHERALS},
+    };
+
+    HttpCache() { reset(); }
+
+    HttpCache(const HttpCache&) = delete;
+    HttpCache& operator=(const HttpCache&) = delete;
+
+    /**
+     * @return Index into ENDPOINTS, or -1 if the path is not cacheable
+     */
+    static int find(const char* path) {
+        if (!path) return -1;
+        for (int i = 0; i < ENDPOINT_COUNT; i++) {
+            const Endpoint& e = ENDPOINTS[i];
+            if (!e.prefix) {
+                if (strcmp(path, e.path) == 0) return i;
+                continue;
+            }
+            size_t len = strlen(e.path);
+            if (strncmp(path, e.path, len) == 0 && path[len] != '\0' &&
+                strchr(path + len, '/') == nullptr) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Format a strong ETag: "g<generation>[-s<second>][-p<fingerprint>][-<variant>]"
+     * @param variant Distinguishes representations of one URI (nullptr: none)
+     */
+    static void format_etag(char* out, size_t size, uint32_t generation, uint8_t flags,
+                            uint32_t second, uint32_t fingerprint, const char* variant) {
+        if (!out || size == 0) return;
+        int n = snprintf(out, size, "\"g%lx", (unsigned long)generation);
+        if ((flags & PER_SECOND) && n > 0 && (size_t)n < size) {
+            n += snprintf(out + n, size - n, "-s%lx", (unsigned long)second);
+        }
+        if ((flags & PERIPHERALS) && n > 0 && (size_t)n < size) {
+            n += snprintf(out + n, size - n, "-p%lx", (unsigned long)fingerprint);
+        }
+        if (variant && n > 0 && (size_t)n < size) {
+            n += snprintf(out + n, size - n, "-%s", variant);
+        }
+        if (n > 0 && (size_t)n < size) {
+            snprintf(out + n, size - n, "\"");
+        }
+    }
+
+    /**
+     * If-None-Match comparison (weak, per RFC 7232)
+     * @param if_none_match Header value: "*" or a comma-separated ETag list
+     */
+    static bool matches(const char* if_none_match, const char* etag) {
+        if (!if_none_match || !etag || etag[0] == '\0') return false;
+        size_t etag_len = strlen(etag);
+        const char* p = if_none_match;
+        while (*p) {
+            while (*p == ' ' || *p == ',') p++;
+            if (*p == '*') return true;
+            if (p[0] == 'W' && p[1] == '/') p += 2;
+            const char* start = p;
+            while (*p && *p != ',' && *p != ' ') p++;
+            if ((size_t)(p - start) == etag_len && strncmp(start, etag, etag_len) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * FNV-1a over a value, for fingerprinting live readings
+     */
+    static uint32_t fnv1a(uint32_t hash, const void* data, size_t len) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < len; i++) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+    static constexpr uint32_t FNV_OFFSET = 2166136261u;
+
+    /**
+     * Count a conditional-capable request
+     * @param not_modified Answered with 304
+     */
+    void record(int index, bool not_modified) {
+        if (index < 0 || index >= ENDPOINT_COUNT) return;
+        requests_[index].fetch_add(1, std::memory_order_relaxed);
+        if (not_modified) hits_[index].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint32_t requests(int index) const {
+        return requests_[index].load(std::memory_order_relaxed);
+    }
+
+    uint32_t hits(int index) const {
+        return hits_[index].load(std::memory_order_relaxed);
+    }
+
+    void reset() {
+        for (int i = 0; i < ENDPOINT_COUNT; i++) {
+            requests_[i].store(0);
+            hits_[i].store(0);
+        }
+    }
+
+private:
+    std::atomic<uint32_t> requests_[ENDPOINT_COUNT];
+    std::atomic<uint32_t> hits_[ENDPOINT_COUNT];
+};
+
+} // namespace modules
@@ -4,8 +4,13 @@
 #include "core/state_manager.h"
 #include "core/event_bus.h"
 #include "core/config.h"
+#include "core/json_writer.h"
 #include "modules/safety_controller.h"
 #include "modules/fermentation_plan.h"
+#include "modules/http_cache.h"
+#include "modules/route_table.h"
+#include "modules/state_snapshot.h"
+#include "modules/static_assets.h"
 #include "security/secure_utils.h"
 #include "security/cert_generator.h"
 #include "version.h"
@@ -14,6 +19,7 @@
 #include <cstdarg>
 #include <string>
 #include <functional>
+#include <iterator>
 
 #ifdef WIFI_NTP_ENABLED
 #include "modules/wifi_provisioning.h"
@@ -36,6 +42,7 @@
 #endif
 
 #ifdef ESP32_BUILD
+#include "sdkconfig.h"
 #include "esp_https_server.h"
 #include "esp_log.h"
 #include "esp_spiffs.h"
@@ -63,9 +70,18 @@ namespace modules {
  */
 class HttpServer {
 public:
-    static constexpr size_t MAX_RESPONSE_SIZE = 4096;
     static constexpr size_t MAX_SESSION_TOKEN = security::SESSION_TOKEN_BUF_SIZE;
     static constexpr uint32_t SESSION_TIMEOUT_MS = 3600000;  // 1 hour
+    // Per server: every WebSocket client holds one (see CONFIG_LWIP_MAX_SOCKETS)
+    static constexpr uint16_t MAX_OPEN_SOCKETS = 10;
+#ifdef CONFIG_LWIP_MAX_SOCKETS
+    // httpd_start() also needs a listen and a control socket, and rejects
+    // max_open_sockets above LWIP_MAX_SOCKETS - 3
+    static_assert(MAX_OPEN_SOCKETS <= CONFIG_LWIP_MAX_SOCKETS - 3,
+                  "Raise CONFIG_LWIP_MAX_SOCKETS in every sdkconfig.<env>");
+    static_assert(2 * (MAX_OPEN_SOCKETS + 3) + 4 <= CONFIG_LWIP_MAX_SOCKETS,
+                  "HTTPS and HTTP servers leave no sockets for MQTT/NTP/mDNS");
+#endif
 
     // Rate limiting constants
     static constexpr uint8_t MAX_LOGIN_ATTEMPTS = 10;
@@ -198,6 +214,7 @@ public:
             size_t total = 0, used = 0;
             esp_spiffs_info(NULL, &total, &used);
             ESP_LOGI("HTTP", "SPIFFS mounted: %d/%d bytes used", used, total);
+            load_assets();
         }
 
         if (use_ssl) {
@@ -213,6 +230,7 @@ public:
             config.httpd.max_uri_handlers = 50;
             config.httpd.stack_size = 12288;  // 12KB for OTA setup
             config.httpd.lru_purge_enable = true;
+            config.httpd.max_open_sockets = MAX_OPEN_SOCKETS;
             config.httpd.uri_match_fn = httpd_uri_match_wildcard;  // Enable wildcard matching
 
             // Use embedded certificate
@@ -236,6 +254,7 @@ public:
             config.max_uri_handlers = 50;
             config.stack_size = 12288;  // 12KB for OTA setup
             config.lru_purge_enable = true;
+            config.max_open_sockets = MAX_OPEN_SOCKETS;
             config.uri_match_fn = httpd_uri_match_wildcard;  // Enable wildcard matching
 
             esp_err_t ret = httpd_start(&server_, &config);
@@ -261,6 +280,8 @@ public:
                     },
                     this
                 );
+                ws_manager_->set_safety_controller(safety_);
+                if (config_) ws_manager_->set_update_interval(config_->display.update_interval_ms);
                 ESP_LOGI("HTTP", "WebSocket manager initialized");
             } else {
                 ESP_LOGW("HTTP", "WebSocket manager initialization failed");
@@ -512,7 +533,82 @@ public:
     }
 
     /**
-     * Process REST API request
+     * REST API route identifiers
+     */
+    enum class ApiRoute : uint8_t {
+        // No auth
+        SETUP_STATUS, SETUP, LOGIN, HEALTH, INFO, SSL_STATUS,
+        // Authenticated
+        LOGOUT, PASSWORD, FACTORY_RESET,
+        STATUS, SENSORS, SENSOR, RELAYS, RELAY_SET,
+        FERMENTERS, FERMENTER, FERMENTER_SET, PID, PID_SET, OUTPUT_SET,
+        ALARMS, MODBUS_STATS, INPUTS, OUTPUTS, CONFIG, MODULES,
+        WIFI, CAN_STATUS,
+        FIRMWARE_INFO, FIRMWARE_STATUS, FIRMWARE_DOWNLOAD, FIRMWARE_CONFIRM, FIRMWARE_ROLLBACK,
+        CPU_HISTORY, NETWORK_HISTORY, SENSOR_HISTORY,
+        WIFI_SUMMARY, DASHBOARD, STATE, REBOOT
+    };
+
+    /**
+     * REST API routes, compiled into ROUTER at build time
+     * A path served for another method is still a 404.
+     */
+    static constexpr RouteDef<ApiRoute> ROUTES[] = {
+        {RouteMethod::GET,  "/api/setup",                  ApiRoute::SETUP_STATUS},
+        {RouteMethod::POST, "/api/setup",                  ApiRoute::SETUP},
+        {RouteMethod::POST, "/api/login",                  ApiRoute::LOGIN},
+        {RouteMethod::GET,  "/api/health",                 ApiRoute::HEALTH},
+        {RouteMethod::GET,  "/api/info",                   ApiRoute::INFO},
+        {RouteMethod::GET,  "/api/ssl/status",             ApiRoute::SSL_STATUS},
+        {RouteMethod::POST, "/api/logout",                 ApiRoute::LOGOUT},
+        {RouteMethod::POST, "/api/password",               ApiRoute::PASSWORD},
+        {RouteMethod::POST, "/api/factory_reset",          ApiRoute::FACTORY_RESET},
+        {RouteMethod::GET,  "/api/status",                 ApiRoute::STATUS},
+        {RouteMethod::GET,  "/api/sensors",                ApiRoute::SENSORS},
+        {RouteMethod::GET,  "/api/sensor/{name}",          ApiRoute::SENSOR},
+        {RouteMethod::GET,  "/api/relays",                 ApiRoute::RELAYS},
+        {RouteMethod::POST, "/api/relay/{name}",           ApiRoute::RELAY_SET},
+        {RouteMethod::GET,  "/api/fermenters",             ApiRoute::FERMENTERS},
+        {RouteMethod::GET,  "/api/fermenter/{id:int}",     ApiRoute::FERMENTER},
+        {RouteMethod::POST, "/api/fermenter/{id:int}",     ApiRoute::FERMENTER_SET},
+        {RouteMethod::GET,  "/api/pid/{id:int}",           ApiRoute::PID},
+        {RouteMethod::POST, "/api/pid/{id:int}",           ApiRoute::PID_SET},
+        {RouteMethod::POST, "/api/output/{id:int}",        ApiRoute::OUTPUT_SET},
+        {RouteMethod::GET,  "/api/alarms",                 ApiRoute::ALARMS},
+        {RouteMethod::GET,  "/api/modbus/stats",           ApiRoute::MODBUS_STATS},
+        {RouteMethod::GET,  "/api/inputs",                 ApiRoute::INPUTS},
+        {RouteMethod::GET,  "/api/outputs",                ApiRoute::OUTPUTS},
+        {RouteMethod::GET,  "/api/config",                 ApiRoute::CONFIG},
+        {RouteMethod::GET,  "/api/modules",                ApiRoute::MODULES},
+#ifdef WIFI_NTP_ENABLED
+        {RouteMethod::GET,  "/api/wifi",                   ApiRoute::WIFI},
+#endif
+#ifdef CAN_ENABLED
+        {RouteMethod::GET,  "/api/can/status",             ApiRoute::CAN_STATUS},
+#endif
+#ifdef OTA_ENABLED
+        {RouteMethod::GET,  "/api/firmware/info",          ApiRoute::FIRMWARE_INFO},
+        {RouteMethod::GET,  "/api/firmware/status",        ApiRoute::FIRMWARE_STATUS},
+        {RouteMethod::POST, "/api/firmware/download",      ApiRoute::FIRMWARE_DOWNLOAD},
+        {RouteMethod::POST, "/api/firmware/confirm",       ApiRoute::FIRMWARE_CONFIRM},
+        {RouteMethod::POST, "/api/firmware/rollback",      ApiRoute::FIRMWARE_ROLLBACK},
+#endif
+        {RouteMethod::GET,  "/api/cpu/history",            ApiRoute::CPU_HISTORY},
+        {RouteMethod::GET,  "/api/network/history",        ApiRoute::NETWORK_HISTORY},
+        {RouteMethod::GET,  "/api/history/sensor/{name}",  ApiRoute::SENSOR_HISTORY},
+        {RouteMethod::GET,  "/api/wifi/summary",           ApiRoute::WIFI_SUMMARY},
+        {RouteMethod::GET,  "/api/dashboard",              ApiRoute::DASHBOARD},
+        {RouteMethod::GET,  "/api/state",                  ApiRoute::STATE},
+        {RouteMethod::POST, "/api/reboot",                 ApiRoute::REBOOT},
+    };
+
+    static constexpr RouteTrie<ApiRoute, route_trie_nodes(ROUTES), std::size(ROUTES)> ROUTER{ROUTES};
+    static_assert(ROUTER.valid(), "REST API route table is ambiguous");
+
+    /**
+     * Process REST API request into a caller-supplied buffer
+     * Output that doesn't fit is truncated (the streaming overload below
+     * has no size limit).
      * @param method HTTP method (GET, POST, PUT, DELETE)
      * @param path Request path
      * @param body Request body (for POST/PUT)
@@ -523,185 +619,270 @@ public:
      */
     int handle_request(const char* method, const char* path, const char* body,
                        const char* token, char* response, size_t response_size) {
-        // Setup endpoint (for first-boot provisioning) - always accessible
-        if (strcmp(path, "/api/setup") == 0) {
-            if (strcmp(method, "GET") == 0) {
-                // Return provisioning status
-                snprintf(response, response_size,
-                    "{\"provisioned\":%s,\"password_requirements\":{\"min_length\":%zu,\"categories\":2}}",
-                    provisioned_ ? "true" : "false",
-                    security::MIN_PASSWORD_LENGTH);
-                return 200;
-            } else if (strcmp(method, "POST") == 0) {
-                return handle_setup(body, response, response_size);
-            }
-        }
-
-        // Login endpoint - handles rate limiting internally
-        if (strcmp(path, "/api/login") == 0 && strcmp(method, "POST") == 0) {
-            return handle_login(body, response, response_size);
-        }
-
-        // Health check (no auth, minimal info)
-        if (strcmp(path, "/api/health") == 0 && strcmp(method, "GET") == 0) {
-            snprintf(response, response_size, "{\"status\":\"ok\",\"provisioned\":%s}",
-                     provisioned_ ? "true" : "false");
-            return 200;
-        }
+        core::JsonBufferSink sink(response, response_size);
+        core::JsonWriter json(core::JsonBufferSink::write, &sink);
+        int status = handle_request(method, path, body, token, json);
+        json.finish();
+        return status;
+    }
 
-        // Feature info (no auth - needed for WebSocket detection)
-        if (strcmp(path, "/api/info") == 0 && strcmp(method, "GET") == 0) {
+    /**
+     * Process REST API request, streaming the JSON response
+     * Error responses must stay within one JsonWriter chunk, so the status
+     * is known before anything is flushed (see api_handler).
+     * @return HTTP status code
+     */
+    int handle_request(const char* method, const char* path, const char* body,
+                       const char* token, core::JsonWriter& json) {
+        RouteMatch match;
+        ApiRoute route;
+        bool found = ROUTER.match(RouteMethod::from_string(method), path, match, route);
+
+        // Endpoints reachable before provisioning/login
+        if (found) {
+            switch (route) {
+                case ApiRoute::SETUP_STATUS:
+                    // First-boot provisioning status
+                    json.begin_object()
+                        .field("provisioned", provisioned_)
+                        .key("password_requirements").begin_object()
+                            .field("min_length", security::MIN_PASSWORD_LENGTH)
+                            .field("categories", 2)
+                        .end_object()
+                    .end_object();
+                    return 200;
+
+                case ApiRoute::SETUP:
+                    return handle_setup(body, json);
+
+                case ApiRoute::LOGIN:
+                    // Handles rate limiting internally
+                    return handle_login(body, json);
+
+                case ApiRoute::HEALTH:
+                    // No auth, minimal info
+                    json.begin_object()
+                        .field("status", "ok")
+                        .field("provisioned", provisioned_)
+                    .end_object();
+                    return 200;
+
+                case ApiRoute::INFO: {
+                    // Needed for WebSocket detection
 #ifdef WEBSOCKET_ENABLED
-            bool ws_available = (ws_manager_ != nullptr);
+                    bool ws_available = (ws_manager_ != nullptr);
 #else
-            bool ws_available = false;
+                    bool ws_available = false;
 #endif
-            snprintf(response, response_size,
-                     "{\"version\":\"%s\",\"websocket\":%s}",
-                     FIRMWARE_VERSION, ws_available ? "true" : "false");
-            return 200;
-        }
+                    json.begin_object()
+                        .field("version", FIRMWARE_VERSION)
+                        .field("websocket", ws_available)
+                    .end_object();
+                    return 200;
+                }
 
-        // SSL certificate status (no auth)
-        if (strcmp(path, "/api/ssl/status") == 0 && strcmp(method, "GET") == 0) {
+                case ApiRoute::SSL_STATUS:
+                    json.begin_object();
 #ifdef ESP32_BUILD
-            snprintf(response, response_size,
-                     "{\"cert_status\":\"%s\",\"https_enabled\":%s,\"https_port\":443}",
-                     get_cert_status(),
-                     (https_ready_ && server_) ? "true" : "false");
+                    json.field("cert_status", get_cert_status())
+                        .field("https_enabled", https_ready_ && server_)
+                        .field("https_port", 443);
 #else
-            snprintf(response, response_size,
-                     "{\"cert_status\":\"simulator\",\"https_enabled\":false}");
+                    json.field("cert_status", "simulator")
+                        .field("https_enabled", false);
 #endif
-            return 200;
+                    json.end_object();
+                    return 200;
+
+                default:
+                    break;
+            }
         }
 
         // If not provisioned, require setup first
         if (!provisioned_) {
-            snprintf(response, response_size,
-                "{\"error\":\"Device not provisioned\",\"setup_required\":true}");
+            json.begin_object()
+                .field("error", "Device not provisioned")
+                .field("setup_required", true)
+            .end_object();
             return 403;
         }
 
         // All other endpoints require auth
         if (!is_authenticated(token)) {
-            snprintf(response, response_size, "{\"error\":\"Unauthorized\"}");
-            return 401;
-        }
-
-        // Logout
-        if (strcmp(path, "/api/logout") == 0 && strcmp(method, "POST") == 0) {
-            logout();
-            snprintf(response, response_size, "{\"success\":true}");
-            return 200;
-        }
-
-        // Change password
-        if (strcmp(path, "/api/password") == 0 && strcmp(method, "POST") == 0) {
-            return handle_password_change(body, response, response_size);
-        }
-
-        // Factory reset
-        if (strcmp(path, "/api/factory_reset") == 0 && strcmp(method, "POST") == 0) {
-            return handle_factory_reset(response, response_size);
+            return json_error(json, 401, "Unauthorized");
         }
 
-        // Route to handlers
-        if (strcmp(method, "GET") == 0) {
-            return handle_get(path, response, response_size);
-        } else if (strcmp(method, "POST") == 0) {
-            return handle_post(path, body, response, response_size);
+        if (!found) {
+            return json_error(json, 404, "Not found");
         }
-
-        snprintf(response, response_size, "{\"error\":\"Not found\"}");
-        return 404;
+        return handle_route(route, match, body, json);
     }
 
     /**
      * Build current state as JSON for WebSocket broadcast
+     * Output that doesn't fit the buffer is truncated.
      */
     void build_state_json(char* buffer, size_t size) {
+        core::JsonBufferSink sink(buffer, size);
+        core::JsonWriter json(core::JsonBufferSink::write, &sink);
+        build_state_json(json);
+        json.finish();
+    }
+
+    void build_state_json(core::JsonWriter& json) {
         auto& sys = state_->get_system_state();
 
-        int offset = snprintf(buffer, size,
-            "{\"type\":\"state\",\"timestamp\":%lu,"
-            "\"system\":{\"uptime\":%lu,\"heap\":%lu,\"wifi_rssi\":%d,\"ntp_synced\":%s},"
-            "\"sensors\":{",
-            (unsigned long)time_->millis() / 1000,
-            (unsigned long)sys.uptime_seconds,
-            (unsigned long)sys.free_heap,
-            sys.wifi_rssi,
-            sys.ntp_synced ? "true" : "false");
+        json.begin_object()
+            .field("type", "state")
+            .field("timestamp", (unsigned long)time_->millis() / 1000)
+            .key("system").begin_object()
+                .field("uptime", (unsigned long)sys.uptime_seconds)
+                .field("heap", (unsigned long)sys.free_heap)
+                .field("wifi_rssi", sys.wifi_rssi)
+                .field("ntp_synced", sys.ntp_synced)
+            .end_object();
 
         // Add sensors
+        json.key("sensors").begin_object();
         uint8_t sensor_count = state_->get_sensor_count();
-        for (uint8_t i = 0; i < sensor_count && offset < (int)size - 100; i++) {
+        for (uint8_t i = 0; i < sensor_count; i++) {
             auto* sensor = state_->get_sensor_by_id(i);
-            if (sensor) {
-                if (i > 0) offset += snprintf(buffer + offset, size - offset, ",");
-                offset += snprintf(buffer + offset, size - offset,
-                    "\"%s\":{\"value\":%.3f,\"quality\":\"%s\"}",
-                    sensor->name, sensor->filtered_value,
-                    quality_to_string(sensor->quality));
+            core::SensorSnapshot snap;
+            if (sensor && state_->read_sensor(i, snap)) {
+                json.key(sensor->name).begin_object()
+                    .field("value", snap.filtered_value, 3)
+                    .field("quality", quality_to_string(snap.quality))
+                .end_object();
             }
         }
-
-        offset += snprintf(buffer + offset, size - offset, "},\"relays\":{");
+        json.end_object();
 
         // Add relays
+        json.key("relays").begin_object();
         uint8_t relay_count = state_->get_relay_count();
-        for (uint8_t i = 0; i < relay_count && offset < (int)size - 100; i++) {
+        for (uint8_t i = 0; i < relay_count; i++) {
             auto* relay = state_->get_relay_by_id(i);
-            if (relay) {
-                if (i > 0) offset += snprintf(buffer + offset, size - offset, ",");
-                offset += snprintf(buffer + offset, size - offset,
-                    "\"%s\":%s", relay->name, relay->state ? "true" : "false");
+            core::RelaySnapshot snap;
+            if (relay && state_->read_relay(i, snap)) {
+                json.field(relay->name, snap.state);
             }
         }
-
-        offset += snprintf(buffer + offset, size - offset, "},\"fermenters\":{");
+        json.end_object();
 
         // Add fermenters
-        bool first_ferm = true;
-        for (uint8_t i = 1; i <= core::MAX_FERMENTERS && offset < (int)size - 200; i++) {
+        json.key("fermenters").begin_object();
+        for (uint8_t i = 1; i <= core::MAX_FERMENTERS; i++) {
             auto* ferm = state_->get_fermenter(i);
             if (ferm && ferm->id != 0) {
-                if (!first_ferm) offset += snprintf(buffer + offset, size - offset, ",");
-                first_ferm = false;
-                offset += snprintf(buffer + offset, size - offset,
-                    "\"F%d\":{\"temp\":%.2f,\"setpoint\":%.2f,\"pressure\":%.3f,"
-                    "\"mode\":\"%s\",\"pid_output\":%.1f,\"plan_active\":%s,"
-                    "\"current_step\":%d,\"hours_remaining\":%.1f}",
-                    i, ferm->current_temp, ferm->target_temp, ferm->current_pressure,
-                    mode_to_string(ferm->mode), ferm->pid_output,
-                    ferm->plan_active ? "true" : "false",
-                    ferm->current_step, ferm->hours_remaining);
+                char key[8];
+                snprintf(key, sizeof(key), "F%d", i);
+                json.key(key).begin_object()
+                    .field("temp", ferm->current_temp, 2)
+                    .field("setpoint", ferm->target_temp, 2)
+                    .field("pressure", ferm->current_pressure, 3)
+                    .field("mode", mode_to_string(ferm->mode))
+                    .field("pid_output", ferm->pid_output, 1)
+                    .field("plan_active", ferm->plan_active)
+                    .field("current_step", ferm->current_step)
+                    .field("hours_remaining", ferm->hours_remaining, 1)
+                .end_object();
             }
         }
+        json.end_object();
 
-        offset += snprintf(buffer + offset, size - offset, "},\"alarms\":[");
+        json.key("alarms");
+        write_alarms(json);
 
-        // Add alarms
-        bool first_alarm = true;
-        if (safety_) {
-            for (uint8_t i = 1; i <= core::MAX_FERMENTERS && offset < (int)size - 100; i++) {
-                auto* alarm = safety_->get_alarm_state(i);
-                if (alarm && (alarm->temp_high_alarm || alarm->temp_low_alarm ||
-                              alarm->pressure_high_alarm || alarm->sensor_failure_alarm)) {
-                    if (!first_alarm) offset += snprintf(buffer + offset, size - offset, ",");
-                    first_alarm = false;
-                    offset += snprintf(buffer + offset, size - offset,
-                        "{\"fermenter\":%d,\"temp_high\":%s,\"temp_low\":%s,"
-                        "\"pressure_high\":%s,\"sensor_failure\":%s}",
-                        i, alarm->temp_high_alarm ? "true" : "false",
-                        alarm->temp_low_alarm ? "true" : "false",
-                        alarm->pressure_high_alarm ? "true" : "false",
-                        alarm->sensor_failure_alarm ? "true" : "false");
+        json.end_object();
+    }
+
+    /**
+     * Encode current state as a binary snapshot (layout in state_snapshot.h)
+     * @return Encoded length, 0 if the buffer is too small
+     */
+    size_t build_state_snapshot(uint8_t* buffer, size_t size) {
+        return encode_state_snapshot(*state_, safety_, time_->millis(), buffer, size);
+    }
+
+    /**
+     * Conditional GET for the state endpoints (call before handle_request)
+     * The generations are read before any body is built, so the ETag never
+     * claims a newer state than the response shows.
+     * @param if_none_match If-None-Match header value (nullptr/"" if absent)
+     * @param etag Receives the current ETag; "" if the path is not cacheable
+     *             or the caller is not authenticated
+     * @param variant Representation suffix (e.g. binary /api/state), or nullptr
+     * @return 304 if the client's copy is current, otherwise 0 (serve the
+     *         full response with the ETag)
+     */
+    int check_not_modified(const char* path, const char* token, const char* if_none_match,
+                           char* etag, size_t etag_size, const char* variant = nullptr) {
+        if (etag && etag_size > 0) etag[0] = '\0';
+        int index = HttpCache::find(path);
+        if (index < 0 || !etag || !provisioned_ || !is_authenticated(token)) return 0;
+
+        const HttpCache::Endpoint& endpoint = HttpCache::ENDPOINTS[index];
+        uint8_t flags = endpoint.flags;
+        HttpCache::format_etag(etag, etag_size, state_->get_generation(endpoint.domains), flags,
+                               (flags & HttpCache::PER_SECOND) ? time_->millis() / 1000 : 0,
+                               (flags & HttpCache::PERIPHERALS) ? peripheral_fingerprint() : 0,
+                               variant);
+
+        bool not_modified = HttpCache::matches(if_none_match, etag);
+        cache_.record(index, not_modified);
+        return not_modified ? 304 : 0;
+    }
+
+    /** Per-endpoint conditional GET counters (debug console) */
+    const HttpCache& get_cache_stats() const { return cache_; }
+
+    /**
+     * Endpoints that can answer with a binary snapshot instead of JSON
+     * /api/dashboard is what SCADA pollers hit every second, so it
+     * negotiates the same representation as /api/state.
+     */
+    static bool serves_snapshot(const char* path) {
+        RouteMatch match;
+        ApiRoute route;
+        return ROUTER.match(RouteMethod::GET, path, match, route) &&
+               (route == ApiRoute::STATE || route == ApiRoute::DASHBOARD);
+    }
+
+    /**
+     * Content negotiation for /api/state and /api/dashboard
+     * @param accept Accept header value (may be nullptr)
+     * @return true if it lists the snapshot or octet-stream type with q > 0
+     */
+    static bool accepts_snapshot(const char* accept) {
+        if (!accept) return false;
+        const char* p = accept;
+        while (*p) {
+            while (*p == ' ' || *p == ',') p++;
+            const char* type = p;
+            while (*p && *p != ';' && *p != ',' && *p != ' ') p++;
+            size_t type_len = p - type;
+
+            // Parameters: only q=0 matters (explicitly refused)
+            bool refused = false;
+            while (*p && *p != ',') {
+                if (p > accept && (p[-1] == ';' || p[-1] == ' ') && p[0] == 'q' && p[1] == '=') {
+                    const char* q = p + 2;
+                    refused = (*q == '0');
+                    while (*q == '0' || *q == '.') q++;
+                    if (*q >= '1' && *q <= '9') refused = false;
                 }
+                p++;
             }
-        }
 
-        snprintf(buffer + offset, size - offset, "]}");
+            if (!refused &&
+                ((type_len == strlen(SNAPSHOT_CONTENT_TYPE) &&
+                  strncmp(type, SNAPSHOT_CONTENT_TYPE, type_len) == 0) ||
+                 (type_len == 24 && strncmp(type, "application/octet-stream", 24) == 0))) {
+                return true;
+            }
+        }
+        return false;
     }
 
 private:
@@ -737,6 +918,9 @@ private:
     bool running_;
     bool provisioned_;
     char current_client_ip_[16];  // Temporarily stores client IP during request processing
+    HttpCache cache_;
+    AssetManifest assets_;
+    AssetCache asset_cache_;
 
     /**
      * Load provisioning state from NVS
@@ -915,6 +1099,7 @@ private:
         config.httpd.max_uri_handlers = 50;  // Increased for OTA endpoints
         config.httpd.stack_size = 12288;  // 12KB for OTA setup
         config.httpd.lru_purge_enable = true;
+        config.httpd.max_open_sockets = MAX_OPEN_SOCKETS;
         config.httpd.uri_match_fn = httpd_uri_match_wildcard;
 
         // Use generated certificate
@@ -943,6 +1128,8 @@ private:
                     },
                     this
                 );
+                ws_manager_->set_safety_controller(safety_);
+                if (config_) ws_manager_->set_update_interval(config_->display.update_interval_ms);
                 ESP_LOGI("HTTP", "WebSocket manager initialized");
             } else {
                 ESP_LOGW("HTTP", "WebSocket manager initialization failed");
@@ -1029,6 +1216,7 @@ public:
             size_t total = 0, used = 0;
             esp_spiffs_info(NULL, &total, &used);
             ESP_LOGI("HTTP", "SPIFFS mounted: %d/%d bytes used", used, total);
+            load_assets();
         }
 
         // Start HTTP server on port 80 immediately
@@ -1038,6 +1226,7 @@ public:
         config.max_uri_handlers = 50;  // Increased for OTA endpoints
         config.stack_size = 12288;  // 12KB for OTA setup
         config.lru_purge_enable = true;
+        config.max_open_sockets = MAX_OPEN_SOCKETS;
         config.uri_match_fn = httpd_uri_match_wildcard;
 
         esp_err_t ret = httpd_start(&http_redirect_server_, &config);
@@ -1138,6 +1327,7 @@ public:
         httpd_uri_t api_network_history = { .uri = "/api/network/history", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
         httpd_uri_t api_wifi_summary = { .uri = "/api/wifi/summary", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
         httpd_uri_t api_dashboard = { .uri = "/api/dashboard", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
+        httpd_uri_t api_state = { .uri = "/api/state", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
         httpd_uri_t api_reboot = { .uri = "/api/reboot", .method = HTTP_POST, .handler = api_handler, .user_ctx = this };
 
 #ifdef OTA_ENABLED
@@ -1158,6 +1348,7 @@ public:
         httpd_uri_t api_pid_get = { .uri = "/api/pid/*", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
         httpd_uri_t api_pid_set = { .uri = "/api/pid/*", .method = HTTP_POST, .handler = api_handler, .user_ctx = this };
         httpd_uri_t api_sensor_get = { .uri = "/api/sensor/*", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
+        httpd_uri_t api_history_sensor = { .uri = "/api/history/sensor/*", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
         httpd_uri_t api_sensor_config = { .uri = "/api/sensor/*/config", .method = HTTP_POST, .handler = api_handler, .user_ctx = this };
 
         // Register API handlers first (more specific)
@@ -1185,6 +1376,7 @@ public:
         httpd_register_uri_handler(server, &api_network_history);
         httpd_register_uri_handler(server, &api_wifi_summary);
         httpd_register_uri_handler(server, &api_dashboard);
+        httpd_register_uri_handler(server, &api_state);
         httpd_register_uri_handler(server, &api_reboot);
 #ifdef OTA_ENABLED
         httpd_register_uri_handler(server, &api_firmware_info);
@@ -1201,6 +1393,7 @@ public:
         httpd_register_uri_handler(server, &api_pid_get);
         httpd_register_uri_handler(server, &api_pid_set);
         httpd_register_uri_handler(server, &api_sensor_get);
+        httpd_register_uri_handler(server, &api_history_sensor);
         httpd_register_uri_handler(server, &api_sensor_config);
 
         // Static handlers last
@@ -1267,6 +1460,7 @@ public:
         httpd_uri_t api_network_history = { .uri = "/api/network/history", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
         httpd_uri_t api_wifi_summary = { .uri = "/api/wifi/summary", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
         httpd_uri_t api_dashboard = { .uri = "/api/dashboard", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
+        httpd_uri_t api_state = { .uri = "/api/state", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
         httpd_uri_t api_reboot = { .uri = "/api/reboot", .method = HTTP_POST, .handler = api_handler, .user_ctx = this };
 
         // Wildcard handlers for dynamic paths
@@ -1277,6 +1471,7 @@ public:
         httpd_uri_t api_pid_get = { .uri = "/api/pid/*", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
         httpd_uri_t api_pid_set = { .uri = "/api/pid/*", .method = HTTP_POST, .handler = api_handler, .user_ctx = this };
         httpd_uri_t api_sensor_get = { .uri = "/api/sensor/*", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
+        httpd_uri_t api_history_sensor = { .uri = "/api/history/sensor/*", .method = HTTP_GET, .handler = api_handler, .user_ctx = this };
         httpd_uri_t api_sensor_config = { .uri = "/api/sensor/*/config", .method = HTTP_POST, .handler = api_handler, .user_ctx = this };
 
         // Register in order (specific first, then wildcards)
@@ -1304,6 +1499,7 @@ public:
         httpd_register_uri_handler(server_, &api_network_history);
         httpd_register_uri_handler(server_, &api_wifi_summary);
         httpd_register_uri_handler(server_, &api_dashboard);
+        httpd_register_uri_handler(server_, &api_state);
         httpd_register_uri_handler(server_, &api_reboot);
         httpd_register_uri_handler(server_, &api_relay_set);
         httpd_register_uri_handler(server_, &api_output_set);
@@ -1312,6 +1508,7 @@ public:
         httpd_register_uri_handler(server_, &api_pid_get);
         httpd_register_uri_handler(server_, &api_pid_set);
         httpd_register_uri_handler(server_, &api_sensor_get);
+        httpd_register_uri_handler(server_, &api_history_sensor);
         httpd_register_uri_handler(server_, &api_sensor_config);
 
         // Static file handlers (register last so API routes take priority)
@@ -1321,6 +1518,59 @@ public:
         httpd_register_uri_handler(server_, &static_handler);
     }
 
+    static const char* status_line(int status) {
+        switch (status) {
+            case 200: return "200 OK";
+            case 400: return "400 Bad Request";
+            case 401: return "401 Unauthorized";
+            case 403: return "403 Forbidden";
+            case 404: return "404 Not Found";
+            case 429: return "429 Too Many Requests";
+            case 503: return "503 Service Unavailable";
+            default:  return "500 Internal Server Error";
+        }
+    }
+
+    static void set_json_headers(httpd_req_t* req, int status) {
+        httpd_resp_set_type(req, "application/json");
+        // CORS: No wildcard - same-origin policy by default
+        // Only allow requests from the same origin for security
+        // If cross-origin access is needed, configure specific allowed origins
+        httpd_resp_set_status(req, status_line(status));
+    }
+
+    /**
+     * ETag plus no-cache, so clients revalidate every poll
+     * @param etag Current ETag; nothing is set for ""
+     */
+    static void set_etag_headers(httpd_req_t* req, const char* etag) {
+        if (!etag || etag[0] == '\0') return;
+        httpd_resp_set_hdr(req, "ETag", etag);
+        httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    }
+
+    /**
+     * JsonWriter sink that sends the response as HTTP chunks
+     * Headers go out with the first chunk; handlers only produce more than
+     * one chunk on success, so the status is 200 by then.
+     */
+    struct ChunkedJsonResponse {
+        httpd_req_t* req;
+        int status;
+        bool started;
+        const char* etag;   // Sent with the headers (nullptr: none)
+
+        static bool write(void* ctx, const char* data, size_t len) {
+            auto* self = static_cast<ChunkedJsonResponse*>(ctx);
+            if (!self->started) {
+                set_json_headers(self->req, self->status);
+                set_etag_headers(self->req, self->etag);
+                self->started = true;
+            }
+            return httpd_resp_send_chunk(self->req, data, len) == ESP_OK;
+        }
+    };
+
     /**
      * API request handler
      */
@@ -1375,24 +1625,52 @@ public:
             if (ret > 0) body[ret] = '\0';
         }
 
-        // Process request
-        char response[MAX_RESPONSE_SIZE];
-        int status = self->handle_request(method, req->uri, body, token, response, sizeof(response));
+        // /api/state, /api/dashboard: JSON or binary snapshot by Accept header
+        bool snapshot = false;
+        if (req->method == HTTP_GET && serves_snapshot(req->uri)) {
+            httpd_resp_set_hdr(req, "Vary", "Accept");
+            char accept[128] = {0};
+            snapshot = httpd_req_get_hdr_value_str(req, "Accept", accept, sizeof(accept)) == ESP_OK &&
+                       accepts_snapshot(accept);
+        }
+
+        // Conditional GET: an unchanged state answers 304 without building a body
+        char etag[HttpCache::ETAG_SIZE] = {0};
+        if (req->method == HTTP_GET) {
+            char if_none_match[128] = {0};
+            httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match));
+            if (self->check_not_modified(req->uri, token, if_none_match, etag, sizeof(etag),
+                                         snapshot ? "bin" : nullptr) == 304) {
+                httpd_resp_set_status(req, "304 Not Modified");
+                set_etag_headers(req, etag);
+                httpd_resp_send(req, nullptr, 0);
+                return ESP_OK;
+            }
+        }
 
-        // Set response headers
-        httpd_resp_set_type(req, "application/json");
-        // CORS: No wildcard - same-origin policy by default
-        // Only allow requests from the same origin for security
-        // If cross-origin access is needed, configure specific allowed origins
-        httpd_resp_set_status(req, status == 200 ? "200 OK" :
-                                   status == 400 ? "400 Bad Request" :
-                                   status == 401 ? "401 Unauthorized" :
-                                   status == 403 ? "403 Forbidden" :
-                                   status == 404 ? "404 Not Found" :
-                                   status == 429 ? "429 Too Many Requests" : "500 Internal Server Error");
-
-        // Send response
-        httpd_resp_send(req, response, strlen(response));
+        if (snapshot && self->provisioned_ && self->is_authenticated(token)) {
+            uint8_t buffer[SNAPSHOT_MAX_SIZE];
+            size_t len = self->build_state_snapshot(buffer, sizeof(buffer));
+            httpd_resp_set_type(req, SNAPSHOT_CONTENT_TYPE);
+            set_etag_headers(req, etag);
+            httpd_resp_send(req, (const char*)buffer, len);
+            return ESP_OK;
+        }
+
+        // Process request; output beyond one chunk is sent while it is built
+        ChunkedJsonResponse chunked = {req, 200, false, etag};
+        core::JsonWriter json(ChunkedJsonResponse::write, &chunked);
+        int status = self->handle_request(method, req->uri, body, token, json);
+
+        if (json.fits_in_chunk()) {
+            // Small response: single send with Content-Length and the real status
+            set_json_headers(req, status);
+            if (status == 200) set_etag_headers(req, etag);
+            httpd_resp_send(req, json.buffered(), json.buffered_size());
+        } else {
+            json.finish();
+            httpd_resp_send_chunk(req, nullptr, 0);
+        }
         return ESP_OK;
     }
 
@@ -1473,8 +1751,13 @@ public:
             }
         }
 
+        // Query string (?v=<hash>) is not part of the file path
+        char url[208];
+        size_t path_len = strcspn(req->uri, "?");
+        snprintf(url, sizeof(url), "%.*s", (int)path_len, req->uri);
+
         // Redirect root to /admin/
-        if (strcmp(req->uri, "/") == 0) {
+        if (strcmp(url, "/") == 0 || url[0] == '\0') {
             httpd_resp_set_status(req, "302 Found");
             httpd_resp_set_hdr(req, "Location", "/admin/");
             httpd_resp_send(req, NULL, 0);
@@ -1482,12 +1765,24 @@ public:
         }
 
         // Default to index.html for admin paths
-        if (strcmp(req->uri, "/admin") == 0 || strcmp(req->uri, "/admin/") == 0) {
-            snprintf(filepath, sizeof(filepath), "/spiffs/admin/index.html");
-        } else {
-            snprintf(filepath, sizeof(filepath), "/spiffs%.200s", req->uri);
+        if (strcmp(url, "/admin") == 0 || strcmp(url, "/admin/") == 0) {
+            snprintf(url, sizeof(url), "/admin/index.html");
         }
 
+        // Pipeline-built assets: precompressed, hashed, hot-cached
+        HttpServer* self = static_cast<HttpServer*>(req->user_ctx);
+        if (self && self->send_asset(req, url)) {
+            return ESP_OK;
+        }
+        char index_url[208];
+        snprintf(index_url, sizeof(index_url), "%.180s%sindex.html", url,
+                 url[strlen(url) - 1] == '/' ? "" : "/");  // url is non-empty
+        if (self && self->send_asset(req, index_url)) {
+            return ESP_OK;
+        }
+
+        snprintf(filepath, sizeof(filepath), "/spiffs%s", url);
+
         // Final validation: ensure path is within /spiffs
         if (!security::path_within_base(filepath, "/spiffs")) {
             ESP_LOGW("HTTP", "Path escaped base directory: %s", filepath);
@@ -1500,7 +1795,7 @@ public:
         if (!f) {
             // Try with index.html appended (also validate)
             char index_path[256];
-            snprintf(index_path, sizeof(index_path), "/spiffs%.180s/index.html", req->uri);
+            snprintf(index_path, sizeof(index_path), "/spiffs%s", index_url);
             if (security::path_within_base(index_path, "/spiffs")) {
                 f = fopen(index_path, "r");
                 if (f) {
@@ -1515,16 +1810,8 @@ public:
             return ESP_OK;
         }
 
-        // Determine content type
-        const char* content_type = "text/plain";
-        if (strstr(filepath, ".html")) content_type = "text/html";
-        else if (strstr(filepath, ".css")) content_type = "text/css";
-        else if (strstr(filepath, ".js")) content_type = "application/javascript";
-        else if (strstr(filepath, ".json")) content_type = "application/json";
-        else if (strstr(filepath, ".png")) content_type = "image/png";
-        else if (strstr(filepath, ".ico")) content_type = "image/x-icon";
-
-        httpd_resp_set_type(req, content_type);
+        httpd_resp_set_type(req, asset_content_type(filepath));
+        httpd_resp_set_hdr(req, "Cache-Control", ASSET_CACHE_REVALIDATE);
 
         // Stream file
         char chunk[1024];
@@ -1538,6 +1825,125 @@ public:
         return ESP_OK;
     }
 
+    /**
+     * Read the asset manifest written by scripts/build_assets.py
+     * The hot cache is only enabled with PSRAM; internal RAM is kept for TLS.
+     */
+    void load_assets() {
+        asset_cache_.clear();
+        assets_.clear();
+
+        char path[32];
+        snprintf(path, sizeof(path), "/spiffs%s", ASSET_MANIFEST_FILE);
+        FILE* f = fopen(path, "r");
+        if (!f) {
+            ESP_LOGW("HTTP", "No asset manifest - static files served uncompressed");
+            return;
+        }
+        size_t size = AssetManifest::MAX_ASSETS * 96;
+        char* text = static_cast<char*>(malloc(size));
+        if (text) {
+            size_t len = fread(text, 1, size - 1, f);
+            text[len] = '\0';
+            assets_.load(text);
+            free(text);
+        }
+        fclose(f);
+
+        size_t budget = asset_cache_budget(heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0);
+        asset_cache_.set_budget(budget);
+        ESP_LOGI("HTTP", "Asset manifest: %d assets, hot cache %u KB",
+                 assets_.count(), (unsigned)(budget / 1024));
+    }
+
+    /**
+     * Cache headers, plus type and encoding unless the answer is a 304
+     */
+    static void set_asset_headers(httpd_req_t* req, const AssetManifest::Entry& entry,
+                                  const AssetResponse& asset) {
+        if (asset.status == 200) {
+            httpd_resp_set_type(req, asset_content_type(entry.path));
+            if (asset.gzip) httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+        }
+        httpd_resp_set_hdr(req, "Cache-Control", asset.cache_control);
+        httpd_resp_set_hdr(req, "ETag", asset.etag);
+        if (entry.gz_size > 0) httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    }
+
+    /**
+     * Serve a manifest asset: 304, hot cache hit, or file read (cached
+     * when it fits the budget)
+     * @return false if the URL is not in the manifest
+     */
+    bool send_asset(httpd_req_t* req, const char* url) {
+        if (assets_.count() == 0) return false;
+
+        char query[64] = {0};
+        char accept_encoding[64] = {0};
+        char if_none_match[64] = {0};
+        httpd_req_get_url_query_str(req, query, sizeof(query));
+        httpd_req_get_hdr_value_str(req, "Accept-Encoding", accept_encoding, sizeof(accept_encoding));
+        httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match));
+
+        AssetResponse asset;
+        if (!resolve_asset(assets_, url, query, accept_encoding, if_none_match, asset)) {
+            return false;
+        }
+        const AssetManifest::Entry& entry = assets_.entry(asset.index);
+
+        if (asset.status == 304) {
+            httpd_resp_set_status(req, "304 Not Modified");
+            set_asset_headers(req, entry, asset);
+            httpd_resp_send(req, nullptr, 0);
+            return true;
+        }
+
+        uint16_t key = AssetCache::key(asset.index, asset.gzip);
+        size_t len = 0;
+        const uint8_t* cached = asset_cache_.acquire(key, len);
+        if (cached) {
+            set_asset_headers(req, entry, asset);
+            httpd_resp_send(req, (const char*)cached, len);
+            asset_cache_.release(cached);
+            return true;
+        }
+
+        // Not hot yet: read from SPIFFS, keeping the body if it fits
+        char filepath[AssetManifest::PATH_SIZE + 16];
+        snprintf(filepath, sizeof(filepath), "/spiffs%s", asset.file);
+        FILE* f = fopen(filepath, "r");
+        if (!f) {
+            ESP_LOGW("HTTP", "Asset in manifest but missing: %s", filepath);
+            send_styled_404(req);
+            return true;
+        }
+
+        uint8_t* body = asset_cache_.admits(asset.length) ? AssetCache::alloc(asset.length) : nullptr;
+        if (body && fread(body, 1, asset.length, f) == asset.length) {
+            fclose(f);
+            bool kept = asset_cache_.insert(key, body, asset.length);
+            set_asset_headers(req, entry, asset);
+            httpd_resp_send(req, (const char*)body, asset.length);
+            if (kept) asset_cache_.release(body);
+            else AssetCache::free_buffer(body);
+            return true;
+        }
+        if (body) {
+            AssetCache::free_buffer(body);
+            rewind(f);
+        }
+
+        set_asset_headers(req, entry, asset);
+        char chunk[1024];
+        size_t read_bytes;
+        while ((read_bytes = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+            httpd_resp_send_chunk(req, chunk, read_bytes);
+        }
+        httpd_resp_send_chunk(req, NULL, 0);
+        fclose(f);
+        return true;
+    }
+
     /**
      * HTTP to HTTPS redirect handler
      * Redirects all HTTP requests to HTTPS
@@ -1624,25 +2030,54 @@ public:
         }
     }
 
+    /**
+     * Write {"error":message} and pass the status through
+     */
+    static int json_error(core::JsonWriter& json, int status, const char* message) {
+        json.begin_object().field("error", message).end_object();
+        return status;
+    }
+
+    /**
+     * Active alarms as a JSON array (shared by /api/alarms, dashboard, state)
+     */
+    void write_alarms(core::JsonWriter& json) {
+        json.begin_array();
+        if (safety_) {
+            for (uint8_t i = 1; i <= core::MAX_FERMENTERS; i++) {
+                auto* alarm = safety_->get_alarm_state(i);
+                if (alarm && (alarm->temp_high_alarm || alarm->temp_low_alarm ||
+                              alarm->pressure_high_alarm || alarm->sensor_failure_alarm)) {
+                    json.begin_object()
+                        .field("fermenter", i)
+                        .field("temp_high", alarm->temp_high_alarm)
+                        .field("temp_low", alarm->temp_low_alarm)
+                        .field("pressure_high", alarm->pressure_high_alarm)
+                        .field("sensor_failure", alarm->sensor_failure_alarm)
+                    .end_object();
+                }
+            }
+        }
+        json.end_array();
+    }
+
     /**
      * Handle first-boot password setup
      */
-    int handle_setup(const char* body, char* response, size_t response_size) {
+    int handle_setup(const char* body, core::JsonWriter& json) {
         // If already provisioned, reject (use factory_reset first)
         if (provisioned_) {
 #ifdef ESP32_BUILD
             ESP_LOGW(HTTP_LOG_TAG, "Setup rejected - already provisioned");
 #endif
-            snprintf(response, response_size,
-                "{\"error\":\"Device already provisioned. Use factory reset to change password.\"}");
-            return 400;
+            return json_error(json, 400,
+                "Device already provisioned. Use factory reset to change password.");
         }
 
         // Parse password from body
         char password[security::MAX_PASSWORD_LENGTH + 1];
         if (!parse_json_string(body, "password", password, sizeof(password))) {
-            snprintf(response, response_size, "{\"error\":\"Missing password field\"}");
-            return 400;
+            return json_error(json, 400, "Missing password field");
         }
 
         // Validate and set password
@@ -1650,11 +2085,18 @@ public:
 #ifdef ESP32_BUILD
             ESP_LOGW(HTTP_LOG_TAG, "Setup rejected - weak password");
 #endif
-            snprintf(response, response_size,
-                "{\"error\":\"Password does not meet requirements\","
-                "\"requirements\":{\"min_length\":%zu,\"categories\":2,"
-                "\"description\":\"At least %zu characters with 2 of: uppercase, lowercase, digit\"}}",
-                security::MIN_PASSWORD_LENGTH, security::MIN_PASSWORD_LENGTH);
+            char description[80];
+            snprintf(description, sizeof(description),
+                "At least %zu characters with 2 of: uppercase, lowercase, digit",
+                security::MIN_PASSWORD_LENGTH);
+            json.begin_object()
+                .field("error", "Password does not meet requirements")
+                .key("requirements").begin_object()
+                    .field("min_length", security::MIN_PASSWORD_LENGTH)
+                    .field("categories", 2)
+                    .field("description", description)
+                .end_object()
+            .end_object();
             return 400;
         }
 
@@ -1664,74 +2106,74 @@ public:
 #ifdef ESP32_BUILD
         ESP_LOGI(HTTP_LOG_TAG, "Device provisioned and logged in successfully");
 #endif
-        if (token) {
-            snprintf(response, response_size,
-                "{\"success\":true,\"message\":\"Device provisioned successfully\",\"token\":\"%s\"}", token);
-        } else {
-            // Fallback if login somehow fails (shouldn't happen)
-            snprintf(response, response_size,
-                "{\"success\":true,\"message\":\"Device provisioned successfully\"}");
-        }
+        json.begin_object()
+            .field("success", true)
+            .field("message", "Device provisioned successfully");
+        // Token is missing only if login somehow fails (shouldn't happen)
+        if (token) json.field("token", token);
+        json.end_object();
         return 200;
     }
 
-    int handle_login(const char* body, char* response, size_t response_size) {
+    int handle_login(const char* body, core::JsonWriter& json) {
         // Check rate limiting first
         if (is_rate_limited()) {
-            uint32_t remaining = get_lockout_remaining();
-            snprintf(response, response_size,
-                "{\"error\":\"Too many failed attempts\",\"retry_after\":%lu,\"locked\":true}",
-                (unsigned long)remaining);
+            json.begin_object()
+                .field("error", "Too many failed attempts")
+                .field("retry_after", (unsigned long)get_lockout_remaining())
+                .field("locked", true)
+            .end_object();
             return 429;  // Too Many Requests
         }
 
         // Check if device is provisioned
         if (!provisioned_) {
-            snprintf(response, response_size,
-                "{\"error\":\"Device not provisioned\",\"setup_required\":true}");
+            json.begin_object()
+                .field("error", "Device not provisioned")
+                .field("setup_required", true)
+            .end_object();
             return 403;
         }
 
         // Parse password from body
         char password[security::MAX_PASSWORD_LENGTH + 1];
         if (!parse_json_string(body, "password", password, sizeof(password))) {
-            snprintf(response, response_size, "{\"error\":\"Missing password field\"}");
-            return 400;
+            return json_error(json, 400, "Missing password field");
         }
 
         const char* token = login(password);
         if (token) {
-            snprintf(response, response_size, "{\"success\":true,\"token\":\"%s\"}", token);
+            json.begin_object().field("success", true).field("token", token).end_object();
             return 200;
         } else {
             // Check if we're now rate limited after this attempt
             if (is_rate_limited()) {
-                uint32_t remaining = get_lockout_remaining();
-                snprintf(response, response_size,
-                    "{\"error\":\"Invalid password\",\"retry_after\":%lu,\"locked\":true}",
-                    (unsigned long)remaining);
+                json.begin_object()
+                    .field("error", "Invalid password")
+                    .field("retry_after", (unsigned long)get_lockout_remaining())
+                    .field("locked", true)
+                .end_object();
                 return 429;
             }
-            snprintf(response, response_size,
-                "{\"error\":\"Invalid password\",\"attempts_remaining\":%d}",
-                MAX_LOGIN_ATTEMPTS - rate_limit_.failed_attempts);
+            json.begin_object()
+                .field("error", "Invalid password")
+                .field("attempts_remaining", MAX_LOGIN_ATTEMPTS - rate_limit_.failed_attempts)
+            .end_object();
             return 401;
         }
     }
 
-    int handle_password_change(const char* body, char* response, size_t response_size) {
+    int handle_password_change(const char* body, core::JsonWriter& json) {
         // Parse current and new passwords
         char current_password[security::MAX_PASSWORD_LENGTH + 1];
         char new_password[security::MAX_PASSWORD_LENGTH + 1];
 
         if (!parse_json_string(body, "current_password", current_password, sizeof(current_password))) {
-            snprintf(response, response_size, "{\"error\":\"Missing current_password field\"}");
-            return 400;
+            return json_error(json, 400, "Missing current_password field");
         }
 
         if (!parse_json_string(body, "new_password", new_password, sizeof(new_password))) {
-            snprintf(response, response_size, "{\"error\":\"Missing new_password field\"}");
-            return 400;
+            return json_error(json, 400, "Missing new_password field");
         }
 
         // Verify current password
@@ -1739,8 +2181,7 @@ public:
 #ifdef ESP32_BUILD
             ESP_LOGW(HTTP_LOG_TAG, "Password change failed - incorrect current password");
 #endif
-            snprintf(response, response_size, "{\"error\":\"Current password is incorrect\"}");
-            return 401;
+            return json_error(json, 401, "Current password is incorrect");
         }
 
         // Validate new password strength
@@ -1748,27 +2189,32 @@ public:
 #ifdef ESP32_BUILD
             ESP_LOGW(HTTP_LOG_TAG, "Password change failed - weak new password");
 #endif
-            snprintf(response, response_size,
-                "{\"error\":\"New password does not meet requirements\","
-                "\"requirements\":{\"min_length\":%zu,\"categories\":2}}",
-                security::MIN_PASSWORD_LENGTH);
+            json.begin_object()
+                .field("error", "New password does not meet requirements")
+                .key("requirements").begin_object()
+                    .field("min_length", security::MIN_PASSWORD_LENGTH)
+                    .field("categories", 2)
+                .end_object()
+            .end_object();
             return 400;
         }
 
         // Set new password
         if (!set_admin_password(new_password)) {
-            snprintf(response, response_size, "{\"error\":\"Failed to set new password\"}");
-            return 500;
+            return json_error(json, 500, "Failed to set new password");
         }
 
 #ifdef ESP32_BUILD
         ESP_LOGI(HTTP_LOG_TAG, "Password changed successfully");
 #endif
-        snprintf(response, response_size, "{\"success\":true,\"message\":\"Password changed successfully\"}");
+        json.begin_object()
+            .field("success", true)
+            .field("message", "Password changed successfully")
+        .end_object();
         return 200;
     }
 
-    int handle_factory_reset(char* response, size_t response_size) {
+    int handle_factory_reset(core::JsonWriter& json) {
 #ifdef ESP32_BUILD
         ESP_LOGW(HTTP_LOG_TAG, "Factory reset initiated");
 
@@ -1788,7 +2234,10 @@ public:
             nvs_close(wifi_nvs);
         }
 
-        snprintf(response, response_size, "{\"success\":true,\"message\":\"Factory reset complete. Rebooting...\"}");
+        json.begin_object()
+            .field("success", true)
+            .field("message", "Factory reset complete. Rebooting...")
+        .end_object();
 
         // Schedule reboot
         vTaskDelay(pdMS_TO_TICKS(500));
@@ -1797,7 +2246,10 @@ public:
         // Simulator - just clear provisioned flag
         provisioned_ = false;
         memset(admin_password_hash_, 0, sizeof(admin_password_hash_));
-        snprintf(response, response_size, "{\"success\":true,\"message\":\"Factory reset complete (simulator)\"}");
+        json.begin_object()
+            .field("success", true)
+            .field("message", "Factory reset complete (simulator)")
+        .end_object();
 #endif
         return 200;
     }
@@ -1843,103 +2295,135 @@ public:
         return true;
     }
 
-    int handle_get(const char* path, char* response, size_t response_size) {
-        if (strcmp(path, "/api/status") == 0) {
-            return api_status(response, response_size);
-        } else if (strcmp(path, "/api/sensors") == 0) {
-            return api_sensors(response, response_size);
-        } else if (strncmp(path, "/api/sensor/", 12) == 0) {
-            return api_sensor(path + 12, response, response_size);
-        } else if (strcmp(path, "/api/relays") == 0) {
-            return api_relays(response, response_size);
-        } else if (strcmp(path, "/api/fermenters") == 0) {
-            return api_fermenters(response, response_size);
-        } else if (strncmp(path, "/api/fermenter/", 15) == 0) {
-            return api_fermenter(path + 15, response, response_size);
-        } else if (strncmp(path, "/api/pid/", 9) == 0) {
-            return api_pid(path + 9, response, response_size);
-        } else if (strcmp(path, "/api/alarms") == 0) {
-            return api_alarms(response, response_size);
-        } else if (strcmp(path, "/api/modbus/stats") == 0) {
-            return api_modbus_stats(response, response_size);
-        } else if (strcmp(path, "/api/inputs") == 0) {
-            return api_inputs(response, response_size);
-        } else if (strcmp(path, "/api/outputs") == 0) {
-            return api_outputs(response, response_size);
-        } else if (strcmp(path, "/api/config") == 0) {
-            return api_config(response, response_size);
-        } else if (strcmp(path, "/api/modules") == 0) {
-            return api_modules(response, response_size);
-        }
+    /**
+     * Dispatch an authenticated route
+     */
+    int handle_route(ApiRoute route, const RouteMatch& match, const char* body,
+                     core::JsonWriter& json) {
+        char name[core::MAX_NAME_LENGTH];
+        uint32_t id = match.get_int(0);
+
+        switch (route) {
+            case ApiRoute::LOGOUT:
+                logout();
+                json.begin_object().field("success", true).end_object();
+                return 200;
+            case ApiRoute::PASSWORD:        return handle_password_change(body, json);
+            case ApiRoute::FACTORY_RESET:   return handle_factory_reset(json);
+
+            case ApiRoute::STATUS:          return api_status(json);
+            case ApiRoute::SENSORS:         return api_sensors(json);
+            case ApiRoute::SENSOR:
+                if (!match.get_str(0, name, sizeof(name))) {
+                    return json_error(json, 404, "Sensor not found");
+                }
+                return api_sensor(name, json);
+            case ApiRoute::RELAYS:          return api_relays(json);
+            case ApiRoute::RELAY_SET:
+                if (!match.get_str(0, name, sizeof(name))) {
+                    return json_error(json, 404, "Relay not found");
+                }
+                return api_relay_set(name, body, json);
+            case ApiRoute::FERMENTERS:      return api_fermenters(json);
+            case ApiRoute::FERMENTER:       return api_fermenter(id, json);
+            case ApiRoute::FERMENTER_SET:   return api_fermenter_set(id, body, json);
+            case ApiRoute::PID:             return api_pid(id, json);
+            case ApiRoute::PID_SET:         return api_pid_set(id, body, json);
+            case ApiRoute::OUTPUT_SET:      return api_output_set(id, body, json);
+            case ApiRoute::ALARMS:          return api_alarms(json);
+            case ApiRoute::MODBUS_STATS:    return api_modbus_stats(json);
+            case ApiRoute::INPUTS:          return api_inputs(json);
+            case ApiRoute::OUTPUTS:         return api_outputs(json);
+            case ApiRoute::CONFIG:          return api_config(json);
+            case ApiRoute::MODULES:         return api_modules(json);
+            case ApiRoute::CPU_HISTORY:     return api_cpu_history(json);
+            case ApiRoute::NETWORK_HISTORY: return api_network_history(json);
+            case ApiRoute::SENSOR_HISTORY:
+                if (!match.get_str(0, name, sizeof(name))) {
+                    return json_error(json, 404, "Sensor not found");
+                }
+                return api_sensor_history(name, match.query, json);
+            case ApiRoute::WIFI_SUMMARY:    return api_wifi_summary(json);
+            case ApiRoute::DASHBOARD:       return api_dashboard(json);
+            case ApiRoute::STATE:
+                // JSON form; api_handler serves the binary snapshot on request
+                build_state_json(json);
+                return 200;
+            case ApiRoute::REBOOT:          return api_reboot(json);
 #ifdef WIFI_NTP_ENABLED
-        else if (strcmp(path, "/api/wifi") == 0) {
-            return api_wifi_status(response, response_size);
-        }
+            case ApiRoute::WIFI:            return api_wifi_status(json);
 #endif
 #ifdef CAN_ENABLED
-        else if (strcmp(path, "/api/can/status") == 0) {
-            return api_can_status(response, response_size);
-        }
+            case ApiRoute::CAN_STATUS:      return api_can_status(json);
 #endif
 #ifdef OTA_ENABLED
-        else if (strcmp(path, "/api/firmware/info") == 0) {
-            return api_firmware_info(response, response_size);
-        }
-        else if (strcmp(path, "/api/firmware/status") == 0) {
-            return api_firmware_status(response, response_size);
-        }
+            case ApiRoute::FIRMWARE_INFO:     return api_firmware_info(json);
+            case ApiRoute::FIRMWARE_STATUS:   return api_firmware_status(json);
+            case ApiRoute::FIRMWARE_DOWNLOAD: return api_firmware_download(body, json);
+            case ApiRoute::FIRMWARE_CONFIRM:  return api_firmware_confirm(json);
+            case ApiRoute::FIRMWARE_ROLLBACK: return api_firmware_rollback(json);
 #endif
-        else if (strcmp(path, "/api/cpu/history") == 0) {
-            return api_cpu_history(response, response_size);
-        }
-        else if (strcmp(path, "/api/network/history") == 0) {
-            return api_network_history(response, response_size);
-        }
-        else if (strcmp(path, "/api/wifi/summary") == 0) {
-            return api_wifi_summary(response, response_size);
-        }
-        else if (strcmp(path, "/api/dashboard") == 0) {
-            return api_dashboard(response, response_size);
+            default:
+                break;
         }
 
-        snprintf(response, response_size, "{\"error\":\"Not found\"}");
-        return 404;
+        return json_error(json, 404, "Not found");
     }
 
-    int handle_post(const char* path, const char* body, char* response, size_t response_size) {
-        if (strncmp(path, "/api/relay/", 11) == 0) {
-            return api_relay_set(path + 11, body, response, response_size);
-        } else if (strncmp(path, "/api/fermenter/", 15) == 0) {
-            return api_fermenter_set(path + 15, body, response, response_size);
-        } else if (strncmp(path, "/api/pid/", 9) == 0) {
-            return api_pid_set(path + 9, body, response, response_size);
-        } else if (strncmp(path, "/api/output/", 12) == 0) {
-            return api_output_set(path + 12, body, response, response_size);
-        } else if (strcmp(path, "/api/reboot") == 0) {
-            return api_reboot(response, response_size);
+    /**
+     * Hash of the dashboard values read live from hardware rather than
+     * StateManager (GPIO, network, CAN), for its ETag
+     */
+    uint32_t peripheral_fingerprint() {
+        uint32_t h = HttpCache::FNV_OFFSET;
+        if (gpio_) {
+            uint16_t bits = 0;
+            for (uint8_t i = 0; i < 8; i++) {
+                if (gpio_->get_digital_input(i)) bits |= 1u << i;
+                if (gpio_->get_relay_state(i)) bits |= 0x100u << i;
+            }
+            h = HttpCache::fnv1a(h, &bits, sizeof(bits));
         }
-#ifdef OTA_ENABLED
-        // OTA firmware POST endpoints
-        else if (strcmp(path, "/api/firmware/download") == 0) {
-            return api_firmware_download(body, response, response_size);
-        } else if (strcmp(path, "/api/firmware/confirm") == 0) {
-            return api_firmware_confirm(response, response_size);
-        } else if (strcmp(path, "/api/firmware/rollback") == 0) {
-            return api_firmware_rollback(response, response_size);
+#ifdef WIFI_NTP_ENABLED
+        if (wifi_prov_) {
+            uint8_t flags = (wifi_prov_->is_connected() ? 1 : 0) | (wifi_prov_->is_standby() ? 2 : 0);
+            int rssi = wifi_prov_->get_rssi();
+            h = HttpCache::fnv1a(h, &flags, sizeof(flags));
+            h = HttpCache::fnv1a(h, &rssi, sizeof(rssi));
+            const char* ip = wifi_prov_->get_ip_address();
+            if (ip) h = HttpCache::fnv1a(h, ip, strlen(ip));
         }
 #endif
-
-        snprintf(response, response_size, "{\"error\":\"Not found\"}");
-        return 404;
+#ifdef ETHERNET_ENABLED
+        if (ethernet_) {
+            auto* eth = static_cast<hal::esp32::ESP32Ethernet*>(ethernet_);
+            bool connected = eth->is_connected();
+            h = HttpCache::fnv1a(h, &connected, sizeof(connected));
+            h = HttpCache::fnv1a(h, eth->get_info().ip_address, strlen(eth->get_info().ip_address));
+        }
+#endif
+#ifdef CAN_ENABLED
+        if (can_module_) {
+            auto stats = static_cast<CANModule*>(can_module_)->get_stats();
+            uint32_t counts[3] = {stats.tx_count, stats.rx_count, stats.error_count};
+            h = HttpCache::fnv1a(h, counts, sizeof(counts));
+            h = HttpCache::fnv1a(h, &stats.bus_ok, sizeof(stats.bus_ok));
+        }
+#endif
+        return h;
     }
 
-    // API Handlers
-    int api_status(char* response, size_t response_size) {
+    // Sections shared by the single endpoints and the dashboard
+
+    void write_status(core::JsonWriter& json) {
         auto& sys = state_->get_system_state();
 
         uint32_t uptime_h = sys.uptime_seconds / 3600;
         uint32_t uptime_m = (sys.uptime_seconds % 3600) / 60;
         uint32_t uptime_s = sys.uptime_seconds % 60;
+        char uptime[32];
+        snprintf(uptime, sizeof(uptime), "%luh %lum %lus",
+                 (unsigned long)uptime_h, (unsigned long)uptime_m, (unsigned long)uptime_s);
 
         // Build number from compile date
         const char* build_date = __DATE__;  // "Nov 24 2025"
@@ -1984,90 +2468,171 @@ public:
                  mac[3], mac[4], mac[5]);
 #endif
 
-        snprintf(response, response_size,
-            "{\"version\":\"%s\",\"build\":\"%s\",\"built\":\"%s %s\","
-            "\"hostname\":\"%s\","
-            "\"uptime\":\"%luh %lum %lus\",\"uptime_seconds\":%lu,"
-            "\"free_heap\":%lu,\"cpu_usage\":%.1f,\"cpu_freq_mhz\":%lu,\"cpu_freq_max_mhz\":%lu,"
-            "\"wifi_rssi\":%d,\"ntp_synced\":%s,"
-            "\"sensor_count\":%d,\"fermenter_count\":%d,"
-            "\"modbus_transactions\":%lu,\"modbus_errors\":%lu,"
-            "\"system_time\":\"%s\",\"timezone\":\"%s\","
-            "\"flash_used\":%lu,\"flash_total\":%lu}",
-            FIRMWARE_VERSION, build_num, __DATE__, __TIME__,
-            hostname,
-            (unsigned long)uptime_h, (unsigned long)uptime_m, (unsigned long)uptime_s,
-            (unsigned long)sys.uptime_seconds,
-            (unsigned long)sys.free_heap, sys.cpu_usage,
-            (unsigned long)sys.cpu_freq_mhz, (unsigned long)sys.cpu_freq_max_mhz,
-            sys.wifi_rssi,
-            sys.ntp_synced ? "true" : "false",
-            state_->get_sensor_count(), state_->get_fermenter_count(),
-            (unsigned long)sys.modbus_transactions, (unsigned long)sys.modbus_errors,
-            time_str, timezone_str,
-            (unsigned long)flash_used, (unsigned long)flash_total);
+        json.begin_object()
+            .field("version", FIRMWARE_VERSION)
+            .field("build", build_num)
+            .field("built", __DATE__ " " __TIME__)
+            .field("hostname", hostname)
+            .field("uptime", uptime)
+            .field("uptime_seconds", (unsigned long)sys.uptime_seconds)
+            .field("free_heap", (unsigned long)sys.free_heap)
+            .field("cpu_usage", sys.cpu_usage, 1)
+            .field("cpu_freq_mhz", (unsigned long)sys.cpu_freq_mhz)
+            .field("cpu_freq_max_mhz", (unsigned long)sys.cpu_freq_max_mhz)
+            .field("wifi_rssi", sys.wifi_rssi)
+            .field("ntp_synced", sys.ntp_synced)
+            .field("sensor_count", state_->get_sensor_count())
+            .field("fermenter_count", state_->get_fermenter_count())
+            .field("modbus_transactions", (unsigned long)sys.modbus_transactions)
+            .field("modbus_errors", (unsigned long)sys.modbus_errors)
+            .field("system_time", time_str)
+            .field("timezone", timezone_str)
+            .field("flash_used", (unsigned long)flash_used)
+            .field("flash_total", (unsigned long)flash_total)
+        .end_object();
+    }
+
+    void write_sensors(core::JsonWriter& json) {
+        json.begin_array();
+        uint8_t count = state_->get_sensor_count();
+        for (uint8_t i = 0; i < count; i++) {
+            auto* sensor = state_->get_sensor_by_id(i);
+            core::SensorSnapshot snap;
+            if (sensor && state_->read_sensor(i, snap)) {
+                json.begin_object()
+                    .field("name", sensor->name)
+                    .field("value", snap.filtered_value, 3)
+                    .field("unit", sensor->unit)
+                    .field("quality", quality_to_string(snap.quality))
+                .end_object();
+            }
+        }
+        json.end_array();
+    }
 
-        return 200;
+    void write_relays(core::JsonWriter& json, bool with_last_change) {
+        json.begin_array();
+        uint8_t count = state_->get_relay_count();
+        for (uint8_t i = 0; i < count; i++) {
+            auto* relay = state_->get_relay_by_id(i);
+            core::RelaySnapshot snap;
+            if (relay && state_->read_relay(i, snap)) {
+                json.begin_object()
+                    .field("name", relay->name)
+                    .field("state", snap.state);
+                if (with_last_change) {
+                    json.field("last_change", (unsigned long)snap.last_change);
+                }
+                json.end_object();
+            }
+        }
+        json.end_array();
     }
 
-    int api_sensors(char* response, size_t response_size) {
-        int offset = snprintf(response, response_size, "{\"sensors\":[");
+    void write_modbus_stats(core::JsonWriter& json) {
+        auto& sys = state_->get_system_state();
 
-        uint8_t count = state_->get_sensor_count();
-        for (uint8_t i = 0; i < count && offset < (int)response_size - 150; i++) {
-            auto* sensor = state_->get_sensor_by_id(i);
-            if (sensor) {
-                if (i > 0) offset += snprintf(response + offset, response_size - offset, ",");
-                offset += snprintf(response + offset, response_size - offset,
-                    "{\"name\":\"%s\",\"value\":%.3f,\"unit\":\"%s\",\"quality\":\"%s\"}",
-                    sensor->name, sensor->filtered_value, sensor->unit,
-                    quality_to_string(sensor->quality));
-            }
+        float error_rate = 0;
+        if (sys.modbus_transactions > 0) {
+            error_rate = 100.0f * sys.modbus_errors / sys.modbus_transactions;
         }
 
-        snprintf(response + offset, response_size - offset, "]}");
-        return 200;
+        json.begin_object()
+            .field("transactions", (unsigned long)sys.modbus_transactions)
+            .field("errors", (unsigned long)sys.modbus_errors)
+            .field("error_rate", error_rate, 2)
+        .end_object();
     }
 
-    int api_sensor(const char* name, char* response, size_t response_size) {
-        auto* sensor = state_->get_sensor(name);
-        if (!sensor) {
-            snprintf(response, response_size, "{\"error\":\"Sensor not found\"}");
-            return 404;
+    /**
+     * Digital inputs or relay outputs as [{"id":1,"state":...}, ...]
+     */
+    void write_gpio(core::JsonWriter& json, bool outputs) {
+        json.begin_array();
+        if (gpio_) {
+            for (uint8_t i = 0; i < 8; i++) {
+                bool state = outputs ? gpio_->get_relay_state(i) : gpio_->get_digital_input(i);
+                json.begin_object().field("id", i + 1).field("state", state).end_object();
+            }
         }
+        json.end_array();
+    }
 
-        snprintf(response, response_size,
-            "{\"name\":\"%s\",\"raw_value\":%.3f,\"filtered_value\":%.3f,"
-            "\"display_value\":%.3f,\"unit\":\"%s\",\"quality\":\"%s\","
-            "\"filter_type\":%d,\"alpha\":%.2f,\"scale\":%.6f,\"timestamp\":%lu}",
-            sensor->name, sensor->raw_value, sensor->filtered_value,
-            sensor->display_value, sensor->unit, quality_to_string(sensor->quality),
-            (int)sensor->filter_type, sensor->alpha, sensor->scale,
-            (unsigned long)sensor->timestamp);
+    void write_modules(core::JsonWriter& json) {
+        json.begin_object()
+#ifdef WIFI_NTP_ENABLED
+            .field("wifi", true).field("ntp", true)
+#else
+            .field("wifi", false).field("ntp", false)
+#endif
+#ifdef HTTP_ENABLED
+            .field("http", true)
+#else
+            .field("http", false)
+#endif
+#ifdef MQTT_ENABLED
+            .field("mqtt", true)
+#else
+            .field("mqtt", false)
+#endif
+#ifdef CAN_ENABLED
+            .field("can", true)
+#else
+            .field("can", false)
+#endif
+#ifdef DEBUG_CONSOLE_ENABLED
+            .field("debug_console", true)
+#else
+            .field("debug_console", false)
+#endif
+        .end_object();
+    }
 
+    // API Handlers
+    int api_status(core::JsonWriter& json) {
+        write_status(json);
         return 200;
     }
 
-    int api_relays(char* response, size_t response_size) {
-        int offset = snprintf(response, response_size, "{\"relays\":[");
+    int api_sensors(core::JsonWriter& json) {
+        json.begin_object().key("sensors");
+        write_sensors(json);
+        json.end_object();
+        return 200;
+    }
 
-        uint8_t count = state_->get_relay_count();
-        for (uint8_t i = 0; i < count && offset < (int)response_size - 100; i++) {
-            auto* relay = state_->get_relay_by_id(i);
-            if (relay) {
-                if (i > 0) offset += snprintf(response + offset, response_size - offset, ",");
-                offset += snprintf(response + offset, response_size - offset,
-                    "{\"name\":\"%s\",\"state\":%s,\"last_change\":%lu}",
-                    relay->name, relay->state ? "true" : "false",
-                    (unsigned long)relay->last_change);
-            }
+    int api_sensor(const char* name, core::JsonWriter& json) {
+        uint8_t sensor_id = state_->get_sensor_id(name);
+        auto* sensor = state_->get_sensor_by_id(sensor_id);
+        core::SensorSnapshot snap;
+        if (!sensor || !state_->read_sensor(sensor_id, snap)) {
+            return json_error(json, 404, "Sensor not found");
         }
 
-        snprintf(response + offset, response_size - offset, "]}");
+        json.begin_object()
+            .field("name", sensor->name)
+            .field("raw_value", snap.raw_value, 3)
+            .field("filtered_value", snap.filtered_value, 3)
+            .field("display_value", snap.display_value, 3)
+            .field("unit", sensor->unit)
+            .field("quality", quality_to_string(snap.quality))
+            .field("filter_type", (int)sensor->filter_type)
+            .field("alpha", sensor->alpha, 2)
+            .field("scale", sensor->scale, 6)
+            .field("timestamp", (unsigned long)snap.timestamp)
+        .end_object();
+
         return 200;
     }
 
-    int api_relay_set(const char* name, const char* body, char* response, size_t response_size) {
+    int api_relays(core::JsonWriter& json) {
+        json.begin_object().key("relays");
+        write_relays(json, true);
+        json.end_object();
+        return 200;
+    }
+
+    int api_relay_set(const char* name, const char* body, core::JsonWriter& json) {
         // Find relay
         uint8_t count = state_->get_relay_count();
         core::RelayState* relay = nullptr;
@@ -2083,8 +2648,7 @@ public:
         }
 
         if (!relay) {
-            snprintf(response, response_size, "{\"error\":\"Relay not found\"}");
-            return 404;
+            return json_error(json, 404, "Relay not found");
         }
 
         // Parse state from body
@@ -2093,63 +2657,72 @@ public:
 
         state_->set_relay_state(relay_id, new_state, time_->millis());
 
-        snprintf(response, response_size,
-            "{\"success\":true,\"relay\":\"%s\",\"state\":%s}",
-            name, new_state ? "true" : "false");
+        json.begin_object()
+            .field("success", true)
+            .field("relay", relay->name)
+            .field("state", new_state)
+        .end_object();
         return 200;
     }
 
-    int api_fermenters(char* response, size_t response_size) {
-        int offset = snprintf(response, response_size, "{\"fermenters\":[");
+    int api_fermenters(core::JsonWriter& json) {
+        json.begin_object().key("fermenters").begin_array();
 
-        bool first = true;
-        for (uint8_t i = 1; i <= core::MAX_FERMENTERS && offset < (int)response_size - 200; i++) {
+        for (uint8_t i = 1; i <= core::MAX_FERMENTERS; i++) {
             auto* ferm = state_->get_fermenter(i);
             if (ferm && ferm->id != 0) {
-                if (!first) offset += snprintf(response + offset, response_size - offset, ",");
-                first = false;
-                offset += snprintf(response + offset, response_size - offset,
-                    "{\"id\":%d,\"name\":\"%s\",\"temp\":%.2f,\"setpoint\":%.2f,"
-                    "\"pressure\":%.3f,\"mode\":\"%s\",\"pid_output\":%.1f}",
-                    i, ferm->name, ferm->current_temp, ferm->target_temp,
-                    ferm->current_pressure, mode_to_string(ferm->mode), ferm->pid_output);
+                json.begin_object()
+                    .field("id", i)
+                    .field("name", ferm->name)
+                    .field("temp", ferm->current_temp, 2)
+                    .field("setpoint", ferm->target_temp, 2)
+                    .field("pressure", ferm->current_pressure, 3)
+                    .field("mode", mode_to_string(ferm->mode))
+                    .field("pid_output", ferm->pid_output, 1)
+                .end_object();
             }
         }
 
-        snprintf(response + offset, response_size - offset, "]}");
+        json.end_array().end_object();
         return 200;
     }
 
-    int api_fermenter(const char* id_str, char* response, size_t response_size) {
-        uint8_t id = atoi(id_str);
-        auto* ferm = state_->get_fermenter(id);
-
-        if (!ferm || ferm->id == 0) {
-            snprintf(response, response_size, "{\"error\":\"Fermenter not found\"}");
-            return 404;
-        }
-
-        snprintf(response, response_size,
-            "{\"id\":%d,\"name\":\"%s\",\"temp\":%.2f,\"setpoint\":%.2f,"
-            "\"pressure\":%.3f,\"target_pressure\":%.3f,\"mode\":\"%s\","
-            "\"pid_output\":%.1f,\"plan_active\":%s,\"current_step\":%d,"
-            "\"hours_remaining\":%.1f}",
-            id, ferm->name, ferm->current_temp, ferm->target_temp,
-            ferm->current_pressure, ferm->target_pressure,
-            mode_to_string(ferm->mode), ferm->pid_output,
-            ferm->plan_active ? "true" : "false",
-            ferm->current_step, ferm->hours_remaining);
+    /**
+     * Configured fermenter for a route id, nullptr if none
+     */
+    core::FermenterState* find_fermenter(uint32_t id) {
+        if (id == 0 || id > UINT8_MAX) return nullptr;
+        auto* ferm = state_->get_fermenter((uint8_t)id);
+        return (ferm && ferm->id != 0) ? ferm : nullptr;
+    }
+
+    int api_fermenter(uint32_t id, core::JsonWriter& json) {
+        auto* ferm = find_fermenter(id);
+        if (!ferm) {
+            return json_error(json, 404, "Fermenter not found");
+        }
+
+        json.begin_object()
+            .field("id", id)
+            .field("name", ferm->name)
+            .field("temp", ferm->current_temp, 2)
+            .field("setpoint", ferm->target_temp, 2)
+            .field("pressure", ferm->current_pressure, 3)
+            .field("target_pressure", ferm->target_pressure, 3)
+            .field("mode", mode_to_string(ferm->mode))
+            .field("pid_output", ferm->pid_output, 1)
+            .field("plan_active", ferm->plan_active)
+            .field("current_step", ferm->current_step)
+            .field("hours_remaining", ferm->hours_remaining, 1)
+        .end_object();
 
         return 200;
     }
 
-    int api_fermenter_set(const char* id_str, const char* body, char* response, size_t response_size) {
-        uint8_t id = atoi(id_str);
-        auto* ferm = state_->get_fermenter(id);
-
-        if (!ferm || ferm->id == 0) {
-            snprintf(response, response_size, "{\"error\":\"Fermenter not found\"}");
-            return 404;
+    int api_fermenter_set(uint32_t id, const char* body, core::JsonWriter& json) {
+        auto* ferm = find_fermenter(id);
+        if (!ferm) {
+            return json_error(json, 404, "Fermenter not found");
         }
 
         // Parse setpoint
@@ -2172,40 +2745,42 @@ public:
                 ferm->mode = core::FermenterMode::PLAN;
             }
         }
+        state_->mark_changed(core::StateDomain::FERMENTERS);
 
-        snprintf(response, response_size,
-            "{\"success\":true,\"id\":%d,\"setpoint\":%.1f,\"mode\":\"%s\"}",
-            id, ferm->target_temp, mode_to_string(ferm->mode));
+        json.begin_object()
+            .field("success", true)
+            .field("id", id)
+            .field("setpoint", ferm->target_temp, 1)
+            .field("mode", mode_to_string(ferm->mode))
+        .end_object();
         return 200;
     }
 
-    int api_pid(const char* id_str, char* response, size_t response_size) {
-        uint8_t id = atoi(id_str);
-        auto* ferm = state_->get_fermenter(id);
-
-        if (!ferm || ferm->id == 0) {
-            snprintf(response, response_size, "{\"error\":\"Fermenter not found\"}");
-            return 404;
+    int api_pid(uint32_t id, core::JsonWriter& json) {
+        auto* ferm = find_fermenter(id);
+        if (!ferm) {
+            return json_error(json, 404, "Fermenter not found");
         }
 
-        snprintf(response, response_size,
-            "{\"fermenter_id\":%d,\"kp\":%.3f,\"ki\":%.3f,\"kd\":%.3f,"
-            "\"output\":%.1f,\"output_min\":%.0f,\"output_max\":%.0f,"
-            "\"integral\":%.3f,\"last_error\":%.3f}",
-            id, ferm->pid_params.kp, ferm->pid_params.ki, ferm->pid_params.kd,
-            ferm->pid_output, ferm->pid_params.output_min, ferm->pid_params.output_max,
-            ferm->pid_integral, ferm->pid_last_error);
+        json.begin_object()
+            .field("fermenter_id", id)
+            .field("kp", ferm->pid_params.kp, 3)
+            .field("ki", ferm->pid_params.ki, 3)
+            .field("kd", ferm->pid_params.kd, 3)
+            .field("output", ferm->pid_output, 1)
+            .field("output_min", ferm->pid_params.output_min, 0)
+            .field("output_max", ferm->pid_params.output_max, 0)
+            .field("integral", ferm->pid_integral, 3)
+            .field("last_error", ferm->pid_last_error, 3)
+        .end_object();
 
         return 200;
     }
 
-    int api_pid_set(const char* id_str, const char* body, char* response, size_t response_size) {
-        uint8_t id = atoi(id_str);
-        auto* ferm = state_->get_fermenter(id);
-
-        if (!ferm || ferm->id == 0) {
-            snprintf(response, response_size, "{\"error\":\"Fermenter not found\"}");
-            return 404;
+    int api_pid_set(uint32_t id, const char* body, core::JsonWriter& json) {
+        auto* ferm = find_fermenter(id);
+        if (!ferm) {
+            return json_error(json, 404, "Fermenter not found");
         }
 
         // Parse PID parameters
@@ -2225,100 +2800,51 @@ public:
             kd_str = strchr(kd_str, ':');
             if (kd_str) ferm->pid_params.kd = atof(kd_str + 1);
         }
+        state_->mark_changed(core::StateDomain::FERMENTERS);
 
-        snprintf(response, response_size,
-            "{\"success\":true,\"id\":%d,\"kp\":%.3f,\"ki\":%.3f,\"kd\":%.3f}",
-            id, ferm->pid_params.kp, ferm->pid_params.ki, ferm->pid_params.kd);
+        json.begin_object()
+            .field("success", true)
+            .field("id", id)
+            .field("kp", ferm->pid_params.kp, 3)
+            .field("ki", ferm->pid_params.ki, 3)
+            .field("kd", ferm->pid_params.kd, 3)
+        .end_object();
         return 200;
     }
 
-    int api_alarms(char* response, size_t response_size) {
-        int offset = snprintf(response, response_size, "{\"alarms\":[");
-
-        if (safety_) {
-            bool first = true;
-            for (uint8_t i = 1; i <= core::MAX_FERMENTERS && offset < (int)response_size - 150; i++) {
-                auto* alarm = safety_->get_alarm_state(i);
-                if (alarm && (alarm->temp_high_alarm || alarm->temp_low_alarm ||
-                              alarm->pressure_high_alarm || alarm->sensor_failure_alarm)) {
-                    if (!first) offset += snprintf(response + offset, response_size - offset, ",");
-                    first = false;
-                    offset += snprintf(response + offset, response_size - offset,
-                        "{\"fermenter\":%d,\"temp_high\":%s,\"temp_low\":%s,"
-                        "\"pressure_high\":%s,\"sensor_failure\":%s}",
-                        i, alarm->temp_high_alarm ? "true" : "false",
-                        alarm->temp_low_alarm ? "true" : "false",
-                        alarm->pressure_high_alarm ? "true" : "false",
-                        alarm->sensor_failure_alarm ? "true" : "false");
-                }
-            }
-        }
-
-        snprintf(response + offset, response_size - offset, "]}");
+    int api_alarms(core::JsonWriter& json) {
+        json.begin_object().key("alarms");
+        write_alarms(json);
+        json.end_object();
         return 200;
     }
 
-    int api_modbus_stats(char* response, size_t response_size) {
-        auto& sys = state_->get_system_state();
-
-        float error_rate = 0;
-        if (sys.modbus_transactions > 0) {
-            error_rate = 100.0f * sys.modbus_errors / sys.modbus_transactions;
-        }
-
-        snprintf(response, response_size,
-            "{\"transactions\":%lu,\"errors\":%lu,\"error_rate\":%.2f}",
-            (unsigned long)sys.modbus_transactions,
-            (unsigned long)sys.modbus_errors,
-            error_rate);
-
+    int api_modbus_stats(core::JsonWriter& json) {
+        write_modbus_stats(json);
         return 200;
     }
 
-    int api_inputs(char* response, size_t response_size) {
-        int offset = 0;
-        core::safe_snprintf_append(response, response_size, offset, "{\"inputs\":[");
-
-        if (gpio_) {
-            for (uint8_t i = 0; i < 8; i++) {
-                if (i > 0) core::safe_snprintf_append(response, response_size, offset, ",");
-                bool state = gpio_->get_digital_input(i);
-                core::safe_snprintf_append(response, response_size, offset,
-                    "{\"id\":%d,\"state\":%s}", i + 1, state ? "true" : "false");
-            }
-        }
-
-        core::safe_snprintf_append(response, response_size, offset, "]}");
+    int api_inputs(core::JsonWriter& json) {
+        json.begin_object().key("inputs");
+        write_gpio(json, false);
+        json.end_object();
         return 200;
     }
 
-    int api_outputs(char* response, size_t response_size) {
-        int offset = 0;
-        core::safe_snprintf_append(response, response_size, offset, "{\"outputs\":[");
-
-        if (gpio_) {
-            for (uint8_t i = 0; i < 8; i++) {
-                if (i > 0) core::safe_snprintf_append(response, response_size, offset, ",");
-                bool state = gpio_->get_relay_state(i);
-                core::safe_snprintf_append(response, response_size, offset,
-                    "{\"id\":%d,\"state\":%s}", i + 1, state ? "true" : "false");
-            }
-        }
-
-        core::safe_snprintf_append(response, response_size, offset, "]}");
+    int api_outputs(core::JsonWriter& json) {
+        json.begin_object().key("outputs");
+        write_gpio(json, true);
+        json.end_object();
         return 200;
     }
 
-    int api_output_set(const char* id_str, const char* body, char* response, size_t response_size) {
+    int api_output_set(uint32_t id, const char* body, core::JsonWriter& json) {
         if (!gpio_) {
-            snprintf(response, response_size, "{\"error\":\"GPIO not available\"}");
-            return 500;
+            return json_error(json, 500, "GPIO not available");
         }
 
-        uint8_t id = atoi(id_str);
         if (id < 1 || id > 8) {
-            snprintf(response, response_size, "{\"error\":\"Invalid output ID (1-8)\"}");
-            return 400;
+            return json_error(json, 400, "Invalid output ID (1-8)");
         }
 
         bool new_state = (strstr(body, "\"state\":true") != nullptr ||
@@ -2326,424 +2852,365 @@ public:
 
         gpio_->set_relay(id - 1, new_state);
 
-        snprintf(response, response_size,
-            "{\"success\":true,\"output\":%d,\"state\":%s}",
-            id, new_state ? "true" : "false");
+        json.begin_object()
+            .field("success", true)
+            .field("output", id)
+            .field("state", new_state)
+        .end_object();
         return 200;
     }
 
-    int api_config(char* response, size_t response_size) {
+    int api_config(core::JsonWriter& json) {
         if (!config_) {
-            snprintf(response, response_size, "{\"error\":\"Config not loaded\"}");
-            return 500;
-        }
-
-        snprintf(response, response_size,
-            "{\"fermenter_count\":%d,\"modbus_device_count\":%d,"
-            "\"gpio_relay_count\":%d,\"timing\":{"
-            "\"modbus_poll_ms\":%lu,\"pid_interval_ms\":%lu,"
-            "\"safety_check_ms\":%lu}}",
-            config_->fermenter_count,
-            config_->hardware.modbus_device_count,
-            config_->hardware.gpio_relay_count,
-            (unsigned long)config_->modbus_timing.poll_interval_ms,
-            (unsigned long)config_->pid_timing.calculation_interval_ms,
-            (unsigned long)config_->safety_timing.check_interval_ms);
+            return json_error(json, 500, "Config not loaded");
+        }
+
+        json.begin_object()
+            .field("fermenter_count", config_->fermenter_count)
+            .field("modbus_device_count", config_->hardware.modbus_device_count)
+            .field("gpio_relay_count", config_->hardware.gpio_relay_count)
+            .key("timing").begin_object()
+                .field("modbus_poll_ms", (unsigned long)config_->modbus_timing.poll_interval_ms)
+                .field("pid_interval_ms", (unsigned long)config_->pid_timing.calculation_interval_ms)
+                .field("safety_check_ms", (unsigned long)config_->safety_timing.check_interval_ms)
+            .end_object()
+        .end_object();
 
         return 200;
     }
 
-    int api_modules(char* response, size_t response_size) {
-        snprintf(response, response_size,
-            "{\"modules\":{"
-            "\"wifi\":%s,"
-            "\"ntp\":%s,"
-            "\"http\":%s,"
-            "\"mqtt\":%s,"
-            "\"can\":%s,"
-            "\"debug_console\":%s"
-            "}}",
-#ifdef WIFI_NTP_ENABLED
-            "true", "true",
-#else
-            "false", "false",
-#endif
-#ifdef HTTP_ENABLED
-            "true",
-#else
-            "false",
-#endif
-#ifdef MQTT_ENABLED
-            "true",
-#else
-            "false",
-#endif
-#ifdef CAN_ENABLED
-            "true",
-#else
-            "false",
-#endif
-#ifdef DEBUG_CONSOLE_ENABLED
-            "true"
-#else
-            "false"
-#endif
-        );
-
+    int api_modules(core::JsonWriter& json) {
+        json.begin_object().key("modules");
+        write_modules(json);
+        json.end_object();
         return 200;
     }
 
-    int api_cpu_history(char* response, size_t response_size) {
+    int api_cpu_history(core::JsonWriter& json) {
         const auto& history = state_->get_cpu_history();
         uint8_t count = history.get_sample_count();
 
-        // Build JSON array of samples
-        int offset = 0;
-        core::safe_snprintf_append(response, response_size, offset, "{\"samples\":[");
-
+        // JSON array of samples
+        json.begin_object().key("samples").begin_array();
         if (count > 0) {
             uint8_t samples[core::CpuHistory::MAX_SAMPLES];
             uint8_t actual_count = history.get_samples(samples);
-
             for (uint8_t i = 0; i < actual_count; i++) {
-                if (i > 0) {
-                    core::safe_snprintf_append(response, response_size, offset, ",");
-                }
-                core::safe_snprintf_append(response, response_size, offset, "%d", samples[i]);
+                json.value(samples[i]);
             }
         }
-
-        core::safe_snprintf_append(response, response_size, offset,
-            "],\"interval_sec\":%d,\"count\":%d}",
-            core::CpuHistory::SAMPLE_INTERVAL_MS / 1000,
-            count);
+        json.end_array()
+            .field("interval_sec", core::CpuHistory::SAMPLE_INTERVAL_MS / 1000)
+            .field("count", count)
+        .end_object();
 
         return 200;
     }
 
-    int api_network_history(char* response, size_t response_size) {
+    int api_network_history(core::JsonWriter& json) {
         const auto& history = state_->get_network_history();
         uint8_t count = history.get_sample_count();
 
-        // Build JSON array of samples (utilization %)
-        int offset = 0;
-        core::safe_snprintf_append(response, response_size, offset, "{\"samples\":[");
-
+        // JSON array of samples (utilization %)
+        json.begin_object().key("samples").begin_array();
         if (count > 0) {
             uint8_t samples[core::NetworkHistory::MAX_SAMPLES];
             uint8_t actual_count = history.get_samples(samples);
-
             for (uint8_t i = 0; i < actual_count; i++) {
-                if (i > 0) {
-                    core::safe_snprintf_append(response, response_size, offset, ",");
+                json.value(samples[i]);
+            }
+        }
+        json.end_array()
+            .field("interval_sec", core::NetworkHistory::SAMPLE_INTERVAL_MS / 1000)
+            .field("count", count)
+            .field("link_speed_mbps", (unsigned long)history.get_link_speed_mbps())
+            .field("channel", history.get_channel())
+        .end_object();
+
+        return 200;
+    }
+
+    /**
+     * Extract a parameter from a query string ("key=value&...")
+     * @param query Query after '?' (RouteMatch::query), may be nullptr
+     */
+    static bool get_query_param(const char* query, const char* key, char* value, size_t value_size) {
+        if (!query) return false;
+
+        size_t key_len = strlen(key);
+        const char* p = query;
+        while (*p) {
+            if (strncmp(p, key, key_len) == 0 && p[key_len] == '=') {
+                p += key_len + 1;
+                size_t len = strcspn(p, "&");
+                if (len >= value_size) len = value_size - 1;
+                memcpy(value, p, len);
+                value[len] = '\0';
+                return true;
+            }
+            p += strcspn(p, "&");
+            if (*p == '&') p++;
+        }
+        return false;
+    }
+
+    static constexpr uint16_t HISTORY_PAGE_SAMPLES = 256;
+
+    /**
+     * GET /api/history/sensor/<name|id>?tier=&from=&to=
+     * Times are seconds since boot. Without tier, the finest tier covering
+     * `from` is used. A response carries at most HISTORY_PAGE_SAMPLES and
+     * reports `next` so the client can continue the range. The page is
+     * copied under the state lock and serialized after releasing it, so a
+     * slow client never holds up the MODBUS writer.
+     */
+    int api_sensor_history(const char* name, const char* query, core::JsonWriter& json) {
+        uint8_t sensor_id = state_->get_sensor_id(name);
+        if (sensor_id == 0xFF && strspn(name, "0123456789") == strlen(name)) {
+            sensor_id = (uint8_t)atoi(name);
+        }
+        auto* sensor = state_->get_sensor_by_id(sensor_id);
+        if (!sensor) {
+            return json_error(json, 404, "Sensor not found");
+        }
+
+        float values[HISTORY_PAGE_SAMPLES];     // NaN = gap (written as null)
+        uint16_t count;
+        uint16_t written;
+        uint8_t tier;
+        uint32_t interval;
+        uint32_t start_s;
+        int decimals = 0;
+        {
+            auto guard = state_->scoped_lock();
+            if (!guard.acquired()) {
+                return json_error(json, 503, "State busy");
+            }
+
+            const auto& history = state_->get_sensor_history();
+            if (sensor_id >= history.get_sensor_count()) {
+                return json_error(json, 404, "No history for sensor");
+            }
+
+            char param[16];
+            uint32_t from_s = get_query_param(query, "from", param, sizeof(param)) ?
+                strtoul(param, nullptr, 10) : 0;
+            uint32_t to_s = get_query_param(query, "to", param, sizeof(param)) ?
+                strtoul(param, nullptr, 10) : UINT32_MAX;
+
+            if (get_query_param(query, "tier", param, sizeof(param))) {
+                tier = (uint8_t)atoi(param);
+                if (tier >= core::SensorHistory::TIER_COUNT) {
+                    return json_error(json, 400, "Invalid tier");
+                }
+            } else {
+                tier = history.select_tier(from_s);
+            }
+
+            uint16_t first;
+            count = history.find_range(tier, from_s, to_s, first);
+            interval = core::SensorHistory::TIER_INTERVAL_S[tier];
+            start_s = history.get_oldest_time(tier) + first * interval;
+
+            // Decimals matching the stored resolution (0.01 -> 2, 0.001 -> 3)
+            for (float r = history.get_resolution(sensor_id); r < 0.999f && decimals < 6; r *= 10.0f) {
+                decimals++;
+            }
+
+            written = count < HISTORY_PAGE_SAMPLES ? count : HISTORY_PAGE_SAMPLES;
+            for (uint16_t i = 0; i < written; i++) {
+                if (!history.get_value(sensor_id, tier, first + i, values[i])) {
+                    values[i] = NAN;
                 }
-                core::safe_snprintf_append(response, response_size, offset, "%d", samples[i]);
             }
         }
 
-        core::safe_snprintf_append(response, response_size, offset,
-            "],\"interval_sec\":%d,\"count\":%d,\"link_speed_mbps\":%lu,\"channel\":%d}",
-            core::NetworkHistory::SAMPLE_INTERVAL_MS / 1000,
-            count,
-            (unsigned long)history.get_link_speed_mbps(),
-            history.get_channel());
+        json.begin_object()
+            .field("sensor", sensor->name)
+            .field("unit", sensor->unit)
+            .field("tier", tier)
+            .field("interval_sec", (unsigned long)interval)
+            .field("start", (unsigned long)start_s)
+            .key("samples").begin_array();
+        for (uint16_t i = 0; i < written; i++) {
+            json.value(values[i], decimals);
+        }
+        json.end_array().field("count", written);
+        if (written < count) {
+            json.field("next", (unsigned long)(start_s + written * interval));
+        }
+        json.end_object();
 
         return 200;
     }
 
-    int api_wifi_summary(char* response, size_t response_size) {
+    int api_wifi_summary(core::JsonWriter& json) {
         const auto& history = state_->get_network_history();
 
 #ifdef WIFI_NTP_ENABLED
         if (wifi_prov_) {
-            snprintf(response, response_size,
-                "{\"connected\":%s,\"ssid\":\"%s\",\"link_speed_mbps\":%lu,"
-                "\"channel\":%d,\"tx_bytes\":%llu,\"rx_bytes\":%llu}",
-                wifi_prov_->is_connected() ? "true" : "false",
-                wifi_prov_->get_ssid() ? wifi_prov_->get_ssid() : "",
-                (unsigned long)history.get_link_speed_mbps(),
-                history.get_channel(),
-                (unsigned long long)history.get_total_tx_bytes(),
-                (unsigned long long)history.get_total_rx_bytes());
+            json.begin_object()
+                .field("connected", wifi_prov_->is_connected())
+                .field("ssid", wifi_prov_->get_ssid() ? wifi_prov_->get_ssid() : "")
+                .field("link_speed_mbps", (unsigned long)history.get_link_speed_mbps())
+                .field("channel", history.get_channel())
+                .field("tx_bytes", (unsigned long long)history.get_total_tx_bytes())
+                .field("rx_bytes", (unsigned long long)history.get_total_rx_bytes())
+            .end_object();
             return 200;
         }
 #endif
-        snprintf(response, response_size,
-            "{\"connected\":false,\"ssid\":\"\",\"link_speed_mbps\":0,"
-            "\"channel\":0,\"tx_bytes\":0,\"rx_bytes\":0}");
+        (void)history;
+        json.begin_object()
+            .field("connected", false)
+            .field("ssid", "")
+            .field("link_speed_mbps", 0)
+            .field("channel", 0)
+            .field("tx_bytes", 0)
+            .field("rx_bytes", 0)
+        .end_object();
         return 200;
     }
 
 #ifdef WIFI_NTP_ENABLED
-    int api_wifi_status(char* response, size_t response_size) {
+    int api_wifi_status(core::JsonWriter& json) {
         if (!wifi_prov_) {
-            snprintf(response, response_size, "{\"error\":\"WiFi not available\"}");
-            return 500;
+            return json_error(json, 500, "WiFi not available");
         }
 
-        snprintf(response, response_size,
-            "{\"connected\":%s,\"ip\":\"%s\",\"ssid\":\"%s\","
-            "\"state\":\"%s\",\"provisioning\":%s}",
-            wifi_prov_->is_connected() ? "true" : "false",
-            wifi_prov_->get_ip_address(),
-            wifi_prov_->get_ssid(),
-            wifi_prov_->get_state_string(),
-            wifi_prov_->is_provisioning() ? "true" : "false");
+        json.begin_object()
+            .field("connected", wifi_prov_->is_connected())
+            .field("ip", wifi_prov_->get_ip_address())
+            .field("ssid", wifi_prov_->get_ssid())
+            .field("state", wifi_prov_->get_state_string())
+            .field("provisioning", wifi_prov_->is_provisioning())
+        .end_object();
 
         return 200;
     }
 #endif
 
 #ifdef CAN_ENABLED
-    int api_can_status(char* response, size_t response_size) {
+    int api_can_status(core::JsonWriter& json) {
         if (!can_module_) {
-            snprintf(response, response_size, "{\"error\":\"CAN not available\"}");
-            return 500;
+            return json_error(json, 500, "CAN not available");
         }
 
         auto* can = static_cast<CANModule*>(can_module_);
         auto stats = can->get_stats();
 
-        snprintf(response, response_size,
-            "{\"tx\":%lu,\"rx\":%lu,\"errors\":%lu,\"state\":\"%s\",\"bitrate\":%lu}",
-            (unsigned long)stats.tx_count,
-            (unsigned long)stats.rx_count,
-            (unsigned long)stats.error_count,
-            stats.bus_ok ? "OK" : "ERROR",
-            (unsigned long)500000);
+        json.begin_object()
+            .field("tx", (unsigned long)stats.tx_count)
+            .field("rx", (unsigned long)stats.rx_count)
+            .field("errors", (unsigned long)stats.error_count)
+            .field("state", stats.bus_ok ? "OK" : "ERROR")
+            .field("bitrate", 500000UL)
+        .end_object();
 
         return 200;
     }
 #endif
 
-    int api_reboot(char* response, size_t response_size) {
-        snprintf(response, response_size, "{\"success\":true,\"message\":\"Rebooting...\"}");
+    int api_reboot(core::JsonWriter& json) {
+        json.begin_object().field("success", true).field("message", "Rebooting...").end_object();
         // Actual reboot should be triggered after response is sent
         return 200;
     }
 
     // Dashboard API - returns all data in a single request
-    int api_dashboard(char* response, size_t response_size) {
-        auto& sys = state_->get_system_state();
-        int offset = 0;
+    int api_dashboard(core::JsonWriter& json) {
+        json.begin_object();
 
-        // Start JSON
-        offset += snprintf(response + offset, response_size - offset, "{");
+        json.key("status");
+        write_status(json);
 
-        // Status section
-        uint32_t uptime_h = sys.uptime_seconds / 3600;
-        uint32_t uptime_m = (sys.uptime_seconds % 3600) / 60;
-        uint32_t uptime_s = sys.uptime_seconds % 60;
+        json.key("sensors");
+        write_sensors(json);
 
-        const char* build_date = __DATE__;
-        const char* months = "JanFebMarAprMayJunJulAugSepOctNovDec";
-        int month = 1;
-        for (int i = 0; i < 12; i++) {
-            if (strncmp(build_date, months + i * 3, 3) == 0) { month = i + 1; break; }
-        }
-        int day = atoi(build_date + 4);
-        int year = atoi(build_date + 7) % 100;
-        char build_num[8];
-        snprintf(build_num, sizeof(build_num), "%02d%02d%02d", year, month, day);
+        json.key("relays");
+        write_relays(json, false);
 
-        char time_str[32] = "N/A";
-        char timezone_str[16] = "UTC";
-        char hostname[32] = "fermenter";
-#ifdef ESP32_BUILD
-        if (sys.ntp_synced) {
-            time_t now; time(&now);
-            struct tm timeinfo; localtime_r(&now, &timeinfo);
-            strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &timeinfo);
-            strftime(timezone_str, sizeof(timezone_str), "%Z", &timeinfo);
-        }
-        uint8_t mac[6];
-        esp_wifi_get_mac(WIFI_IF_STA, mac);
-        snprintf(hostname, sizeof(hostname), "fermenter-%02X%02X%02X.local", mac[3], mac[4], mac[5]);
-#endif
-
-        offset += snprintf(response + offset, response_size - offset,
-            "\"status\":{\"version\":\"%s\",\"build\":\"%s\",\"built\":\"%s %s\","
-            "\"hostname\":\"%s\",\"uptime\":\"%luh %lum %lus\",\"uptime_seconds\":%lu,"
-            "\"free_heap\":%lu,\"cpu_usage\":%.1f,\"cpu_freq_mhz\":%lu,\"cpu_freq_max_mhz\":%lu,"
-            "\"wifi_rssi\":%d,\"ntp_synced\":%s,\"sensor_count\":%d,\"fermenter_count\":%d,"
-            "\"modbus_transactions\":%lu,\"modbus_errors\":%lu,"
-            "\"system_time\":\"%s\",\"timezone\":\"%s\",\"flash_used\":1015808,\"flash_total\":4194304},",
-            FIRMWARE_VERSION, build_num, __DATE__, __TIME__, hostname,
-            (unsigned long)uptime_h, (unsigned long)uptime_m, (unsigned long)uptime_s,
-            (unsigned long)sys.uptime_seconds, (unsigned long)sys.free_heap, sys.cpu_usage,
-            (unsigned long)sys.cpu_freq_mhz, (unsigned long)sys.cpu_freq_max_mhz,
-            sys.wifi_rssi, sys.ntp_synced ? "true" : "false",
-            state_->get_sensor_count(), state_->get_fermenter_count(),
-            (unsigned long)sys.modbus_transactions, (unsigned long)sys.modbus_errors,
-            time_str, timezone_str);
-
-        // Sensors section
-        offset += snprintf(response + offset, response_size - offset, "\"sensors\":[");
-        uint8_t sensor_count = state_->get_sensor_count();
-        for (uint8_t i = 0; i < sensor_count && offset < (int)response_size - 200; i++) {
-            auto* sensor = state_->get_sensor_by_id(i);
-            if (sensor) {
-                if (i > 0) offset += snprintf(response + offset, response_size - offset, ",");
-                offset += snprintf(response + offset, response_size - offset,
-                    "{\"name\":\"%s\",\"value\":%.3f,\"unit\":\"%s\",\"quality\":\"%s\"}",
-                    sensor->name, sensor->filtered_value, sensor->unit, quality_to_string(sensor->quality));
-            }
-        }
-        offset += snprintf(response + offset, response_size - offset, "],");
+        json.key("alarms");
+        write_alarms(json);
 
-        // Relays section
-        offset += snprintf(response + offset, response_size - offset, "\"relays\":[");
-        uint8_t relay_count = state_->get_relay_count();
-        for (uint8_t i = 0; i < relay_count && offset < (int)response_size - 100; i++) {
-            auto* relay = state_->get_relay_by_id(i);
-            if (relay) {
-                if (i > 0) offset += snprintf(response + offset, response_size - offset, ",");
-                offset += snprintf(response + offset, response_size - offset,
-                    "{\"name\":\"%s\",\"state\":%s}", relay->name, relay->state ? "true" : "false");
-            }
-        }
-        offset += snprintf(response + offset, response_size - offset, "],");
+        json.key("modbus");
+        write_modbus_stats(json);
 
-        // Alarms section
-        offset += snprintf(response + offset, response_size - offset, "\"alarms\":[");
-        if (safety_) {
-            bool first = true;
-            for (uint8_t i = 1; i <= core::MAX_FERMENTERS && offset < (int)response_size - 150; i++) {
-                auto* alarm = safety_->get_alarm_state(i);
-                if (alarm && (alarm->temp_high_alarm || alarm->temp_low_alarm ||
-                              alarm->pressure_high_alarm || alarm->sensor_failure_alarm)) {
-                    if (!first) offset += snprintf(response + offset, response_size - offset, ",");
-                    first = false;
-                    offset += snprintf(response + offset, response_size - offset,
-                        "{\"fermenter\":%d,\"temp_high\":%s,\"temp_low\":%s,\"pressure_high\":%s,\"sensor_failure\":%s}",
-                        i, alarm->temp_high_alarm ? "true" : "false", alarm->temp_low_alarm ? "true" : "false",
-                        alarm->pressure_high_alarm ? "true" : "false", alarm->sensor_failure_alarm ? "true" : "false");
-                }
-            }
-        }
-        offset += snprintf(response + offset, response_size - offset, "],");
-
-        // Modbus stats
-        float error_rate = sys.modbus_transactions > 0 ? 100.0f * sys.modbus_errors / sys.modbus_transactions : 0;
-        offset += snprintf(response + offset, response_size - offset,
-            "\"modbus\":{\"transactions\":%lu,\"errors\":%lu,\"error_rate\":%.2f},",
-            (unsigned long)sys.modbus_transactions, (unsigned long)sys.modbus_errors, error_rate);
-
-        // Inputs section
-        core::safe_snprintf_append(response, response_size, offset, "\"inputs\":[");
-        if (gpio_) {
-            for (uint8_t i = 0; i < 8; i++) {
-                if (i > 0) core::safe_snprintf_append(response, response_size, offset, ",");
-                core::safe_snprintf_append(response, response_size, offset,
-                    "{\"id\":%d,\"state\":%s}", i + 1, gpio_->get_digital_input(i) ? "true" : "false");
-            }
-        }
-        core::safe_snprintf_append(response, response_size, offset, "],");
+        json.key("inputs");
+        write_gpio(json, false);
 
-        // Outputs section
-        core::safe_snprintf_append(response, response_size, offset, "\"outputs\":[");
-        if (gpio_) {
-            for (uint8_t i = 0; i < 8; i++) {
-                if (i > 0) core::safe_snprintf_append(response, response_size, offset, ",");
-                core::safe_snprintf_append(response, response_size, offset,
-                    "{\"id\":%d,\"state\":%s}", i + 1, gpio_->get_relay_state(i) ? "true" : "false");
-            }
-        }
-        core::safe_snprintf_append(response, response_size, offset, "],");
+        json.key("outputs");
+        write_gpio(json, true);
 
         // Config section
+        json.key("config").begin_object();
         if (config_) {
-            offset += snprintf(response + offset, response_size - offset,
-                "\"config\":{\"fermenter_count\":%d,\"modbus_device_count\":%d,\"gpio_relay_count\":%d},",
-                config_->fermenter_count, config_->hardware.modbus_device_count, config_->hardware.gpio_relay_count);
-        } else {
-            offset += snprintf(response + offset, response_size - offset, "\"config\":{},");
+            json.field("fermenter_count", config_->fermenter_count)
+                .field("modbus_device_count", config_->hardware.modbus_device_count)
+                .field("gpio_relay_count", config_->hardware.gpio_relay_count);
         }
+        json.end_object();
 
-        // Modules section
-        offset += snprintf(response + offset, response_size - offset,
-            "\"modules\":{\"wifi\":%s,\"ntp\":%s,\"http\":%s,\"mqtt\":%s,\"can\":%s,\"debug_console\":%s},",
-#ifdef WIFI_NTP_ENABLED
-            "true", "true",
-#else
-            "false", "false",
-#endif
-#ifdef HTTP_ENABLED
-            "true",
-#else
-            "false",
-#endif
-#ifdef MQTT_ENABLED
-            "true",
-#else
-            "false",
-#endif
-#ifdef CAN_ENABLED
-            "true",
-#else
-            "false",
-#endif
-#ifdef DEBUG_CONSOLE_ENABLED
-            "true"
-#else
-            "false"
-#endif
-        );
+        json.key("modules");
+        write_modules(json);
 
         // Network interfaces
-        offset += snprintf(response + offset, response_size - offset, "\"network\":{");
+        json.key("network").begin_object();
 #ifdef WIFI_NTP_ENABLED
+        json.key("wifi").begin_object();
         if (wifi_prov_) {
-            offset += snprintf(response + offset, response_size - offset,
-                "\"wifi\":{\"connected\":%s,\"standby\":%s,\"ip\":\"%s\",\"netmask\":\"%s\",\"gateway\":\"%s\",\"ssid\":\"%s\",\"rssi\":%d}",
-                wifi_prov_->is_connected() ? "true" : "false",
-                wifi_prov_->is_standby() ? "true" : "false",
-                wifi_prov_->get_ip_address() ? wifi_prov_->get_ip_address() : "",
-                wifi_prov_->get_netmask() ? wifi_prov_->get_netmask() : "",
-                wifi_prov_->get_gateway() ? wifi_prov_->get_gateway() : "",
-                wifi_prov_->get_ssid() ? wifi_prov_->get_ssid() : "",
-                wifi_prov_->get_rssi());
+            json.field("connected", wifi_prov_->is_connected())
+                .field("standby", wifi_prov_->is_standby())
+                .field("ip", wifi_prov_->get_ip_address() ? wifi_prov_->get_ip_address() : "")
+                .field("netmask", wifi_prov_->get_netmask() ? wifi_prov_->get_netmask() : "")
+                .field("gateway", wifi_prov_->get_gateway() ? wifi_prov_->get_gateway() : "")
+                .field("ssid", wifi_prov_->get_ssid() ? wifi_prov_->get_ssid() : "")
+                .field("rssi", wifi_prov_->get_rssi());
         } else {
-            offset += snprintf(response + offset, response_size - offset, "\"wifi\":{\"connected\":false,\"standby\":false}");
+            json.field("connected", false).field("standby", false);
         }
+        json.end_object();
 #else
-        offset += snprintf(response + offset, response_size - offset, "\"wifi\":{\"enabled\":false}");
+        json.key("wifi").begin_object().field("enabled", false).end_object();
 #endif
 #ifdef ETHERNET_ENABLED
+        json.key("ethernet").begin_object();
         if (ethernet_) {
             auto* eth = static_cast<hal::esp32::ESP32Ethernet*>(ethernet_);
             auto& info = eth->get_info();
-            offset += snprintf(response + offset, response_size - offset,
-                ",\"ethernet\":{\"connected\":%s,\"ip\":\"%s\",\"netmask\":\"%s\",\"gateway\":\"%s\",\"speed\":%d}",
-                eth->is_connected() ? "true" : "false",
-                info.ip_address, info.netmask, info.gateway, info.link_speed_mbps);
+            json.field("connected", eth->is_connected())
+                .field("ip", info.ip_address)
+                .field("netmask", info.netmask)
+                .field("gateway", info.gateway)
+                .field("speed", info.link_speed_mbps);
         } else {
-            offset += snprintf(response + offset, response_size - offset, ",\"ethernet\":{\"connected\":false}");
+            json.field("connected", false);
         }
+        json.end_object();
 #else
-        offset += snprintf(response + offset, response_size - offset, ",\"ethernet\":{\"enabled\":false}");
+        json.key("ethernet").begin_object().field("enabled", false).end_object();
 #endif
-        offset += snprintf(response + offset, response_size - offset, "},");
+        json.end_object();
 
         // CAN status
+        json.key("can").begin_object();
 #ifdef CAN_ENABLED
         if (can_module_) {
             auto* can = static_cast<CANModule*>(can_module_);
             auto stats = can->get_stats();
-            offset += snprintf(response + offset, response_size - offset,
-                "\"can\":{\"tx\":%lu,\"rx\":%lu,\"errors\":%lu,\"state\":\"%s\"}",
-                (unsigned long)stats.tx_count, (unsigned long)stats.rx_count,
-                (unsigned long)stats.error_count, stats.bus_ok ? "OK" : "ERROR");
+            json.field("tx", (unsigned long)stats.tx_count)
+                .field("rx", (unsigned long)stats.rx_count)
+                .field("errors", (unsigned long)stats.error_count)
+                .field("state", stats.bus_ok ? "OK" : "ERROR");
         } else {
-            offset += snprintf(response + offset, response_size - offset, "\"can\":{\"state\":\"OFFLINE\"}");
+            json.field("state", "OFFLINE");
         }
 #else
-        offset += snprintf(response + offset, response_size - offset, "\"can\":{\"state\":\"DISABLED\"}");
+        json.field("state", "DISABLED");
 #endif
+        json.end_object();
 
-        // Close JSON
-        offset += snprintf(response + offset, response_size - offset, "}");
-
+        json.end_object();
         return 200;
     }
 
@@ -2753,24 +3220,29 @@ public:
     /**
      * GET /api/firmware/info - Get partition and version info
      */
-    int api_firmware_info(char* response, size_t response_size) {
+    int api_firmware_info(core::JsonWriter& json) {
         if (!ota_manager_) {
-            snprintf(response, response_size, "{\"error\":\"OTA not available\"}");
-            return 500;
+            return json_error(json, 500, "OTA not available");
         }
 
         PartitionInfo running, other;
         ota_manager_->get_partition_info(running, other);
         bool needs_confirm = ota_manager_->needs_confirmation();
 
-        snprintf(response, response_size,
-            "{\"running\":{\"label\":\"%s\",\"version\":\"%s\",\"size\":%lu},"
-            "\"other\":{\"label\":\"%s\",\"version\":\"%s\",\"size\":%lu,\"valid\":%s},"
-            "\"needs_confirmation\":%s}",
-            running.label, running.app_version, (unsigned long)running.size,
-            other.label, other.app_version, (unsigned long)other.size,
-            other.is_valid ? "true" : "false",
-            needs_confirm ? "true" : "false");
+        json.begin_object()
+            .key("running").begin_object()
+                .field("label", running.label)
+                .field("version", running.app_version)
+                .field("size", (unsigned long)running.size)
+            .end_object()
+            .key("other").begin_object()
+                .field("label", other.label)
+                .field("version", other.app_version)
+                .field("size", (unsigned long)other.size)
+                .field("valid", other.is_valid)
+            .end_object()
+            .field("needs_confirmation", needs_confirm)
+        .end_object();
 
         return 200;
     }
@@ -2778,10 +3250,9 @@ public:
     /**
      * GET /api/firmware/status - Get OTA update progress
      */
-    int api_firmware_status(char* response, size_t response_size) {
+    int api_firmware_status(core::JsonWriter& json) {
         if (!ota_manager_) {
-            snprintf(response, response_size, "{\"error\":\"OTA not available\"}");
-            return 500;
+            return json_error(json, 500, "OTA not available");
         }
 
         OtaProgress progress = ota_manager_->get_progress();
@@ -2796,14 +3267,13 @@ public:
             case OtaState::FAILED: state_str = "failed"; break;
         }
 
-        snprintf(response, response_size,
-            "{\"state\":\"%s\",\"progress\":%d,"
-            "\"bytes_received\":%lu,\"bytes_total\":%lu,"
-            "\"message\":\"%s\"}",
-            state_str, progress.percent,
-            (unsigned long)progress.bytes_received,
-            (unsigned long)progress.bytes_total,
-            progress.status_message);
+        json.begin_object()
+            .field("state", state_str)
+            .field("progress", progress.percent)
+            .field("bytes_received", (unsigned long)progress.bytes_received)
+            .field("bytes_total", (unsigned long)progress.bytes_total)
+            .field("message", progress.status_message)
+        .end_object();
 
         return 200;
     }
@@ -2812,10 +3282,9 @@ public:
      * POST /api/firmware/download - Download firmware from URL
      * Body: {"url": "https://..."} or empty for default GitHub OTA branch
      */
-    int api_firmware_download(const char* body, char* response, size_t response_size) {
+    int api_firmware_download(const char* body, core::JsonWriter& json) {
         if (!ota_manager_) {
-            snprintf(response, response_size, "{\"error\":\"OTA not available\"}");
-            return 500;
+            return json_error(json, 500, "OTA not available");
         }
 
         // Parse URL from body (optional)
@@ -2839,10 +3308,10 @@ public:
 
         OtaResult result = ota_manager_->download_from_url(url);
 
-        snprintf(response, response_size,
-            "{\"success\":%s,\"message\":\"%s\"}",
-            result.success ? "true" : "false",
-            result.message);
+        json.begin_object()
+            .field("success", result.success)
+            .field("message", result.message)
+        .end_object();
 
         return result.success ? 200 : 500;
     }
@@ -2850,18 +3319,17 @@ public:
     /**
      * POST /api/firmware/confirm - Confirm firmware update (prevent rollback)
      */
-    int api_firmware_confirm(char* response, size_t response_size) {
+    int api_firmware_confirm(core::JsonWriter& json) {
         if (!ota_manager_) {
-            snprintf(response, response_size, "{\"error\":\"OTA not available\"}");
-            return 500;
+            return json_error(json, 500, "OTA not available");
         }
 
         OtaResult result = ota_manager_->confirm_update();
 
-        snprintf(response, response_size,
-            "{\"success\":%s,\"message\":\"%s\"}",
-            result.success ? "true" : "false",
-            result.message);
+        json.begin_object()
+            .field("success", result.success)
+            .field("message", result.message)
+        .end_object();
 
         return result.success ? 200 : 500;
     }
@@ -2869,19 +3337,18 @@ public:
     /**
      * POST /api/firmware/rollback - Rollback to previous firmware
      */
-    int api_firmware_rollback(char* response, size_t response_size) {
+    int api_firmware_rollback(core::JsonWriter& json) {
         if (!ota_manager_) {
-            snprintf(response, response_size, "{\"error\":\"OTA not available\"}");
-            return 500;
+            return json_error(json, 500, "OTA not available");
         }
 
         OtaResult result = ota_manager_->rollback();
 
         // Note: If rollback succeeds, device reboots and this response won't be sent
-        snprintf(response, response_size,
-            "{\"success\":%s,\"message\":\"%s\"}",
-            result.success ? "true" : "false",
-            result.message);
+        json.begin_object()
+            .field("success", result.success)
+            .field("message", result.message)
+        .end_object();
 
         return result.success ? 200 : 500;
     }
@@ -2971,12 +3438,14 @@ public:
         }
 
         // Send success response
-        char response[256];
-        snprintf(response, sizeof(response),
-            "{\"success\":true,\"message\":\"%s\"}", result.message);
-
-        httpd_resp_set_type(req, "application/json");
-        httpd_resp_send(req, response, strlen(response));
+        ChunkedJsonResponse chunked = {req, 200, false, nullptr};
+        core::JsonWriter json(ChunkedJsonResponse::write, &chunked);
+        json.begin_object()
+            .field("success", true)
+            .field("message", result.message)
+        .end_object();
+        set_json_headers(req, 200);
+        httpd_resp_send(req, json.buffered(), json.buffered_size());
 
         ESP_LOGI("OTA", "Firmware upload complete");
         return ESP_OK;
@@ -6,8 +6,10 @@
 #include "core/state_manager.h"
 #include "core/event_bus.h"
 #include "core/utils.h"
-#include "modules/filters.h"
-#include <memory>
+#include "modules/filter_bank.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
 
 namespace modules {
 
@@ -20,8 +22,60 @@ struct ScheduledTransaction {
     uint16_t start_reg;
     uint16_t count;
     bool is_bulk;               // True for bulk read, false for single
-    uint8_t sensor_ids[16];     // Sensor IDs for this transaction
+    bool is_extra;              // Priority extra sample (not a base read)
+    uint8_t sensor_ids[16];     // Sensor indices (MAX_TRANSACTION_SENSORS)
     uint8_t sensor_count;
+    uint32_t cost_us;           // Planned bus time (cost model)
+};
+
+/**
+ * Planned bus usage of the poll schedule, from the planner's cost model
+ */
+struct BusPlan {
+    uint32_t bus_us_per_cycle;  // Sum of planned transaction times
+    uint16_t registers_read;    // Registers transferred per cycle
+    uint16_t registers_used;    // Of those, registers mapped to sensors
+    uint8_t spans_per_sample;   // Bulk reads per base sample
+    uint8_t transactions;       // Transactions per cycle
+    float occupancy_pct;        // Bus time as % of base_cycle_ms
+    uint32_t max_gap_ms[4];     // Planned worst gap between samples, by SensorPriority
+
+    BusPlan()
+        : bus_us_per_cycle(0)
+        , registers_read(0)
+        , registers_used(0)
+        , spans_per_sample(0)
+        , transactions(0)
+        , occupancy_pct(0)
+        , max_gap_ms{0, 0, 0, 0} {}
+};
+
+/**
+ * Poll engine timing statistics
+ * Jitter is how late a transaction started relative to its scheduled slot.
+ * An overrun is a cycle that did not complete within base_cycle_ms.
+ */
+struct PollStats {
+    uint32_t cycles;            // Completed poll cycles
+    uint32_t overruns;          // Cycles that ran past base_cycle_ms
+    uint32_t transactions;      // Transactions executed
+    uint32_t last_jitter_ms;    // Worst lateness in the last completed cycle
+    uint32_t max_jitter_ms;     // Worst lateness since reset
+    uint32_t jitter_sum_ms;     // Sum of per-cycle worst lateness (for mean)
+    uint32_t last_cycle_ms;     // Duration of the last completed cycle
+    uint32_t max_call_ms;       // Longest time spent inside one poll call
+    uint32_t max_sample_gap_ms[4];  // Longest time between good samples, by SensorPriority
+
+    PollStats()
+        : cycles(0)
+        , overruns(0)
+        , transactions(0)
+        , last_jitter_ms(0)
+        , max_jitter_ms(0)
+        , jitter_sum_ms(0)
+        , last_cycle_ms(0)
+        , max_call_ms(0)
+        , max_sample_gap_ms{0, 0, 0, 0} {}
 };
 
 /**
@@ -49,7 +103,9 @@ struct ModbusSensorConfig {
 class ModbusModule {
 public:
     static constexpr uint8_t MAX_SENSORS = 32;
-    static constexpr uint8_t MAX_TRANSACTIONS = 64;
+    static constexpr uint8_t MAX_TRANSACTIONS = 128;
+    static constexpr uint16_t MAX_READ_REGISTERS = 125;    // MODBUS protocol limit
+    static constexpr uint8_t MAX_TRANSACTION_SENSORS = 16;
 
     ModbusModule(hal::IModbusInterface* modbus,
                  hal::ITimeInterface* time,
@@ -61,8 +117,18 @@ public:
         , events_(events)
         , sensor_count_(0)
         , transaction_count_(0)
+        , fill_idle_windows_(true)
+        , transaction_time_ms_(5)
+        , baudrate_(115200)
+        , filter_window_(5)
+        , span_count_(0)
         , cycle_start_time_(0)
-        , current_transaction_(0) {}
+        , next_cycle_time_(0)
+        , current_transaction_(0)
+        , cycle_started_(false)
+        , cycle_jitter_ms_(0) {
+        schedule_error_[0] = '\0';
+    }
 
     /**
      * Initialize module with configuration
@@ -71,14 +137,20 @@ public:
         // Clear existing config
         sensor_count_ = 0;
         transaction_count_ = 0;
+        filters_.clear();
 
         // Store timing config
         base_cycle_ms_ = config.scheduler.base_cycle_ms;
         base_samples_per_cycle_ = config.scheduler.base_samples_per_cycle;
         min_sample_spacing_ms_ = config.scheduler.min_sample_spacing_ms;
         bulk_read_enabled_ = config.scheduler.bulk_read_enabled;
+        fill_idle_windows_ = config.scheduler.fill_idle_windows;
+        transaction_time_ms_ = config.scheduler.transaction_time_ms;
+        baudrate_ = config.hardware.baudrate;
+        filter_window_ = config.sensor_timing.window_size;
 
         // Register sensors from MODBUS devices
+        const char* unfiltered = nullptr;
         for (uint8_t d = 0; d < config.hardware.modbus_device_count; d++) {
             const auto& device = config.hardware.modbus_devices[d];
 
@@ -103,28 +175,96 @@ public:
                 // Get sensor ID from state manager
                 sensor.sensor_id = state_->get_sensor_id(reg.name);
 
-                // Create filter for this sensor
-                create_filter(sensor_count_);
+                // Filter index matches the sensor index
+                if (!filters_.add(reg.filter, reg.filter_alpha, filter_window_) && !unfiltered) {
+                    unfiltered = reg.name;
+                }
 
                 sensor_count_++;
             }
         }
 
-        // Build poll schedule
-        build_schedule();
+        // Never fall back to unfiltered readings silently
+        if (unfiltered) {
+            return schedule_error("no room in the filter bank for '%s'", unfiltered);
+        }
 
-        return true;
+        // Build poll schedule (thins extras the bus cannot serve)
+        bool scheduled = build_schedule();
+
+        // Restart the poll engine on the new schedule
+        current_transaction_ = transaction_count_;
+        cycle_started_ = false;
+        for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+            last_sample_ms_[i] = 0;
+            sampled_[i] = false;
+        }
+
+        return scheduled;
+    }
+
+    /**
+     * Incremental, non-blocking poll
+     * Executes the transactions that are due at the current time and returns.
+     * Call this every control loop tick; cycles start on a fixed base_cycle_ms
+     * grid so the bus schedule does not drift with the caller's period.
+     * @param budget_ms Stop after this much time was spent in the call
+     *                  (0 = no limit). At least one due transaction always runs.
+     * @return Number of transactions executed
+     */
+    uint8_t poll(uint32_t budget_ms = 0) {
+        if (sensor_count_ == 0 || transaction_count_ == 0) return 0;
+
+        uint32_t call_start = time_->millis();
+
+        // Previous cycle finished - wait for the next slot on the cycle grid
+        if (current_transaction_ >= transaction_count_) {
+            if (cycle_started_ && static_cast<int32_t>(call_start - next_cycle_time_) < 0) {
+                return 0;
+            }
+            begin_cycle(call_start);
+        }
+
+        uint8_t executed = 0;
+        while (current_transaction_ < transaction_count_) {
+            ScheduledTransaction& trans = schedule_[current_transaction_];
+
+            uint32_t now = time_->millis();
+            uint32_t elapsed = now - cycle_start_time_;
+            if (elapsed < trans.time_ms) break;  // Not due yet
+            if (budget_ms > 0 && executed > 0 && now - call_start >= budget_ms) break;
+
+            record_lateness(elapsed - trans.time_ms);
+            execute_transaction(trans);
+            current_transaction_++;
+            executed++;
+        }
+
+        if (current_transaction_ >= transaction_count_) {
+            finish_cycle();
+        }
+
+        uint32_t call_ms = time_->millis() - call_start;
+        if (call_ms > stats_.max_call_ms) {
+            stats_.max_call_ms = call_ms;
+        }
+
+        return executed;
     }
 
     /**
-     * Execute one poll cycle
-     * Call this from main loop or timer task
+     * Execute one complete poll cycle (blocking)
+     * Waits between scheduled transactions with delay_ms(), so the caller is
+     * held for the whole cycle. Prefer poll() from periodic tasks.
      */
     void poll_cycle() {
         if (sensor_count_ == 0) return;
 
-        cycle_start_time_ = time_->millis();
+        uint32_t call_start = time_->millis();
+        cycle_start_time_ = call_start;
         current_transaction_ = 0;
+        cycle_jitter_ms_ = 0;
+        cycle_started_ = true;
 
         // Execute all scheduled transactions
         while (current_transaction_ < transaction_count_) {
@@ -134,13 +274,37 @@ public:
             uint32_t elapsed = time_->millis() - cycle_start_time_;
             if (elapsed < trans.time_ms) {
                 time_->delay_ms(trans.time_ms - elapsed);
+                elapsed = time_->millis() - cycle_start_time_;
             }
+            record_lateness(elapsed > trans.time_ms ? elapsed - trans.time_ms : 0);
 
             // Execute transaction
             execute_transaction(trans);
 
             current_transaction_++;
         }
+
+        finish_cycle();
+
+        uint32_t call_ms = time_->millis() - call_start;
+        if (call_ms > stats_.max_call_ms) {
+            stats_.max_call_ms = call_ms;
+        }
+    }
+
+    /**
+     * Check whether a poll cycle is in progress (transactions still pending)
+     */
+    bool is_cycle_active() const {
+        return current_transaction_ < transaction_count_;
+    }
+
+    const PollStats& get_poll_stats() const { return stats_; }
+    void reset_poll_stats() {
+        stats_ = PollStats();
+        for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+            sampled_[i] = false;
+        }
     }
 
     /**
@@ -149,9 +313,7 @@ public:
     float get_sensor_value(const char* name) const {
         for (uint8_t i = 0; i < sensor_count_; i++) {
             if (strcmp(sensors_[i].name, name) == 0) {
-                if (filters_[i]) {
-                    return filters_[i]->get_value();
-                }
+                return filters_.get_value(i);
             }
         }
         return 0;
@@ -163,16 +325,45 @@ public:
     core::SensorQuality get_sensor_quality(const char* name) const {
         for (uint8_t i = 0; i < sensor_count_; i++) {
             if (strcmp(sensors_[i].name, name) == 0) {
-                auto* sensor = state_->get_sensor_by_id(sensors_[i].sensor_id);
-                if (sensor) return sensor->quality;
+                return state_->get_sensor_quality(sensors_[i].sensor_id);
             }
         }
         return core::SensorQuality::UNKNOWN;
     }
 
     uint8_t get_sensor_count() const { return sensor_count_; }
+    const FilterBank& get_filters() const { return filters_; }
     uint8_t get_transaction_count() const { return transaction_count_; }
 
+    /**
+     * Get a scheduled transaction (nullptr if out of range)
+     */
+    const ScheduledTransaction* get_transaction(uint8_t index) const {
+        return index < transaction_count_ ? &schedule_[index] : nullptr;
+    }
+
+    const BusPlan& get_bus_plan() const { return bus_plan_; }
+
+    /**
+     * Why the last schedule build was rejected, or how it was degraded to
+     * fit the bus (empty if every read meets its deadline)
+     */
+    const char* get_schedule_error() const { return schedule_error_; }
+
+    /**
+     * Estimated bus time of one read transaction
+     * Fixed per-frame overhead (transaction_time_ms: turnaround, silent
+     * intervals, slave latency) plus request and response bytes on the wire.
+     * @param count Registers read
+     * @return Microseconds
+     */
+    uint32_t estimate_read_us(uint16_t count) const {
+        // Request: 8 bytes; response: addr + fn + byte count + data + CRC
+        uint32_t bytes = 8 + 5 + 2u * count;
+        uint32_t char_us = 11000000UL / (baudrate_ > 0 ? baudrate_ : 9600);  // 11 bits/char
+        return transaction_time_ms_ * 1000 + bytes * char_us;
+    }
+
 private:
     hal::IModbusInterface* modbus_;
     hal::ITimeInterface* time_;
@@ -180,7 +371,7 @@ private:
     core::EventBus* events_;
 
     ModbusSensorConfig sensors_[MAX_SENSORS];
-    std::unique_ptr<IFilter> filters_[MAX_SENSORS];
+    FilterBank filters_;
     uint8_t sensor_count_;
 
     ScheduledTransaction schedule_[MAX_TRANSACTIONS];
@@ -190,235 +381,643 @@ private:
     uint8_t base_samples_per_cycle_;
     uint32_t min_sample_spacing_ms_;
     bool bulk_read_enabled_;
+    bool fill_idle_windows_;
+    uint32_t transaction_time_ms_;
+    uint32_t baudrate_;
+    uint8_t filter_window_;     // Moving average / median window (sensor_timing)
+    BusPlan bus_plan_;
+    char schedule_error_[160];
+
+    /**
+     * Device read span planned once per base sample
+     */
+    struct PlannedSpan {
+        uint8_t device_addr;
+        uint8_t sensor_ids[MAX_TRANSACTION_SENSORS];
+        uint16_t start_reg;
+        uint16_t count;
+        uint8_t sensor_count;
+        uint8_t used_registers;
+        uint32_t cost_us;
+    };
+
+    /**
+     * One read to place in the cycle; times are ms from cycle start
+     * The deadline is the latest start time, i.e. the sampling latency bound.
+     */
+    struct PollJob {
+        uint32_t release_ms;
+        uint32_t deadline_ms;
+        uint32_t cost_ms;
+        uint8_t ref;                // Span index (base) or sensor index (extra)
+        bool is_base;
+    };
+
+    PlannedSpan spans_[MAX_SENSORS];
+    uint8_t span_count_;
+    PollJob jobs_[MAX_TRANSACTIONS];
+    uint16_t extra_per_cycle_[MAX_SENSORS];   // Extras placed per cycle, after thinning
+
+    uint32_t last_sample_ms_[MAX_SENSORS];
+    bool sampled_[MAX_SENSORS];
 
     uint32_t cycle_start_time_;
+    uint32_t next_cycle_time_;
     uint8_t current_transaction_;
+    bool cycle_started_;
+    uint32_t cycle_jitter_ms_;
+    PollStats stats_;
+
+    void begin_cycle(uint32_t now) {
+        // Stay on the cycle grid unless more than a full cycle behind
+        if (cycle_started_ && now - next_cycle_time_ < base_cycle_ms_) {
+            cycle_start_time_ = next_cycle_time_;
+        } else {
+            cycle_start_time_ = now;
+        }
+        cycle_started_ = true;
+        current_transaction_ = 0;
+        cycle_jitter_ms_ = 0;
+    }
 
-    void create_filter(uint8_t sensor_idx) {
-        const auto& sensor = sensors_[sensor_idx];
+    void finish_cycle() {
+        uint32_t duration = time_->millis() - cycle_start_time_;
+        next_cycle_time_ = cycle_start_time_ + base_cycle_ms_;
 
-        switch (sensor.filter_type) {
-            case core::FilterType::EMA:
-                filters_[sensor_idx] = std::make_unique<EMAFilter>(sensor.filter_alpha);
-                break;
-            case core::FilterType::MOVING_AVERAGE:
-                filters_[sensor_idx] = std::make_unique<MovingAverageFilter>(5);
-                break;
-            case core::FilterType::MEDIAN:
-                filters_[sensor_idx] = std::make_unique<MedianFilter>(5);
-                break;
-            default:
-                filters_[sensor_idx] = std::make_unique<NoFilter>();
-                break;
+        stats_.cycles++;
+        stats_.last_cycle_ms = duration;
+        stats_.last_jitter_ms = cycle_jitter_ms_;
+        stats_.jitter_sum_ms += cycle_jitter_ms_;
+        if (cycle_jitter_ms_ > stats_.max_jitter_ms) {
+            stats_.max_jitter_ms = cycle_jitter_ms_;
+        }
+        if (duration > base_cycle_ms_) {
+            stats_.overruns++;
         }
     }
 
-    void build_schedule() {
-        transaction_count_ = 0;
+    /**
+     * Track the interval between good samples of a sensor per priority class
+     */
+    void record_sample(uint8_t idx, uint32_t timestamp) {
+        if (sampled_[idx]) {
+            uint32_t gap = timestamp - last_sample_ms_[idx];
+            uint8_t prio = static_cast<uint8_t>(sensors_[idx].priority) & 3;
+            if (gap > stats_.max_sample_gap_ms[prio]) {
+                stats_.max_sample_gap_ms[prio] = gap;
+            }
+        }
+        last_sample_ms_[idx] = timestamp;
+        sampled_[idx] = true;
+    }
 
-        // Calculate base sample times
-        uint32_t base_interval = base_cycle_ms_ / base_samples_per_cycle_;
+    void record_lateness(uint32_t late_ms) {
+        stats_.transactions++;
+        if (late_ms > cycle_jitter_ms_) {
+            cycle_jitter_ms_ = late_ms;
+        }
+    }
 
-        // Group sensors by device address for bulk reads
-        struct DeviceGroup {
-            uint8_t device_addr;
-            uint8_t sensor_indices[16];
-            uint8_t count;
-            uint16_t min_reg;
-            uint16_t max_reg;
-        };
+    /**
+     * Contiguous register span read in one transaction
+     */
+    struct ReadSpan {
+        uint16_t start_reg;
+        uint16_t count;
+        uint8_t first;              // Range in the sorted sensor index list
+        uint8_t sensor_count;
+        uint8_t used_registers;     // Distinct registers mapped to sensors
+        uint32_t cost_us;
+    };
+
+    /**
+     * Split one device's registers into read spans with minimal bus time
+     * Dynamic programming over the registers sorted by address: best[j] is
+     * the cheapest plan for the first j sensors, where the last span covers
+     * sensors i..j-1. An optimal plan only uses spans that are contiguous in
+     * sorted order, so this is exact. Spans are limited to 125 registers and
+     * MAX_TRANSACTION_SENSORS sensors; with bulk reads disabled every span
+     * holds a single register.
+     * @param idx Sensor indices of one device, sorted by register
+     * @param n Number of indices
+     * @param spans Output spans in register order
+     * @return Number of spans
+     */
+    uint8_t plan_device_spans(const uint8_t* idx, uint8_t n, ReadSpan* spans) const {
+        uint32_t best[MAX_SENSORS + 1];
+        uint8_t from[MAX_SENSORS + 1];
+        best[0] = 0;
+
+        for (uint8_t j = 1; j <= n; j++) {
+            best[j] = UINT32_MAX;
+            from[j] = j - 1;
+            uint16_t last_reg = sensors_[idx[j - 1]].reg;
+
+            for (int i = j - 1; i >= 0; i--) {
+                uint32_t regs = last_reg - sensors_[idx[i]].reg + 1u;
+                if (regs > MAX_READ_REGISTERS || j - i > MAX_TRANSACTION_SENSORS) break;
+                if (!bulk_read_enabled_ && regs > 1) break;
+
+                uint32_t cost = best[i] + estimate_read_us(regs);
+                if (cost < best[j]) {
+                    best[j] = cost;
+                    from[j] = i;
+                }
+            }
+        }
+
+        // Walk back from the end, then reverse into register order
+        uint8_t count = 0;
+        for (uint8_t j = n; j > 0; j = from[j]) {
+            ReadSpan& span = spans[count++];
+            span.first = from[j];
+            span.sensor_count = j - from[j];
+            span.start_reg = sensors_[idx[from[j]]].reg;
+            span.count = sensors_[idx[j - 1]].reg - span.start_reg + 1;
+            span.cost_us = estimate_read_us(span.count);
+
+            span.used_registers = 1;
+            for (uint8_t k = from[j] + 1; k < j; k++) {
+                if (sensors_[idx[k]].reg != sensors_[idx[k - 1]].reg) span.used_registers++;
+            }
+        }
+        for (uint8_t a = 0; a < count / 2; a++) {
+            ReadSpan tmp = spans[a];
+            spans[a] = spans[count - 1 - a];
+            spans[count - 1 - a] = tmp;
+        }
+        return count;
+    }
 
-        DeviceGroup groups[8];
-        uint8_t group_count = 0;
+    static uint32_t us_to_slot_ms(uint32_t us) {
+        return (us + 999) / 1000;
+    }
+
+    /**
+     * Relative start deadline of an extra sample, as a fraction of its period
+     * CRITICAL sensors must be sampled within a quarter period of release,
+     * HIGH within half; NORMAL/LOW only before the next release.
+     */
+    static uint32_t deadline_divisor(core::SensorPriority priority) {
+        switch (priority) {
+            case core::SensorPriority::CRITICAL: return 4;
+            case core::SensorPriority::HIGH:     return 2;
+            default:                             return 1;
+        }
+    }
+
+    /**
+     * Group sensors by device and plan the read spans of one base sample
+     */
+    void plan_spans() {
+        span_count_ = 0;
+        bool done[MAX_SENSORS] = {};
 
-        // Build device groups
         for (uint8_t i = 0; i < sensor_count_; i++) {
+            if (done[i]) continue;
             uint8_t addr = sensors_[i].device_addr;
 
-            // Find or create group
-            int group_idx = -1;
-            for (uint8_t g = 0; g < group_count; g++) {
-                if (groups[g].device_addr == addr) {
-                    group_idx = g;
-                    break;
+            // Collect this device's sensors
+            uint8_t idx[MAX_SENSORS];
+            uint8_t n = 0;
+            for (uint8_t k = i; k < sensor_count_; k++) {
+                if (sensors_[k].device_addr == addr) {
+                    idx[n++] = k;
+                    done[k] = true;
                 }
             }
 
-            if (group_idx < 0 && group_count < 8) {
-                group_idx = group_count++;
-                groups[group_idx].device_addr = addr;
-                groups[group_idx].count = 0;
-                groups[group_idx].min_reg = 0xFFFF;
-                groups[group_idx].max_reg = 0;
-            }
+            std::sort(idx, idx + n, [this](uint8_t a, uint8_t b) {
+                return sensors_[a].reg < sensors_[b].reg;
+            });
 
-            if (group_idx >= 0 && groups[group_idx].count < 16) {
-                groups[group_idx].sensor_indices[groups[group_idx].count++] = i;
-                if (sensors_[i].reg < groups[group_idx].min_reg) {
-                    groups[group_idx].min_reg = sensors_[i].reg;
-                }
-                if (sensors_[i].reg > groups[group_idx].max_reg) {
-                    groups[group_idx].max_reg = sensors_[i].reg;
+            ReadSpan spans[MAX_SENSORS];
+            uint8_t count = plan_device_spans(idx, n, spans);
+
+            for (uint8_t sp = 0; sp < count; sp++) {
+                PlannedSpan& p = spans_[span_count_++];
+                p.device_addr = addr;
+                p.start_reg = spans[sp].start_reg;
+                p.count = spans[sp].count;
+                p.sensor_count = spans[sp].sensor_count;
+                p.used_registers = spans[sp].used_registers;
+                p.cost_us = spans[sp].cost_us;
+                for (uint8_t k = 0; k < spans[sp].sensor_count; k++) {
+                    p.sensor_ids[k] = idx[spans[sp].first + k];
                 }
             }
         }
+        bus_plan_.spans_per_sample = span_count_;
+    }
 
-        // Schedule base samples (bulk reads)
-        for (uint8_t sample = 0; sample < base_samples_per_cycle_; sample++) {
-            uint32_t sample_time = sample * base_interval;
+    /**
+     * Record a schedule rejection reason and clear the schedule
+     * @return false, for use as "return schedule_error(...)"
+     */
+    bool schedule_error(const char* fmt, ...) {
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(schedule_error_, sizeof(schedule_error_), fmt, args);
+        va_end(args);
+        transaction_count_ = 0;
+        return false;
+    }
 
-            for (uint8_t g = 0; g < group_count; g++) {
-                if (transaction_count_ >= MAX_TRANSACTIONS) break;
+    /**
+     * Append a degradation note to schedule_error_, "; "-separated
+     */
+    void note_shortfall(const char* fmt, ...) {
+        size_t len = strlen(schedule_error_);
+        if (len > 0 && len + 2 < sizeof(schedule_error_)) {
+            strcpy(schedule_error_ + len, "; ");
+            len += 2;
+        }
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(schedule_error_ + len, sizeof(schedule_error_) - len, fmt, args);
+        va_end(args);
+    }
 
-                ScheduledTransaction& trans = schedule_[transaction_count_++];
-                trans.time_ms = sample_time;
-                trans.device_addr = groups[g].device_addr;
-                trans.start_reg = groups[g].min_reg;
-                uint16_t reg_count = groups[g].max_reg - groups[g].min_reg + 1;
-                // Clamp to maximum buffer size
-                trans.count = (reg_count > 16) ? 16 : reg_count;
-                trans.is_bulk = bulk_read_enabled_;
-                trans.sensor_count = (groups[g].count > 16) ? 16 : groups[g].count;
+    /**
+     * Build the cyclic poll schedule with non-preemptive EDF
+     *
+     * Jobs within one base cycle:
+     * - Base reads: every planned span at each of the base_samples_per_cycle
+     *   sample points. Their start deadline keeps consecutive base samples at
+     *   least min_sample_spacing_ms apart.
+     * - Extra samples: extra_samples_per_second spread evenly over the cycle;
+     *   each must start within period / deadline_divisor(priority).
+     *
+     * A bus that cannot serve the configuration never stops the controller.
+     * Extra samples are halved, lowest priority class first, until every job
+     * meets its deadline. Base reads are always kept; if they alone do not
+     * fit, they run late and the cycle overruns. Each degradation is reported
+     * in get_schedule_error().
+     * @return false only for an invalid scheduler config
+     */
+    bool build_schedule() {
+        transaction_count_ = 0;
+        bus_plan_ = BusPlan();
+        schedule_error_[0] = '\0';
 
-                for (uint8_t s = 0; s < trans.sensor_count && s < 16; s++) {
-                    trans.sensor_ids[s] = groups[g].sensor_indices[s];
-                }
+        if (base_samples_per_cycle_ == 0 || base_cycle_ms_ == 0) {
+            return schedule_error("invalid scheduler config: base_cycle_ms=%lu, base_samples=%u",
+                                  (unsigned long)base_cycle_ms_, base_samples_per_cycle_);
+        }
+
+        plan_spans();
+
+        // Every span is read at each base sample; stay within the table
+        uint8_t base_samples = base_samples_per_cycle_;
+        while (base_samples > 1 && base_samples * span_count_ > MAX_TRANSACTIONS) {
+            base_samples--;
+        }
+        if (base_samples < base_samples_per_cycle_) {
+            note_shortfall("base samples cut to %u per cycle (transaction limit)", base_samples);
+        }
+
+        uint32_t base_interval = base_cycle_ms_ / base_samples;
+        if (base_interval < min_sample_spacing_ms_) {
+            note_shortfall("base samples every %lu ms violate min_sample_spacing_ms=%lu",
+                           (unsigned long)base_interval, (unsigned long)min_sample_spacing_ms_);
+        }
+
+        // Extras per base cycle (configured per second)
+        uint32_t requested = 0;
+        for (uint8_t i = 0; i < sensor_count_; i++) {
+            uint32_t extras = fill_idle_windows_ ? sensors_[i].extra_samples_per_second : 0;
+            uint32_t per_cycle = (extras * base_cycle_ms_ + 500) / 1000;
+            if (extras > 0 && per_cycle == 0) per_cycle = 1;
+            extra_per_cycle_[i] = static_cast<uint16_t>(std::min<uint32_t>(per_cycle, MAX_TRANSACTIONS));
+            requested += extra_per_cycle_[i];
+        }
+
+        const char* thinned = nullptr;
+        uint32_t late_ms = 0;
+        while (!place_jobs(base_samples, true, late_ms)) {
+            int8_t victim = thinning_victim();
+            if (victim < 0) {
+                place_jobs(base_samples, false, late_ms);  // Base reads only, late
+                break;
+            }
+            if (!thinned) thinned = sensors_[victim].name;
+            extra_per_cycle_[victim] /= 2;
+        }
 
-                // Offset next device slightly
-                sample_time += 5;  // 5ms per transaction
+        if (thinned) {
+            uint32_t kept = 0;
+            for (uint8_t i = 0; i < sensor_count_; i++) kept += extra_per_cycle_[i];
+            note_shortfall("kept %lu of %lu extra samples per cycle, '%s' thinned first",
+                           (unsigned long)kept, (unsigned long)requested, thinned);
+        }
+        if (late_ms > 0) {
+            note_shortfall("bus over-subscribed: base reads start up to %lu ms late",
+                           (unsigned long)late_ms);
+        }
+        return true;
+    }
+
+    /**
+     * Sensor whose extras are thinned next: the lowest priority class first,
+     * within it the sensor with the most extras per cycle
+     * @return Sensor index, or -1 when no extras are left
+     */
+    int8_t thinning_victim() const {
+        int8_t victim = -1;
+        for (uint8_t i = 0; i < sensor_count_; i++) {
+            if (extra_per_cycle_[i] == 0) continue;
+            if (victim < 0 ||
+                sensors_[i].priority < sensors_[victim].priority ||
+                (sensors_[i].priority == sensors_[victim].priority &&
+                 extra_per_cycle_[i] > extra_per_cycle_[victim])) {
+                victim = static_cast<int8_t>(i);
             }
         }
+        return victim;
+    }
 
-        // Schedule extra samples in idle windows
-        // Simple round-robin distribution for now
-        uint32_t extra_time = 15;  // Start after first bulk reads
+    /**
+     * Collect the jobs of one cycle and dispatch them earliest-deadline-first
+     * Jobs are sorted by release and dispatched from a binary heap, O(n log n).
+     * @param base_samples Base sample points per cycle
+     * @param strict Fail on over-subscription or a late job; otherwise place
+     *               late jobs anyway and report the worst lateness
+     * @param late_ms Worst start lateness of a non-strict placement
+     * @return false if strict and some job misses its deadline
+     */
+    bool place_jobs(uint8_t base_samples, bool strict, uint32_t& late_ms) {
+        transaction_count_ = 0;
+        late_ms = 0;
+        bus_plan_ = BusPlan();
+        bus_plan_.spans_per_sample = span_count_;
+
+        uint32_t base_interval = base_cycle_ms_ / base_samples;
+        uint32_t base_slack = base_interval > min_sample_spacing_ms_
+                                  ? base_interval - min_sample_spacing_ms_ : 0;
+        uint16_t job_count = 0;
+        uint32_t demand_ms = 0;
+
+        for (uint8_t sample = 0; sample < base_samples; sample++) {
+            for (uint8_t sp = 0; sp < span_count_; sp++) {
+                PollJob& job = jobs_[job_count++];
+                job.release_ms = sample * base_interval;
+                job.deadline_ms = job.release_ms + base_slack;
+                job.cost_ms = us_to_slot_ms(spans_[sp].cost_us);
+                job.ref = sp;
+                job.is_base = true;
+                demand_ms += job.cost_ms;
+            }
+        }
 
+        const uint32_t single_cost_ms = us_to_slot_ms(estimate_read_us(1));
         for (uint8_t i = 0; i < sensor_count_; i++) {
-            uint8_t extras = sensors_[i].extra_samples_per_second;
-            if (extras == 0) continue;
+            uint32_t per_cycle = extra_per_cycle_[i];
+            if (per_cycle == 0) continue;
+            uint32_t period = base_cycle_ms_ / per_cycle;
+            uint32_t window = period / deadline_divisor(sensors_[i].priority);
+
+            for (uint32_t e = 0; e < per_cycle; e++) {
+                if (job_count >= MAX_TRANSACTIONS) return false;
+                PollJob& job = jobs_[job_count++];
+                job.release_ms = e * period;
+                job.deadline_ms = job.release_ms + window;
+                job.cost_ms = single_cost_ms;
+                job.ref = i;
+                job.is_base = false;
+                demand_ms += job.cost_ms;
+            }
+        }
 
-            for (uint8_t e = 0; e < extras && transaction_count_ < MAX_TRANSACTIONS; e++) {
-                ScheduledTransaction& trans = schedule_[transaction_count_++];
+        if (strict && demand_ms > base_cycle_ms_) return false;
 
-                // Find next available slot
-                trans.time_ms = extra_time;
-                trans.device_addr = sensors_[i].device_addr;
-                trans.start_reg = sensors_[i].reg;
-                trans.count = 1;
-                trans.is_bulk = false;
-                trans.sensor_count = 1;
-                trans.sensor_ids[0] = i;
+        std::sort(jobs_, jobs_ + job_count, [](const PollJob& a, const PollJob& b) {
+            return a.release_ms < b.release_ms;
+        });
 
-                extra_time += 5;
+        // Min-heap on deadline; base reads win ties so bulk samples stay aligned
+        auto later = [this](uint8_t a, uint8_t b) {
+            if (jobs_[a].deadline_ms != jobs_[b].deadline_ms) {
+                return jobs_[a].deadline_ms > jobs_[b].deadline_ms;
+            }
+            return !jobs_[a].is_base && jobs_[b].is_base;
+        };
+        uint8_t ready[MAX_TRANSACTIONS];
+        uint8_t ready_count = 0;
+        uint16_t next_job = 0;
+        uint32_t now = 0;
+
+        while (next_job < job_count || ready_count > 0) {
+            if (ready_count == 0 && jobs_[next_job].release_ms > now) {
+                now = jobs_[next_job].release_ms;  // Bus idle until next release
+            }
+            while (next_job < job_count && jobs_[next_job].release_ms <= now) {
+                ready[ready_count++] = next_job++;
+                std::push_heap(ready, ready + ready_count, later);
+            }
 
-                // Wrap around if needed, skip base sample times
-                if (extra_time >= base_cycle_ms_) {
-                    extra_time = 15;
+            std::pop_heap(ready, ready + ready_count, later);
+            const PollJob& job = jobs_[ready[--ready_count]];
+
+            if (now > job.deadline_ms) {
+                if (strict) {
+                    transaction_count_ = 0;
+                    return false;
                 }
+                late_ms = std::max(late_ms, now - job.deadline_ms);
             }
+
+            ScheduledTransaction& trans = schedule_[transaction_count_++];
+            trans.time_ms = now;
+            trans.is_extra = !job.is_base;
+            if (job.is_base) {
+                const PlannedSpan& span = spans_[job.ref];
+                trans.device_addr = span.device_addr;
+                trans.start_reg = span.start_reg;
+                trans.count = span.count;
+                trans.is_bulk = span.count > 1;
+                trans.sensor_count = span.sensor_count;
+                trans.cost_us = span.cost_us;
+                for (uint8_t s = 0; s < span.sensor_count; s++) {
+                    trans.sensor_ids[s] = span.sensor_ids[s];
+                }
+                bus_plan_.registers_read += span.count;
+                bus_plan_.registers_used += span.used_registers;
+            } else {
+                trans.device_addr = sensors_[job.ref].device_addr;
+                trans.start_reg = sensors_[job.ref].reg;
+                trans.count = 1;
+                trans.is_bulk = false;
+                trans.sensor_count = 1;
+                trans.sensor_ids[0] = job.ref;
+                trans.cost_us = estimate_read_us(1);
+                bus_plan_.registers_read += 1;
+                bus_plan_.registers_used += 1;
+            }
+            bus_plan_.bus_us_per_cycle += trans.cost_us;
+
+            now += job.cost_ms;
         }
 
-        // Sort schedule by time
-        core::bubble_sort(schedule_, transaction_count_,
-            [](const ScheduledTransaction& a, const ScheduledTransaction& b) {
-                return a.time_ms > b.time_ms;
-            });
+        bus_plan_.transactions = transaction_count_;
+        bus_plan_.occupancy_pct = bus_plan_.bus_us_per_cycle / (base_cycle_ms_ * 10.0f);
+        compute_planned_gaps();
+        return true;
     }
 
-    void execute_transaction(ScheduledTransaction& trans) {
-        uint16_t data[16];
+    /**
+     * Worst planned interval between samples of each sensor (wrapping
+     * into the next cycle), folded per priority class
+     */
+    void compute_planned_gaps() {
+        int32_t first[MAX_SENSORS];
+        int32_t last[MAX_SENSORS];
+        uint32_t gap[MAX_SENSORS] = {};
+        for (uint8_t i = 0; i < sensor_count_; i++) {
+            first[i] = -1;
+            last[i] = -1;
+        }
 
-        // Validate transaction parameters to prevent buffer overflow
-        if (trans.count == 0 || trans.count > 16) {
-            // Invalid register count - mark sensors as bad
+        for (uint8_t t = 0; t < transaction_count_; t++) {
+            const ScheduledTransaction& trans = schedule_[t];
             for (uint8_t s = 0; s < trans.sensor_count; s++) {
-                if (trans.sensor_ids[s] < sensor_count_) {
-                    state_->set_sensor_quality(sensors_[trans.sensor_ids[s]].sensor_id,
-                                              core::SensorQuality::BAD);
+                uint8_t idx = trans.sensor_ids[s];
+                if (first[idx] < 0) {
+                    first[idx] = trans.time_ms;
+                } else if (trans.time_ms - last[idx] > gap[idx]) {
+                    gap[idx] = trans.time_ms - last[idx];
                 }
+                last[idx] = trans.time_ms;
             }
-            return;
         }
 
-        if (trans.sensor_count > 16) {
-            trans.sensor_count = 16;  // Clamp to maximum
+        for (uint8_t i = 0; i < sensor_count_; i++) {
+            if (first[i] < 0) continue;
+            uint32_t wrap = base_cycle_ms_ - last[i] + first[i];
+            if (wrap > gap[i]) gap[i] = wrap;
+
+            uint8_t prio = static_cast<uint8_t>(sensors_[i].priority) & 3;
+            if (gap[i] > bus_plan_.max_gap_ms[prio]) {
+                bus_plan_.max_gap_ms[prio] = gap[i];
+            }
         }
+    }
 
-        bool success = modbus_->read_holding_registers(
-            trans.device_addr,
-            trans.start_reg,
-            trans.count,
-            data
-        );
+    /**
+     * Read one transaction and apply all its sensors in a single batch
+     * State is written under one lock acquisition and subscribers get one
+     * SENSORS_UPDATED event for the whole transaction.
+     */
+    void execute_transaction(ScheduledTransaction& trans) {
+        uint16_t data[MAX_READ_REGISTERS];
+        core::SensorSample batch[MAX_TRANSACTION_SENSORS];
+        uint8_t batch_count = 0;
+
+        if (trans.sensor_count > MAX_TRANSACTION_SENSORS) {
+            trans.sensor_count = MAX_TRANSACTION_SENSORS;  // Clamp to maximum
+        }
+
+        // Validate transaction parameters to prevent buffer overflow
+        bool success = false;
+        if (trans.count > 0 && trans.count <= MAX_READ_REGISTERS) {
+            success = modbus_->read_holding_registers(
+                trans.device_addr,
+                trans.start_reg,
+                trans.count,
+                data
+            );
+        }
 
         uint32_t timestamp = time_->millis();
 
-        if (success) {
-            // Process each sensor in this transaction
+        if (!success) {
+            // Invalid register count or bus error - mark sensors as bad
             for (uint8_t s = 0; s < trans.sensor_count; s++) {
                 uint8_t idx = trans.sensor_ids[s];
-
                 // Bounds check sensor index
-                if (idx >= sensor_count_) {
-                    continue;  // Skip invalid sensor index
+                if (idx < sensor_count_) {
+                    add_quality_sample(batch, batch_count, sensors_[idx].sensor_id,
+                                       core::SensorQuality::BAD);
                 }
+            }
+            state_->ingest_sensor_batch(batch, batch_count, timestamp);
+            return;
+        }
 
-                const auto& sensor = sensors_[idx];
-
-                // Calculate register offset within bulk read
-                uint16_t reg_offset = sensor.reg - trans.start_reg;
-                if (reg_offset >= trans.count) continue;
+        uint8_t alarm_ids[MAX_TRANSACTION_SENSORS];
+        uint8_t alarm_count = 0;
 
-                uint16_t raw_modbus = data[reg_offset];
+        // Process each sensor in this transaction
+        for (uint8_t s = 0; s < trans.sensor_count; s++) {
+            uint8_t idx = trans.sensor_ids[s];
 
-                // Check 4-20mA range validity
-                if (raw_modbus < sensor.min_raw) {
-                    // Wire break detected (<4mA)
-                    state_->set_sensor_quality(sensor.sensor_id, core::SensorQuality::BAD);
-                    if (events_) {
-                        events_->publish_alarm(sensor.sensor_id, timestamp);
-                    }
-                    continue;
-                }
-                if (raw_modbus > sensor.max_raw) {
-                    // Sensor fault or over-range (>20mA)
-                    state_->set_sensor_quality(sensor.sensor_id, core::SensorQuality::BAD);
-                    if (events_) {
-                        events_->publish_alarm(sensor.sensor_id, timestamp);
-                    }
-                    continue;
-                }
+            // Bounds check sensor index
+            if (idx >= sensor_count_) {
+                continue;  // Skip invalid sensor index
+            }
 
-                // Convert to engineering units
-                float raw = raw_modbus * sensor.scale + sensor.offset;
+            const auto& sensor = sensors_[idx];
 
-                // Apply filter
-                float filtered = raw;
-                if (filters_[idx]) {
-                    filtered = filters_[idx]->update(raw);
-                }
+            // Calculate register offset within bulk read
+            uint16_t reg_offset = sensor.reg - trans.start_reg;
+            if (reg_offset >= trans.count) continue;
 
-                // Update state manager
-                state_->update_sensor_value(sensor.sensor_id, raw, timestamp);
-                state_->update_sensor_filtered(sensor.sensor_id, filtered, filtered);
-                state_->set_sensor_quality(sensor.sensor_id, core::SensorQuality::GOOD);
+            uint16_t raw_modbus = data[reg_offset];
 
-                // Publish event
-                if (events_) {
-                    events_->publish_sensor_update(sensor.sensor_id, filtered, timestamp);
-                }
+            // Check 4-20mA range validity: <4mA = wire break, >20mA = sensor
+            // fault or over-range
+            if (raw_modbus < sensor.min_raw || raw_modbus > sensor.max_raw) {
+                add_quality_sample(batch, batch_count, sensor.sensor_id,
+                                   core::SensorQuality::BAD);
+                alarm_ids[alarm_count++] = sensor.sensor_id;
+                continue;
             }
-        } else {
-            // Mark sensors as bad quality
-            for (uint8_t s = 0; s < trans.sensor_count; s++) {
-                uint8_t idx = trans.sensor_ids[s];
-                // Bounds check sensor index
-                if (idx < sensor_count_) {
-                    state_->set_sensor_quality(sensors_[idx].sensor_id, core::SensorQuality::BAD);
+
+            // Convert to engineering units
+            float raw = raw_modbus * sensor.scale + sensor.offset;
+
+            // Apply filter
+            float filtered = filters_.update(idx, raw, trans.is_extra);
+
+            core::SensorSample& sample = batch[batch_count++];
+            sample.sensor_id = sensor.sensor_id;
+            sample.has_value = true;
+            sample.raw_value = raw;
+            sample.filtered_value = filtered;
+            sample.display_value = filtered;
+            sample.quality = core::SensorQuality::GOOD;
+            sample.is_extra = trans.is_extra;
+            record_sample(idx, timestamp);
+        }
+
+        // Update state manager under one lock
+        uint32_t updated = state_->ingest_sensor_batch(batch, batch_count, timestamp);
+
+        if (!events_) return;
+
+        for (uint8_t a = 0; a < alarm_count; a++) {
+            events_->publish_alarm(alarm_ids[a], timestamp);
+        }
+        if (updated) {
+            events_->publish_sensors_updated(updated, timestamp);
+        }
+
+        // Per-sensor events only for subscribers that still want them
+        if (updated && events_->has_subscribers(core::EventType::SENSOR_UPDATE)) {
+            for (uint8_t i = 0; i < batch_count; i++) {
+                if (batch[i].has_value) {
+                    events_->publish_sensor_update(batch[i].sensor_id, batch[i].filtered_value, timestamp);
                 }
             }
         }
     }
+
+    static void add_quality_sample(core::SensorSample* batch, uint8_t& count,
+                                   uint8_t sensor_id, core::SensorQuality quality) {
+        core::SensorSample& sample = batch[count++];
+        sample.sensor_id = sensor_id;
+        sample.has_value = false;
+        sample.quality = quality;
+    }
 };
 
 } // namespace modules
@@ -0,0 +1,564 @@
+#pragma once
+
+#include "hal/interfaces.h"
+#include "core/types.h"
+#include "core/config.h"
+#include "core/state_manager.h"
+#include "core/event_bus.h"
+#include "core/json_writer.h"
+#include "modules/mqtt_spool.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#ifdef ESP32_BUILD
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#else
+#include <mutex>
+#endif
+
+namespace modules {
+
+/**
+ * MQTT telemetry publisher
+ *
+ * Collects changes from the EventBus and publishes them in batches, one
+ * message per kind per MQTTConfig::publish_interval_ms:
+ *   <topic_prefix>/sensors     sensors sampled since the last batch
+ *   <topic_prefix>/relays      relays that changed since the last batch
+ *   <topic_prefix>/fermenters  all fermenters, when a published field changed
+ *   <topic_prefix>/alarms      each alarm change, without waiting
+ *   <topic_prefix>/status      "online", retained ("offline" as last will)
+ * Payloads are JSON with a Unix timestamp ("ts") taken when the batch
+ * was made, so replayed messages keep their time. A batch larger than
+ * PAYLOAD_SIZE is counted in Stats::truncated and not sent.
+ *
+ * Everything is QoS 1. Messages go through an MqttSpool and leave it only
+ * when the broker acknowledges them: unacknowledged ones are resent after
+ * ACK_TIMEOUT_MS, and after a reconnect from the oldest. The spool is the
+ * only retransmitter; the client sends each publish once and buffers at
+ * most OUTBOX_LIMIT bytes of it. While the broker is unreachable batches
+ * keep being spooled (oldest dropped when full).
+ *
+ * EventBus callbacks only set dirty bits; process() does the formatting
+ * and the network calls, so call it from a low-priority loop.
+ */
+class MqttPublisher {
+public:
+    static constexpr size_t SPOOL_PSRAM_SIZE = 256 * 1024;
+    static constexpr size_t SPOOL_FALLBACK_SIZE = 32 * 1024;    // No PSRAM
+    static constexpr size_t PAYLOAD_SIZE = 4096;
+    static constexpr int MAX_INFLIGHT = 4;                      // Unacknowledged publishes
+    // Client buffer: this session's in-flight publishes plus the last
+    // session's, which the client may still hold until they expire
+    static constexpr size_t OUTBOX_LIMIT = 2 * MAX_INFLIGHT * PAYLOAD_SIZE;
+    static constexpr uint32_t ACK_TIMEOUT_MS = 10000;
+    static constexpr int MAX_RELAYS = 32;
+
+    struct Stats {
+        uint32_t batches;       // Messages spooled
+        uint32_t published;     // PUBLISH packets sent, including resends
+        uint32_t acked;
+        uint32_t retries;       // Resent after ACK_TIMEOUT_MS
+        uint32_t connects;
+        uint32_t truncated;     // Batches over PAYLOAD_SIZE, not spooled
+        uint32_t dropped;       // Batches the spool refused
+    };
+
+    MqttPublisher(hal::IMqttClient* client,
+                  hal::ITimeInterface* time,
+                  core::StateManager* state,
+                  core::EventBus* events,
+                  const core::MQTTConfig& config,
+                  const char* client_id)
+        : client_(client)
+        , time_(time)
+        , state_(state)
+        , events_(events)
+        , config_(config)
+        , client_id_{}
+        , status_topic_{}
+        , options_{}
+        , sensor_sub_id_(-1)
+        , relay_sub_id_(-1)
+        , alarm_sub_id_(-1)
+        , dirty_sensors_(0)
+        , dirty_relays_(0)
+        , pending_alarms_(0)
+        , alarm_states_(0)
+        , fermenters_reported_(false)
+        , last_fermenters_{}
+        , last_batch_ms_(0)
+        , last_connect_ms_(0)
+        , connected_(false)
+        , initialized_(false)
+        , inflight_{}
+        , stats_{}
+        , payload_{}
+        , sink_(payload_, sizeof(payload_))
+        , json_(core::JsonBufferSink::write, &sink_)
+        , message_{} {
+        strncpy(client_id_, client_id ? client_id : "fermenter", sizeof(client_id_) - 1);
+#ifdef ESP32_BUILD
+        mutex_ = xSemaphoreCreateMutex();
+#endif
+    }
+
+    ~MqttPublisher() {
+        stop();
+#ifdef ESP32_BUILD
+        if (mutex_) vSemaphoreDelete(mutex_);
+#endif
+    }
+
+    MqttPublisher(const MqttPublisher&) = delete;
+    MqttPublisher& operator=(const MqttPublisher&) = delete;
+
+    /**
+     * Allocate the spool, subscribe to events and start connecting
+     * @return false without a broker or spool memory
+     */
+    bool initialize() {
+        if (initialized_) return true;
+        if (!client_ || !time_ || !state_ || !events_ || config_.broker[0] == '\0') return false;
+
+        if (!spool_.allocate(SPOOL_PSRAM_SIZE) && !spool_.allocate(SPOOL_FALLBACK_SIZE)) {
+            return false;
+        }
+
+        topic(status_topic_, "status");
+        options_.host = config_.broker;
+        options_.port = config_.port;
+        options_.client_id = client_id_;
+        options_.username = config_.username;
+        options_.password = config_.password;
+        options_.keepalive_s = config_.keepalive_s;
+        options_.will_topic = status_topic_;
+        options_.will_message = "offline";
+        options_.outbox_limit = OUTBOX_LIMIT;
+
+        sensor_sub_id_ = events_->subscribe(core::EventType::SENSORS_UPDATED,
+            [](const core::Event& e, void* ctx) { static_cast<MqttPublisher*>(ctx)->on_sensors_updated(e); }, this);
+        relay_sub_id_ = events_->subscribe(core::EventType::RELAY_CHANGE,
+            [](const core::Event& e, void* ctx) { static_cast<MqttPublisher*>(ctx)->on_relay_change(e); }, this);
+        alarm_sub_id_ = events_->subscribe(core::EventType::ALARM,
+            [](const core::Event& e, void* ctx) { static_cast<MqttPublisher*>(ctx)->on_alarm(e); }, this);
+
+        uint32_t now = time_->millis();
+        last_batch_ms_ = now;
+        last_connect_ms_ = now;
+        fermenters_reported_ = false;                       // First batch has fermenters
+        client_->connect(options_);
+        initialized_ = true;
+        return true;
+    }
+
+    void stop() {
+        if (!initialized_) return;
+        if (sensor_sub_id_ >= 0) events_->unsubscribe(sensor_sub_id_);
+        if (relay_sub_id_ >= 0) events_->unsubscribe(relay_sub_id_);
+        if (alarm_sub_id_ >= 0) events_->unsubscribe(alarm_sub_id_);
+        sensor_sub_id_ = relay_sub_id_ = alarm_sub_id_ = -1;
+        client_->disconnect();
+        connected_ = false;
+        initialized_ = false;
+    }
+
+    /**
+     * Connection upkeep, batching and (re)sending
+     * Call often (every 10-100 ms); returns quickly when there is nothing to do.
+     */
+    void process() {
+        if (!initialized_) return;
+        uint32_t now = time_->millis();
+
+        bool connected = client_->is_connected();
+        if (connected && !connected_) {
+            on_connected();
+        } else if (!connected && connected_) {
+            on_disconnected();
+        }
+        connected_ = connected;
+
+        if (!connected && now - last_connect_ms_ >= config_.reconnect_delay_ms) {
+            last_connect_ms_ = now;
+            client_->connect(options_);
+        }
+
+        uint16_t msg_id;
+        while (client_->poll_ack(msg_id)) {
+            on_ack(msg_id);
+        }
+
+        spool_alarms();
+        if (now - last_batch_ms_ >= config_.publish_interval_ms) {
+            last_batch_ms_ = now;
+            spool_batch();
+        }
+
+        if (connected_) send(now);
+    }
+
+    bool is_connected() const { return connected_; }
+    const Stats& get_stats() const { return stats_; }
+    const MqttSpool& get_spool() const { return spool_; }
+
+    int get_inflight() const {
+        int count = 0;
+        for (const auto& f : inflight_) count += f.active ? 1 : 0;
+        return count;
+    }
+
+private:
+    struct InFlight {
+        uint32_t offset;    // Spool record
+        uint32_t sent_ms;
+        uint16_t msg_id;
+        bool active;
+    };
+
+    /**
+     * Fermenter fields as last published, at payload precision
+     */
+    struct FermenterReport {
+        bool present;
+        core::FermenterMode mode;
+        int32_t temp;               // 1/100 C
+        int32_t target_temp;
+        int32_t pressure;           // 1/1000 bar
+        int32_t target_pressure;
+        int32_t pid_output;         // 1/10 %
+
+        bool operator!=(const FermenterReport& other) const {
+            return present != other.present || mode != other.mode || temp != other.temp ||
+                   target_temp != other.target_temp || pressure != other.pressure ||
+                   target_pressure != other.target_pressure || pid_output != other.pid_output;
+        }
+    };
+
+    hal::IMqttClient* client_;
+    hal::ITimeInterface* time_;
+    core::StateManager* state_;
+    core::EventBus* events_;
+    const core::MQTTConfig& config_;
+    char client_id_[32];
+    char status_topic_[MqttSpool::MAX_TOPIC];
+    hal::MqttConnectOptions options_;
+
+    int sensor_sub_id_;
+    int relay_sub_id_;
+    int alarm_sub_id_;
+
+    // Set by EventBus callbacks (under mutex_)
+    uint32_t dirty_sensors_;
+    uint32_t dirty_relays_;
+    uint8_t pending_alarms_;    // Bit (id - 1) per fermenter
+    uint8_t alarm_states_;
+
+    bool fermenters_reported_;
+    FermenterReport last_fermenters_[core::MAX_FERMENTERS];
+    uint32_t last_batch_ms_;
+    uint32_t last_connect_ms_;
+    bool connected_;
+    bool initialized_;
+
+    MqttSpool spool_;
+    InFlight inflight_[MAX_INFLIGHT];
+    Stats stats_;
+    char payload_[PAYLOAD_SIZE];                    // Formatting
+    core::JsonBufferSink sink_;
+    core::JsonWriter json_;
+    MqttSpool::Message message_;                    // Sending
+    uint8_t send_buffer_[PAYLOAD_SIZE];
+
+#ifdef ESP32_BUILD
+    SemaphoreHandle_t mutex_;
+#else
+    std::mutex mutex_;
+#endif
+
+    void lock() {
+#ifdef ESP32_BUILD
+        if (mutex_) xSemaphoreTake(mutex_, portMAX_DELAY);
+#else
+        mutex_.lock();
+#endif
+    }
+
+    void unlock() {
+#ifdef ESP32_BUILD
+        if (mutex_) xSemaphoreGive(mutex_);
+#else
+        mutex_.unlock();
+#endif
+    }
+
+    void topic(char* out, const char* leaf) const {
+        snprintf(out, MqttSpool::MAX_TOPIC, "%s/%s", config_.topic_prefix, leaf);
+    }
+
+    // EventBus callbacks: bookkeeping only
+
+    void on_sensors_updated(const core::Event& event) {
+        lock();
+        dirty_sensors_ |= event.data.mask;
+        unlock();
+    }
+
+    void on_relay_change(const core::Event& event) {
+        if (event.source_id >= MAX_RELAYS) return;
+        lock();
+        dirty_relays_ |= 1u << event.source_id;
+        unlock();
+    }
+
+    void on_alarm(const core::Event& event) {
+        if (event.source_id < 1 || event.source_id > core::MAX_FERMENTERS) return;
+        uint8_t bit = 1u << (event.source_id - 1);
+        lock();
+        pending_alarms_ |= bit;
+        if (event.data.state) alarm_states_ |= bit;
+        else alarm_states_ &= ~bit;
+        unlock();
+    }
+
+    // Connection
+
+    void on_connected() {
+        stats_.connects++;
+        // Anything unacknowledged from the last session goes again, in order
+        for (auto& f : inflight_) f.active = false;
+        spool_.rewind();
+        client_->publish(status_topic_, "online", 6, 1, true);
+    }
+
+    void on_disconnected() {
+        for (auto& f : inflight_) f.active = false;
+    }
+
+    void on_ack(uint16_t msg_id) {
+        for (auto& f : inflight_) {
+            if (f.active && f.msg_id == msg_id) {
+                spool_.ack(f.offset);
+                f.active = false;
+                stats_.acked++;
+                return;
+            }
+        }
+        // Status message or a record already dropped: nothing to do
+    }
+
+    /**
+     * Resend timed-out messages, then fill free in-flight slots in order
+     */
+    void send(uint32_t now) {
+        for (auto& f : inflight_) {
+            if (!f.active) continue;
+            if (!spool_.contains(f.offset)) {
+                f.active = false;       // Dropped from a full spool
+                continue;
+            }
+            if (now - f.sent_ms < ACK_TIMEOUT_MS) continue;
+            spool_.read(f.offset, message_, send_buffer_);
+            if (!publish(f, now)) return;
+            stats_.retries++;
+        }
+
+        for (auto& f : inflight_) {
+            if (f.active) continue;
+            if (!spool_.next_unsent(message_, send_buffer_)) return;
+            f.offset = message_.offset;
+            if (!publish(f, now)) return;
+            spool_.mark_sent(f.offset);
+        }
+    }
+
+    bool publish(InFlight& f, uint32_t now) {
+        int id = client_->publish(message_.topic, send_buffer_, message_.len, 1,
+                                  message_.flags & MqttSpool::FLAG_RETAIN);
+        if (id <= 0) return false;     // Connection trouble; retried later
+        f.msg_id = (uint16_t)id;
+        f.sent_ms = now;
+        f.active = true;
+        stats_.published++;
+        return true;
+    }
+
+    // Formatting
+
+    /**
+     * Start a payload in payload_, opened with its timestamp
+     */
+    core::JsonWriter& begin_payload(uint32_t ts) {
+        sink_ = core::JsonBufferSink(payload_, sizeof(payload_));
+        json_.reset();
+        json_.begin_object().field("ts", (unsigned long)ts);
+        return json_;
+    }
+
+    /**
+     * Close the payload and spool it; a batch cut off by PAYLOAD_SIZE is
+     * counted, never sent
+     */
+    void spool(const char* leaf) {
+        json_.end_object();
+        if (!json_.finish()) {
+            stats_.truncated++;
+            return;
+        }
+        char name[MqttSpool::MAX_TOPIC];
+        topic(name, leaf);
+        if (spool_.push(name, payload_, sink_.length())) {
+            stats_.batches++;
+        } else {
+            stats_.dropped++;
+        }
+    }
+
+    void spool_alarms() {
+        lock();
+        uint8_t pending = pending_alarms_;
+        uint8_t states = alarm_states_;
+        pending_alarms_ = 0;
+        unlock();
+        if (pending == 0) return;
+
+        uint32_t ts = time_->get_unix_time();
+        for (uint8_t i = 0; i < core::MAX_FERMENTERS; i++) {
+            if (!(pending & (1u << i))) continue;
+            begin_payload(ts)
+                .field("fermenter", i + 1)
+                .field("active", ((states >> i) & 1u) != 0);
+            spool("alarms");
+        }
+    }
+
+    void spool_batch() {
+        lock();
+        uint32_t sensors = dirty_sensors_;
+        uint32_t relays = dirty_relays_;
+        dirty_sensors_ = 0;
+        dirty_relays_ = 0;
+        unlock();
+
+        uint32_t ts = time_->get_unix_time();
+        if (sensors) {
+            format_sensors(ts, sensors);
+            spool("sensors");
+        }
+        if (relays) {
+            format_relays(ts, relays);
+            spool("relays");
+        }
+        if (fermenters_changed()) {
+            format_fermenters(ts);
+            spool("fermenters");
+        }
+    }
+
+    /**
+     * Compare what format_fermenters() would publish with the last batch
+     * (the state generation also moves for sensors, relays and alarms)
+     */
+    bool fermenters_changed() {
+        bool changed = !fermenters_reported_;
+        fermenters_reported_ = true;
+        for (uint8_t i = 1; i <= core::MAX_FERMENTERS; i++) {
+            FermenterReport report = {};
+            auto* ferm = state_->get_fermenter(i);
+            if (ferm && ferm->id != 0) {
+                report.present = true;
+                report.mode = ferm->mode;
+                report.temp = (int32_t)lroundf(ferm->current_temp * 100.0f);
+                report.target_temp = (int32_t)lroundf(ferm->target_temp * 100.0f);
+                report.pressure = (int32_t)lroundf(ferm->current_pressure * 1000.0f);
+                report.target_pressure = (int32_t)lroundf(ferm->target_pressure * 1000.0f);
+                report.pid_output = (int32_t)lroundf(ferm->pid_output * 10.0f);
+            }
+            if (report != last_fermenters_[i - 1]) {
+                last_fermenters_[i - 1] = report;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    void format_sensors(uint32_t ts, uint32_t mask) {
+        core::JsonWriter& json = begin_payload(ts);
+        json.key("sensors").begin_array();
+        for (uint8_t id = 0; mask != 0; id++, mask >>= 1) {
+            if (!(mask & 1)) continue;
+            auto* sensor = state_->get_sensor_by_id(id);
+            core::SensorSnapshot snap;
+            if (!sensor || !state_->read_sensor(id, snap)) continue;
+            json.begin_object()
+                .field("id", (int)id)
+                .field("name", sensor->name)
+                .field("value", snap.filtered_value, 3)
+                .field("unit", sensor->unit)
+                .field("quality", quality_to_string(snap.quality))
+            .end_object();
+        }
+        json.end_array();
+    }
+
+    void format_relays(uint32_t ts, uint32_t mask) {
+        core::JsonWriter& json = begin_payload(ts);
+        json.key("relays").begin_array();
+        for (uint8_t id = 0; mask != 0; id++, mask >>= 1) {
+            if (!(mask & 1)) continue;
+            auto* relay = state_->get_relay_by_id(id);
+            core::RelaySnapshot snap;
+            if (!relay || !state_->read_relay(id, snap)) continue;
+            json.begin_object()
+                .field("id", (int)id)
+                .field("name", relay->name)
+                .field("state", snap.state)
+            .end_object();
+        }
+        json.end_array();
+    }
+
+    void format_fermenters(uint32_t ts) {
+        core::JsonWriter& json = begin_payload(ts);
+        json.key("fermenters").begin_array();
+        for (uint8_t i = 1; i <= core::MAX_FERMENTERS; i++) {
+            auto* ferm = state_->get_fermenter(i);
+            if (!ferm || ferm->id == 0) continue;
+            json.begin_object()
+                .field("id", (int)ferm->id)
+                .field("name", ferm->name)
+                .field("temp", ferm->current_temp, 2)
+                .field("target_temp", ferm->target_temp, 2)
+                .field("pressure", ferm->current_pressure, 3)
+                .field("target_pressure", ferm->target_pressure, 3)
+                .field("mode", mode_to_string(ferm->mode))
+                .field("pid_output", ferm->pid_output, 1)
+            .end_object();
+        }
+        json.end_array();
+    }
+
+    static const char* quality_to_string(core::SensorQuality q) {
+        switch (q) {
+            case core::SensorQuality::GOOD: return "GOOD";
+            case core::SensorQuality::BAD: return "BAD";
+            case core::SensorQuality::SUSPECT: return "SUSPECT";
+            case core::SensorQuality::WARMING_UP: return "WARMING_UP";
+            default: return "UNKNOWN";
+        }
+    }
+
+    static const char* mode_to_string(core::FermenterMode m) {
+        switch (m) {
+            case core::FermenterMode::OFF: return "OFF";
+            case core::FermenterMode::MANUAL: return "MANUAL";
+            case core::FermenterMode::PLAN: return "PLAN";
+            case core::FermenterMode::AUTOTUNE: return "AUTOTUNE";
+            default: return "UNKNOWN";
+        }
+    }
+};
+
+} // namespace modules
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef ESP32_BUILD
+#include "esp_heap_caps.h"
+#endif
+
+namespace modules {
+
+/**
+ * Bounded store-and-forward queue for outgoing MQTT messages
+ *
+ * Every message is spooled before it is published and stays until the
+ * broker acknowledges it (QoS 1 PUBACK), so messages produced while the
+ * broker is unreachable are replayed in order once it is back. When the
+ * spool is full the oldest messages are dropped and counted.
+ *
+ * Records are [u16 topic_len][u16 payload_len][u8 flags][u8 acked]
+ * [u16 reserved][topic][payload] in a byte ring with absolute offsets
+ * (wrapping u32); a record's offset identifies it while it is spooled.
+ * Records up to the send cursor have been published at least once.
+ *
+ * The ring lives in PSRAM when available. Not thread-safe: MqttPublisher
+ * only touches it from process().
+ */
+class MqttSpool {
+public:
+    static constexpr size_t RECORD_HEADER = 8;
+    static constexpr size_t MAX_TOPIC = 96;
+    static constexpr uint8_t FLAG_RETAIN = 0x01;
+
+    struct Message {
+        uint32_t offset;    // Record id while spooled
+        uint8_t flags;
+        size_t len;         // Payload bytes copied out
+        char topic[MAX_TOPIC];
+    };
+
+    MqttSpool()
+        : buf_(nullptr), capacity_(0), head_(0), tail_(0), send_(0),
+          count_(0), pushed_(0), dropped_(0) {}
+
+    ~MqttSpool() { release(); }
+
+    MqttSpool(const MqttSpool&) = delete;
+    MqttSpool& operator=(const MqttSpool&) = delete;
+
+    /**
+     * Allocate the ring (PSRAM first on the device)
+     * @param capacity Power of two
+     */
+    bool allocate(size_t capacity) {
+        release();
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0) return false;
+#ifdef ESP32_BUILD
+        buf_ = static_cast<uint8_t*>(heap_caps_malloc(capacity, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+        if (!buf_) buf_ = static_cast<uint8_t*>(heap_caps_malloc(capacity, MALLOC_CAP_8BIT));
+#else
+        buf_ = static_cast<uint8_t*>(malloc(capacity));
+#endif
+        if (!buf_) return false;
+        capacity_ = capacity;
+        head_ = tail_ = send_ = 0;
+        count_ = 0;
+        return true;
+    }
+
+    void release() {
+        if (!buf_) return;
+#ifdef ESP32_BUILD
+        heap_caps_free(buf_);
+#else
+        free(buf_);
+#endif
+        buf_ = nullptr;
+        capacity_ = 0;
+    }
+
+    /** Largest record (header + topic + payload) */
+    size_t max_record() const { return capacity_ / 4; }
+
+    /**
+     * Spool a message, dropping the oldest ones if full
+     * @return false if it does not fit max_record() or the topic is too long
+     */
+    bool push(const char* topic, const void* payload, size_t len, uint8_t flags = 0) {
+        size_t topic_len = topic ? strlen(topic) : 0;
+        if (!buf_ || topic_len == 0 || topic_len >= MAX_TOPIC || len > 0xFFFF) return false;
+        size_t record = RECORD_HEADER + topic_len + len;
+        if (record > max_record()) return false;
+
+        while (head_ + record - tail_ > capacity_) {
+            if (!is_acked(tail_)) dropped_++;
+            pop_tail();
+        }
+        uint8_t header[RECORD_HEADER] = {
+            (uint8_t)topic_len, (uint8_t)(topic_len >> 8),
+            (uint8_t)len, (uint8_t)(len >> 8), flags, 0, 0, 0
+        };
+        copy_in(head_, header, RECORD_HEADER);
+        copy_in(head_ + RECORD_HEADER, topic, topic_len);
+        copy_in(head_ + RECORD_HEADER + topic_len, payload, len);
+        head_ += record;
+        count_++;
+        pushed_++;
+        return true;
+    }
+
+    /** Record is still spooled (not acknowledged and not dropped) */
+    bool contains(uint32_t offset) const {
+        return head_ - offset <= head_ - tail_ && offset != head_ && !is_acked(offset);
+    }
+
+    /**
+     * Copy out a spooled record
+     * @param payload Buffer of at least max_record() bytes
+     */
+    bool read(uint32_t offset, Message& msg, uint8_t* payload) const {
+        if (!contains(offset)) return false;
+        size_t topic_len = u16(offset);
+        msg.offset = offset;
+        msg.len = u16(offset + 2);
+        msg.flags = buf_[(offset + 4) & mask()];
+        copy_out(offset + RECORD_HEADER, msg.topic, topic_len);
+        msg.topic[topic_len] = '\0';
+        copy_out(offset + RECORD_HEADER + topic_len, payload, msg.len);
+        return true;
+    }
+
+    /**
+     * Copy out the next record not yet published (skips acknowledged ones)
+     * mark_sent() moves past it once the client accepted it.
+     */
+    bool next_unsent(Message& msg, uint8_t* payload) {
+        while (send_ != head_ && is_acked(send_)) send_ = next(send_);
+        if (send_ == head_) return false;
+        return read(send_, msg, payload);
+    }
+
+    void mark_sent(uint32_t offset) {
+        if (offset == send_) send_ = next(send_);
+    }
+
+    /**
+     * Broker acknowledged the record; frees it and any acknowledged
+     * records behind it at the tail
+     */
+    void ack(uint32_t offset) {
+        if (!contains(offset)) return;
+        buf_[(offset + 5) & mask()] = 1;
+        while (tail_ != head_ && is_acked(tail_)) pop_tail();
+    }
+
+    /** Resend everything unacknowledged (after a reconnect) */
+    void rewind() { send_ = tail_; }
+
+    bool has_unsent() const { return send_ != head_; }
+    size_t bytes() const { return head_ - tail_; }
+    size_t capacity() const { return capacity_; }
+    /** Records spooled, including acknowledged ones not yet at the tail */
+    uint32_t count() const { return count_; }
+    uint32_t pushed() const { return pushed_; }
+    /** Unacknowledged messages dropped because the spool was full */
+    uint32_t dropped() const { return dropped_; }
+
+private:
+    uint8_t* buf_;
+    size_t capacity_;
+    uint32_t head_;     // Offset of the next record
+    uint32_t tail_;     // Oldest spooled record
+    uint32_t send_;     // Oldest record not yet published
+    uint32_t count_;
+    uint32_t pushed_;
+    uint32_t dropped_;
+
+    uint32_t mask() const { return (uint32_t)capacity_ - 1; }
+
+    size_t u16(uint32_t offset) const {
+        return buf_[offset & mask()] | (buf_[(offset + 1) & mask()] << 8);
+    }
+
+    bool is_acked(uint32_t offset) const { return buf_[(offset + 5) & mask()] != 0; }
+
+    uint32_t next(uint32_t offset) const {
+        return offset + RECORD_HEADER + u16(offset) + u16(offset + 2);
+    }
+
+    void pop_tail() {
+        tail_ = next(tail_);
+        if (head_ - send_ > head_ - tail_) send_ = tail_;   // Cursor was dropped
+        count_--;
+    }
+
+    void copy_in(uint32_t offset, const void* data, size_t len) {
+        size_t start = offset & mask();
+        size_t first = len < capacity_ - start ? len : capacity_ - start;
+        memcpy(buf_ + start, data, first);
+        memcpy(buf_, static_cast<const uint8_t*>(data) + first, len - first);
+    }
+
+    void copy_out(uint32_t offset, void* out, size_t len) const {
+        size_t start = offset & mask();
+        size_t first = len < capacity_ - start ? len : capacity_ - start;
+        memcpy(out, buf_ + start, first);
+        memcpy(static_cast<uint8_t*>(out) + first, buf_, len - first);
+    }
+};
+
+} // namespace modules
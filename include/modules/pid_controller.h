@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/fixed_point.h"
 #include <cstdint>
 
 namespace modules {
@@ -8,35 +9,73 @@ namespace modules {
  * PID Controller with back-calculation anti-windup
  * Standard PID algorithm with improved anti-windup using back-calculation
  * method to prevent integral accumulation when output saturates.
+ *
+ * Gains are in seconds: Ki is per second and Kd is in seconds, so the
+ * response does not change with the compute interval. Pass the elapsed
+ * time to compute(); the two-argument form assumes 1 s steps.
+ *
+ * The math runs in T (float or core::Q16_16); the interface is float.
+ * PIDController uses core::dsp_t. In Q16.16 keep |Kd * rate| and the
+ * output limits well below 32768.
  */
-class PIDController {
+template <typename T>
+class BasicPIDController {
 public:
-    PIDController(float kp = 2.0f, float ki = 0.1f, float kd = 1.0f)
-        : kp_(kp), ki_(ki), kd_(kd)
-        , output_min_(0.0f), output_max_(100.0f)
-        , integral_(0.0f), last_error_(0.0f)
-        , last_input_(0.0f), last_output_(0.0f)
-        , prev_saturation_error_(0.0f)
-        , tracking_gain_(1.0f)  // Back-calculation tracking gain (Kt = 1/Ti typically)
+    BasicPIDController(float kp = 2.0f, float ki = 0.1f, float kd = 1.0f)
+        : kp_(num(kp)), ki_(num(ki)), kd_(num(kd))
+        , output_min_(num(0.0f)), output_max_(num(100.0f))
+        , integral_(), last_error_()
+        , last_input_(), last_output_()
+        , prev_saturation_error_()
+        , tracking_gain_(num(1.0f))  // Back-calculation tracking gain (Kt = 1/Ti typically)
+        , derivative_tau_s_()
+        , input_rate_()
         , first_run_(true) {}
 
     /**
-     * Compute PID output
+     * Compute PID output for a 1 s step
      * @param setpoint Target value
      * @param input Current measured value
      * @return Control output (clamped to output_min..output_max)
      */
     float compute(float setpoint, float input) {
-        float error = setpoint - input;
+        return compute(setpoint, input, 1.0f);
+    }
+
+    /**
+     * Compute PID output
+     * @param setpoint Target value
+     * @param input Current measured value
+     * @param dt_s Time since the previous compute in seconds
+     * @return Control output (clamped to output_min..output_max)
+     */
+    float compute(float setpoint, float input, float dt_s) {
+        if (!(dt_s > 0.0f)) {
+            return core::dsp_to_float(last_output_);
+        }
+        return core::dsp_to_float(compute_value(num(setpoint), num(input), num(dt_s)));
+    }
+
+    /**
+     * compute() in the controller's own number type
+     */
+    T compute_value(T setpoint, T input, T dt_s) {
+        if (!(dt_s > T())) {
+            return last_output_;
+        }
+
+        T error = setpoint - input;
 
         // Proportional term
-        float p_term = kp_ * error;
+        T p_term = kp_ * error;
 
         // Integral term - accumulate BEFORE computing output
-        integral_ += ki_ * error;
+        integral_ += ki_ * error * dt_s;
 
         // Apply back-calculation correction from PREVIOUS iteration's saturation
-        // This prevents windup while maintaining immediate integral response
+        // This prevents windup while maintaining immediate integral response.
+        // Applied per step, not per second: scaling by a long dt would
+        // overshoot the correction.
         integral_ += prev_saturation_error_ * tracking_gain_;
 
         // Clamp integral to safety limits
@@ -47,16 +86,23 @@ public:
         }
 
         // Derivative term (on input to avoid derivative kick on setpoint change)
-        float d_term = 0;
+        // First-order low-pass on the input rate when a filter is set
+        T d_term = T();
         if (!first_run_) {
-            d_term = -kd_ * (input - last_input_);
+            T rate = (input - last_input_) / dt_s;
+            if (derivative_tau_s_ > T()) {
+                input_rate_ += (rate - input_rate_) * (dt_s / (derivative_tau_s_ + dt_s));
+            } else {
+                input_rate_ = rate;
+            }
+            d_term = -(kd_ * input_rate_);
         }
 
         // Calculate output
-        float output_unsaturated = p_term + integral_ + d_term;
+        T output_unsaturated = p_term + integral_ + d_term;
 
         // Clamp output to limits
-        float output = output_unsaturated;
+        T output = output_unsaturated;
         if (output > output_max_) {
             output = output_max_;
         } else if (output < output_min_) {
@@ -80,8 +126,8 @@ public:
      */
     void set_output_limits(float min, float max) {
         if (min >= max) return;
-        output_min_ = min;
-        output_max_ = max;
+        output_min_ = num(min);
+        output_max_ = num(max);
 
         // Clamp integral to new limits
         if (integral_ > output_max_) {
@@ -96,9 +142,9 @@ public:
      */
     void set_tunings(float kp, float ki, float kd) {
         if (kp < 0 || ki < 0 || kd < 0) return;
-        kp_ = kp;
-        ki_ = ki;
-        kd_ = kd;
+        kp_ = num(kp);
+        ki_ = num(ki);
+        kd_ = num(kd);
     }
 
     /**
@@ -107,7 +153,15 @@ public:
      * Typical range: 0.5 to 2.0 (default 1.0)
      */
     void set_tracking_gain(float kt) {
-        if (kt >= 0) tracking_gain_ = kt;
+        if (kt >= 0) tracking_gain_ = num(kt);
+    }
+
+    /**
+     * Set derivative filter time constant
+     * Low-passes the input rate before Kd is applied. 0 = unfiltered.
+     */
+    void set_derivative_filter(float tau_s) {
+        if (tau_s >= 0) derivative_tau_s_ = num(tau_s);
     }
 
     /**
@@ -115,11 +169,12 @@ public:
      * Call when switching modes or restarting control
      */
     void reset() {
-        integral_ = 0;
-        last_error_ = 0;
-        last_input_ = 0;
-        last_output_ = 0;
-        prev_saturation_error_ = 0;
+        integral_ = T();
+        last_error_ = T();
+        last_input_ = T();
+        last_output_ = T();
+        prev_saturation_error_ = T();
+        input_rate_ = T();
         first_run_ = true;
     }
 
@@ -128,10 +183,11 @@ public:
      * Useful for bumpless transfer when switching from manual to auto
      */
     void initialize(float output, float input) {
-        integral_ = output;
-        last_input_ = input;
-        last_output_ = output;
-        prev_saturation_error_ = 0;
+        integral_ = num(output);
+        last_input_ = num(input);
+        last_output_ = num(output);
+        prev_saturation_error_ = T();
+        input_rate_ = T();
         first_run_ = false;
 
         // Clamp integral to output limits
@@ -143,34 +199,140 @@ public:
     }
 
     // Getters
-    float get_kp() const { return kp_; }
-    float get_ki() const { return ki_; }
-    float get_kd() const { return kd_; }
-    float get_tracking_gain() const { return tracking_gain_; }
-    float get_output_min() const { return output_min_; }
-    float get_output_max() const { return output_max_; }
-    float get_integral() const { return integral_; }
-    float get_last_error() const { return last_error_; }
-    float get_last_output() const { return last_output_; }
+    float get_kp() const { return core::dsp_to_float(kp_); }
+    float get_ki() const { return core::dsp_to_float(ki_); }
+    float get_kd() const { return core::dsp_to_float(kd_); }
+    float get_tracking_gain() const { return core::dsp_to_float(tracking_gain_); }
+    float get_derivative_filter() const { return core::dsp_to_float(derivative_tau_s_); }
+    float get_output_min() const { return core::dsp_to_float(output_min_); }
+    float get_output_max() const { return core::dsp_to_float(output_max_); }
+    float get_integral() const { return core::dsp_to_float(integral_); }
+    float get_last_error() const { return core::dsp_to_float(last_error_); }
+    float get_last_output() const { return core::dsp_to_float(last_output_); }
 
 private:
     // Tuning parameters
-    float kp_;
-    float ki_;
-    float kd_;
+    T kp_;
+    T ki_;
+    T kd_;
 
     // Output limits
-    float output_min_;
-    float output_max_;
+    T output_min_;
+    T output_max_;
 
     // State
-    float integral_;
-    float last_error_;
-    float last_input_;
-    float last_output_;
-    float prev_saturation_error_;  // For back-calculation anti-windup
-    float tracking_gain_;  // Back-calculation anti-windup gain
+    T integral_;
+    T last_error_;
+    T last_input_;
+    T last_output_;
+    T prev_saturation_error_;  // For back-calculation anti-windup
+    T tracking_gain_;  // Back-calculation anti-windup gain
+    T derivative_tau_s_;  // Derivative filter time constant (0 = off)
+    T input_rate_;  // Filtered input rate for the derivative term
     bool first_run_;
+
+    static T num(float value) { return core::dsp_from_float<T>(value); }
+};
+
+using PIDController = BasicPIDController<core::dsp_t>;
+
+/**
+ * Per-loop PID compute timing
+ * Runs each loop at its own interval (calculation_interval_ms, or a
+ * per-fermenter override) independently of the control tick. Loop N of M
+ * is offset by N * interval / M so the loops do not all compute on the
+ * same tick. due() returns the measured time since the loop last ran.
+ */
+class PIDScheduler {
+public:
+    static constexpr uint8_t MAX_LOOPS = 8;
+
+    PIDScheduler() : loop_count_(0) {}
+
+    /**
+     * Set the number of loops and reset their timing
+     * Intervals default to 1000 ms until set_interval() is called.
+     */
+    void configure(uint8_t loop_count) {
+        loop_count_ = loop_count < MAX_LOOPS ? loop_count : MAX_LOOPS;
+        for (uint8_t i = 0; i < MAX_LOOPS; i++) {
+            loops_[i] = Loop();
+        }
+    }
+
+    void set_interval(uint8_t loop, uint32_t interval_ms) {
+        if (loop >= loop_count_ || interval_ms == 0) return;
+        loops_[loop].interval_ms = interval_ms;
+        loops_[loop].scheduled = false;
+    }
+
+    /**
+     * Check whether a loop should compute at now_ms
+     * @param dt_s Set to the seconds since the loop last ran. The first run
+     *             and runs after a stall longer than two intervals use the
+     *             nominal interval, so a pause cannot dump a large step
+     *             into the integral.
+     */
+    bool due(uint8_t loop, uint32_t now_ms, float& dt_s) {
+        if (loop >= loop_count_) return false;
+        Loop& l = loops_[loop];
+
+        if (!l.scheduled) {
+            l.scheduled = true;
+            l.next_ms = now_ms + get_phase_ms(loop);
+        }
+        if ((int32_t)(now_ms - l.next_ms) < 0) return false;
+
+        uint32_t elapsed = now_ms - l.last_run_ms;
+        if (l.run_count == 0 || elapsed > 2 * l.interval_ms) {
+            elapsed = l.interval_ms;
+        }
+        dt_s = elapsed / 1000.0f;
+
+        // Stay on the phase grid; resync if a whole interval was missed
+        l.next_ms += l.interval_ms;
+        if ((int32_t)(now_ms - l.next_ms) >= 0) {
+            l.next_ms = now_ms + l.interval_ms;
+        }
+        l.last_run_ms = now_ms;
+        l.run_count++;
+        return true;
+    }
+
+    /** Offset of a loop within its interval */
+    uint32_t get_phase_ms(uint8_t loop) const {
+        if (loop >= loop_count_) return 0;
+        return (uint32_t)((uint64_t)loops_[loop].interval_ms * loop / loop_count_);
+    }
+
+    uint32_t get_interval_ms(uint8_t loop) const {
+        return loop < loop_count_ ? loops_[loop].interval_ms : 0;
+    }
+
+    uint32_t get_run_count(uint8_t loop) const {
+        return loop < loop_count_ ? loops_[loop].run_count : 0;
+    }
+
+    uint8_t get_loop_count() const { return loop_count_; }
+
+private:
+    struct Loop {
+        uint32_t interval_ms;
+        uint32_t next_ms;
+        uint32_t last_run_ms;
+        uint32_t run_count;
+        bool scheduled;
+
+        Loop()
+            : interval_ms(1000)
+            , next_ms(0)
+            , last_run_ms(0)
+            , run_count(0)
+            , scheduled(false) {}
+    };
+
+    uint8_t loop_count_;
+    Loop loops_[MAX_LOOPS];
 };
 
 /**
@@ -0,0 +1,271 @@
+#pragma once
+
+#include "core/state_manager.h"
+#include "core/types.h"
+#include <cstdint>
+
+namespace modules {
+
+/**
+ * Minimum switching times for a relay type
+ */
+struct RelayTiming {
+    uint32_t min_on_ms;
+    uint32_t min_off_ms;
+};
+
+/**
+ * Time-proportioning output stage for relays
+ *
+ * Converts a 0-100% demand into ON time within a fixed window
+ * (PIDTimingConfig::output_cycle_time_ms). Example: 30% with a 60 s window
+ * = ON for 18 s, OFF for 42 s.
+ *
+ * The ON time of each window is planned at the window start and rounded to
+ * the control period, so edges land on control ticks. Windows whose ON or
+ * OFF part would be shorter than the relay type's minimum are rounded to
+ * fully OFF or fully ON. The rounding error is carried into the next
+ * window, so small demands still average out correctly (e.g. 5% on a
+ * solenoid with a 10 s minimum = 10 s ON every ~3.3 windows) instead of
+ * chattering or never switching.
+ *
+ * Call update() every control tick. The driver owns RelayState::state and
+ * RelayState::duty_cycle for the relays it drives.
+ */
+class TimeProportionalOutput {
+public:
+    static constexpr uint8_t RELAY_TYPE_COUNT = 4;
+
+    explicit TimeProportionalOutput(core::StateManager* state)
+        : state_(state)
+        , cycle_time_ms_(60000)
+        , tick_ms_(100) {
+        for (uint8_t t = 0; t < RELAY_TYPE_COUNT; t++) {
+            timing_[t] = default_timing((core::RelayType)t);
+        }
+    }
+
+    /**
+     * @param cycle_time_ms Window length (output_cycle_time_ms)
+     * @param control_period_ms Tick length; ON times are multiples of it
+     */
+    void configure(uint32_t cycle_time_ms, uint32_t control_period_ms) {
+        cycle_time_ms_ = cycle_time_ms > 0 ? cycle_time_ms : 60000;
+        tick_ms_ = control_period_ms > 0 ? control_period_ms : 1;
+    }
+
+    /**
+     * Defaults per relay type: solenoid valves chatter and wear below ~10 s,
+     * contactors (compressors, pumps) need longer rests, SSRs have no limit.
+     */
+    static RelayTiming default_timing(core::RelayType type) {
+        switch (type) {
+            case core::RelayType::SOLENOID_NC:
+            case core::RelayType::SOLENOID_NO:
+                return {10000, 10000};
+            case core::RelayType::CONTACTOR_COIL:
+                return {30000, 30000};
+            case core::RelayType::SSR:
+            default:
+                return {0, 0};
+        }
+    }
+
+    void set_timing(core::RelayType type, uint32_t min_on_ms, uint32_t min_off_ms) {
+        uint8_t t = (uint8_t)type;
+        if (t < RELAY_TYPE_COUNT) {
+            timing_[t] = {min_on_ms, min_off_ms};
+        }
+    }
+
+    RelayTiming get_timing(core::RelayType type) const {
+        uint8_t t = (uint8_t)type;
+        return t < RELAY_TYPE_COUNT ? timing_[t] : RelayTiming{0, 0};
+    }
+
+    /**
+     * Set demand (0-100%) and take control of the relay
+     * Takes effect at the next window start, or at the next tick when the
+     * relay was idle at 0%.
+     */
+    void set_duty(uint8_t relay_id, float percent) {
+        if (relay_id >= core::MAX_RELAYS) return;
+        if (percent < 0.0f) percent = 0.0f;
+        if (percent > 100.0f) percent = 100.0f;
+
+        Channel& ch = channels_[relay_id];
+        if (!ch.active) {
+            ch = Channel();
+            ch.active = true;
+        }
+        if (ch.duty <= 0.0f && percent > 0.0f && !ch.output) {
+            ch.restart = true;
+        }
+        ch.duty = percent;
+        state_->set_relay_duty_cycle(relay_id, percent);
+    }
+
+    /**
+     * Switch off immediately, ignoring min ON time (safety path)
+     * The relay stays driven at 0% until set_duty() raises it again.
+     * Idempotent: called every tick while a sensor is bad, so an already
+     * forced-off channel is left alone (no state write, and the minimum
+     * OFF time keeps counting from the real switch-off).
+     */
+    void force_off(uint8_t relay_id, uint32_t now_ms) {
+        if (relay_id >= core::MAX_RELAYS) return;
+        Channel& ch = channels_[relay_id];
+        auto* relay = state_->get_relay_by_id(relay_id);
+        if (ch.active && ch.started && ch.duty <= 0.0f && !ch.output &&
+            (!relay || (!relay->state && relay->duty_cycle <= 0.0f))) {
+            return;
+        }
+        bool was_on = ch.active && ch.output;
+
+        ch = Channel();
+        ch.active = true;
+        ch.started = true;
+        ch.window_start_ms = now_ms;
+        ch.last_edge_ms = now_ms;
+        state_->set_relay_duty_cycle(relay_id, 0.0f);
+
+        if (was_on || (relay && relay->state)) {
+            state_->set_relay_state(relay_id, false, now_ms);
+        }
+    }
+
+    /**
+     * Stop driving a relay; its current state is left as-is
+     */
+    void release(uint8_t relay_id) {
+        if (relay_id < core::MAX_RELAYS) {
+            channels_[relay_id].active = false;
+        }
+    }
+
+    bool is_active(uint8_t relay_id) const {
+        return relay_id < core::MAX_RELAYS && channels_[relay_id].active;
+    }
+
+    /**
+     * Advance all driven relays to now_ms (call every control tick)
+     */
+    void update(uint32_t now_ms) {
+        for (uint8_t id = 0; id < state_->get_relay_count(); id++) {
+            Channel& ch = channels_[id];
+            if (!ch.active) continue;
+
+            auto* relay = state_->get_relay_by_id(id);
+            if (!relay) continue;
+            RelayTiming timing = get_timing(relay->type);
+
+            if (!ch.started) {
+                ch.started = true;
+                ch.output = relay->state;
+                ch.last_edge_ms = now_ms - (ch.output ? timing.min_on_ms : timing.min_off_ms);
+                start_window(ch, now_ms, timing);
+            } else if (ch.restart) {
+                start_window(ch, now_ms, timing);
+            } else if (now_ms - ch.window_start_ms >= cycle_time_ms_) {
+                // Restart on the window grid; resync after a long stall
+                uint32_t next = ch.window_start_ms + cycle_time_ms_;
+                start_window(ch, (now_ms - next < cycle_time_ms_) ? next : now_ms, timing);
+            }
+
+            bool want = (now_ms - ch.window_start_ms) < ch.on_ms;
+            if (want == ch.output) continue;
+
+            // Hold the current state until its minimum time has elapsed
+            uint32_t held = now_ms - ch.last_edge_ms;
+            if (ch.output && held < timing.min_on_ms) continue;
+            if (!ch.output && held < timing.min_off_ms) continue;
+
+            ch.output = want;
+            ch.last_edge_ms = now_ms;
+            ch.switch_count++;
+            state_->set_relay_state(id, want, now_ms);
+        }
+    }
+
+    /** Planned ON time of the current window */
+    uint32_t get_on_time_ms(uint8_t relay_id) const {
+        return relay_id < core::MAX_RELAYS ? channels_[relay_id].on_ms : 0;
+    }
+
+    uint32_t get_switch_count(uint8_t relay_id) const {
+        return relay_id < core::MAX_RELAYS ? channels_[relay_id].switch_count : 0;
+    }
+
+    uint32_t get_cycle_time_ms() const { return cycle_time_ms_; }
+
+private:
+    struct Channel {
+        bool active;
+        bool started;
+        bool restart;               // Demand rose from 0%: start a window now
+        bool output;
+        float duty;
+        uint32_t window_start_ms;
+        uint32_t on_ms;
+        int32_t carry_ms;           // ON time owed (+) or overpaid (-) by earlier windows
+        uint32_t last_edge_ms;
+        uint32_t switch_count;
+
+        Channel()
+            : active(false)
+            , started(false)
+            , restart(false)
+            , output(false)
+            , duty(0.0f)
+            , window_start_ms(0)
+            , on_ms(0)
+            , carry_ms(0)
+            , last_edge_ms(0)
+            , switch_count(0) {}
+    };
+
+    core::StateManager* state_;
+    uint32_t cycle_time_ms_;
+    uint32_t tick_ms_;
+    RelayTiming timing_[RELAY_TYPE_COUNT];
+    Channel channels_[core::MAX_RELAYS];
+
+    /**
+     * Plan the ON time of a new window
+     */
+    void start_window(Channel& ch, uint32_t start_ms, const RelayTiming& timing) {
+        ch.window_start_ms = start_ms;
+        ch.restart = false;
+
+        int32_t cycle = (int32_t)cycle_time_ms_;
+        int32_t demand = (int32_t)(ch.duty * cycle / 100.0f) + ch.carry_ms;
+
+        int32_t on;
+        if (ch.duty <= 0.0f) {
+            on = 0;
+            demand = 0;
+        } else if (ch.duty >= 100.0f) {
+            on = cycle;
+            demand = cycle;
+        } else if (demand < (int32_t)timing.min_on_ms) {
+            on = 0;
+        } else if (cycle - demand < (int32_t)timing.min_off_ms) {
+            on = cycle;
+        } else {
+            // Round to whole control ticks
+            on = ((demand + (int32_t)tick_ms_ / 2) / (int32_t)tick_ms_) * (int32_t)tick_ms_;
+        }
+        if (on < 0) on = 0;
+        if (on > cycle) on = cycle;
+
+        // Carry is bounded to one window so a long saturated spell cannot
+        // build up a debt that lingers after the demand changes
+        int32_t carry = demand - on;
+        if (carry > cycle) carry = cycle;
+        if (carry < -cycle) carry = -cycle;
+        ch.carry_ms = carry;
+        ch.on_ms = (uint32_t)on;
+    }
+};
+
+} // namespace modules
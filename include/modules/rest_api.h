@@ -6,8 +6,10 @@
 #include "core/config_loader.h"
 #include "core/utils.h"
 #include "modules/fermentation_plan.h"
+#include "modules/route_table.h"
 #include <cstring>
 #include <cstdio>
+#include <iterator>
 
 namespace modules {
 
@@ -62,6 +64,44 @@ public:
         , plans_(plans)
         , config_(config) {}
 
+    /**
+     * Route identifiers for the REST table
+     */
+    enum class Route : uint8_t {
+        SENSORS,
+        SENSOR,
+        RELAYS,
+        RELAY_ON,
+        RELAY_OFF,
+        FERMENTERS,
+        FERMENTER,
+        START_PLAN,
+        GET_PLAN,
+        STOP_PLAN,
+        SETPOINT,
+        SYSTEM_STATUS,
+        CONFIG
+    };
+
+    static constexpr RouteDef<Route> ROUTES[] = {
+        {RouteMethod::GET,    "/sensors",                      Route::SENSORS},
+        {RouteMethod::GET,    "/sensors/{name}",               Route::SENSOR},
+        {RouteMethod::GET,    "/relays",                       Route::RELAYS},
+        {RouteMethod::POST,   "/relays/{name}/on",             Route::RELAY_ON},
+        {RouteMethod::POST,   "/relays/{name}/off",            Route::RELAY_OFF},
+        {RouteMethod::GET,    "/fermenters",                   Route::FERMENTERS},
+        {RouteMethod::GET,    "/fermenters/{id:int}",          Route::FERMENTER},
+        {RouteMethod::POST,   "/fermenters/{id:int}/plan",     Route::START_PLAN},
+        {RouteMethod::GET,    "/fermenters/{id:int}/plan",     Route::GET_PLAN},
+        {RouteMethod::DELETE, "/fermenters/{id:int}/plan",     Route::STOP_PLAN},
+        {RouteMethod::PUT,    "/fermenters/{id:int}/setpoint", Route::SETPOINT},
+        {RouteMethod::GET,    "/system/status",                Route::SYSTEM_STATUS},
+        {RouteMethod::GET,    "/config",                       Route::CONFIG},
+    };
+
+    static constexpr RouteTrie<Route, route_trie_nodes(ROUTES), std::size(ROUTES)> ROUTER{ROUTES};
+    static_assert(ROUTER.valid(), "REST route table is ambiguous");
+
     /**
      * Handle an API request
      * @param method HTTP method
@@ -71,99 +111,55 @@ public:
      */
     void handle_request(HttpMethod method, const char* path,
                        const char* body, HttpResponse& response) {
-        // Sensors
-        if (strcmp(path, "/sensors") == 0 && method == HttpMethod::GET) {
-            handle_get_sensors(response);
+        RouteMatch match;
+        Route route;
+        if (!ROUTER.match(1u << static_cast<int>(method), path, match, route)) {
+            response.set_error(404, "Endpoint not found");
             return;
         }
 
-        if (strncmp(path, "/sensors/", 9) == 0 && method == HttpMethod::GET) {
-            handle_get_sensor(path + 9, response);
-            return;
+        char name[core::MAX_NAME_LENGTH];
+        int ferm_id = static_cast<int>(match.get_int(0));
+
+        switch (route) {
+            case Route::SENSOR:
+            case Route::RELAY_ON:
+            case Route::RELAY_OFF:
+                if (!match.get_str(0, name, sizeof(name))) {
+                    response.set_error(404, route == Route::SENSOR ?
+                                       "Sensor not found" : "Relay not found");
+                    return;
+                }
+                break;
+            case Route::FERMENTER:
+            case Route::START_PLAN:
+            case Route::GET_PLAN:
+            case Route::STOP_PLAN:
+            case Route::SETPOINT:
+                if (ferm_id < 1 || ferm_id > 8) {
+                    response.set_error(404, "Fermenter not found");
+                    return;
+                }
+                break;
+            default:
+                break;
         }
 
-        // Relays
-        if (strcmp(path, "/relays") == 0 && method == HttpMethod::GET) {
-            handle_get_relays(response);
-            return;
-        }
-
-        if (strncmp(path, "/relays/", 8) == 0) {
-            const char* relay_path = path + 8;
-            if (strstr(relay_path, "/on") && method == HttpMethod::POST) {
-                char name[32];
-                core::safe_strncpy(name, relay_path, sizeof(name));
-                char* slash = strchr(name, '/');
-                if (slash) *slash = '\0';
-                handle_relay_on(name, response);
-                return;
-            }
-            if (strstr(relay_path, "/off") && method == HttpMethod::POST) {
-                char name[32];
-                core::safe_strncpy(name, relay_path, sizeof(name));
-                char* slash = strchr(name, '/');
-                if (slash) *slash = '\0';
-                handle_relay_off(name, response);
-                return;
-            }
+        switch (route) {
+            case Route::SENSORS:       handle_get_sensors(response); break;
+            case Route::SENSOR:        handle_get_sensor(name, response); break;
+            case Route::RELAYS:        handle_get_relays(response); break;
+            case Route::RELAY_ON:      handle_relay_on(name, response); break;
+            case Route::RELAY_OFF:     handle_relay_off(name, response); break;
+            case Route::FERMENTERS:    handle_get_fermenters(response); break;
+            case Route::FERMENTER:     handle_get_fermenter(ferm_id, response); break;
+            case Route::START_PLAN:    handle_start_plan(ferm_id, body, response); break;
+            case Route::GET_PLAN:      handle_get_plan(ferm_id, response); break;
+            case Route::STOP_PLAN:     handle_stop_plan(ferm_id, response); break;
+            case Route::SETPOINT:      handle_set_setpoint(ferm_id, body, response); break;
+            case Route::SYSTEM_STATUS: handle_get_system_status(response); break;
+            case Route::CONFIG:        handle_get_config(response); break;
         }
-
-        // Fermenters
-        if (strcmp(path, "/fermenters") == 0 && method == HttpMethod::GET) {
-            handle_get_fermenters(response);
-            return;
-        }
-
-        if (strncmp(path, "/fermenters/", 12) == 0) {
-            const char* ferm_path = path + 12;
-
-            // Extract fermenter ID
-            int ferm_id = atoi(ferm_path);
-            if (ferm_id < 1 || ferm_id > 8) {
-                response.set_error(404, "Fermenter not found");
-                return;
-            }
-
-            if (strstr(ferm_path, "/plan") && method == HttpMethod::POST) {
-                handle_start_plan(ferm_id, body, response);
-                return;
-            }
-
-            if (strstr(ferm_path, "/plan") && method == HttpMethod::GET) {
-                handle_get_plan(ferm_id, response);
-                return;
-            }
-
-            if (strstr(ferm_path, "/plan") && method == HttpMethod::DELETE) {
-                handle_stop_plan(ferm_id, response);
-                return;
-            }
-
-            if (strstr(ferm_path, "/setpoint") && method == HttpMethod::PUT) {
-                handle_set_setpoint(ferm_id, body, response);
-                return;
-            }
-
-            // Get single fermenter
-            if (method == HttpMethod::GET) {
-                handle_get_fermenter(ferm_id, response);
-                return;
-            }
-        }
-
-        // System
-        if (strcmp(path, "/system/status") == 0 && method == HttpMethod::GET) {
-            handle_get_system_status(response);
-            return;
-        }
-
-        if (strcmp(path, "/config") == 0 && method == HttpMethod::GET) {
-            handle_get_config(response);
-            return;
-        }
-
-        // Not found
-        response.set_error(404, "Endpoint not found");
     }
 
 private:
@@ -181,14 +177,15 @@ private:
         uint8_t count = state_->get_sensor_count();
         for (uint8_t i = 0; i < count; i++) {
             auto* sensor = state_->get_sensor_by_id(i);
-            if (!sensor) continue;
+            core::SensorSnapshot snap;
+            if (!sensor || !state_->read_sensor(i, snap)) continue;
 
             if (i > 0) core::safe_snprintf_append(json, sizeof(json), offset, ",");
 
             core::safe_snprintf_append(json, sizeof(json), offset,
                 "{\"name\":\"%s\",\"value\":%.2f,\"unit\":\"%s\",\"quality\":%d}",
-                sensor->name, sensor->filtered_value, sensor->unit,
-                static_cast<int>(sensor->quality));
+                sensor->name, snap.filtered_value, sensor->unit,
+                static_cast<int>(snap.quality));
         }
 
         core::safe_snprintf_append(json, sizeof(json), offset, "]}");
@@ -196,8 +193,10 @@ private:
     }
 
     void handle_get_sensor(const char* name, HttpResponse& response) {
-        auto* sensor = state_->get_sensor(name);
-        if (!sensor) {
+        uint8_t sensor_id = state_->get_sensor_id(name);
+        auto* sensor = state_->get_sensor_by_id(sensor_id);
+        core::SensorSnapshot snap;
+        if (!sensor || !state_->read_sensor(sensor_id, snap)) {
             response.set_error(404, "Sensor not found");
             return;
         }
@@ -206,9 +205,9 @@ private:
         snprintf(json, sizeof(json),
             "{\"name\":\"%s\",\"raw\":%.2f,\"filtered\":%.2f,\"display\":%.2f,"
             "\"unit\":\"%s\",\"quality\":%d,\"timestamp\":%lu}",
-            sensor->name, sensor->raw_value, sensor->filtered_value,
-            sensor->display_value, sensor->unit,
-            static_cast<int>(sensor->quality), (unsigned long)sensor->timestamp);
+            sensor->name, snap.raw_value, snap.filtered_value,
+            snap.display_value, sensor->unit,
+            static_cast<int>(snap.quality), (unsigned long)snap.timestamp);
 
         response.set_json(json);
     }
@@ -222,13 +221,14 @@ private:
         uint8_t count = state_->get_relay_count();
         for (uint8_t i = 0; i < count; i++) {
             auto* relay = state_->get_relay_by_id(i);
-            if (!relay) continue;
+            core::RelaySnapshot snap;
+            if (!relay || !state_->read_relay(i, snap)) continue;
 
             if (i > 0) core::safe_snprintf_append(json, sizeof(json), offset, ",");
 
             core::safe_snprintf_append(json, sizeof(json), offset,
                 "{\"name\":\"%s\",\"state\":%s,\"duty_cycle\":%.1f}",
-                relay->name, relay->state ? "true" : "false", relay->duty_cycle);
+                relay->name, snap.state ? "true" : "false", snap.duty_cycle);
         }
 
         core::safe_snprintf_append(json, sizeof(json), offset, "]}");
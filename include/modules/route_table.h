@@ -0,0 +1,353 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace modules {
+
+/**
+ * HTTP method bits for route tables
+ */
+struct RouteMethod {
+    static constexpr uint8_t GET = 0x01;
+    static constexpr uint8_t POST = 0x02;
+    static constexpr uint8_t PUT = 0x04;
+    static constexpr uint8_t DELETE = 0x08;
+
+    /** @return Method bit, 0 if unknown */
+    static uint8_t from_string(const char* method) {
+        if (!method) return 0;
+        if (strcmp(method, "GET") == 0) return GET;
+        if (strcmp(method, "POST") == 0) return POST;
+        if (strcmp(method, "PUT") == 0) return PUT;
+        if (strcmp(method, "DELETE") == 0) return DELETE;
+        return 0;
+    }
+};
+
+/**
+ * Path parameter types
+ * "{name}" matches one non-empty segment, "{name:int}" one of 1-9 digits.
+ * Parameter names only document the pattern; values are positional.
+ */
+enum class RouteParamType : uint8_t {
+    NONE = 0,
+    STR,
+    INT
+};
+
+/**
+ * One route table entry
+ * @tparam Id Handler identifier (usually an enum class) returned on match
+ */
+template <typename Id>
+struct RouteDef {
+    uint8_t methods;        // RouteMethod bits
+    const char* pattern;    // e.g. "/api/fermenter/{id:int}/plan"
+    Id id;
+};
+
+/**
+ * Path parameters and query of a matched request
+ * Strings point into the request path (not terminated).
+ */
+struct RouteMatch {
+    static constexpr int MAX_PARAMS = 3;
+
+    struct Param {
+        const char* str;
+        size_t len;
+        uint32_t value;     // INT parameters
+    };
+
+    Param params[MAX_PARAMS];
+    uint8_t count;
+    const char* query;      // After '?', nullptr if none
+    bool path_found;        // Path exists, but maybe not for this method
+
+    RouteMatch() : params{}, count(0), query(nullptr), path_found(false) {}
+
+    uint32_t get_int(int index) const {
+        return index < count ? params[index].value : 0;
+    }
+
+    /**
+     * Copy a parameter as a C string
+     * @return false if missing or it does not fit
+     */
+    bool get_str(int index, char* out, size_t size) const {
+        if (index >= count || params[index].len >= size) return false;
+        memcpy(out, params[index].str, params[index].len);
+        out[params[index].len] = '\0';
+        return true;
+    }
+
+    bool add(RouteParamType type, const char* str, size_t len) {
+        if (len == 0 || count == MAX_PARAMS) return false;
+        uint32_t value = 0;
+        if (type == RouteParamType::INT) {
+            if (len > 9) return false;
+            for (size_t i = 0; i < len; i++) {
+                if (str[i] < '0' || str[i] > '9') return false;
+                value = value * 10 + (uint32_t)(str[i] - '0');
+            }
+        }
+        params[count++] = {str, len, value};
+        return true;
+    }
+};
+
+/**
+ * One pattern token: a literal character or a whole "{...}" parameter
+ */
+struct RouteToken {
+    char ch;
+    RouteParamType param;
+    int length;             // Pattern characters consumed
+
+    static constexpr RouteToken at(const char* p) {
+        if (*p != '{') return {*p, RouteParamType::NONE, 1};
+        int n = 1;
+        int colon = 0;
+        while (p[n] != '\0' && p[n] != '}') {
+            if (p[n] == ':') colon = n;
+            n++;
+        }
+        bool is_int = colon != 0 && n - colon == 4 &&
+                      p[colon + 1] == 'i' && p[colon + 2] == 'n' && p[colon + 3] == 't';
+        return {'\0', is_int ? RouteParamType::INT : RouteParamType::STR,
+                p[n] == '}' ? n + 1 : n};
+    }
+
+    constexpr bool same(const RouteToken& other) const {
+        return ch == other.ch && param == other.param;
+    }
+};
+
+/** Patterns a and b share their first `tokens` tokens */
+constexpr bool route_same_prefix(const char* a, const char* b, int tokens) {
+    for (int i = 0; i < tokens; i++) {
+        if (*a == '\0' || *b == '\0') return false;
+        RouteToken ta = RouteToken::at(a);
+        RouteToken tb = RouteToken::at(b);
+        if (!ta.same(tb)) return false;
+        a += ta.length;
+        b += tb.length;
+    }
+    return true;
+}
+
+/**
+ * Number of trie nodes a route table needs (one per distinct token prefix)
+ */
+template <typename Id, size_t N>
+constexpr size_t route_trie_nodes(const RouteDef<Id> (&routes)[N]) {
+    size_t nodes = 1;   // Root
+    for (size_t r = 0; r < N; r++) {
+        int tokens = 0;
+        for (const char* p = routes[r].pattern; *p != '\0'; p += RouteToken::at(p).length) {
+            tokens++;
+            bool shared = false;
+            for (size_t q = 0; q < r && !shared; q++) {
+                shared = route_same_prefix(routes[q].pattern, routes[r].pattern, tokens);
+            }
+            if (!shared) nodes++;
+        }
+    }
+    return nodes;
+}
+
+/**
+ * Route table compiled into a character trie at build time
+ *
+ * Declared as a static constexpr from a RouteDef array, so the trie is
+ * built by the compiler and lives in flash:
+ *
+ *   static constexpr RouteDef<Api> ROUTES[] = {
+ *       {RouteMethod::GET, "/api/fermenter/{id:int}", Api::FERMENTER}, ...
+ *   };
+ *   static constexpr RouteTrie<Api, route_trie_nodes(ROUTES), std::size(ROUTES)>
+ *       ROUTER{ROUTES};
+ *   static_assert(ROUTER.valid(), "...");
+ *
+ * match() walks the path once, so routing is O(path length) regardless
+ * of the number of routes, and extracts typed parameters on the way.
+ * Chains of only-child literals (e.g. "/api/") are compared as one run.
+ * A query string ("?...") ends the path. Routing never backtracks, so a
+ * node's children are either literals or exactly one parameter;
+ * tables that break this (or repeat a pattern/method pair) are not
+ * valid().
+ */
+template <typename Id, size_t NODES, size_t ROUTES>
+class RouteTrie {
+public:
+    static_assert(ROUTES < 0xFF, "Too many routes");
+
+    constexpr explicit RouteTrie(const RouteDef<Id> (&routes)[ROUTES]) {
+        for (size_t n = 0; n < NODES; n++) {
+            nodes_[n] = {'\0', RouteParamType::NONE, -1, -1, -1, nullptr, nullptr, 0, -1};
+        }
+        for (size_t e = 0; e < ROUTES; e++) {
+            for (int m = 0; m < METHODS; m++) ends_[e][m] = NO_ROUTE;
+        }
+        used_ = 1;
+        for (size_t r = 0; r < ROUTES; r++) {
+            ids_[r] = routes[r].id;
+            insert(routes[r].pattern, routes[r].methods, (uint8_t)r);
+        }
+        for (size_t n = 0; n < used_; n++) compress(n);
+    }
+
+    constexpr bool valid() const { return valid_; }
+    constexpr size_t node_count() const { return used_; }
+
+    /**
+     * Route a request
+     * @param method RouteMethod bit
+     * @param id Receives the route's id on success
+     * @return false if no route matches (match.path_found tells whether
+     *         the path exists for another method)
+     */
+    bool match(uint8_t method, const char* path, RouteMatch& match, Id& id) const {
+        match = RouteMatch();
+        if (!path) return false;
+
+        int16_t node = 0;
+        const char* p = path;
+        while (*p != '\0' && *p != '?') {
+            const Node& current = nodes_[node];
+            if (current.run_len > 1) {
+                if (strncmp(p, current.run, current.run_len) != 0) return false;
+                p += current.run_len;
+                node = current.run_node;
+                continue;
+            }
+            int16_t child = current.child;
+            if (child >= 0 && nodes_[child].param != RouteParamType::NONE) {
+                const char* start = p;
+                while (*p != '\0' && *p != '/' && *p != '?') p++;
+                if (!match.add(nodes_[child].param, start, (size_t)(p - start))) return false;
+                node = child;
+                continue;
+            }
+            while (child >= 0 && nodes_[child].ch != *p) child = nodes_[child].sibling;
+            if (child < 0) return false;
+            node = child;
+            p++;
+        }
+        if (*p == '?') match.query = p + 1;
+
+        int16_t end = nodes_[node].end;
+        if (end < 0) return false;
+        match.path_found = true;
+
+        int index = method_index(method);
+        if (index < 0 || ends_[end][index] == NO_ROUTE) return false;
+        id = ids_[ends_[end][index]];
+        return true;
+    }
+
+private:
+    static constexpr int METHODS = 4;
+    static constexpr uint8_t NO_ROUTE = 0xFF;
+
+    struct Node {
+        char ch;                // Literal edge into this node
+        RouteParamType param;   // Or a parameter edge
+        int16_t child;          // First child
+        int16_t sibling;        // Next child of the parent
+        int16_t end;            // Row in ends_, -1 if no route ends here
+        const char* src;        // Pattern text of this edge
+        const char* run;        // Literal chain below this node, matched at once
+        uint8_t run_len;
+        int16_t run_node;       // Node at the end of the chain
+    };
+
+    Node nodes_[NODES] = {};
+    uint8_t ends_[ROUTES][METHODS] = {};    // Route index per method
+    Id ids_[ROUTES] = {};
+    size_t used_ = 0;
+    size_t end_count_ = 0;
+    bool valid_ = true;
+
+    static constexpr int method_index(uint8_t method) {
+        return method == RouteMethod::GET ? 0 :
+               method == RouteMethod::POST ? 1 :
+               method == RouteMethod::PUT ? 2 :
+               method == RouteMethod::DELETE ? 3 : -1;
+    }
+
+    constexpr void insert(const char* pattern, uint8_t methods, uint8_t route) {
+        int16_t node = 0;
+        for (const char* p = pattern; *p != '\0';) {
+            RouteToken token = RouteToken::at(p);
+            p += token.length;
+            bool is_param = token.param != RouteParamType::NONE;
+            if (token.ch == '?' || (is_param && *p != '\0' && *p != '/')) {
+                valid_ = false;     // Query in a pattern, or a parameter not a whole segment
+                return;
+            }
+
+            int16_t found = -1;
+            int16_t last = -1;
+            for (int16_t c = nodes_[node].child; c >= 0; c = nodes_[c].sibling) {
+                if (nodes_[c].ch == token.ch && nodes_[c].param == token.param) {
+                    found = c;
+                    break;
+                }
+                if (is_param || nodes_[c].param != RouteParamType::NONE) {
+                    valid_ = false;     // Parameter next to another child
+                    return;
+                }
+                last = c;
+            }
+            if (found < 0) {
+                if (used_ >= NODES) {
+                    valid_ = false;
+                    return;
+                }
+                found = (int16_t)used_++;
+                nodes_[found].ch = token.ch;
+                nodes_[found].param = token.param;
+                nodes_[found].src = p - token.length;
+                if (last < 0) nodes_[node].child = found;
+                else nodes_[last].sibling = found;
+            }
+            node = found;
+        }
+
+        if (nodes_[node].end < 0) nodes_[node].end = (int16_t)end_count_++;
+        uint8_t* end = ends_[nodes_[node].end];
+        for (int m = 0; m < METHODS; m++) {
+            if (!(methods & (1u << m))) continue;
+            if (end[m] != NO_ROUTE) valid_ = false;     // Duplicate route
+            end[m] = route;
+        }
+    }
+
+    /**
+     * Collapse the chain of only-child literal nodes below a node into
+     * one run. The chain's characters are contiguous in the pattern that
+     * created its last node.
+     */
+    constexpr void compress(size_t node) {
+        int16_t last = (int16_t)node;
+        uint8_t len = 0;
+        for (;;) {
+            int16_t child = nodes_[last].child;
+            if (child < 0 || nodes_[child].sibling >= 0 ||
+                nodes_[child].param != RouteParamType::NONE || len == 0xFF) break;
+            if (len > 0 && nodes_[last].end >= 0) break;    // A route ends inside
+            last = child;
+            len++;
+        }
+        if (len > 1) {
+            nodes_[node].run = nodes_[last].src - (len - 1);
+            nodes_[node].run_len = len;
+            nodes_[node].run_node = last;
+        }
+    }
+};
+
+} // namespace modules
@@ -83,7 +83,13 @@ public:
         for (uint8_t id = 1; id <= core::MAX_FERMENTERS; id++) {
             auto* ferm = state_->get_fermenter(id);
             if (ferm) {
+                const FermenterAlarmState& alarm = alarms_[core::fermenter_id_to_index(id)];
+                uint8_t before = alarm_flags(alarm);
                 check_fermenter(id, ferm, now);
+                // Alarms are part of the served state (ETag generation)
+                if (alarm_flags(alarm) != before) {
+                    state_->mark_changed(core::StateDomain::ALARMS);
+                }
             }
         }
     }
@@ -163,6 +169,7 @@ public:
             return;
         }
         alarms_[core::fermenter_id_to_index(fermenter_id)] = FermenterAlarmState();
+        state_->mark_changed(core::StateDomain::ALARMS);
     }
 
     /**
@@ -200,6 +207,11 @@ private:
 
     FermenterAlarmState alarms_[core::MAX_FERMENTERS];
 
+    static uint8_t alarm_flags(const FermenterAlarmState& alarm) {
+        return (alarm.temp_high_alarm ? 0x01 : 0) | (alarm.temp_low_alarm ? 0x02 : 0) |
+               (alarm.pressure_high_alarm ? 0x04 : 0) | (alarm.sensor_failure_alarm ? 0x08 : 0);
+    }
+
     void check_fermenter(uint8_t id, core::FermenterState* ferm, uint32_t now) {
         FermenterAlarmState& alarm = alarms_[core::fermenter_id_to_index(id)];
 
@@ -209,15 +221,11 @@ private:
             return;
         }
 
-        // Get sensor states
-        auto* temp_sensor = state_->get_sensor_by_id(ferm->temp_sensor_id);
-        auto* pressure_sensor = state_->get_sensor_by_id(ferm->pressure_sensor_id);
-
-        // Check sensor failures
-        bool temp_sensor_ok = temp_sensor &&
-                              temp_sensor->quality == core::SensorQuality::GOOD;
-        bool pressure_sensor_ok = pressure_sensor &&
-                                  pressure_sensor->quality == core::SensorQuality::GOOD;
+        // Check sensor failures (unmapped IDs read as UNKNOWN)
+        bool temp_sensor_ok =
+            state_->get_sensor_quality(ferm->temp_sensor_id) == core::SensorQuality::GOOD;
+        bool pressure_sensor_ok =
+            state_->get_sensor_quality(ferm->pressure_sensor_id) == core::SensorQuality::GOOD;
 
         if (!temp_sensor_ok || !pressure_sensor_ok) {
             if (!alarm.sensor_failure_alarm) {
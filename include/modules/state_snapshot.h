@@ -0,0 +1,230 @@
+#pragma once
+
+#include "core/state_manager.h"
+#include "core/types.h"
+#include "modules/safety_controller.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace modules {
+
+/**
+ * Compact binary state snapshot (fixed layout, version 1)
+ *
+ * Alternative to the JSON state document for high-frequency pollers and
+ * WebSocket clients: no float formatting or parsing, ~460 bytes at the
+ * configured limits. All multi-byte fields are little-endian, floats are
+ * IEEE-754 binary32.
+ *
+ *   Header (12 bytes)
+ *     0  'F' 'S'          magic
+ *     2  u8  version      SNAPSHOT_VERSION
+ *     3  u8  flags        bit0: delta (only changed records present)
+ *     4  u32 timestamp    milliseconds since boot
+ *     8  u8  sensors, u8 relays, u8 fermenters, u8 alarms (record counts)
+ *
+ *   Records follow in that section order:
+ *     sensor    (6)  u8 id, u8 quality (core::SensorQuality), f32 value
+ *     relay     (2)  u8 id, u8 state
+ *     fermenter (24) u8 id, u8 mode (core::FermenterMode), u8 flags
+ *                    (bit0: plan active), u8 current_step, f32 temp,
+ *                    f32 setpoint, f32 pressure, f32 pid_output,
+ *                    f32 hours_remaining
+ *     alarm     (2)  u8 fermenter id, u8 SNAPSHOT_ALARM_* bits
+ *
+ * Decoders must reject an unknown version; new fields bump it.
+ */
+constexpr uint8_t SNAPSHOT_VERSION = 1;
+constexpr uint8_t SNAPSHOT_FLAG_DELTA = 0x01;
+
+constexpr size_t SNAPSHOT_HEADER_SIZE = 12;
+constexpr size_t SNAPSHOT_SENSOR_SIZE = 6;
+constexpr size_t SNAPSHOT_RELAY_SIZE = 2;
+constexpr size_t SNAPSHOT_FERMENTER_SIZE = 24;
+constexpr size_t SNAPSHOT_ALARM_SIZE = 2;
+
+/** Largest full snapshot at the configured limits */
+constexpr size_t SNAPSHOT_MAX_SIZE = SNAPSHOT_HEADER_SIZE
+    + core::MAX_SENSORS * SNAPSHOT_SENSOR_SIZE
+    + core::MAX_RELAYS * SNAPSHOT_RELAY_SIZE
+    + core::MAX_FERMENTERS * (SNAPSHOT_FERMENTER_SIZE + SNAPSHOT_ALARM_SIZE);
+
+constexpr uint8_t SNAPSHOT_ALARM_TEMP_HIGH = 0x01;
+constexpr uint8_t SNAPSHOT_ALARM_TEMP_LOW = 0x02;
+constexpr uint8_t SNAPSHOT_ALARM_PRESSURE_HIGH = 0x04;
+constexpr uint8_t SNAPSHOT_ALARM_SENSOR_FAILURE = 0x08;
+constexpr uint8_t SNAPSHOT_ALARM_ACTIVE = 0x80;  // Set whenever any alarm is
+
+constexpr const char* SNAPSHOT_CONTENT_TYPE = "application/vnd.fermenter.snapshot";
+
+/**
+ * Serializes snapshot records into a caller-supplied buffer
+ * Records must be added in section order (sensors, relays, fermenters,
+ * alarms); an out-of-order record or a full buffer makes finish() return 0.
+ */
+class SnapshotWriter {
+public:
+    SnapshotWriter(uint8_t* buffer, size_t size, uint32_t timestamp_ms, uint8_t flags = 0)
+        : buf_(buffer)
+        , size_(size)
+        , len_(SNAPSHOT_HEADER_SIZE)
+        , section_(0)
+        , counts_{}
+        , failed_(!buffer || size < SNAPSHOT_HEADER_SIZE) {
+        if (failed_) return;
+        buf_[0] = 'F';
+        buf_[1] = 'S';
+        buf_[2] = SNAPSHOT_VERSION;
+        buf_[3] = flags;
+        put_u32(buf_ + 4, timestamp_ms);
+    }
+
+    bool add_sensor(uint8_t id, float value, core::SensorQuality quality) {
+        uint8_t* p = record(SECTION_SENSORS, SNAPSHOT_SENSOR_SIZE);
+        if (!p) return false;
+        p[0] = id;
+        p[1] = (uint8_t)quality;
+        put_f32(p + 2, value);
+        return true;
+    }
+
+    bool add_relay(uint8_t id, bool state) {
+        uint8_t* p = record(SECTION_RELAYS, SNAPSHOT_RELAY_SIZE);
+        if (!p) return false;
+        p[0] = id;
+        p[1] = state ? 1 : 0;
+        return true;
+    }
+
+    bool add_fermenter(const core::FermenterState& f) {
+        uint8_t* p = record(SECTION_FERMENTERS, SNAPSHOT_FERMENTER_SIZE);
+        if (!p) return false;
+        p[0] = f.id;
+        p[1] = (uint8_t)f.mode;
+        p[2] = f.plan_active ? 0x01 : 0x00;
+        p[3] = f.current_step;
+        put_f32(p + 4, f.current_temp);
+        put_f32(p + 8, f.target_temp);
+        put_f32(p + 12, f.current_pressure);
+        put_f32(p + 16, f.pid_output);
+        put_f32(p + 20, f.hours_remaining);
+        return true;
+    }
+
+    bool add_alarm(uint8_t fermenter_id, uint8_t bits) {
+        uint8_t* p = record(SECTION_ALARMS, SNAPSHOT_ALARM_SIZE);
+        if (!p) return false;
+        p[0] = fermenter_id;
+        p[1] = bits;
+        return true;
+    }
+
+    /**
+     * Write the record counts into the header
+     * @return Encoded length, or 0 if any record was rejected
+     */
+    size_t finish() {
+        if (failed_) return 0;
+        memcpy(buf_ + 8, counts_, sizeof(counts_));
+        return len_;
+    }
+
+    /** SNAPSHOT_ALARM_* bits for a fermenter (0 when nothing is active) */
+    static uint8_t alarm_bits(const FermenterAlarmState& alarm) {
+        uint8_t bits = 0;
+        if (alarm.temp_high_alarm) bits |= SNAPSHOT_ALARM_TEMP_HIGH;
+        if (alarm.temp_low_alarm) bits |= SNAPSHOT_ALARM_TEMP_LOW;
+        if (alarm.pressure_high_alarm) bits |= SNAPSHOT_ALARM_PRESSURE_HIGH;
+        if (alarm.sensor_failure_alarm) bits |= SNAPSHOT_ALARM_SENSOR_FAILURE;
+        if (bits) bits |= SNAPSHOT_ALARM_ACTIVE;
+        return bits;
+    }
+
+private:
+    enum Section : uint8_t {
+        SECTION_SENSORS = 0,
+        SECTION_RELAYS,
+        SECTION_FERMENTERS,
+        SECTION_ALARMS
+    };
+
+    uint8_t* buf_;
+    size_t size_;
+    size_t len_;
+    uint8_t section_;
+    uint8_t counts_[4];
+    bool failed_;
+
+    uint8_t* record(Section section, size_t record_size) {
+        if (failed_ || section < section_ || counts_[section] == UINT8_MAX ||
+            len_ + record_size > size_) {
+            failed_ = true;
+            return nullptr;
+        }
+        section_ = section;
+        counts_[section]++;
+        uint8_t* p = buf_ + len_;
+        len_ += record_size;
+        return p;
+    }
+
+    static void put_u32(uint8_t* p, uint32_t v) {
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+        p[2] = (uint8_t)(v >> 16);
+        p[3] = (uint8_t)(v >> 24);
+    }
+
+    static void put_f32(uint8_t* p, float v) {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        put_u32(p, bits);
+    }
+};
+
+/**
+ * Encode a full snapshot of the current state
+ * Sensor and relay values come from the seqlock snapshots (no state lock).
+ * @param safety Alarm source; nullptr omits the alarm section
+ * @return Encoded length, or 0 if the buffer is too small
+ */
+inline size_t encode_state_snapshot(core::StateManager& state, const SafetyController* safety,
+                                    uint32_t timestamp_ms, uint8_t* buffer, size_t size) {
+    SnapshotWriter out(buffer, size, timestamp_ms);
+
+    uint8_t sensor_count = state.get_sensor_count();
+    for (uint8_t i = 0; i < sensor_count; i++) {
+        core::SensorSnapshot snap;
+        if (state.read_sensor(i, snap)) {
+            out.add_sensor(i, snap.filtered_value, snap.quality);
+        }
+    }
+
+    uint8_t relay_count = state.get_relay_count();
+    for (uint8_t i = 0; i < relay_count; i++) {
+        core::RelaySnapshot snap;
+        if (state.read_relay(i, snap)) {
+            out.add_relay(i, snap.state);
+        }
+    }
+
+    for (uint8_t i = 1; i <= core::MAX_FERMENTERS; i++) {
+        auto* ferm = state.get_fermenter(i);
+        if (ferm && ferm->id != 0) {
+            out.add_fermenter(*ferm);
+        }
+    }
+
+    if (safety) {
+        for (uint8_t i = 1; i <= core::MAX_FERMENTERS; i++) {
+            auto* alarm = safety->get_alarm_state(i);
+            uint8_t bits = alarm ? SnapshotWriter::alarm_bits(*alarm) : 0;
+            if (bits) out.add_alarm(i, bits);
+        }
+    }
+
+    return out.finish();
+}
+
+} // namespace modules
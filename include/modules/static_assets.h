@@ -0,0 +1,495 @@
+#pragma once
+
+#include "modules/http_cache.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef ESP32_BUILD
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#else
+#include <mutex>
+#endif
+
+namespace modules {
+
+/**
+ * Precompressed static assets (admin UI)
+ *
+ * scripts/build_assets.py stages data/ for the filesystem image: every
+ * web asset gets a gzip sibling (<path>.gz, only when it is smaller) and a
+ * line in /assets.idx with its content hash. The server then answers from
+ * the manifest alone:
+ *
+ *   - Content-Encoding: gzip when the client accepts it (Vary: Accept-Encoding)
+ *   - ETag from the content hash, 304 on a matching If-None-Match
+ *   - Cache-Control: immutable for one year when the request carries the
+ *     current hash as ?v=<hash> (the pipeline rewrites local references in
+ *     HTML that way), no-cache otherwise so entry pages revalidate
+ *
+ * Files missing from the manifest (config.json, anything uploaded without
+ * the pipeline) are served as before, uncompressed and uncached.
+ */
+constexpr const char* ASSET_MANIFEST_FILE = "/assets.idx";
+constexpr const char* ASSET_MANIFEST_HEADER = "# assets v1";
+constexpr const char* ASSET_CACHE_IMMUTABLE = "public, max-age=31536000, immutable";
+constexpr const char* ASSET_CACHE_REVALIDATE = "no-cache";
+
+/** Hot cache size when PSRAM is present */
+constexpr size_t ASSET_CACHE_PSRAM_BUDGET = 512 * 1024;
+
+/**
+ * Hot cache size in internal RAM (boards without PSRAM)
+ * Single bodies may take half the budget, so this keeps the gzipped admin
+ * page (~19 KB) hot at the cost of that much heap that TLS could use.
+ */
+constexpr size_t ASSET_CACHE_INTERNAL_BUDGET = 40 * 1024;
+
+inline size_t asset_cache_budget(bool has_psram) {
+    return has_psram ? ASSET_CACHE_PSRAM_BUDGET : ASSET_CACHE_INTERNAL_BUDGET;
+}
+
+/**
+ * Content type by file extension (a trailing ".gz" is ignored)
+ */
+inline const char* asset_content_type(const char* path) {
+    static const struct {
+        const char* ext;
+        const char* type;
+    } TYPES[] = {
+        {".html", "text/html"},
+        {".htm",  "text/html"},
+        {".css",  "text/css"},
+        {".js",   "application/javascript"},
+        {".json", "application/json"},
+        {".svg",  "image/svg+xml"},
+        {".png",  "image/png"},
+        {".jpg",  "image/jpeg"},
+        {".ico",  "image/x-icon"},
+        {".woff2", "font/woff2"},
+        {".txt",  "text/plain"},
+    };
+
+    if (!path) return "text/plain";
+    size_t len = strlen(path);
+    if (len > 3 && strcmp(path + len - 3, ".gz") == 0) len -= 3;
+
+    for (const auto& t : TYPES) {
+        size_t ext_len = strlen(t.ext);
+        if (len > ext_len && strncmp(path + len - ext_len, t.ext, ext_len) == 0) {
+            return t.type;
+        }
+    }
+    return "text/plain";
+}
+
+/**
+ * @param accept_encoding Accept-Encoding header value (may be nullptr)
+ * @return true if it lists gzip (or *) without q=0
+ */
+inline bool accepts_gzip(const char* accept_encoding) {
+    if (!accept_encoding) return false;
+    const char* p = accept_encoding;
+    while (*p) {
+        while (*p == ' ' || *p == ',') p++;
+        const char* coding = p;
+        while (*p && *p != ';' && *p != ',' && *p != ' ') p++;
+        size_t coding_len = p - coding;
+
+        bool refused = false;
+        while (*p && *p != ',') {
+            if (p > accept_encoding && (p[-1] == ';' || p[-1] == ' ') &&
+                p[0] == 'q' && p[1] == '=') {
+                const char* q = p + 2;
+                refused = (*q == '0');
+                while (*q == '0' || *q == '.') q++;
+                if (*q >= '1' && *q <= '9') refused = false;
+            }
+            p++;
+        }
+
+        if (!refused && ((coding_len == 4 && strncmp(coding, "gzip", 4) == 0) ||
+                         (coding_len == 1 && coding[0] == '*'))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @param query Request query string without '?' (may be nullptr)
+ * @return true if it carries v=<hash>
+ */
+inline bool asset_version_matches(const char* query, const char* hash) {
+    if (!query || !hash || hash[0] == '\0') return false;
+    size_t hash_len = strlen(hash);
+    const char* p = query;
+    while (*p) {
+        const char* param = p;
+        while (*p && *p != '&') p++;
+        if (param[0] == 'v' && param[1] == '=' && (size_t)(p - param - 2) == hash_len &&
+            strncmp(param + 2, hash, hash_len) == 0) {
+            return true;
+        }
+        if (*p == '&') p++;
+    }
+    return false;
+}
+
+/**
+ * Asset list produced by the build pipeline
+ *
+ * Format: a "# assets v1" line, then one "<path> <hash> <size> <gz_size>"
+ * line per asset; gz_size 0 means no .gz sibling.
+ */
+class AssetManifest {
+public:
+    static constexpr int MAX_ASSETS = 32;
+    static constexpr size_t PATH_SIZE = 48;
+    static constexpr size_t HASH_SIZE = 17;
+
+    struct Entry {
+        char path[PATH_SIZE];   // URL path, e.g. "/admin/index.html"
+        char hash[HASH_SIZE];   // Hex content hash
+        uint32_t size;          // Uncompressed bytes
+        uint32_t gz_size;       // Bytes of <path>.gz, 0 if none
+    };
+
+    AssetManifest() : count_(0) {}
+
+    /**
+     * Replace the entries with a parsed manifest
+     * Malformed lines are skipped; a wrong header leaves the manifest empty.
+     * @return Number of entries loaded
+     */
+    int load(const char* text) {
+        count_ = 0;
+        if (!text) return 0;
+        size_t header_len = strlen(ASSET_MANIFEST_HEADER);
+        if (strncmp(text, ASSET_MANIFEST_HEADER, header_len) != 0 ||
+            (text[header_len] != '\n' && text[header_len] != '\r' && text[header_len] != '\0')) {
+            return 0;
+        }
+
+        const char* line = strchr(text, '\n');
+        while (line && count_ < MAX_ASSETS) {
+            line++;
+            const char* end = strchr(line, '\n');
+            size_t len = end ? (size_t)(end - line) : strlen(line);
+            parse_line(line, len);
+            line = end;
+        }
+        return count_;
+    }
+
+    /** @return Index of the asset, or -1 */
+    int find(const char* path) const {
+        if (!path) return -1;
+        for (int i = 0; i < count_; i++) {
+            if (strcmp(entries_[i].path, path) == 0) return i;
+        }
+        return -1;
+    }
+
+    int count() const { return count_; }
+    const Entry& entry(int index) const { return entries_[index]; }
+    void clear() { count_ = 0; }
+
+private:
+    Entry entries_[MAX_ASSETS];
+    int count_;
+
+    void parse_line(const char* line, size_t len) {
+        char buf[PATH_SIZE + HASH_SIZE + 32];
+        if (len == 0 || line[0] != '/' || len >= sizeof(buf)) return;
+        memcpy(buf, line, len);
+        buf[len] = '\0';
+
+        Entry& e = entries_[count_];
+        char path[PATH_SIZE];
+        char hash[HASH_SIZE];
+        unsigned long size = 0, gz_size = 0;
+        if (sscanf(buf, "%47s %16s %lu %lu", path, hash, &size, &gz_size) != 4) return;
+        memcpy(e.path, path, sizeof(path));
+        memcpy(e.hash, hash, sizeof(hash));
+        e.size = size;
+        e.gz_size = gz_size;
+        count_++;
+    }
+};
+
+/**
+ * How to answer a GET for a manifest asset
+ */
+struct AssetResponse {
+    int index;                          // Manifest index, -1 if not listed
+    int status;                         // 200 or 304
+    bool gzip;                          // Send <path>.gz with Content-Encoding
+    const char* cache_control;
+    char etag[AssetManifest::HASH_SIZE + 6];
+    char file[AssetManifest::PATH_SIZE + 4];  // Path relative to the fs base
+    uint32_t length;                    // Body bytes
+};
+
+/**
+ * Decide encoding, cache headers and 304 for a request
+ * @param path URL path without query
+ * @return false if the path is not in the manifest
+ */
+inline bool resolve_asset(const AssetManifest& manifest, const char* path, const char* query,
+                          const char* accept_encoding, const char* if_none_match,
+                          AssetResponse& out) {
+    out.index = manifest.find(path);
+    if (out.index < 0) return false;
+    const AssetManifest::Entry& e = manifest.entry(out.index);
+
+    out.gzip = e.gz_size > 0 && accepts_gzip(accept_encoding);
+    out.length = out.gzip ? e.gz_size : e.size;
+    snprintf(out.file, sizeof(out.file), "%s%s", e.path, out.gzip ? ".gz" : "");
+    // Strong ETags differ per encoding
+    snprintf(out.etag, sizeof(out.etag), "\"%s%s\"", e.hash, out.gzip ? "-gz" : "");
+    out.cache_control = asset_version_matches(query, e.hash) ? ASSET_CACHE_IMMUTABLE
+                                                             : ASSET_CACHE_REVALIDATE;
+    out.status = HttpCache::matches(if_none_match, out.etag) ? 304 : 200;
+    return true;
+}
+
+/**
+ * In-RAM cache of hot asset bodies (PSRAM on the device, a small internal
+ * RAM budget without it)
+ *
+ * Keeps whole files so a hit is one send with no filesystem access.
+ * Bounded by a byte budget with LRU eviction; bodies are pinned while a
+ * request sends them, so the HTTP and HTTPS server tasks can share it.
+ */
+class AssetCache {
+public:
+    static constexpr int MAX_ENTRIES = 16;
+
+    explicit AssetCache(size_t budget = 0)
+        : budget_(budget)
+        , used_(0)
+        , clock_(0)
+        , hits_(0)
+        , misses_(0)
+        , entries_{} {
+#ifdef ESP32_BUILD
+        mutex_ = xSemaphoreCreateMutex();
+#endif
+    }
+
+    ~AssetCache() {
+        clear();
+#ifdef ESP32_BUILD
+        if (mutex_) vSemaphoreDelete(mutex_);
+#endif
+    }
+
+    AssetCache(const AssetCache&) = delete;
+    AssetCache& operator=(const AssetCache&) = delete;
+
+    /** Cache key for a manifest asset and its encoding */
+    static uint16_t key(int index, bool gzip) {
+        return (uint16_t)(index * 2 + (gzip ? 1 : 0));
+    }
+
+    /** Change the budget, evicting unpinned bodies that no longer fit */
+    void set_budget(size_t bytes) {
+        lock();
+        budget_ = bytes;
+        while (used_ > budget_ && evict_lru()) {}
+        unlock();
+    }
+
+    /**
+     * Whether a body of this size would be cached
+     * Single bodies are limited to half the budget so one asset
+     * can't flush everything else.
+     */
+    bool admits(size_t len) const {
+        return len > 0 && len <= budget_ / 2;
+    }
+
+    /**
+     * Pin a cached body
+     * @return Body (release() when sent), or nullptr on a miss
+     */
+    const uint8_t* acquire(uint16_t key, size_t& len) {
+        lock();
+        const uint8_t* data = nullptr;
+        Entry* e = find(key);
+        if (e) {
+            e->pins++;
+            e->last_used = ++clock_;
+            len = e->len;
+            data = e->data;
+            hits_++;
+        } else {
+            misses_++;
+        }
+        unlock();
+        return data;
+    }
+
+    void release(const uint8_t* data) {
+        if (!data) return;
+        lock();
+        for (auto& e : entries_) {
+            if (e.data == data && e.pins > 0) {
+                e.pins--;
+                break;
+            }
+        }
+        unlock();
+    }
+
+    /**
+     * Store a body read by the caller (from alloc())
+     * On success the cache owns the buffer and it is pinned as by
+     * acquire(); on failure (no room, key already present) the caller
+     * keeps ownership and frees it with free_buffer().
+     */
+    bool insert(uint16_t key, uint8_t* data, size_t len) {
+        if (!data || !admits(len)) return false;
+        lock();
+        bool ok = find(key) == nullptr;
+        while (ok && used_ + len > budget_) {
+            ok = evict_lru();
+        }
+        Entry* slot = nullptr;
+        if (ok) {
+            slot = free_slot();
+            if (!slot && evict_lru()) slot = free_slot();
+        }
+        if (slot) {
+            slot->key = key;
+            slot->data = data;
+            slot->len = len;
+            slot->pins = 1;
+            slot->last_used = ++clock_;
+            used_ += len;
+        }
+        unlock();
+        return slot != nullptr;
+    }
+
+    /**
+     * Drop every body (manifest reload)
+     * Pinned bodies stay allocated until evicted but are no longer found.
+     */
+    void clear() {
+        lock();
+        for (auto& e : entries_) {
+            if (!e.data) continue;
+            if (e.pins == 0) drop(e);
+            else e.key = STALE_KEY;
+        }
+        unlock();
+    }
+
+    /**
+     * Buffer for insert(): PSRAM on the device, internal RAM only on boards
+     * without PSRAM (where the budget is ASSET_CACHE_INTERNAL_BUDGET)
+     */
+    static uint8_t* alloc(size_t len) {
+#ifdef ESP32_BUILD
+        uint32_t caps = heap_caps_get_total_size(MALLOC_CAP_SPIRAM) > 0 ? MALLOC_CAP_SPIRAM
+                                                                        : MALLOC_CAP_INTERNAL;
+        return static_cast<uint8_t*>(heap_caps_malloc(len, caps | MALLOC_CAP_8BIT));
+#else
+        return static_cast<uint8_t*>(malloc(len));
+#endif
+    }
+
+    static void free_buffer(uint8_t* data) {
+#ifdef ESP32_BUILD
+        heap_caps_free(data);
+#else
+        free(data);
+#endif
+    }
+
+    size_t budget() const { return budget_; }
+    size_t used() const { return used_; }
+    uint32_t hits() const { return hits_; }
+    uint32_t misses() const { return misses_; }
+
+private:
+    static constexpr uint16_t STALE_KEY = 0xFFFF;
+
+    struct Entry {
+        uint16_t key;
+        uint8_t* data;      // nullptr: slot free
+        size_t len;
+        uint16_t pins;
+        uint32_t last_used;
+    };
+
+    size_t budget_;
+    size_t used_;
+    uint32_t clock_;
+    uint32_t hits_;
+    uint32_t misses_;
+    Entry entries_[MAX_ENTRIES];
+#ifdef ESP32_BUILD
+    SemaphoreHandle_t mutex_;
+#else
+    std::mutex mutex_;
+#endif
+
+    void lock() {
+#ifdef ESP32_BUILD
+        xSemaphoreTake(mutex_, portMAX_DELAY);
+#else
+        mutex_.lock();
+#endif
+    }
+
+    void unlock() {
+#ifdef ESP32_BUILD
+        xSemaphoreGive(mutex_);
+#else
+        mutex_.unlock();
+#endif
+    }
+
+    Entry* find(uint16_t key) {
+        for (auto& e : entries_) {
+            if (e.data && e.key == key) return &e;
+        }
+        return nullptr;
+    }
+
+    Entry* free_slot() {
+        for (auto& e : entries_) {
+            if (!e.data) return &e;
+        }
+        return nullptr;
+    }
+
+    /** @return false if every body is pinned (or none cached) */
+    bool evict_lru() {
+        Entry* victim = nullptr;
+        for (auto& e : entries_) {
+            if (e.data && e.pins == 0 && (!victim || e.last_used < victim->last_used)) {
+                victim = &e;
+            }
+        }
+        if (!victim) return false;
+        drop(*victim);
+        return true;
+    }
+
+    void drop(Entry& e) {
+        free_buffer(e.data);
+        used_ -= e.len;
+        e.data = nullptr;
+        e.len = 0;
+    }
+};
+
+} // namespace modules
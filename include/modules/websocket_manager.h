@@ -3,9 +3,12 @@
 #include "core/state_manager.h"
 #include "core/event_bus.h"
 #include "core/types.h"
+#include "modules/state_snapshot.h"
+#include "modules/ws_delta_aggregator.h"
+#include "modules/ws_subscription.h"
+#include "modules/ws_broadcast_log.h"
 #include <cstring>
 #include <cstdio>
-#include <cmath>
 
 #ifdef ESP32_BUILD
 #include "esp_http_server.h"
@@ -13,6 +16,7 @@
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/task.h"
 #endif
 
 namespace modules {
@@ -21,16 +25,42 @@ namespace modules {
  * WebSocket Manager for real-time push updates
  * Supports event-driven updates (only sends on value changes)
  * Falls back gracefully when WebSocket is unavailable
+ *
+ * Clients that authenticate with "binary":true additionally receive
+ * updates as binary snapshot frames (state_snapshot.h) instead of the
+ * per-item JSON messages; control messages stay JSON.
+ *
+ * Updates are not sent from the EventBus callbacks. They are appended once
+ * to a shared log (ws_broadcast_log.h) and a sender task drains it per
+ * client, so a slow WiFi client never blocks the MODBUS path and publishing
+ * does not get slower with more clients. Sensor/relay deltas go to a log
+ * that drops the oldest entries for a lagging client and then resyncs it
+ * with one full-state message. Alarms have their own log; a client that
+ * falls behind on it gets the current alarm state of every fermenter.
+ *
+ * Sensor samples and relay changes are coalesced (ws_delta_aggregator.h):
+ * at most one "update" message (and one binary delta) per update interval
+ * carries every item that moved by more than its deadband.
+ *
+ * Clients receive everything until they send a subscribe message
+ * (ws_subscription.h). Queued messages then carry the client slots they
+ * are for, and clients skip the rest without copying them.
  */
 class WebSocketManager {
 public:
-    static constexpr int MAX_WS_CLIENTS = 4;
+    static constexpr int MAX_WS_CLIENTS = 8;
     static constexpr uint32_t PING_INTERVAL_MS = 30000;
     static constexpr uint32_t CLIENT_TIMEOUT_MS = 60000;
-    static constexpr float SENSOR_CHANGE_THRESHOLD = 0.01f;
     static constexpr size_t MAX_TX_BUFFER = 512;
     static constexpr int MAX_SENSORS = 32;
     static constexpr int MAX_RELAYS = 24;
+    static constexpr size_t UPDATE_LOG_SIZE = 8192;     // Sensor/relay deltas, all clients
+    static constexpr size_t ALARM_LOG_SIZE = 1024;
+    static constexpr int TX_BATCH = 16;                 // Messages per client per round
+    static constexpr uint32_t TX_TASK_STACK = 8192;  // Full-state resync formats on it
+    static constexpr uint8_t MSG_EVERYONE = 0x02;       // Text for binary clients too
+    static constexpr size_t UPDATE_JSON_SIZE = 1024;    // Larger batches split into several
+    static_assert(MAX_WS_CLIENTS <= 8, "Log audience holds one bit per client slot");
 
     struct WsClient {
         int fd;
@@ -44,10 +74,15 @@ public:
         uint32_t last_ping;
         bool authenticated;
         bool active;
+        bool binary;            // Updates as binary snapshot frames
+        uint32_t update_cursor; // Read positions in the shared logs
+        uint32_t alarm_cursor;
+        WsSubscription subs;    // Default: everything
 
         WsClient() : fd(-1), handle(nullptr), session_token{},
                      last_activity(0), last_ping(0),
-                     authenticated(false), active(false) {}
+                     authenticated(false), active(false), binary(false),
+                     update_cursor(0), alarm_cursor(0), subs() {}
     };
 
     using SessionValidator = bool(*)(const char* token, void* user_ctx);
@@ -57,13 +92,17 @@ public:
         , events_(nullptr)
         , session_validator_(nullptr)
         , validator_ctx_(nullptr)
+        , safety_(nullptr)
         , sensor_sub_id_(-1)
         , relay_sub_id_(-1)
         , alarm_sub_id_(-1)
         , initialized_(false)
-        , client_count_(0) {
-        memset(last_sensor_values_, 0, sizeof(last_sensor_values_));
-        memset(last_relay_states_, 0, sizeof(last_relay_states_));
+        , client_count_(0)
+#ifdef ESP32_BUILD
+        , tx_task_(nullptr)
+        , tx_running_(false)
+#endif
+    {
 #ifdef ESP32_BUILD
         mutex_ = xSemaphoreCreateMutex();
 #endif
@@ -94,6 +133,7 @@ public:
         state_ = state;
         events_ = events;
         server_ = server;
+        refresh_deadbands();
 
         // Register WebSocket URI handler
         httpd_uri_t ws_uri = {
@@ -113,14 +153,22 @@ public:
         }
 
         // Subscribe to EventBus for real-time updates
-        sensor_sub_id_ = events_->subscribe(core::EventType::SENSOR_UPDATE,
-            [this](const core::Event& e) { on_sensor_update(e); });
+        sensor_sub_id_ = events_->subscribe(core::EventType::SENSORS_UPDATED,
+            [](const core::Event& e, void* ctx) { static_cast<WebSocketManager*>(ctx)->on_sensors_updated(e); }, this);
 
         relay_sub_id_ = events_->subscribe(core::EventType::RELAY_CHANGE,
-            [this](const core::Event& e) { on_relay_change(e); });
+            [](const core::Event& e, void* ctx) { static_cast<WebSocketManager*>(ctx)->on_relay_change(e); }, this);
 
         alarm_sub_id_ = events_->subscribe(core::EventType::ALARM,
-            [this](const core::Event& e) { on_alarm(e); });
+            [](const core::Event& e, void* ctx) { static_cast<WebSocketManager*>(ctx)->on_alarm(e); }, this);
+
+        tx_running_ = true;
+        if (xTaskCreate(tx_task, "ws_tx", TX_TASK_STACK, this, 2, &tx_task_) != pdPASS) {
+            ESP_LOGE("WS", "Failed to create sender task");
+            tx_running_ = false;
+            tx_task_ = nullptr;
+            return false;
+        }
 
         initialized_ = true;
         ESP_LOGI("WS", "WebSocket manager initialized (max %d clients)", MAX_WS_CLIENTS);
@@ -136,6 +184,24 @@ public:
         validator_ctx_ = ctx;
     }
 
+    /**
+     * Minimum time between batched sensor/relay updates
+     * From DisplayConfig::update_interval_ms; 0 sends on every change.
+     */
+    void set_update_interval(uint32_t interval_ms) {
+        lock();
+        aggregator_.set_interval(interval_ms);
+        unlock();
+    }
+
+    /**
+     * Set alarm source for binary snapshots
+     * Without it, alarm records only carry SNAPSHOT_ALARM_ACTIVE.
+     */
+    void set_safety_controller(const SafetyController* safety) {
+        safety_ = safety;
+    }
+
     /**
      * Stop WebSocket manager and disconnect all clients
      */
@@ -149,6 +215,13 @@ public:
             if (alarm_sub_id_ >= 0) events_->unsubscribe(alarm_sub_id_);
         }
 
+        // Sender task clears tx_task_ before it exits
+        tx_running_ = false;
+        if (tx_task_) xTaskNotifyGive(tx_task_);
+        for (int i = 0; i < 20 && tx_task_; i++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+
         // Close all client connections
         lock();
         for (int i = 0; i < MAX_WS_CLIENTS; i++) {
@@ -188,6 +261,9 @@ public:
                 clients_[i].last_ping = now;
             }
         }
+
+        // Changes that arrived after the last batch, with no sample since
+        if (aggregator_.due(now)) flush_deltas(now);
         unlock();
     }
 
@@ -209,6 +285,19 @@ public:
         return MAX_WS_CLIENTS;
     }
 
+    /**
+     * Times a lagging client was resynced instead of sent its backlog
+     */
+    uint32_t get_overruns() const {
+        return updates_.overruns() + alarms_.overruns();
+    }
+
+    /**
+     * Sensor samples/relay changes seen and batched frames sent
+     */
+    uint32_t get_delta_samples() const { return aggregator_.samples(); }
+    uint32_t get_delta_frames() const { return aggregator_.frames(); }
+
     /**
      * Check if WebSocket manager is initialized
      */
@@ -230,8 +319,9 @@ public:
         for (int i = 0; i < MAX_WS_CLIENTS; i++) {
             if (clients_[i].active && clients_[i].authenticated) {
                 uint32_t age_ms = now - clients_[i].last_activity;
-                snprintf(buf, sizeof(buf), "[%d] fd=%d session=%.8s... last=%lums",
-                         i, clients_[i].fd, clients_[i].session_token, (unsigned long)age_ms);
+                snprintf(buf, sizeof(buf), "[%d] fd=%d session=%.8s... last=%lums queued=%uB",
+                         i, clients_[i].fd, clients_[i].session_token, (unsigned long)age_ms,
+                         (unsigned)updates_.backlog(clients_[i].update_cursor));
                 callback(buf);
             }
         }
@@ -242,13 +332,7 @@ public:
      */
     void broadcast_text(const char* message) {
         if (!initialized_ || !message) return;
-        lock();
-        for (int i = 0; i < MAX_WS_CLIENTS; i++) {
-            if (clients_[i].active && clients_[i].authenticated) {
-                send_text(clients_[i].fd, clients_[i].handle, message);
-            }
-        }
-        unlock();
+        publish(updates_, message, strlen(message), MSG_EVERYONE);
     }
 
     /**
@@ -315,6 +399,7 @@ private:
     httpd_handle_t server_;
     SessionValidator session_validator_;
     void* validator_ctx_;
+    const SafetyController* safety_;
 
     // Subscriptions
     int sensor_sub_id_;
@@ -327,9 +412,18 @@ private:
     int client_count_;
     SemaphoreHandle_t mutex_;
 
-    // Change detection
-    float last_sensor_values_[MAX_SENSORS];
-    bool last_relay_states_[MAX_RELAYS];
+    // Outbound queues (drained by the sender task)
+    WsBroadcastLog<UPDATE_LOG_SIZE> updates_;
+    WsBroadcastLog<ALARM_LOG_SIZE> alarms_;
+    TaskHandle_t tx_task_;
+    volatile bool tx_running_;
+    uint8_t tx_buffer_[WsBroadcastLog<UPDATE_LOG_SIZE>::MAX_MESSAGE + 1];  // Sender task only
+
+    // Change coalescing (under mutex_)
+    WsDeltaAggregator aggregator_;
+    char update_json_[UPDATE_JSON_SIZE];
+    uint8_t update_frame_[SNAPSHOT_HEADER_SIZE + MAX_SENSORS * SNAPSHOT_SENSOR_SIZE +
+                          MAX_RELAYS * SNAPSHOT_RELAY_SIZE];
 
     void lock() {
         if (mutex_) xSemaphoreTake(mutex_, portMAX_DELAY);
@@ -351,11 +445,20 @@ private:
         ESP_LOGD("WS", "Received from fd %d: %s", fd, payload);
 
         // Parse message type
-        // Expected format: {"type":"auth","token":"..."}
+        // Expected format: {"type":"auth","token":"...","binary":true}
         const char* type_start = strstr(payload, "\"type\"");
         if (!type_start) return;
 
-        if (strstr(payload, "\"auth\"")) {
+        if (strstr(payload, "\"subscribe\"")) {
+            if (is_authenticated_fd(fd)) {
+                subscribe_client(fd, req->handle, WsSubscription::parse(payload, state_));
+            }
+        } else if (strstr(payload, "\"snapshot\"")) {
+            // Full binary snapshot on request (fermenters have no events)
+            if (is_authenticated_fd(fd)) {
+                send_snapshot(fd, req->handle);
+            }
+        } else if (strstr(payload, "\"auth\"")) {
             // Authentication message
             const char* token_start = strstr(payload, "\"token\"");
             if (token_start) {
@@ -369,9 +472,12 @@ private:
                         memcpy(token, token_start, len);
                         token[len] = '\0';
 
-                        if (authenticate_client(fd, req->handle, token)) {
+                        bool binary = strstr(payload, "\"binary\":true") != nullptr;
+                        if (authenticate_client(fd, req->handle, token, binary)) {
                             send_text(fd, req->handle, "{\"type\":\"auth_ok\"}");
+                            // JSON full state carries names/units for both kinds
                             send_full_state(fd, req->handle);
+                            if (binary) send_snapshot(fd, req->handle);
                         } else {
                             send_text(fd, req->handle, "{\"type\":\"auth_failed\"}");
                         }
@@ -397,6 +503,8 @@ private:
                 clients_[i].last_ping = clients_[i].last_activity;
                 clients_[i].authenticated = false;
                 clients_[i].active = true;
+                clients_[i].binary = false;
+                clients_[i].subs = WsSubscription();
                 client_count_++;
                 unlock();
 
@@ -434,6 +542,7 @@ private:
         ESP_LOGI("WS", "Client removed: fd=%d", clients_[index].fd);
         clients_[index].active = false;
         clients_[index].authenticated = false;
+        clients_[index].binary = false;
         clients_[index].fd = -1;
         client_count_--;
     }
@@ -452,10 +561,47 @@ private:
         unlock();
     }
 
+    /**
+     * Check whether the client on fd has authenticated
+     */
+    bool is_authenticated_fd(int fd) {
+        bool result = false;
+        lock();
+        for (int i = 0; i < MAX_WS_CLIENTS; i++) {
+            if (clients_[i].active && clients_[i].fd == fd) {
+                result = clients_[i].authenticated;
+                break;
+            }
+        }
+        unlock();
+        return result;
+    }
+
+    /**
+     * Replace a client's subscription and confirm it with the masks in use
+     */
+    void subscribe_client(int fd, httpd_handle_t handle, const WsSubscription& subs) {
+        lock();
+        for (int i = 0; i < MAX_WS_CLIENTS; i++) {
+            if (clients_[i].active && clients_[i].fd == fd) {
+                clients_[i].subs = subs;
+                break;
+            }
+        }
+        unlock();
+
+        char buffer[128];
+        snprintf(buffer, sizeof(buffer),
+            "{\"type\":\"subscribed\",\"sensors\":%lu,\"relays\":%lu,\"fermenters\":%u}",
+            (unsigned long)subs.sensors, (unsigned long)subs.relays, (unsigned)subs.fermenters);
+        send_text(fd, handle, buffer);
+    }
+
     /**
      * Authenticate client with session token
+     * @param binary Client wants binary snapshot frames for updates
      */
-    bool authenticate_client(int fd, httpd_handle_t handle, const char* token) {
+    bool authenticate_client(int fd, httpd_handle_t handle, const char* token, bool binary) {
         // Validate token using callback
         if (session_validator_ && !session_validator_(token, validator_ctx_)) {
             ESP_LOGW("WS", "Invalid session token from fd %d", fd);
@@ -482,6 +628,7 @@ private:
                     clients_[i].active = true;
                     clients_[i].last_activity = xTaskGetTickCount() * portTICK_PERIOD_MS;
                     clients_[i].last_ping = clients_[i].last_activity;
+                    clients_[i].subs = WsSubscription();
                     client_count_++;
                     break;
                 }
@@ -497,6 +644,10 @@ private:
         strncpy(clients_[slot].session_token, token, 64);
         clients_[slot].session_token[64] = '\0';
         clients_[slot].authenticated = true;
+        clients_[slot].binary = binary;
+        // Queued updates start after the full state sent on auth_ok
+        clients_[slot].update_cursor = updates_.head();
+        clients_[slot].alarm_cursor = alarms_.head();
         unlock();
 
         ESP_LOGI("WS", "Client authenticated: fd=%d", fd);
@@ -504,21 +655,47 @@ private:
     }
 
     /**
-     * Send text message to specific client
+     * Send one frame to specific client
      */
-    void send_text(int fd, httpd_handle_t handle, const char* text) {
+    esp_err_t send_frame(int fd, httpd_handle_t handle, httpd_ws_type_t type,
+                         const uint8_t* data, size_t len) {
         httpd_ws_frame_t frame = {
             .final = true,
             .fragmented = false,
-            .type = HTTPD_WS_TYPE_TEXT,
-            .payload = (uint8_t*)text,
-            .len = strlen(text)
+            .type = type,
+            .payload = (uint8_t*)data,
+            .len = len
         };
 
         esp_err_t ret = httpd_ws_send_frame_async(handle, fd, &frame);
         if (ret != ESP_OK) {
             ESP_LOGW("WS", "Failed to send to fd %d: %s", fd, esp_err_to_name(ret));
         }
+        return ret;
+    }
+
+    /**
+     * Send text message to specific client
+     */
+    void send_text(int fd, httpd_handle_t handle, const char* text) {
+        send_frame(fd, handle, HTTPD_WS_TYPE_TEXT, (const uint8_t*)text, strlen(text));
+    }
+
+    /**
+     * Send binary message to specific client
+     */
+    void send_binary(int fd, httpd_handle_t handle, const uint8_t* data, size_t len) {
+        send_frame(fd, handle, HTTPD_WS_TYPE_BINARY, data, len);
+    }
+
+    /**
+     * Send a full binary snapshot to specific client
+     */
+    void send_snapshot(int fd, httpd_handle_t handle) {
+        if (!state_) return;
+        uint8_t buffer[SNAPSHOT_MAX_SIZE];
+        size_t len = encode_state_snapshot(*state_, safety_, now_ms(), buffer, sizeof(buffer));
+        if (len > 0) send_binary(fd, handle, buffer, len);
     }
 
     /**
@@ -539,16 +716,168 @@ private:
     }
 
     /**
-     * Broadcast message to all authenticated clients
+     * Queue a message for the audience's clients and wake the sender task
+     * O(1) in the number of clients; never waits on a socket.
+     * @param audience Bit per client slot
+     */
+    template<size_t N>
+    void publish(WsBroadcastLog<N>& log, const void* data, size_t len, uint8_t flags,
+                 uint8_t audience = WS_LOG_EVERYONE) {
+        if (len == 0 || audience == 0) return;
+        if (!log.append(data, len, flags, audience)) {
+            ESP_LOGW("WS", "Message of %u bytes too large to queue", (unsigned)len);
+            return;
+        }
+        if (tx_task_) xTaskNotifyGive(tx_task_);
+    }
+
+    /**
+     * Queue JSON update for authenticated clients that did not opt into binary
+     */
+    void broadcast(const char* message, uint8_t audience = WS_LOG_EVERYONE) {
+        publish(updates_, message, strlen(message), 0, audience);
+    }
+
+    /**
+     * Queue binary snapshot frame for authenticated binary clients
+     */
+    void broadcast_binary(const uint8_t* data, size_t len, uint8_t audience = WS_LOG_EVERYONE) {
+        publish(updates_, data, len, WS_LOG_BINARY, audience);
+    }
+
+    /**
+     * Whether a queued message goes to this client
+     */
+    static bool wants(const WsClient& client, uint8_t flags) {
+        if (flags & WS_LOG_BINARY) return client.binary;
+        return !client.binary || (flags & MSG_EVERYONE);
+    }
+
+    /**
+     * Sender task: drains the logs for each client in turn
      */
-    void broadcast(const char* message) {
+    static void tx_task(void* arg) {
+        auto* self = static_cast<WebSocketManager*>(arg);
+        while (self->tx_running_) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+            if (!self->tx_running_) break;
+            bool more = false;
+            for (int i = 0; i < MAX_WS_CLIENTS; i++) {
+                more |= self->drain_client(i);
+            }
+            // Round-robin: clients with a backlog continue in the next round
+            if (more) xTaskNotifyGive(self->tx_task_);
+        }
+        self->tx_task_ = nullptr;
+        vTaskDelete(nullptr);
+    }
+
+    /**
+     * Send up to TX_BATCH queued messages (all queued alarms) to one client
+     * @return true if the client still has messages queued
+     */
+    bool drain_client(int index) {
         lock();
-        for (int i = 0; i < MAX_WS_CLIENTS; i++) {
-            if (clients_[i].active && clients_[i].authenticated) {
-                send_text(clients_[i].fd, clients_[i].handle, message);
+        WsClient client = clients_[index];
+        unlock();
+        if (!client.active || !client.authenticated) return false;
+
+        size_t len = 0;
+        uint8_t flags = 0;
+        uint8_t reader = 1u << index;
+        bool ok = true;
+
+        // Alarms first and never dropped: a client that fell behind gets
+        // the current alarm state instead
+        for (;;) {
+            auto r = alarms_.read(client.alarm_cursor, tx_buffer_, len, flags, reader);
+            if (r == WsLogRead::EMPTY) break;
+            if (r == WsLogRead::OVERRUN) {
+                client.alarm_cursor = alarms_.head();
+                ok = send_alarm_state(client);
+                break;
+            }
+            if (wants(client, flags) && !send_queued(client, flags, len)) {
+                ok = false;
+                break;
+            }
+        }
+
+        int sent = 0;
+        bool more = false;
+        while (ok) {
+            if (sent == TX_BATCH) {
+                more = true;
+                break;
+            }
+            auto r = updates_.read(client.update_cursor, tx_buffer_, len, flags, reader);
+            if (r == WsLogRead::EMPTY) break;
+            if (r == WsLogRead::OVERRUN) {
+                // Dropped deltas coalesce into one full state
+                client.update_cursor = updates_.head();
+                if (client.binary) send_snapshot(client.fd, client.handle);
+                else send_full_state(client.fd, client.handle);
+                sent++;
+                continue;
+            }
+            if (wants(client, flags)) {
+                ok = send_queued(client, flags, len);
+                sent++;
             }
         }
+
+        // Store cursors unless the slot was reused meanwhile
+        lock();
+        WsClient& current = clients_[index];
+        if (current.active && current.fd == client.fd) {
+            current.update_cursor = client.update_cursor;
+            current.alarm_cursor = client.alarm_cursor;
+        }
         unlock();
+        return more;
+    }
+
+    bool send_queued(const WsClient& client, uint8_t flags, size_t len) {
+        bool binary = flags & WS_LOG_BINARY;
+        return send_frame(client.fd, client.handle,
+                          binary ? HTTPD_WS_TYPE_BINARY : HTTPD_WS_TYPE_TEXT,
+                          tx_buffer_, len) == ESP_OK;
+    }
+
+    /**
+     * Current alarm state of every fermenter (resync after an alarm overrun)
+     */
+    bool send_alarm_state(const WsClient& client) {
+        if (!safety_) return true;
+        if (client.binary) {
+            uint8_t frame[SNAPSHOT_HEADER_SIZE + core::MAX_FERMENTERS * SNAPSHOT_ALARM_SIZE];
+            SnapshotWriter binary(frame, sizeof(frame), now_ms(), SNAPSHOT_FLAG_DELTA);
+            for (uint8_t i = 1; i <= core::MAX_FERMENTERS; i++) {
+                auto* alarm = safety_->get_alarm_state(i);
+                if (alarm && client.subs.wants_alarm(i)) {
+                    binary.add_alarm(i, SnapshotWriter::alarm_bits(*alarm));
+                }
+            }
+            size_t len = binary.finish();
+            return len == 0 ||
+                   send_frame(client.fd, client.handle, HTTPD_WS_TYPE_BINARY, frame, len) == ESP_OK;
+        }
+        for (uint8_t i = 1; i <= core::MAX_FERMENTERS; i++) {
+            auto* alarm = safety_->get_alarm_state(i);
+            if (!alarm || !client.subs.wants_alarm(i)) continue;
+            char buffer[80];
+            snprintf(buffer, sizeof(buffer), "{\"type\":\"alarm\",\"fermenter\":%d,\"active\":%s}",
+                     i, SnapshotWriter::alarm_bits(*alarm) ? "true" : "false");
+            if (send_frame(client.fd, client.handle, HTTPD_WS_TYPE_TEXT,
+                           (const uint8_t*)buffer, strlen(buffer)) != ESP_OK) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static uint32_t now_ms() {
+        return xTaskGetTickCount() * portTICK_PERIOD_MS;
     }
 
     /**
@@ -563,25 +892,18 @@ private:
         offset += snprintf(buffer + offset, sizeof(buffer) - offset,
             "{\"type\":\"full\",\"sensors\":[");
 
-        // Add all sensors
-        auto guard = state_->scoped_lock(100);
-        if (!guard.acquired()) return;
-
+        // Add all sensors (snapshot reads, no state lock)
         uint8_t sensor_count = state_->get_sensor_count();
         for (uint8_t i = 0; i < sensor_count && offset < (int)sizeof(buffer) - 100; i++) {
             auto* sensor = state_->get_sensor_by_id(i);
-            if (!sensor) continue;
+            core::SensorSnapshot snap;
+            if (!sensor || !state_->read_sensor(i, snap)) continue;
 
             if (i > 0) offset += snprintf(buffer + offset, sizeof(buffer) - offset, ",");
             offset += snprintf(buffer + offset, sizeof(buffer) - offset,
                 "{\"id\":%d,\"name\":\"%s\",\"value\":%.2f,\"unit\":\"%s\",\"quality\":\"%s\"}",
-                i, sensor->name, sensor->filtered_value, sensor->unit,
-                quality_to_string(sensor->quality));
-
-            // Track for change detection
-            if (i < MAX_SENSORS) {
-                last_sensor_values_[i] = sensor->filtered_value;
-            }
+                i, sensor->name, snap.filtered_value, sensor->unit,
+                quality_to_string(snap.quality));
         }
 
         offset += snprintf(buffer + offset, sizeof(buffer) - offset, "],\"relays\":[");
@@ -590,17 +912,13 @@ private:
         uint8_t relay_count = state_->get_relay_count();
         for (uint8_t i = 0; i < relay_count && offset < (int)sizeof(buffer) - 100; i++) {
             auto* relay = state_->get_relay_by_id(i);
-            if (!relay) continue;
+            core::RelaySnapshot snap;
+            if (!relay || !state_->read_relay(i, snap)) continue;
 
             if (i > 0) offset += snprintf(buffer + offset, sizeof(buffer) - offset, ",");
             offset += snprintf(buffer + offset, sizeof(buffer) - offset,
                 "{\"id\":%d,\"name\":\"%s\",\"state\":%s}",
-                i, relay->name, relay->state ? "true" : "false");
-
-            // Track for change detection
-            if (i < MAX_RELAYS) {
-                last_relay_states_[i] = relay->state;
-            }
+                i, relay->name, snap.state ? "true" : "false");
         }
 
         offset += snprintf(buffer + offset, sizeof(buffer) - offset, "]}");
@@ -609,41 +927,37 @@ private:
     }
 
     /**
-     * EventBus callback: sensor update
+     * Per-sensor deadbands: configured value, else the default for its unit
      */
-    void on_sensor_update(const core::Event& event) {
-        if (!initialized_ || client_count_ == 0) return;
-
-        uint8_t id = event.source_id;
-        if (id >= MAX_SENSORS) return;
-
-        float new_value = event.data.value;
-
-        // Check for significant change
-        if (std::abs(new_value - last_sensor_values_[id]) < SENSOR_CHANGE_THRESHOLD) {
-            return;  // No significant change
+    void refresh_deadbands() {
+        uint8_t count = state_->get_sensor_count();
+        for (uint8_t i = 0; i < count && i < MAX_SENSORS; i++) {
+            auto* sensor = state_->get_sensor_by_id(i);
+            if (!sensor) continue;
+            aggregator_.set_deadband(i, sensor->deadband > 0.0f
+                ? sensor->deadband : WsDeltaAggregator::unit_deadband(sensor->unit));
         }
+    }
 
-        last_sensor_values_[id] = new_value;
-
-        // Get quality from state manager
-        const char* quality = "UNKNOWN";
-        if (state_) {
-            auto guard = state_->scoped_lock(50);
-            if (guard.acquired()) {
-                auto* sensor = state_->get_sensor_by_id(id);
-                if (sensor) {
-                    quality = quality_to_string(sensor->quality);
-                }
-            }
-        }
+    /**
+     * EventBus callback: batch of sensor updates (one per MODBUS transaction)
+     * Only records the samples; changes go out once per update interval.
+     */
+    void on_sensors_updated(const core::Event& event) {
+        if (!initialized_ || client_count_ == 0 || !state_) return;
 
-        char buffer[MAX_TX_BUFFER];
-        snprintf(buffer, sizeof(buffer),
-            "{\"type\":\"sensor\",\"id\":%d,\"value\":%.2f,\"quality\":\"%s\"}",
-            id, new_value, quality);
+        uint32_t now = now_ms();
+        lock();
+        uint32_t mask = event.data.mask;
+        for (uint8_t id = 0; mask != 0 && id < MAX_SENSORS; id++, mask >>= 1) {
+            if (!(mask & 1)) continue;
 
-        broadcast(buffer);
+            core::SensorSnapshot snap;
+            if (!state_->read_sensor(id, snap)) continue;
+            aggregator_.sensor_sample(id, snap.filtered_value, snap.quality);
+        }
+        if (aggregator_.due(now)) flush_deltas(now);
+        unlock();
     }
 
     /**
@@ -655,21 +969,96 @@ private:
         uint8_t id = event.source_id;
         if (id >= MAX_RELAYS) return;
 
-        bool new_state = event.data.state;
+        uint32_t now = now_ms();
+        lock();
+        aggregator_.relay_change(id, event.data.state);
+        if (aggregator_.due(now)) flush_deltas(now);
+        unlock();
+    }
+
+    /**
+     * Queue one batched update per group of clients with the same slice of
+     * it (see WsFanout); unsubscribed clients are in no group
+     * Caller holds mutex_.
+     */
+    void flush_deltas(uint32_t now) {
+        auto batch = aggregator_.flush(now);
 
-        // Check for change
-        if (new_state == last_relay_states_[id]) {
-            return;  // No change
+        WsFanout fanout;
+        for (int i = 0; i < MAX_WS_CLIENTS; i++) {
+            const WsClient& client = clients_[i];
+            if (!client.active || !client.authenticated) continue;
+            fanout.add(i, client.subs, batch.sensors, batch.relays, client.binary);
         }
 
-        last_relay_states_[id] = new_state;
+        for (int g = 0; g < fanout.count; g++) {
+            const auto& group = fanout.groups[g];
+            if (group.binary) {
+                publish_update_binary(group.sensors, group.relays, group.audience, now);
+            } else {
+                publish_update_json(group.sensors, group.relays, group.audience);
+            }
+        }
+    }
 
-        char buffer[MAX_TX_BUFFER];
-        snprintf(buffer, sizeof(buffer),
-            "{\"type\":\"relay\",\"id\":%d,\"state\":%s}",
-            id, new_state ? "true" : "false");
+    /**
+     * Queue one binary delta frame with the given sensors and relays
+     */
+    void publish_update_binary(uint32_t sensors, uint32_t relays, uint8_t audience, uint32_t now) {
+        SnapshotWriter binary(update_frame_, sizeof(update_frame_), now, SNAPSHOT_FLAG_DELTA);
+        for (uint8_t id = 0; sensors != 0; id++, sensors >>= 1) {
+            if (sensors & 1) binary.add_sensor(id, aggregator_.value(id), aggregator_.quality(id));
+        }
+        for (uint8_t id = 0; relays != 0 && id < MAX_RELAYS; id++, relays >>= 1) {
+            if (relays & 1) binary.add_relay(id, aggregator_.relay(id));
+        }
+        broadcast_binary(update_frame_, binary.finish(), audience);
+    }
+
+    /**
+     * Queue a JSON "update" message with the given sensors and relays
+     * Split into several if it does not fit UPDATE_JSON_SIZE.
+     */
+    void publish_update_json(uint32_t sensors, uint32_t relays, uint8_t audience) {
+        char* buffer = update_json_;
+        const int size = (int)sizeof(update_json_);
+        int offset = snprintf(buffer, size, "{\"type\":\"update\",\"sensors\":[");
+        bool first = true;
+
+        for (uint8_t id = 0; sensors != 0; id++, sensors >>= 1) {
+            if (!(sensors & 1)) continue;
+            if (offset > size - 80) {
+                snprintf(buffer + offset, size - offset, "],\"relays\":[]}");
+                broadcast(buffer, audience);
+                offset = snprintf(buffer, size, "{\"type\":\"update\",\"sensors\":[");
+                first = true;
+            }
+            offset += snprintf(buffer + offset, size - offset,
+                "%s{\"id\":%d,\"value\":%.2f,\"quality\":\"%s\"}",
+                first ? "" : ",", id, aggregator_.value(id),
+                quality_to_string(aggregator_.quality(id)));
+            first = false;
+        }
 
-        broadcast(buffer);
+        offset += snprintf(buffer + offset, size - offset, "],\"relays\":[");
+        first = true;
+
+        for (uint8_t id = 0; relays != 0 && id < MAX_RELAYS; id++, relays >>= 1) {
+            if (!(relays & 1)) continue;
+            if (offset > size - 40) {
+                snprintf(buffer + offset, size - offset, "]}");
+                broadcast(buffer, audience);
+                offset = snprintf(buffer, size, "{\"type\":\"update\",\"sensors\":[],\"relays\":[");
+                first = true;
+            }
+            offset += snprintf(buffer + offset, size - offset,
+                "%s{\"id\":%d,\"state\":%s}", first ? "" : ",", id,
+                aggregator_.relay(id) ? "true" : "false");
+            first = false;
+        }
+
+        snprintf(buffer + offset, size - offset, "]}");
+        broadcast(buffer, audience);
     }
 
     /**
@@ -678,13 +1067,38 @@ private:
     void on_alarm(const core::Event& event) {
         if (!initialized_ || client_count_ == 0) return;
 
-        // Alarms always broadcast immediately
+        // Only clients subscribed to this fermenter's alarms
+        uint8_t audience = 0;
+        lock();
+        for (int i = 0; i < MAX_WS_CLIENTS; i++) {
+            const WsClient& client = clients_[i];
+            if (client.active && client.subs.wants_alarm(event.source_id)) audience |= 1u << i;
+        }
+        unlock();
+        if (audience == 0) return;
+
+        // Alarms have their own queue, never dropped for a slow client
         char buffer[MAX_TX_BUFFER];
-        snprintf(buffer, sizeof(buffer),
+        int len = snprintf(buffer, sizeof(buffer),
             "{\"type\":\"alarm\",\"fermenter\":%d,\"active\":%s}",
             event.source_id, event.data.state ? "true" : "false");
 
-        broadcast(buffer);
+        publish(alarms_, buffer, len, 0, audience);
+
+        // Detail bits from the safety controller when available
+        uint8_t bits = 0;
+        if (safety_) {
+            auto* alarm = safety_->get_alarm_state(event.source_id);
+            if (alarm) bits = SnapshotWriter::alarm_bits(*alarm);
+        }
+        if (event.data.state) {
+            bits |= SNAPSHOT_ALARM_ACTIVE;
+        }
+
+        uint8_t delta[SNAPSHOT_HEADER_SIZE + SNAPSHOT_ALARM_SIZE];
+        SnapshotWriter binary(delta, sizeof(delta), now_ms(), SNAPSHOT_FLAG_DELTA);
+        binary.add_alarm(event.source_id, bits);
+        publish(alarms_, delta, binary.finish(), WS_LOG_BINARY, audience);
     }
 
     /**
@@ -709,9 +1123,14 @@ private:
     void set_session_validator(SessionValidator validator, void* ctx) {
         (void)validator; (void)ctx;
     }
+    void set_safety_controller(const SafetyController* safety) { (void)safety; }
+    void set_update_interval(uint32_t interval_ms) { (void)interval_ms; }
     void stop() {}
     void process() {}
     int get_client_count() const { return 0; }
+    uint32_t get_overruns() const { return 0; }
+    uint32_t get_delta_samples() const { return 0; }
+    uint32_t get_delta_frames() const { return 0; }
 #endif
 };
 
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef ESP32_BUILD
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#else
+#include <mutex>
+#endif
+
+namespace modules {
+
+constexpr uint8_t WS_LOG_BINARY = 0x01;     // Record flag: binary frame (else text)
+constexpr uint8_t WS_LOG_EVERYONE = 0xFF;   // Audience: every reader
+
+enum class WsLogRead : uint8_t {
+    EMPTY,      // Cursor is at the head
+    MESSAGE,    // A message was copied out
+    OVERRUN     // Messages were dropped; cursor moved to the oldest one
+};
+
+/**
+ * Bounded outbound log shared by all WebSocket clients
+ *
+ * A producer appends each message once, so publishing costs the same no
+ * matter how many clients are connected. Every client drains the log
+ * through its own cursor from the sender task; the bytes between a cursor
+ * and the head are that client's queue, bounded by the log capacity.
+ *
+ * When a slow client's cursor is overtaken, read() reports OVERRUN and
+ * moves the cursor to the oldest retained message (drop-oldest). The
+ * caller then resyncs the client with one full-state message, which
+ * coalesces everything it missed.
+ *
+ * Each record carries an audience, one bit per reader (client slot). A
+ * reader skips records not addressed to it without copying them, so a
+ * message for a subset of clients costs the others only a header check.
+ *
+ * Records are [u16 length][u8 flags][u8 audience][payload] in a byte
+ * ring; offsets are absolute (wrapping u32), so cursor arithmetic needs
+ * no modulo.
+ */
+template<size_t CAPACITY>
+class WsBroadcastLog {
+public:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+    static constexpr size_t RECORD_HEADER = 4;
+    static constexpr size_t MAX_MESSAGE = CAPACITY / 4;
+
+    WsBroadcastLog() : head_(0), tail_(0), appended_(0), overruns_(0), buf_{} {
+#ifdef ESP32_BUILD
+        mutex_ = xSemaphoreCreateMutex();
+#endif
+    }
+
+    ~WsBroadcastLog() {
+#ifdef ESP32_BUILD
+        if (mutex_) vSemaphoreDelete(mutex_);
+#endif
+    }
+
+    WsBroadcastLog(const WsBroadcastLog&) = delete;
+    WsBroadcastLog& operator=(const WsBroadcastLog&) = delete;
+
+    /**
+     * Append a message, evicting the oldest ones if the log is full
+     * @return false if the message is larger than MAX_MESSAGE
+     */
+    bool append(const void* data, size_t len, uint8_t flags = 0,
+                uint8_t audience = WS_LOG_EVERYONE) {
+        if (!data || len == 0 || len > MAX_MESSAGE) return false;
+        size_t record = RECORD_HEADER + len;
+
+        lock();
+        while (head_ + record - tail_ > CAPACITY) {
+            tail_ += RECORD_HEADER + record_length(tail_);
+        }
+        uint8_t header[RECORD_HEADER] = {(uint8_t)len, (uint8_t)(len >> 8), flags, audience};
+        copy_in(head_, header, RECORD_HEADER);
+        copy_in(head_ + RECORD_HEADER, data, len);
+        head_ += record;
+        appended_++;
+        unlock();
+        return true;
+    }
+
+    /**
+     * Copy the next message for this reader and advance the cursor past it
+     * @param out Buffer of at least MAX_MESSAGE bytes
+     * @param reader Reader's audience bit(s); other records are skipped
+     */
+    WsLogRead read(uint32_t& cursor, uint8_t* out, size_t& len, uint8_t& flags,
+                   uint8_t reader = WS_LOG_EVERYONE) {
+        lock();
+        WsLogRead result = WsLogRead::EMPTY;
+        if (head_ - cursor > head_ - tail_) {
+            cursor = tail_;
+            overruns_++;
+            result = WsLogRead::OVERRUN;
+        } else {
+            while (cursor != head_) {
+                size_t record = record_length(cursor);
+                bool addressed = buf_[(cursor + 3) & MASK] & reader;
+                if (addressed) {
+                    len = record;
+                    flags = buf_[(cursor + 2) & MASK];
+                    copy_out(cursor + RECORD_HEADER, out, len);
+                }
+                cursor += RECORD_HEADER + record;
+                if (addressed) {
+                    result = WsLogRead::MESSAGE;
+                    break;
+                }
+            }
+        }
+        unlock();
+        return result;
+    }
+
+    /** Cursor for a new reader: only messages appended from now on */
+    uint32_t head() const {
+        lock();
+        uint32_t h = head_;
+        unlock();
+        return h;
+    }
+
+    /** Bytes queued for a cursor (0 once it has been overtaken) */
+    size_t backlog(uint32_t cursor) const {
+        lock();
+        size_t pending = (head_ - cursor <= head_ - tail_) ? head_ - cursor : 0;
+        unlock();
+        return pending;
+    }
+
+    uint32_t appended() const { return appended_; }
+    uint32_t overruns() const { return overruns_; }
+
+private:
+    static constexpr uint32_t MASK = CAPACITY - 1;
+
+    uint32_t head_;         // Offset of the next record
+    uint32_t tail_;         // Offset of the oldest retained record
+    uint32_t appended_;
+    uint32_t overruns_;
+    uint8_t buf_[CAPACITY];
+#ifdef ESP32_BUILD
+    SemaphoreHandle_t mutex_;
+#else
+    mutable std::mutex mutex_;
+#endif
+
+    void lock() const {
+#ifdef ESP32_BUILD
+        xSemaphoreTake(mutex_, portMAX_DELAY);
+#else
+        mutex_.lock();
+#endif
+    }
+
+    void unlock() const {
+#ifdef ESP32_BUILD
+        xSemaphoreGive(mutex_);
+#else
+        mutex_.unlock();
+#endif
+    }
+
+    size_t record_length(uint32_t offset) const {
+        return buf_[offset & MASK] | (buf_[(offset + 1) & MASK] << 8);
+    }
+
+    void copy_in(uint32_t offset, const void* data, size_t len) {
+        size_t start = offset & MASK;
+        size_t first = len < CAPACITY - start ? len : CAPACITY - start;
+        memcpy(buf_ + start, data, first);
+        memcpy(buf_, static_cast<const uint8_t*>(data) + first, len - first);
+    }
+
+    void copy_out(uint32_t offset, uint8_t* out, size_t len) const {
+        size_t start = offset & MASK;
+        size_t first = len < CAPACITY - start ? len : CAPACITY - start;
+        memcpy(out, buf_ + start, first);
+        memcpy(out + first, buf_, len - first);
+    }
+};
+
+} // namespace modules
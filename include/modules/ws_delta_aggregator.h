@@ -0,0 +1,167 @@
+#pragma once
+
+#include "core/types.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace modules {
+
+/**
+ * Collects WebSocket sensor/relay changes between sends
+ *
+ * Samples only update the latest value and set a dirty bit; one batched
+ * frame per update interval (DisplayConfig::update_interval_ms) carries
+ * every item that changed since the previous frame, with its latest value.
+ * A sensor becomes dirty when it moves by at least its deadband from the
+ * value last sent, or when its quality changes. Relays become dirty when
+ * they differ from the state last sent, so a toggle back and forth within
+ * one interval sends nothing.
+ *
+ * Not thread-safe; WebSocketManager calls it under its lock.
+ */
+class WsDeltaAggregator {
+public:
+    static constexpr int MAX_SENSORS = 32;      // One bit each in a uint32_t
+    static constexpr int MAX_RELAYS = 32;
+    static constexpr float DEFAULT_DEADBAND = 0.01f;
+
+    struct Batch {
+        uint32_t sensors;   // Bit per sensor id to send
+        uint32_t relays;    // Bit per relay id to send
+    };
+
+    WsDeltaAggregator()
+        : interval_ms_(1000)
+        , last_flush_ms_(0)
+        , dirty_sensors_(0)
+        , dirty_relays_(0)
+        , known_sensors_(0)
+        , relay_state_(0)
+        , sent_relay_state_(0)
+        , samples_(0)
+        , frames_(0) {
+        for (int i = 0; i < MAX_SENSORS; i++) {
+            deadband_[i] = DEFAULT_DEADBAND;
+            value_[i] = 0.0f;
+            sent_value_[i] = 0.0f;
+            quality_[i] = core::SensorQuality::UNKNOWN;
+            sent_quality_[i] = core::SensorQuality::UNKNOWN;
+        }
+    }
+
+    /**
+     * Deadband for a sensor's engineering unit
+     * Roughly the display resolution, so noise below it is not pushed.
+     */
+    static float unit_deadband(const char* unit) {
+        static const struct {
+            const char* unit;
+            float deadband;
+        } UNITS[] = {
+            {"°C",  0.05f},
+            {"°F",  0.1f},
+            {"bar", 0.005f},
+            {"psi", 0.05f},
+            {"kPa", 0.5f},
+            {"%",   0.5f},
+            {"pH",  0.01f},
+            {"SG",  0.0005f},
+            {"°P",  0.05f},
+        };
+        if (unit) {
+            for (const auto& u : UNITS) {
+                if (strcmp(unit, u.unit) == 0) return u.deadband;
+            }
+        }
+        return DEFAULT_DEADBAND;
+    }
+
+    /** @param interval_ms Minimum time between batched frames (0: every sample) */
+    void set_interval(uint32_t interval_ms) { interval_ms_ = interval_ms; }
+    uint32_t interval() const { return interval_ms_; }
+
+    void set_deadband(uint8_t id, float deadband) {
+        if (id < MAX_SENSORS && deadband >= 0.0f) deadband_[id] = deadband;
+    }
+
+    float deadband(uint8_t id) const {
+        return id < MAX_SENSORS ? deadband_[id] : DEFAULT_DEADBAND;
+    }
+
+    void sensor_sample(uint8_t id, float value, core::SensorQuality quality) {
+        if (id >= MAX_SENSORS) return;
+        samples_++;
+        uint32_t bit = 1u << id;
+        value_[id] = value;
+        quality_[id] = quality;
+        if (!(known_sensors_ & bit) || quality != sent_quality_[id] ||
+            std::fabs(value - sent_value_[id]) >= deadband_[id]) {
+            dirty_sensors_ |= bit;
+        }
+    }
+
+    void relay_change(uint8_t id, bool state) {
+        if (id >= MAX_RELAYS) return;
+        samples_++;
+        uint32_t bit = 1u << id;
+        if (state) relay_state_ |= bit;
+        else relay_state_ &= ~bit;
+        dirty_relays_ = relay_state_ ^ sent_relay_state_;
+    }
+
+    bool pending() const { return (dirty_sensors_ | dirty_relays_) != 0; }
+
+    /** Something changed and the interval since the last frame has passed */
+    bool due(uint32_t now_ms) const {
+        return pending() && now_ms - last_flush_ms_ >= interval_ms_;
+    }
+
+    /**
+     * Take the dirty sets; their latest values become the sent baseline
+     * Read them with value()/quality()/relay() before the next sample.
+     */
+    Batch flush(uint32_t now_ms) {
+        Batch batch = {dirty_sensors_, dirty_relays_};
+        uint32_t mask = dirty_sensors_;
+        for (uint8_t id = 0; mask != 0; id++, mask >>= 1) {
+            if (!(mask & 1)) continue;
+            sent_value_[id] = value_[id];
+            sent_quality_[id] = quality_[id];
+        }
+        known_sensors_ |= dirty_sensors_;
+        sent_relay_state_ = relay_state_;
+        dirty_sensors_ = 0;
+        dirty_relays_ = 0;
+        last_flush_ms_ = now_ms;
+        if (batch.sensors | batch.relays) frames_++;
+        return batch;
+    }
+
+    float value(uint8_t id) const { return value_[id]; }
+    core::SensorQuality quality(uint8_t id) const { return quality_[id]; }
+    bool relay(uint8_t id) const { return (relay_state_ >> id) & 1u; }
+
+    /** Sensor samples and relay changes fed in */
+    uint32_t samples() const { return samples_; }
+    /** Batches flushed (one frame per client kind each) */
+    uint32_t frames() const { return frames_; }
+
+private:
+    uint32_t interval_ms_;
+    uint32_t last_flush_ms_;
+    uint32_t dirty_sensors_;
+    uint32_t dirty_relays_;
+    uint32_t known_sensors_;        // Sensors with a sent baseline
+    uint32_t relay_state_;
+    uint32_t sent_relay_state_;
+    uint32_t samples_;
+    uint32_t frames_;
+    float deadband_[MAX_SENSORS];
+    float value_[MAX_SENSORS];
+    float sent_value_[MAX_SENSORS];
+    core::SensorQuality quality_[MAX_SENSORS];
+    core::SensorQuality sent_quality_[MAX_SENSORS];
+};
+
+} // namespace modules
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "core/state_manager.h"
+#include "core/types.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace modules {
+
+/**
+ * What one WebSocket client wants to receive
+ *
+ * Kept as bitmasks, computed once when the client subscribes, so fan-out
+ * is a mask test per client. Fermenter subscriptions are expanded into the
+ * fermenter's temperature/pressure sensors and cooling/spunding relays.
+ *
+ * Subscribe message (replaces the previous subscription):
+ *   {"type":"subscribe","fermenters":[1,2],"sensors":[7],"events":["alarms"]}
+ * Event classes are "sensors", "relays", "alarms" (every item of that
+ * class) and "all". Listed items are combined; a message that lists
+ * nothing unsubscribes from all updates.
+ */
+struct WsSubscription {
+    static constexpr int MAX_SENSORS = 32;
+    static constexpr int MAX_RELAYS = 32;
+
+    uint32_t sensors;       // Bit per sensor id
+    uint32_t relays;        // Bit per relay id
+    uint8_t fermenters;     // Alarms, bit (id - 1) per fermenter
+
+    WsSubscription() : sensors(0xFFFFFFFF), relays(0xFFFFFFFF), fermenters(0xFF) {}
+
+    static WsSubscription none() {
+        WsSubscription s;
+        s.sensors = 0;
+        s.relays = 0;
+        s.fermenters = 0;
+        return s;
+    }
+
+    bool wants_alarm(uint8_t fermenter_id) const {
+        return fermenter_id >= 1 && fermenter_id <= core::MAX_FERMENTERS &&
+               ((fermenters >> (fermenter_id - 1)) & 1u);
+    }
+
+    /**
+     * Build a subscription from a subscribe message
+     * @param state Resolves fermenter ids to their sensors and relays
+     */
+    static WsSubscription parse(const char* payload, core::StateManager* state) {
+        WsSubscription s = none();
+        int ids[16];
+
+        int n = parse_ids(payload, "sensors", ids, 16);
+        for (int i = 0; i < n; i++) s.add_sensor(ids[i]);
+
+        n = parse_ids(payload, "fermenters", ids, 16);
+        for (int i = 0; i < n; i++) {
+            if (ids[i] < 1 || ids[i] > core::MAX_FERMENTERS) continue;
+            s.fermenters |= 1u << (ids[i] - 1);
+            auto* ferm = state ? state->get_fermenter(ids[i]) : nullptr;
+            if (!ferm) continue;
+            s.add_sensor(ferm->temp_sensor_id);
+            s.add_sensor(ferm->pressure_sensor_id);
+            s.add_relay(ferm->cooling_relay_id);
+            s.add_relay(ferm->spunding_relay_id);
+        }
+
+        const char* events = find_array(payload, "events");
+        const char* end = events ? strchr(events, ']') : nullptr;
+        if (end) {
+            bool all = has_string(events, end, "all");
+            if (all || has_string(events, end, "sensors")) s.sensors = 0xFFFFFFFF;
+            if (all || has_string(events, end, "relays")) s.relays = 0xFFFFFFFF;
+            if (all || has_string(events, end, "alarms")) s.fermenters = 0xFF;
+        }
+        return s;
+    }
+
+private:
+    void add_sensor(int id) {
+        if (id >= 0 && id < MAX_SENSORS) sensors |= 1u << id;   // 0xFF: not mapped
+    }
+
+    void add_relay(int id) {
+        if (id >= 0 && id < MAX_RELAYS) relays |= 1u << id;
+    }
+
+    /** Position after the '[' of "key":[ ...], or nullptr */
+    static const char* find_array(const char* payload, const char* key) {
+        size_t key_len = strlen(key);
+        for (const char* p = strchr(payload, '"'); p; p = strchr(p + 1, '"')) {
+            if (strncmp(p + 1, key, key_len) != 0 || p[key_len + 1] != '"') continue;
+            const char* q = p + key_len + 2;
+            while (*q == ' ') q++;
+            if (*q != ':') continue;        // A string value, not the key
+            q++;
+            while (*q == ' ') q++;
+            return *q == '[' ? q + 1 : nullptr;
+        }
+        return nullptr;
+    }
+
+    static int parse_ids(const char* payload, const char* key, int* ids, int max) {
+        const char* p = find_array(payload, key);
+        int count = 0;
+        while (p && count < max) {
+            while (*p == ' ' || *p == ',') p++;
+            char* next;
+            long value = strtol(p, &next, 10);
+            if (next == p) break;           // ']' or garbage
+            ids[count++] = (int)value;
+            p = next;
+        }
+        return count;
+    }
+
+    static bool has_string(const char* begin, const char* end, const char* word) {
+        size_t len = strlen(word);
+        for (const char* p = begin; p + len + 2 <= end; p++) {
+            if (p[0] == '"' && strncmp(p + 1, word, len) == 0 && p[len + 1] == '"') return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * Groups clients that get the same slice of a delta batch
+ *
+ * One message is formatted per group and queued once with the group's
+ * client bits as its audience; clients with nothing in the batch are in
+ * no group and cost nothing. With default subscriptions this is one group
+ * per frame kind, as before subscriptions existed.
+ */
+struct WsFanout {
+    static constexpr int MAX_GROUPS = 8;
+
+    struct Group {
+        uint32_t sensors;
+        uint32_t relays;
+        bool binary;
+        uint8_t audience;   // Bit per client slot
+    };
+
+    Group groups[MAX_GROUPS];
+    int count;
+
+    WsFanout() : groups{}, count(0) {}
+
+    /** Add a client slot (< 8) for a batch; returns false if it gets nothing */
+    bool add(int slot, const WsSubscription& sub, uint32_t sensors, uint32_t relays, bool binary) {
+        sensors &= sub.sensors;
+        relays &= sub.relays;
+        if ((sensors | relays) == 0) return false;
+        uint8_t bit = 1u << slot;
+        for (int i = 0; i < count; i++) {
+            Group& g = groups[i];
+            if (g.sensors == sensors && g.relays == relays && g.binary == binary) {
+                g.audience |= bit;
+                return true;
+            }
+        }
+        if (count == MAX_GROUPS) return false;
+        groups[count++] = {sensors, relays, binary, bit};
+        return true;
+    }
+};
+
+} // namespace modules
@@ -0,0 +1,138 @@
+"""
+Pre-build script that stages data/ for the SPIFFS image.
+
+Web assets get a gzip sibling (<file>.gz, only when it is smaller) and an
+entry in /assets.idx with a content hash, which the HTTP server uses for
+Content-Encoding, ETags and immutable Cache-Control (see
+include/modules/static_assets.h). References to local assets inside HTML
+and CSS are rewritten to "<path>?v=<hash>" so browsers can cache them
+for a year and still pick up new firmware.
+
+Other files (config.json) are copied unchanged and left out of the
+manifest.
+
+Under PlatformIO the staged tree replaces PROJECT_DATA_DIR, so buildfs and
+uploadfs pick it up. It can also be run by hand:
+
+    python3 scripts/build_assets.py data build/data
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+import sys
+
+MANIFEST_NAME = "assets.idx"
+MANIFEST_HEADER = "# assets v1"
+HASH_LENGTH = 12        # Hex digits; AssetManifest::HASH_SIZE allows 16
+MAX_PATH_LENGTH = 31    # SPIFFS object name limit incl. "/" and ".gz"
+MAX_ASSETS = 32         # AssetManifest::MAX_ASSETS
+
+WEB_EXTENSIONS = {".html", ".htm", ".css", ".js", ".svg", ".ico", ".png",
+                  ".jpg", ".woff2", ".txt"}
+COMPRESSIBLE = {".html", ".htm", ".css", ".js", ".svg", ".ico", ".txt"}
+REWRITABLE = {".html", ".htm", ".css"}
+
+# src="/x", href="/x" and CSS url(/x) with an absolute local path
+REFERENCE = re.compile(r'''((?:src|href)\s*=\s*["']|url\(\s*["']?)(/[^"'()?#\s]+)''')
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:HASH_LENGTH]
+
+
+def rewrite_references(text, hashes):
+    def replace(match):
+        path = match.group(2)
+        if path not in hashes:
+            return match.group(0)
+        return f"{match.group(1)}{path}?v={hashes[path]}"
+    return REFERENCE.sub(replace, text)
+
+
+def collect(src_dir):
+    files = []
+    for root, _, names in os.walk(src_dir):
+        for name in sorted(names):
+            full = os.path.join(root, name)
+            url = "/" + os.path.relpath(full, src_dir).replace(os.sep, "/")
+            files.append((url, full))
+    return sorted(files)
+
+
+def build(src_dir, out_dir):
+    """Stage src_dir into out_dir; returns the manifest entries."""
+    if os.path.isdir(out_dir):
+        shutil.rmtree(out_dir)
+    os.makedirs(out_dir)
+
+    files = collect(src_dir)
+    web = [(url, path) for url, path in files
+           if os.path.splitext(url)[1].lower() in WEB_EXTENSIONS]
+    if len(web) > MAX_ASSETS:
+        raise RuntimeError(f"{len(web)} web assets, manifest holds {MAX_ASSETS}")
+
+    # Non-rewritable assets first, so HTML/CSS can reference their hashes
+    web.sort(key=lambda item: os.path.splitext(item[0])[1].lower() in REWRITABLE)
+    hashes = {}
+    contents = {}
+    for url, path in web:
+        with open(path, "rb") as f:
+            data = f.read()
+        if os.path.splitext(url)[1].lower() in REWRITABLE:
+            data = rewrite_references(data.decode("utf-8"), hashes).encode("utf-8")
+        contents[url] = data
+        hashes[url] = content_hash(data)
+
+    entries = []
+    for url, path in files:
+        dest = os.path.join(out_dir, url.lstrip("/"))
+        os.makedirs(os.path.dirname(dest), exist_ok=True)
+        if url not in contents:
+            shutil.copyfile(path, dest)
+            continue
+
+        data = contents[url]
+        with open(dest, "wb") as f:
+            f.write(data)
+
+        gz_size = 0
+        if os.path.splitext(url)[1].lower() in COMPRESSIBLE:
+            # mtime=0 keeps the image reproducible
+            packed = gzip.compress(data, compresslevel=9, mtime=0)
+            if len(packed) < len(data):
+                if len(url) + 3 > MAX_PATH_LENGTH:
+                    raise RuntimeError(f"{url}.gz exceeds the SPIFFS name limit")
+                with open(dest + ".gz", "wb") as f:
+                    f.write(packed)
+                gz_size = len(packed)
+        entries.append((url, hashes[url], len(data), gz_size))
+
+    with open(os.path.join(out_dir, MANIFEST_NAME), "w") as f:
+        f.write(MANIFEST_HEADER + "\n")
+        for url, digest, size, gz_size in sorted(entries):
+            f.write(f"{url} {digest} {size} {gz_size}\n")
+    return entries
+
+
+def report(entries):
+    for url, digest, size, gz_size in sorted(entries):
+        packed = f"{gz_size} gz" if gz_size else "stored"
+        print(f"  {url}: {size} -> {packed} ({digest})")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print("usage: build_assets.py <data_dir> <out_dir>")
+        sys.exit(2)
+    report(build(sys.argv[1], sys.argv[2]))
+else:
+    Import("env")
+
+    src = env.subst("$PROJECT_DATA_DIR")
+    out = os.path.join(env.subst("$PROJECT_BUILD_DIR"), env.subst("$PIOENV"), "data")
+    print(f"Staging web assets: {src} -> {out}")
+    report(build(src, out))
+    env.Replace(PROJECT_DATA_DIR=out)
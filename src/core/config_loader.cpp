@@ -15,12 +15,14 @@ void ConfigLoader::load_defaults(SystemConfig& config) {
     config.scheduler.base_samples_per_cycle = 3;
     config.scheduler.min_sample_spacing_ms = 100;
     config.scheduler.transaction_time_ms = 5;
+    config.scheduler.control_period_ms = 100;
     config.scheduler.bulk_read_enabled = true;
     config.scheduler.fill_idle_windows = true;
 
     config.pid_timing.calculation_interval_ms = 5000;
     config.pid_timing.output_cycle_time_ms = 60000;
     config.pid_timing.autotune_max_duration_min = 120;
+    config.pid_timing.derivative_filter_ms = 0;
 
     config.sensor_timing.quality_bad_timeout_ms = 300000;
     config.sensor_timing.default_filter = FilterType::EMA;
@@ -103,6 +105,8 @@ bool ConfigLoader::load_from_json(const char* json, SystemConfig& config) {
             config.scheduler.base_cycle_ms = scheduler["base_cycle_ms"] | config.scheduler.base_cycle_ms;
             config.scheduler.base_samples_per_cycle = scheduler["base_samples_per_cycle"] | config.scheduler.base_samples_per_cycle;
             config.scheduler.min_sample_spacing_ms = scheduler["min_sample_spacing_ms"] | config.scheduler.min_sample_spacing_ms;
+            config.scheduler.transaction_time_ms = scheduler["transaction_time_ms"] | config.scheduler.transaction_time_ms;
+            config.scheduler.control_period_ms = scheduler["control_period_ms"] | config.scheduler.control_period_ms;
             config.scheduler.bulk_read_enabled = scheduler["bulk_read_enabled"] | config.scheduler.bulk_read_enabled;
             config.scheduler.fill_idle_windows = scheduler["fill_idle_windows"] | config.scheduler.fill_idle_windows;
         }
@@ -112,6 +116,7 @@ bool ConfigLoader::load_from_json(const char* json, SystemConfig& config) {
             config.pid_timing.calculation_interval_ms = pid["calculation_interval_ms"] | config.pid_timing.calculation_interval_ms;
             config.pid_timing.output_cycle_time_ms = pid["output_cycle_time_ms"] | config.pid_timing.output_cycle_time_ms;
             config.pid_timing.autotune_max_duration_min = pid["autotune_max_duration_min"] | config.pid_timing.autotune_max_duration_min;
+            config.pid_timing.derivative_filter_ms = pid["derivative_filter_ms"] | config.pid_timing.derivative_filter_ms;
         }
 
         JsonObject safety = timing["safety"];
@@ -121,6 +126,12 @@ bool ConfigLoader::load_from_json(const char* json, SystemConfig& config) {
             config.safety_timing.max_temp_deviation = safety["max_temp_deviation"] | config.safety_timing.max_temp_deviation;
             config.safety_timing.max_pressure_bar = safety["max_pressure_bar"] | config.safety_timing.max_pressure_bar;
         }
+
+        JsonObject display = timing["display"];
+        if (display) {
+            config.display.update_interval_ms = display["update_interval_ms"] | config.display.update_interval_ms;
+            config.display.websocket_ping_interval_ms = display["websocket_ping_interval_ms"] | config.display.websocket_ping_interval_ms;
+        }
     }
 
     // WiFi configuration
@@ -154,6 +165,8 @@ bool ConfigLoader::load_from_json(const char* json, SystemConfig& config) {
         if (topic_prefix) strncpy(config.mqtt.topic_prefix, topic_prefix, sizeof(config.mqtt.topic_prefix) - 1);
 
         config.mqtt.publish_interval_ms = mqtt["publish_interval_ms"] | config.mqtt.publish_interval_ms;
+        config.mqtt.reconnect_delay_ms = mqtt["reconnect_delay_ms"] | config.mqtt.reconnect_delay_ms;
+        config.mqtt.keepalive_s = mqtt["keepalive_s"] | config.mqtt.keepalive_s;
         config.mqtt.enabled = mqtt["enabled"] | config.mqtt.enabled;
     }
 
@@ -169,7 +182,9 @@ bool ConfigLoader::load_from_json(const char* json, SystemConfig& config) {
         config.ntp.enabled = ntp["enabled"] | config.ntp.enabled;
     }
 
-    // Hardware configuration - MODBUS devices
+    // Hardware configuration - MODBUS bus and devices
+    config.hardware.baudrate = doc["modbus"]["baudrate"] | config.hardware.baudrate;
+
     JsonArray devices = doc["modbus"]["devices"];
     if (devices) {
         config.hardware.modbus_device_count = 0;
@@ -227,6 +242,7 @@ bool ConfigLoader::load_from_json(const char* json, SystemConfig& config) {
                     // Parse 4-20mA range thresholds
                     r.min_raw = reg["min_raw"] | 0;
                     r.max_raw = reg["max_raw"] | 65535;
+                    r.deadband = reg["deadband"] | 0.0f;
 
                     def.register_count++;
                 }
@@ -288,6 +304,8 @@ bool ConfigLoader::load_from_json(const char* json, SystemConfig& config) {
             const char* spunding_relay = ferm["spunding_relay"];
             if (spunding_relay) strncpy(def.spunding_relay, spunding_relay, sizeof(def.spunding_relay) - 1);
 
+            def.pid_interval_ms = ferm["pid_interval_ms"] | 0;
+
             config.fermenter_count++;
         }
     }
@@ -337,11 +355,14 @@ size_t ConfigLoader::to_json(const SystemConfig& config, char* buffer, size_t bu
     scheduler["base_cycle_ms"] = config.scheduler.base_cycle_ms;
     scheduler["base_samples_per_cycle"] = config.scheduler.base_samples_per_cycle;
     scheduler["min_sample_spacing_ms"] = config.scheduler.min_sample_spacing_ms;
+    scheduler["transaction_time_ms"] = config.scheduler.transaction_time_ms;
+    scheduler["control_period_ms"] = config.scheduler.control_period_ms;
     scheduler["bulk_read_enabled"] = config.scheduler.bulk_read_enabled;
 
     JsonObject pid = timing["pid"].to<JsonObject>();
     pid["calculation_interval_ms"] = config.pid_timing.calculation_interval_ms;
     pid["output_cycle_time_ms"] = config.pid_timing.output_cycle_time_ms;
+    pid["derivative_filter_ms"] = config.pid_timing.derivative_filter_ms;
 
     JsonObject safety = timing["safety"].to<JsonObject>();
     safety["check_interval_ms"] = config.safety_timing.check_interval_ms;
@@ -376,6 +397,9 @@ size_t ConfigLoader::to_json(const SystemConfig& config, char* buffer, size_t bu
         ferm["pressure_sensor"] = config.fermenters[i].pressure_sensor;
         ferm["cooling_relay"] = config.fermenters[i].cooling_relay;
         ferm["spunding_relay"] = config.fermenters[i].spunding_relay;
+        if (config.fermenters[i].pid_interval_ms > 0) {
+            ferm["pid_interval_ms"] = config.fermenters[i].pid_interval_ms;
+        }
     }
 
     return serializeJson(doc, buffer, buffer_size);
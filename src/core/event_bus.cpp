@@ -9,14 +9,33 @@ EventBus& get_event_bus() {
     return g_event_bus;
 }
 
-EventBus::EventBus() : subscriber_count_(0) {
+EventBus::EventBus()
+    : subscriber_count_(0)
+    , deferred_dropped_(0)
+#ifndef ESP32_BUILD
+    , deferred_head_(0)
+    , deferred_count_(0)
+#endif
+{
+    for (uint8_t t = 0; t < EVENT_TYPE_COUNT; t++) {
+        heads_[t].store(Subscriber::NONE);
+    }
 #ifdef ESP32_BUILD
     mutex_ = xSemaphoreCreateMutex();
+    deferred_queue_ = xQueueCreateStatic(DEFERRED_QUEUE_SIZE, sizeof(Event),
+                                         deferred_storage_, &deferred_queue_buf_);
+    dispatcher_task_ = nullptr;
 #endif
 }
 
 EventBus::~EventBus() {
 #ifdef ESP32_BUILD
+    if (dispatcher_task_) {
+        vTaskDelete(dispatcher_task_);
+    }
+    if (deferred_queue_) {
+        vQueueDelete(deferred_queue_);
+    }
     if (mutex_) {
         vSemaphoreDelete(mutex_);
     }
@@ -39,41 +58,102 @@ void EventBus::unlock() {
 #endif
 }
 
+int EventBus::subscribe(EventType type, EventHandler handler, void* ctx) {
+    if (!handler) {
+        return -1;
+    }
+    return add_subscriber(type, handler, ctx, nullptr);
+}
+
 int EventBus::subscribe(EventType type, EventCallback callback) {
+    if (!callback) {
+        return -1;
+    }
+    // Stored once in the slot; publish calls it through call_function
+    return add_subscriber(type, call_function, nullptr, &callback);
+}
+
+int EventBus::add_subscriber(EventType type, EventHandler handler, void* ctx,
+                             EventCallback* callback) {
+    uint8_t t = (uint8_t)type;
+    if (t >= EVENT_TYPE_COUNT) {
+        return -1;
+    }
+
     lock();
 
-    // Find empty slot
+    // Prefer a node that was never linked; otherwise reuse an inactive
+    // node already in this type's list (nodes cannot move between lists)
+    // that no publisher is still calling into
     int slot = -1;
     for (uint8_t i = 0; i < MAX_SUBSCRIBERS; i++) {
-        if (!subscribers_[i].active) {
+        if (!subscribers_[i].linked) {
             slot = i;
             break;
         }
     }
+    if (slot < 0) {
+        for (uint8_t i = heads_[t].load(); i != Subscriber::NONE; i = subscribers_[i].next.load()) {
+            if (!subscribers_[i].active.load() && subscribers_[i].busy.load() == 0) {
+                slot = i;
+                break;
+            }
+        }
+    }
 
     if (slot < 0) {
         unlock();
         return -1; // No slots available
     }
 
-    subscribers_[slot].type = type;
-    subscribers_[slot].callback = callback;
-    subscribers_[slot].active = true;
+    Subscriber& sub = subscribers_[slot];
+    sub.type = type;
+    sub.handler = handler;
+    if (callback) {
+        sub.callback = std::move(*callback);
+        sub.context = &sub.callback;
+    } else {
+        sub.callback = nullptr;
+        sub.context = ctx;
+    }
+
+    if (!sub.linked) {
+        // Append so subscribers are called in subscription order
+        sub.next.store(Subscriber::NONE);
+        uint8_t tail = heads_[t].load();
+        if (tail == Subscriber::NONE) {
+            heads_[t].store((uint8_t)slot, std::memory_order_release);
+        } else {
+            while (subscribers_[tail].next.load() != Subscriber::NONE) {
+                tail = subscribers_[tail].next.load();
+            }
+            subscribers_[tail].next.store((uint8_t)slot, std::memory_order_release);
+        }
+        sub.linked = true;
+    }
+
+    sub.active.store(true, std::memory_order_release);
     subscriber_count_++;
 
     unlock();
     return slot;
 }
 
+void EventBus::call_function(const Event& event, void* ctx) {
+    auto* callback = static_cast<EventCallback*>(ctx);
+    if (callback && *callback) {
+        (*callback)(event);
+    }
+}
+
 void EventBus::unsubscribe(int subscription_id) {
     if (subscription_id < 0 || subscription_id >= MAX_SUBSCRIBERS) {
         return;
     }
 
     lock();
-    if (subscribers_[subscription_id].active) {
-        subscribers_[subscription_id].active = false;
-        subscribers_[subscription_id].callback = nullptr;
+    if (subscribers_[subscription_id].active.load()) {
+        subscribers_[subscription_id].active.store(false);
         if (subscriber_count_ > 0) {
             subscriber_count_--;
         }
@@ -82,28 +162,97 @@ void EventBus::unsubscribe(int subscription_id) {
 }
 
 void EventBus::publish(const Event& event) {
-    lock();
+    uint8_t t = (uint8_t)event.type;
+    if (t >= EVENT_TYPE_COUNT) {
+        return;
+    }
 
-    // Copy subscribers to avoid holding lock during callbacks
-    Subscriber local_subs[MAX_SUBSCRIBERS];
-    uint8_t count = 0;
+    // Lock-free walk: nodes are never unlinked, so the list stays valid.
+    // busy is raised before active is checked, so add_subscriber() either
+    // sees it and leaves the node alone, or has finished rewriting it.
+    for (uint8_t i = heads_[t].load(std::memory_order_acquire);
+         i != Subscriber::NONE;
+         i = subscribers_[i].next.load(std::memory_order_acquire)) {
+        Subscriber& sub = subscribers_[i];
+        sub.busy.fetch_add(1);
+        if (sub.active.load()) {
+            sub.handler(event, sub.context);
+        }
+        sub.busy.fetch_sub(1, std::memory_order_release);
+    }
+}
 
-    for (uint8_t i = 0; i < MAX_SUBSCRIBERS; i++) {
-        if (subscribers_[i].active && subscribers_[i].type == event.type) {
-            local_subs[count++] = subscribers_[i];
+bool EventBus::publish_deferred(const Event& event) {
+    bool queued;
+#ifdef ESP32_BUILD
+    if (xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        queued = xQueueSendFromISR(deferred_queue_, &event, &woken) == pdTRUE;
+        if (woken) {
+            portYIELD_FROM_ISR();
         }
+    } else {
+        queued = xQueueSend(deferred_queue_, &event, 0) == pdTRUE;
     }
+#else
+    std::lock_guard<std::mutex> guard(deferred_mutex_);
+    queued = deferred_count_ < DEFERRED_QUEUE_SIZE;
+    if (queued) {
+        deferred_[(deferred_head_ + deferred_count_) % DEFERRED_QUEUE_SIZE] = event;
+        deferred_count_++;
+    }
+#endif
+    if (!queued) {
+        deferred_dropped_.fetch_add(1);
+    }
+    return queued;
+}
 
-    unlock();
+bool EventBus::pop_deferred(Event& event) {
+#ifdef ESP32_BUILD
+    return xQueueReceive(deferred_queue_, &event, 0) == pdTRUE;
+#else
+    std::lock_guard<std::mutex> guard(deferred_mutex_);
+    if (deferred_count_ == 0) {
+        return false;
+    }
+    event = deferred_[deferred_head_];
+    deferred_head_ = (deferred_head_ + 1) % DEFERRED_QUEUE_SIZE;
+    deferred_count_--;
+    return true;
+#endif
+}
+
+uint16_t EventBus::dispatch_deferred(uint16_t max_events) {
+    uint16_t count = 0;
+    Event event;
+    while ((max_events == 0 || count < max_events) && pop_deferred(event)) {
+        publish(event);
+        count++;
+    }
+    return count;
+}
 
-    // Call subscribers outside of lock
-    for (uint8_t i = 0; i < count; i++) {
-        if (local_subs[i].callback) {
-            local_subs[i].callback(event);
+#ifdef ESP32_BUILD
+void EventBus::dispatcher_task(void* arg) {
+    auto* bus = static_cast<EventBus*>(arg);
+    Event event;
+    for (;;) {
+        if (xQueueReceive(bus->deferred_queue_, &event, portMAX_DELAY) == pdTRUE) {
+            bus->publish(event);
         }
     }
 }
 
+bool EventBus::start_dispatcher(UBaseType_t priority, uint32_t stack_size) {
+    if (dispatcher_task_) {
+        return true;
+    }
+    return xTaskCreate(dispatcher_task, "evt_dispatch", stack_size, this,
+                       priority, &dispatcher_task_) == pdPASS;
+}
+#endif
+
 void EventBus::publish_sensor_update(uint8_t sensor_id, float value, uint32_t timestamp) {
     Event event;
     event.type = EventType::SENSOR_UPDATE;
@@ -139,6 +288,29 @@ void EventBus::publish_alarm(uint8_t source_id, uint32_t timestamp) {
     publish(event);
 }
 
+void EventBus::publish_sensors_updated(uint32_t sensor_mask, uint32_t timestamp) {
+    Event event;
+    event.type = EventType::SENSORS_UPDATED;
+    event.timestamp = timestamp;
+    event.data.mask = sensor_mask;
+    publish(event);
+}
+
+bool EventBus::has_subscribers(EventType type) const {
+    uint8_t t = (uint8_t)type;
+    if (t >= EVENT_TYPE_COUNT) {
+        return false;
+    }
+    for (uint8_t i = heads_[t].load(std::memory_order_acquire);
+         i != Subscriber::NONE;
+         i = subscribers_[i].next.load(std::memory_order_acquire)) {
+        if (subscribers_[i].active.load(std::memory_order_acquire)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 uint8_t EventBus::get_subscriber_count() const {
     return subscriber_count_;
 }
@@ -5,7 +5,17 @@ namespace core {
 StateManager::StateManager()
     : sensor_count_(0)
     , relay_count_(0)
-    , fermenter_count_(0) {
+    , fermenter_count_(0)
+    , sensor_history_failed_(false)
+    , lock_acquisitions_(0)
+    , lock_contended_(0)
+    , lock_timeouts_(0)
+    , snapshot_reads_(0)
+    , snapshot_retries_(0)
+    , snapshot_fallbacks_(0) {
+    for (auto& generation : generations_) generation.store(1);
+    for (auto& seq : sensor_seq_) seq.store(0);
+    for (auto& seq : relay_seq_) seq.store(0);
 #ifdef ESP32_BUILD
     mutex_ = xSemaphoreCreateMutex();
 #endif
@@ -21,23 +31,32 @@ StateManager::~StateManager() {
 
 bool StateManager::lock(uint32_t timeout_ms) {
 #ifdef ESP32_BUILD
-    // Use timeout instead of blocking forever to prevent deadlocks
-    TickType_t ticks = (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
-    BaseType_t result = xSemaphoreTake(mutex_, ticks);
-    if (result != pdTRUE) {
-        // Log warning for timeout - indicates potential deadlock
-        // In production, this should trigger an alert
-        return false;
+    if (xSemaphoreTake(mutex_, 0) != pdTRUE) {
+        lock_contended_.fetch_add(1, std::memory_order_relaxed);
+
+        // Use timeout instead of blocking forever to prevent deadlocks
+        TickType_t ticks = (timeout_ms == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+        BaseType_t result = xSemaphoreTake(mutex_, ticks);
+        if (result != pdTRUE) {
+            // Log warning for timeout - indicates potential deadlock
+            // In production, this should trigger an alert
+            lock_timeouts_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
     }
-    return true;
 #else
     // Simulator: std::mutex doesn't have timeout, but we use try_lock for tests
-    if (timeout_ms == 0) {
-        return mutex_.try_lock();
+    if (!mutex_.try_lock()) {
+        lock_contended_.fetch_add(1, std::memory_order_relaxed);
+        if (timeout_ms == 0) {
+            lock_timeouts_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        mutex_.lock();
     }
-    mutex_.lock();
-    return true;
 #endif
+    lock_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    return true;
 }
 
 void StateManager::unlock() {
@@ -48,6 +67,62 @@ void StateManager::unlock() {
 #endif
 }
 
+StateLockStats StateManager::get_lock_stats() const {
+    StateLockStats stats;
+    stats.acquisitions = lock_acquisitions_.load(std::memory_order_relaxed);
+    stats.contended = lock_contended_.load(std::memory_order_relaxed);
+    stats.timeouts = lock_timeouts_.load(std::memory_order_relaxed);
+    stats.snapshot_reads = snapshot_reads_.load(std::memory_order_relaxed);
+    stats.snapshot_retries = snapshot_retries_.load(std::memory_order_relaxed);
+    stats.snapshot_fallbacks = snapshot_fallbacks_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void StateManager::reset_lock_stats() {
+    lock_acquisitions_.store(0);
+    lock_contended_.store(0);
+    lock_timeouts_.store(0);
+    snapshot_reads_.store(0);
+    snapshot_retries_.store(0);
+    snapshot_fallbacks_.store(0);
+}
+
+void StateManager::begin_write(std::atomic<uint32_t>& seq) {
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void StateManager::end_write(std::atomic<uint32_t>& seq) {
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template <typename Copy>
+bool StateManager::read_consistent(const std::atomic<uint32_t>& seq, Copy copy) const {
+    snapshot_reads_.fetch_add(1, std::memory_order_relaxed);
+
+    for (uint8_t attempt = 0; attempt < SNAPSHOT_SPIN_LIMIT; attempt++) {
+        uint32_t before = seq.load(std::memory_order_acquire);
+        if ((before & 1) == 0) {
+            copy();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+        snapshot_retries_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Writer kept the record busy: wait for it on the mutex
+    snapshot_fallbacks_.fetch_add(1, std::memory_order_relaxed);
+    auto* self = const_cast<StateManager*>(this);
+    if (!self->lock()) {
+        return false;
+    }
+    copy();
+    self->unlock();
+    return true;
+}
+
 void StateManager::initialize(const SystemConfig& config) {
     lock();
 
@@ -78,6 +153,7 @@ void StateManager::initialize(const SystemConfig& config) {
                 auto& sensor = sensors_[sensor_count_ - 1];
                 sensor.filter_type = reg.filter;
                 sensor.alpha = reg.filter_alpha;
+                sensor.deadband = reg.deadband;
             }
         }
     }
@@ -108,10 +184,12 @@ bool StateManager::register_sensor(const char* name, const char* unit, float sca
     strncpy(sensor.unit, unit, sizeof(sensor.unit) - 1);
     sensor.scale = scale;
     sensor.quality = SensorQuality::UNKNOWN;
+    hot_.quality[sensor_count_] = SensorQuality::UNKNOWN;
     sensor.filter_type = FilterType::EMA;
     sensor.alpha = 0.3f;
 
     sensor_count_++;
+    mark_changed(StateDomain::SENSORS);
     return true;
 }
 
@@ -144,36 +222,62 @@ void StateManager::update_sensor_value(uint8_t sensor_id, float raw_value, uint3
     if (sensor_id >= sensor_count_) return;
 
     lock();
+    bool changed = hot_.raw_value[sensor_id] != raw_value;
+    begin_write(sensor_seq_[sensor_id]);
+    apply_raw_value(sensor_id, raw_value, timestamp);
+    end_write(sensor_seq_[sensor_id]);
+    if (changed) mark_changed(StateDomain::SENSORS);
+    unlock();
+}
+
+void StateManager::apply_raw_value(uint8_t sensor_id, float raw_value, uint32_t timestamp,
+                                   bool is_extra) {
     auto& sensor = sensors_[sensor_id];
+    hot_.raw_value[sensor_id] = raw_value;
+    hot_.timestamp[sensor_id] = timestamp;
     sensor.raw_value = raw_value;
     sensor.timestamp = timestamp;
 
-    // Add to base samples ring buffer
-    sensor.base_samples[sensor.base_index] = raw_value;
-    sensor.base_index = (sensor.base_index + 1) % 8;
-
-    // Calculate base average
-    float sum = 0;
-    uint8_t count = 0;
-    for (uint8_t i = 0; i < 8 && count < 3; i++) {
-        if (sensor.base_samples[i] != 0) {
-            sum += sensor.base_samples[i];
-            count++;
-        }
+    if (is_extra) {
+        sensor.extra_samples.push(raw_value);
+        sensor.extra_average = sensor.extra_samples.mean();
+    } else {
+        sensor.base_samples.push(raw_value);
+        sensor.base_average = sensor.base_samples.mean();
     }
-    if (count > 0) {
-        sensor.base_average = sum / count;
+}
+
+bool StateManager::is_suspect(const SensorState& sensor, float raw_value, bool is_extra) const {
+    const SuspectDetectorConfig& cfg = suspect_config_;
+    float min_dev = cfg.min_steps * (sensor.scale > 0.0f ? sensor.scale : 0.01f);
+    if (is_extra) {
+        return sensor.extra_samples.deviates(raw_value, cfg.sigma, min_dev, cfg.min_samples);
     }
+    return sensor.base_samples.deviates(raw_value, cfg.sigma, min_dev, cfg.min_samples);
+}
 
-    unlock();
+void StateManager::apply_filtered(uint8_t sensor_id, float filtered, float display) {
+    hot_.filtered_value[sensor_id] = filtered;
+    hot_.display_value[sensor_id] = display;
+    sensors_[sensor_id].filtered_value = filtered;
+    sensors_[sensor_id].display_value = display;
+}
+
+void StateManager::apply_quality(uint8_t sensor_id, SensorQuality quality) {
+    hot_.quality[sensor_id] = quality;
+    sensors_[sensor_id].quality = quality;
 }
 
 void StateManager::update_sensor_filtered(uint8_t sensor_id, float filtered, float display) {
     if (sensor_id >= sensor_count_) return;
 
     lock();
-    sensors_[sensor_id].filtered_value = filtered;
-    sensors_[sensor_id].display_value = display;
+    if (hot_.filtered_value[sensor_id] != filtered || hot_.display_value[sensor_id] != display) {
+        begin_write(sensor_seq_[sensor_id]);
+        apply_filtered(sensor_id, filtered, display);
+        end_write(sensor_seq_[sensor_id]);
+        mark_changed(StateDomain::SENSORS);
+    }
     unlock();
 }
 
@@ -181,8 +285,62 @@ void StateManager::set_sensor_quality(uint8_t sensor_id, SensorQuality quality)
     if (sensor_id >= sensor_count_) return;
 
     lock();
-    sensors_[sensor_id].quality = quality;
+    if (hot_.quality[sensor_id] != quality) {
+        begin_write(sensor_seq_[sensor_id]);
+        apply_quality(sensor_id, quality);
+        end_write(sensor_seq_[sensor_id]);
+        mark_changed(StateDomain::SENSORS);
+    }
+    unlock();
+}
+
+uint32_t StateManager::ingest_sensor_batch(const SensorSample* samples, uint8_t count,
+                                           uint32_t timestamp) {
+    if (!samples || count == 0) return 0;
+    if (!lock()) return 0;
+
+    uint32_t updated = 0;
+    bool changed = false;
+    for (uint8_t i = 0; i < count; i++) {
+        const SensorSample& sample = samples[i];
+        if (sample.sensor_id >= sensor_count_) continue;
+
+        uint8_t id = sample.sensor_id;
+        SensorQuality quality = sample.quality;
+        begin_write(sensor_seq_[id]);
+        if (sample.has_value) {
+            if (quality == SensorQuality::GOOD &&
+                is_suspect(sensors_[id], sample.raw_value, sample.is_extra)) {
+                quality = SensorQuality::SUSPECT;
+            }
+            changed = changed || hot_.raw_value[id] != sample.raw_value ||
+                      hot_.filtered_value[id] != sample.filtered_value ||
+                      hot_.display_value[id] != sample.display_value;
+            apply_raw_value(id, sample.raw_value, timestamp, sample.is_extra);
+            apply_filtered(id, sample.filtered_value, sample.display_value);
+            updated |= 1UL << id;
+        }
+        changed = changed || hot_.quality[id] != quality;
+        apply_quality(id, quality);
+        end_write(sensor_seq_[id]);
+    }
+
+    // A reading identical to the last one only refreshes its timestamp
+    if (changed) mark_changed(StateDomain::SENSORS);
     unlock();
+    return updated;
+}
+
+bool StateManager::read_sensor(uint8_t sensor_id, SensorSnapshot& out) const {
+    if (sensor_id >= sensor_count_) return false;
+
+    return read_consistent(sensor_seq_[sensor_id], [&]() {
+        out.raw_value = hot_.raw_value[sensor_id];
+        out.filtered_value = hot_.filtered_value[sensor_id];
+        out.display_value = hot_.display_value[sensor_id];
+        out.timestamp = hot_.timestamp[sensor_id];
+        out.quality = hot_.quality[sensor_id];
+    });
 }
 
 // Relay operations
@@ -203,6 +361,7 @@ bool StateManager::register_relay(const char* name, RelayType type, uint8_t gpio
     relay.duty_cycle = 0;
 
     relay_count_++;
+    mark_changed(StateDomain::RELAYS);
     return true;
 }
 
@@ -235,8 +394,14 @@ void StateManager::set_relay_state(uint8_t relay_id, bool state, uint32_t timest
     if (relay_id >= relay_count_) return;
 
     lock();
-    relays_[relay_id].state = state;
-    relays_[relay_id].last_change = timestamp;
+    RelayState& relay = relays_[relay_id];
+    if (relay.state != state || relay.last_change != timestamp) {
+        begin_write(relay_seq_[relay_id]);
+        relay.state = state;
+        relay.last_change = timestamp;
+        end_write(relay_seq_[relay_id]);
+        mark_changed(StateDomain::RELAYS);
+    }
     unlock();
 }
 
@@ -244,10 +409,26 @@ void StateManager::set_relay_duty_cycle(uint8_t relay_id, float duty_cycle) {
     if (relay_id >= relay_count_) return;
 
     lock();
-    relays_[relay_id].duty_cycle = duty_cycle;
+    if (relays_[relay_id].duty_cycle != duty_cycle) {
+        begin_write(relay_seq_[relay_id]);
+        relays_[relay_id].duty_cycle = duty_cycle;
+        end_write(relay_seq_[relay_id]);
+        mark_changed(StateDomain::RELAYS);
+    }
     unlock();
 }
 
+bool StateManager::read_relay(uint8_t relay_id, RelaySnapshot& out) const {
+    if (relay_id >= relay_count_) return false;
+
+    const RelayState& relay = relays_[relay_id];
+    return read_consistent(relay_seq_[relay_id], [&]() {
+        out.state = relay.state;
+        out.duty_cycle = relay.duty_cycle;
+        out.last_change = relay.last_change;
+    });
+}
+
 // Fermenter operations
 
 bool StateManager::register_fermenter(const FermenterDef& def) {
@@ -267,6 +448,7 @@ bool StateManager::register_fermenter(const FermenterDef& def) {
     ferm.spunding_relay_id = get_relay_id(def.spunding_relay);
 
     fermenter_count_++;
+    mark_changed(StateDomain::FERMENTERS);
     return true;
 }
 
@@ -293,8 +475,11 @@ void StateManager::update_fermenter_temps(uint8_t id, float current, float targe
     if (!ferm) return;
 
     lock();
-    ferm->current_temp = current;
-    ferm->target_temp = target;
+    if (ferm->current_temp != current || ferm->target_temp != target) {
+        ferm->current_temp = current;
+        ferm->target_temp = target;
+        mark_changed(StateDomain::FERMENTERS);
+    }
     unlock();
 }
 
@@ -303,8 +488,11 @@ void StateManager::update_fermenter_pressure(uint8_t id, float current, float ta
     if (!ferm) return;
 
     lock();
-    ferm->current_pressure = current;
-    ferm->target_pressure = target;
+    if (ferm->current_pressure != current || ferm->target_pressure != target) {
+        ferm->current_pressure = current;
+        ferm->target_pressure = target;
+        mark_changed(StateDomain::FERMENTERS);
+    }
     unlock();
 }
 
@@ -313,7 +501,10 @@ void StateManager::set_fermenter_mode(uint8_t id, FermenterMode mode) {
     if (!ferm) return;
 
     lock();
-    ferm->mode = mode;
+    if (ferm->mode != mode) {
+        ferm->mode = mode;
+        mark_changed(StateDomain::FERMENTERS);
+    }
     unlock();
 }
 
@@ -322,8 +513,11 @@ void StateManager::update_fermenter_plan_progress(uint8_t id, uint8_t step, floa
     if (!ferm) return;
 
     lock();
-    ferm->current_step = step;
-    ferm->hours_remaining = hours_remaining;
+    if (ferm->current_step != step || ferm->hours_remaining != hours_remaining) {
+        ferm->current_step = step;
+        ferm->hours_remaining = hours_remaining;
+        mark_changed(StateDomain::FERMENTERS);
+    }
     unlock();
 }
 
@@ -333,6 +527,9 @@ SystemState& StateManager::get_system_state() {
     return system_state_;
 }
 
+// Uptime, free heap, CPU load and MODBUS counters are telemetry: they
+// change every control tick and bump no generation (see StateDomain)
+
 void StateManager::update_system_uptime(uint32_t seconds) {
     lock();
     system_state_.uptime_seconds = seconds;
@@ -341,16 +538,23 @@ void StateManager::update_system_uptime(uint32_t seconds) {
 
 void StateManager::update_system_ntp_status(bool synced, uint32_t boot_time) {
     lock();
-    system_state_.ntp_synced = synced;
-    if (boot_time > 0) {
-        system_state_.last_boot = boot_time;
+    if (system_state_.ntp_synced != synced ||
+        (boot_time > 0 && system_state_.last_boot != boot_time)) {
+        system_state_.ntp_synced = synced;
+        if (boot_time > 0) {
+            system_state_.last_boot = boot_time;
+        }
+        mark_changed(StateDomain::SYSTEM);
     }
     unlock();
 }
 
 void StateManager::update_wifi_rssi(int rssi) {
     lock();
-    system_state_.wifi_rssi = rssi;
+    if (system_state_.wifi_rssi != rssi) {
+        system_state_.wifi_rssi = rssi;
+        mark_changed(StateDomain::SYSTEM);
+    }
     unlock();
 }
 
@@ -375,8 +579,11 @@ void StateManager::update_cpu_usage(float percent) {
 
 void StateManager::update_cpu_freq(uint32_t current_mhz, uint32_t max_mhz) {
     lock();
-    system_state_.cpu_freq_mhz = current_mhz;
-    system_state_.cpu_freq_max_mhz = max_mhz;
+    if (system_state_.cpu_freq_mhz != current_mhz || system_state_.cpu_freq_max_mhz != max_mhz) {
+        system_state_.cpu_freq_mhz = current_mhz;
+        system_state_.cpu_freq_max_mhz = max_mhz;
+        mark_changed(StateDomain::SYSTEM);
+    }
     unlock();
 }
 
@@ -392,6 +599,42 @@ void StateManager::sample_network_history(uint32_t link_speed_mbps, uint8_t chan
     unlock();
 }
 
+void StateManager::record_sensor_history(uint32_t now_s) {
+    lock();
+
+    if (!sensor_history_.is_allocated()) {
+        // Only try once - a failed allocation won't succeed on the next tick
+        if (sensor_history_failed_ || sensor_count_ == 0) {
+            unlock();
+            return;
+        }
+        if (!sensor_history_.allocate(sensor_count_)) {
+            sensor_history_failed_ = true;
+            unlock();
+            return;
+        }
+        // Store at the sensor's native resolution, but no coarser than 0.01
+        for (uint8_t i = 0; i < sensor_count_; i++) {
+            float scale = sensors_[i].scale;
+            sensor_history_.set_resolution(i,
+                (scale > 0.0f && scale < SensorHistory::DEFAULT_RESOLUTION) ?
+                    scale : SensorHistory::DEFAULT_RESOLUTION);
+        }
+    }
+
+    sensor_history_.advance(now_s);
+    for (uint8_t i = 0; i < sensor_history_.get_sensor_count(); i++) {
+        SensorQuality quality = hot_.quality[i];
+        if (quality == SensorQuality::BAD || quality == SensorQuality::UNKNOWN) {
+            sensor_history_.store_gap(i);
+        } else {
+            sensor_history_.store(i, hot_.filtered_value[i]);
+        }
+    }
+
+    unlock();
+}
+
 void StateManager::add_network_tx_bytes(uint32_t bytes) {
     lock();
     network_history_.add_tx_bytes(bytes);
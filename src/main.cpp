@@ -15,6 +15,8 @@
 #include "modules/fermentation_plan.h"
 #include "modules/rest_api.h"
 #include "modules/safety_controller.h"
+#include "modules/history_log.h"
+#include "modules/relay_output.h"
 
 #ifdef DEBUG_CONSOLE_ENABLED
 #include "modules/debug_console.h"
@@ -45,6 +47,15 @@
 #include "modules/http_server.h"
 #endif
 
+#ifdef MQTT_ENABLED
+#include "modules/mqtt_publisher.h"
+#ifdef ESP32_BUILD
+#include "hal/esp32/esp32_mqtt.h"
+#else
+#include "hal/simulator/posix_mqtt.h"
+#endif
+#endif
+
 #ifdef ESP32_BUILD
 // ESP32 specific includes
 #include "freertos/FreeRTOS.h"
@@ -60,6 +71,7 @@
 #include "hal/esp32/esp32_gpio.h"
 #include "hal/esp32/esp32_modbus.h"
 #include "hal/esp32/esp32_storage.h"
+#include "hal/esp32/esp32_flash_partition.h"
 #else
 // Native/Simulator build
 #include "hal/simulator/hal_simulator.h"
@@ -86,6 +98,7 @@ static hal::IModbusInterface* g_modbus = &g_esp32_modbus;
 static hal::esp32::ESP32GPIO g_gpio;
 static hal::esp32::ESP32Storage g_storage;
 static hal::esp32::ESP32Time g_time;
+static hal::esp32::ESP32FlashPartition g_history_flash;
 // TODO: ESP32 network implementation
 #ifdef DEBUG_CONSOLE_ENABLED
 static hal::esp32::ESP32Serial g_serial;
@@ -98,6 +111,7 @@ static hal::IModbusInterface* g_modbus = &g_sim_modbus;  // Default to simulator
 static hal::simulator::SimulatorGPIO g_gpio;
 static hal::simulator::SimulatorStorage g_storage;
 static hal::simulator::SimulatorTime g_time;
+static hal::simulator::SimulatorFlash g_history_flash;
 static hal::simulator::SimulatorNetwork g_network;
 #ifndef UNIT_TEST
 static bool g_use_serial_modbus = false;
@@ -112,7 +126,10 @@ static ModbusModule* g_modbus_module = nullptr;
 static FermentationPlanManager* g_plan_manager = nullptr;
 static SafetyController* g_safety = nullptr;
 static RestApiHandler* g_api = nullptr;
+static HistoryLog* g_history_log = nullptr;
 static PIDController g_pid_controllers[MAX_FERMENTERS];
+static PIDScheduler g_pid_scheduler;
+static TimeProportionalOutput g_relay_output(&g_state);
 #ifdef DEBUG_CONSOLE_ENABLED
 static DebugConsole* g_debug_console = nullptr;
 #endif
@@ -141,6 +158,15 @@ static hal::esp32::ESP32Ethernet* g_ethernet = nullptr;
 static HttpServer* g_http_server = nullptr;
 #endif
 
+#ifdef MQTT_ENABLED
+#ifdef ESP32_BUILD
+static hal::esp32::ESP32Mqtt g_mqtt_client;
+#else
+static hal::simulator::PosixMqtt g_mqtt_client;
+#endif
+static MqttPublisher* g_mqtt = nullptr;
+#endif
+
 #ifdef OTA_ENABLED
 // Flag to pause control loop during OTA
 static volatile bool g_ota_active = false;
@@ -152,6 +178,9 @@ static volatile bool g_ota_active = false;
  */
 void cleanup_modules() {
     // Delete in reverse order of creation
+#ifdef MQTT_ENABLED
+    if (g_mqtt) { delete g_mqtt; g_mqtt = nullptr; }
+#endif
 #ifdef HTTP_ENABLED
     if (g_http_server) { delete g_http_server; g_http_server = nullptr; }
 #endif
@@ -172,6 +201,7 @@ void cleanup_modules() {
     if (g_wifi_prov) { delete g_wifi_prov; g_wifi_prov = nullptr; }
     if (g_status_led) { delete g_status_led; g_status_led = nullptr; }
 #endif
+    if (g_history_log) { delete g_history_log; g_history_log = nullptr; }
     if (g_api) { delete g_api; g_api = nullptr; }
     if (g_safety) { delete g_safety; g_safety = nullptr; }
     if (g_plan_manager) { delete g_plan_manager; g_plan_manager = nullptr; }
@@ -342,10 +372,15 @@ bool system_init(bool config_loaded = false) {
 
     // Initialize MODBUS module
     if (!g_modbus_module->initialize(g_config)) {
-        printf("ERROR: Failed to initialize MODBUS module\n");
+        printf("ERROR: Failed to initialize MODBUS module: %s\n",
+               g_modbus_module->get_schedule_error());
         cleanup_modules();
         return false;
     }
+    if (g_modbus_module->get_schedule_error()[0] != '\0') {
+        printf("WARNING: MODBUS poll schedule degraded: %s\n",
+               g_modbus_module->get_schedule_error());
+    }
 
     // Load fermentation plans from storage
     g_plan_manager->load_from_storage();
@@ -353,8 +388,19 @@ bool system_init(bool config_loaded = false) {
     // Configure safety controller
     g_safety->configure(g_config.safety_timing);
 
+    // Time-proportioning window for PID-driven relays
+    g_relay_output.configure(g_config.pid_timing.output_cycle_time_ms,
+                             g_config.scheduler.control_period_ms);
+
     // Initialize PID controllers for each fermenter
+    // Each loop computes at its own interval, staggered across the interval
+    g_pid_scheduler.configure(g_config.fermenter_count);
     for (uint8_t i = 0; i < g_config.fermenter_count; i++) {
+        uint32_t interval_ms = g_config.fermenters[i].pid_interval_ms;
+        g_pid_scheduler.set_interval(i, interval_ms > 0 ? interval_ms
+                                                        : g_config.pid_timing.calculation_interval_ms);
+        g_pid_controllers[i].set_derivative_filter(g_config.pid_timing.derivative_filter_ms / 1000.0f);
+
         // Get PID params from fermenter state (uses PIDParams defaults: kp=2.0, ki=0.1, kd=1.0)
         auto* ferm = g_state.get_fermenter(g_config.fermenters[i].id);
         if (ferm) {
@@ -426,6 +472,19 @@ bool system_init(bool config_loaded = false) {
     }
 #endif
 
+    // History log (after NVS so the recovery checkpoint can be read)
+#ifdef ESP32_BUILD
+    g_history_flash.initialize(HistoryLog::PARTITION_SUBTYPE, HistoryLog::PARTITION_LABEL);
+#endif
+    g_history_log = new HistoryLog(&g_history_flash, &g_storage, &g_time, &g_state);
+    if (g_history_log && g_history_log->initialize(g_config)) {
+        printf("History log: %lu blocks, resuming at block %lu\n",
+               (unsigned long)g_history_log->get_block_count(),
+               (unsigned long)g_history_log->get_head());
+    } else {
+        printf("WARNING: History log unavailable\n");
+    }
+
 #ifdef ETHERNET_ENABLED
 #ifdef ESP32_BUILD
     // Initialize Ethernet (W5500 SPI)
@@ -558,6 +617,23 @@ bool system_init(bool config_loaded = false) {
     }
 #endif
 
+#ifdef MQTT_ENABLED
+    // MQTT telemetry (keeps reconnecting on its own if the broker is down)
+    if (g_config.mqtt.enabled && g_config.mqtt.broker[0] != '\0') {
+        g_mqtt = new MqttPublisher(&g_mqtt_client, &g_time, &g_state, &g_events,
+                                   g_config.mqtt, g_config.wifi.hostname);
+        if (!g_mqtt) {
+            printf("WARNING: Failed to allocate MqttPublisher, continuing without MQTT\n");
+        } else if (g_mqtt->initialize()) {
+            printf("MQTT publishing to %s:%u\n", g_config.mqtt.broker, g_config.mqtt.port);
+        } else {
+            printf("WARNING: MQTT initialization failed\n");
+            delete g_mqtt;
+            g_mqtt = nullptr;
+        }
+    }
+#endif
+
 #ifdef DEBUG_CONSOLE_ENABLED
     g_debug_console = new DebugConsole(
         &g_serial, &g_time, &g_state, &g_events,
@@ -584,6 +660,10 @@ bool system_init(bool config_loaded = false) {
 #endif
     );
     g_debug_console->initialize(115200);
+    g_debug_console->set_modbus_module(g_modbus_module);
+#ifdef MQTT_ENABLED
+    g_debug_console->set_mqtt_publisher(g_mqtt);
+#endif
 
     // Suppress TLS/HTTPS handshake error messages by default
     // These are often spurious (client disconnects, timeouts, etc)
@@ -597,6 +677,9 @@ bool system_init(bool config_loaded = false) {
 
 #ifdef HTTP_ENABLED
     g_debug_console->set_http_server(g_http_server);
+    if (g_http_server) {
+        g_debug_console->set_http_cache(&g_http_server->get_cache_stats());
+    }
 #ifdef OTA_ENABLED
     g_debug_console->set_ota_manager(g_http_server->get_ota_manager());
 #endif
@@ -626,55 +709,84 @@ void control_loop() {
     }
 #endif
 
-    // 1. Poll MODBUS sensors
-    g_modbus_module->poll_cycle();
+    // 1. Poll MODBUS sensors (only the transactions due this tick)
+    // Budget half the control period so a slow bus cannot stall the loop
+    g_modbus_module->poll(g_config.scheduler.control_period_ms / 2);
 
     // 2. Update fermentation plans
     g_plan_manager->update();
 
     // 3. Run PID control for each fermenter
+    // Mode and sensor checks run every tick; each PID computes on its own
+    // interval with the measured dt
+    uint32_t pid_now_ms = g_time.millis();
     for (uint8_t i = 0; i < g_config.fermenter_count; i++) {
         uint8_t ferm_id = g_config.fermenters[i].id;
         auto* ferm = g_state.get_fermenter(ferm_id);
         if (!ferm) continue;
 
-        // Skip if not in control mode
-        if (ferm->mode == FermenterMode::OFF) continue;
+        // Skip if not in control mode (relay left to manual control)
+        if (ferm->mode == FermenterMode::OFF) {
+            if (ferm->cooling_relay_id != 0xFF) {
+                g_relay_output.release(ferm->cooling_relay_id);
+            }
+            continue;
+        }
 
         // Check temperature sensor quality - don't control with bad sensor data
-        auto* temp_sensor = g_state.get_sensor_by_id(ferm->temp_sensor_id);
-        if (!temp_sensor || temp_sensor->quality != SensorQuality::GOOD) {
+        if (g_state.get_sensor_quality(ferm->temp_sensor_id) != SensorQuality::GOOD) {
             // Sensor is bad - turn off cooling as a safe default
             uint8_t relay_id = ferm->cooling_relay_id;
             if (relay_id != 0xFF) {
-                g_state.set_relay_state(relay_id, false, g_time.millis());
+                g_relay_output.force_off(relay_id, pid_now_ms);
             }
             continue;  // Skip PID computation
         }
 
+        float dt_s;
+        if (!g_pid_scheduler.due(i, pid_now_ms, dt_s)) continue;
+
         // Get setpoint from plan or manual
         float setpoint = ferm->target_temp;
 
         // Compute PID output
-        float output = g_pid_controllers[i].compute(setpoint, ferm->current_temp);
+        float output = g_pid_controllers[i].compute(setpoint, ferm->current_temp, dt_s);
 
         // Update fermenter state with PID output
-        ferm->pid_output = output;
+        if (ferm->pid_output != output) {
+            ferm->pid_output = output;
+            g_state.mark_changed(core::StateDomain::FERMENTERS);
+        }
 
-        // Apply output to cooling relay (time-proportional control would go here)
-        // For now, simple on/off based on 50% threshold
-        bool cooling_on = output > 50.0f;
+        // Cooling relay is time-proportioned over output_cycle_time_ms
         uint8_t relay_id = ferm->cooling_relay_id;
         if (relay_id != 0xFF) {
-            g_state.set_relay_state(relay_id, cooling_on, g_time.millis());
+            g_relay_output.set_duty(relay_id, output);
         }
     }
 
+    // Relay edges on every tick, independent of the PID rate
+    g_relay_output.update(g_time.millis());
+
     // 4. Safety checks
     g_safety->check();
 
+    // Persist relay/plan transitions and periodic sensor snapshots
+    if (g_history_log) {
+        g_history_log->update();
+    }
+
     // 5. Update system stats
     g_state.update_system_uptime(g_time.millis() / 1000);
+
+    // Sensor history: one tier-0 sample per second
+    static uint32_t last_history_s = UINT32_MAX;
+    uint32_t history_s = g_time.millis() / 1000;
+    if (history_s != last_history_s) {
+        g_state.record_sensor_history(history_s);
+        last_history_s = history_s;
+    }
+
     g_state.update_modbus_stats(
         g_modbus->get_transaction_count(),
         g_modbus->get_error_count()
@@ -682,12 +794,12 @@ void control_loop() {
 #ifdef ESP32_BUILD
     g_state.update_free_heap(esp_get_free_heap_size());
 
-    // Calculate CPU usage based on actual work time within the 100ms cycle
+    // Calculate CPU usage based on actual work time within the control period
     static float cpu_usage_filtered = 0.0f;
     uint64_t loop_end_us = esp_timer_get_time();
     uint64_t work_time_us = loop_end_us - loop_start_us;
-    // Work time as percentage of 100ms cycle
-    float load = (float)work_time_us / 1000.0f;  // Convert to percentage (100ms = 100%)
+    // Work time as percentage of the control period (us / (ms * 10) = %)
+    float load = (float)work_time_us / (g_config.scheduler.control_period_ms * 10.0f);
     if (load > 100) load = 100;
     // Apply EMA filter for smooth display
     cpu_usage_filtered = cpu_usage_filtered * 0.9f + load * 0.1f;
@@ -792,7 +904,8 @@ void control_task(void* pvParameters) {
     (void)pvParameters;
 
     TickType_t last_wake = xTaskGetTickCount();
-    const TickType_t interval = pdMS_TO_TICKS(g_config.scheduler.base_cycle_ms);
+    // Fixed short tick - MODBUS transactions are spread across ticks by poll()
+    const TickType_t interval = pdMS_TO_TICKS(g_config.scheduler.control_period_ms);
 
     while (true) {
         control_loop();
@@ -822,12 +935,17 @@ extern "C" void app_main() {
     // TODO: Create HTTP server task
     // TODO: Create display update task
 
-    // Main task handles debug console
+    // Main task handles debug console and MQTT (off the control task)
     while (true) {
 #ifdef DEBUG_CONSOLE_ENABLED
         if (g_debug_console) {
             g_debug_console->process();
         }
+#endif
+#ifdef MQTT_ENABLED
+        if (g_mqtt) {
+            g_mqtt->process();
+        }
 #endif
         vTaskDelay(pdMS_TO_TICKS(10));  // 10ms for responsive console
     }
@@ -897,10 +1015,25 @@ int main(int argc, char** argv) {
 
     printf("\nStarting control loop (press Ctrl+C to stop)...\n\n");
 
-    // Run control loop
+    // Run control loop at the control period; print once per sensor cycle
+    const uint32_t tick_ms = g_config.scheduler.control_period_ms;
+    const uint32_t ticks_per_cycle = (g_config.scheduler.base_cycle_ms + tick_ms - 1) / tick_ms;
     int cycle = 0;
+    uint32_t tick = 0;
     while (cycle < 10) {  // Run 10 cycles for demo
         control_loop();
+#ifdef MQTT_ENABLED
+        if (g_mqtt) {
+            g_mqtt->process();
+        }
+#endif
+
+        // Advance simulator time by one control tick
+        g_time.advance_millis(tick_ms);
+        if (++tick < ticks_per_cycle) {
+            continue;
+        }
+        tick = 0;
 
         // Print status every cycle
         printf("Cycle %d:\n", cycle + 1);
@@ -919,8 +1052,6 @@ int main(int argc, char** argv) {
             }
         }
 
-        // Advance simulator time
-        g_time.advance_millis(g_config.scheduler.base_cycle_ms);
         g_time.advance_unix_time(1);
 
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -934,9 +1065,17 @@ int main(int argc, char** argv) {
 #endif
     }
 
+    const auto& poll_stats = g_modbus_module->get_poll_stats();
+    printf("\nPoll engine: %lu cycles, %lu overruns, max jitter %lu ms, max call %lu ms\n",
+           (unsigned long)poll_stats.cycles, (unsigned long)poll_stats.overruns,
+           (unsigned long)poll_stats.max_jitter_ms, (unsigned long)poll_stats.max_call_ms);
+
     printf("\nSimulation complete.\n");
 
     // Cleanup
+#ifdef MQTT_ENABLED
+    delete g_mqtt;
+#endif
     delete g_modbus_module;
     delete g_plan_manager;
     delete g_safety;
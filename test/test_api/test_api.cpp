@@ -188,6 +188,30 @@ void test_api_endpoint_not_found() {
     TEST_ASSERT_EQUAL(404, response.status_code);
 }
 
+void test_api_fermenter_subpaths_match_exactly() {
+    FermentationPlanManager plans(&sim_time, &storage, &state, &events);
+    RestApiHandler api(&state, &events, &plans, &config);
+
+    // Used to match through strstr(path, "/plan")
+    HttpResponse response;
+    api.handle_request(HttpMethod::GET, "/fermenters/1/xplan", nullptr, response);
+    TEST_ASSERT_EQUAL(404, response.status_code);
+    TEST_ASSERT_NOT_NULL(strstr(response.body, "Endpoint not found"));
+
+    HttpResponse bad_id;
+    api.handle_request(HttpMethod::GET, "/fermenters/1x/plan", nullptr, bad_id);
+    TEST_ASSERT_EQUAL(404, bad_id.status_code);
+
+    HttpResponse out_of_range;
+    api.handle_request(HttpMethod::GET, "/fermenters/9/plan", nullptr, out_of_range);
+    TEST_ASSERT_EQUAL(404, out_of_range.status_code);
+    TEST_ASSERT_NOT_NULL(strstr(out_of_range.body, "Fermenter not found"));
+
+    HttpResponse wrong_method;
+    api.handle_request(HttpMethod::PUT, "/fermenters/1/plan", nullptr, wrong_method);
+    TEST_ASSERT_EQUAL(404, wrong_method.status_code);
+}
+
 // Safety Controller tests
 
 void test_safety_no_alarms_initially() {
@@ -301,6 +325,7 @@ int main(int argc, char **argv) {
     RUN_TEST(test_api_set_setpoint);
     RUN_TEST(test_api_get_system_status);
     RUN_TEST(test_api_endpoint_not_found);
+    RUN_TEST(test_api_fermenter_subpaths_match_exactly);
 
     // Safety Controller tests
     RUN_TEST(test_safety_no_alarms_initially);
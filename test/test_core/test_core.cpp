@@ -3,6 +3,11 @@
 #include "core/config.h"
 #include "core/state_manager.h"
 #include "core/event_bus.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <string>
 
 using namespace core;
 
@@ -114,6 +119,268 @@ void test_state_manager_register_fermenter() {
     TEST_ASSERT_EQUAL(1, ferm->pressure_sensor_id);
 }
 
+void test_state_manager_generation() {
+    StateManager sm;
+    sm.register_sensor("temp", "°C");
+    sm.register_relay("cool", RelayType::SSR);
+
+    uint32_t gen = sm.get_generation();
+    sm.update_sensor_filtered(0, 18.0f, 18.0f);
+    TEST_ASSERT_TRUE(sm.get_generation() != gen);
+
+    gen = sm.get_generation();
+    sm.set_relay_state(0, true, 1000);
+    TEST_ASSERT_TRUE(sm.get_generation() != gen);
+
+    // Only the domain that changed moves
+    uint32_t sensors = sm.get_generation(StateDomain::SENSORS);
+    uint32_t relays = sm.get_generation(StateDomain::RELAYS);
+    sm.set_relay_state(0, false, 2000);
+    TEST_ASSERT_EQUAL(sensors, sm.get_generation(StateDomain::SENSORS));
+    TEST_ASSERT_TRUE(sm.get_generation(StateDomain::RELAYS) != relays);
+    TEST_ASSERT_TRUE(sm.get_generation(state_domain_bit(StateDomain::RELAYS)) != relays);
+
+    // Telemetry and rewrites of stored values leave it alone
+    gen = sm.get_generation();
+    sm.update_system_uptime(42);
+    sm.update_free_heap(100000);
+    sm.update_cpu_usage(12.5f);
+    sm.update_modbus_stats(10, 1);
+    sm.update_sensor_filtered(0, 18.0f, 18.0f);
+    sm.set_relay_state(0, false, 2000);
+    sm.set_relay_duty_cycle(0, 0.0f);
+    TEST_ASSERT_EQUAL(gen, sm.get_generation());
+
+    // Reads leave it alone
+    SensorSnapshot snap;
+    sm.read_sensor(0, snap);
+    sm.get_sensor_value(0);
+    TEST_ASSERT_EQUAL(gen, sm.get_generation());
+
+    // Direct writers bump it explicitly
+    sm.mark_changed(StateDomain::FERMENTERS);
+    TEST_ASSERT_TRUE(sm.get_generation() != gen);
+}
+
+void test_state_manager_snapshot_reads() {
+    StateManager sm;
+    sm.register_sensor("temp", "°C", 0.1f);
+    sm.register_relay("cool", RelayType::SSR);
+
+    sm.update_sensor_value(0, 18.4f, 500);
+    sm.update_sensor_filtered(0, 18.2f, 18.0f);
+    sm.set_sensor_quality(0, SensorQuality::GOOD);
+    sm.set_relay_state(0, true, 700);
+    sm.set_relay_duty_cycle(0, 40.0f);
+
+    SensorSnapshot s;
+    TEST_ASSERT_TRUE(sm.read_sensor(0, s));
+    TEST_ASSERT_EQUAL_FLOAT(18.4f, s.raw_value);
+    TEST_ASSERT_EQUAL_FLOAT(18.2f, s.filtered_value);
+    TEST_ASSERT_EQUAL_FLOAT(18.0f, s.display_value);
+    TEST_ASSERT_EQUAL_UINT32(500, s.timestamp);
+    TEST_ASSERT_EQUAL(SensorQuality::GOOD, s.quality);
+    TEST_ASSERT_FALSE(sm.read_sensor(1, s));
+
+    RelaySnapshot r;
+    TEST_ASSERT_TRUE(sm.read_relay(0, r));
+    TEST_ASSERT_TRUE(r.state);
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, r.duty_cycle);
+    TEST_ASSERT_EQUAL_UINT32(700, r.last_change);
+
+    // Snapshot reads work while the mutex is held elsewhere
+    sm.reset_lock_stats();
+    TEST_ASSERT_TRUE(sm.lock());
+    TEST_ASSERT_TRUE(sm.read_sensor(0, s));
+    TEST_ASSERT_FALSE(sm.lock(0));
+    sm.unlock();
+
+    StateLockStats stats = sm.get_lock_stats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.acquisitions);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.contended);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.timeouts);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.snapshot_reads);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.snapshot_fallbacks);
+}
+
+void test_state_manager_hot_block() {
+    StateManager sm;
+    sm.register_sensor("temp", "°C", 0.1f);
+    sm.register_sensor("pressure", "bar", 0.01f);
+
+    TEST_ASSERT_EQUAL(SensorQuality::UNKNOWN, sm.get_sensor_quality(0));
+
+    sm.update_sensor_value(0, 18.4f, 500);
+    sm.update_sensor_filtered(0, 18.2f, 18.0f);
+    sm.set_sensor_quality(0, SensorQuality::GOOD);
+
+    SensorSample sample = {1, true, 1.2f, 1.1f, 1.0f, SensorQuality::SUSPECT, false};
+    TEST_ASSERT_EQUAL_UINT32(0x2, sm.ingest_sensor_batch(&sample, 1, 900));
+
+    const SensorHotBlock& hot = sm.get_sensor_hot();
+    TEST_ASSERT_EQUAL_FLOAT(18.2f, hot.filtered_value[0]);
+    TEST_ASSERT_EQUAL_FLOAT(18.0f, hot.display_value[0]);
+    TEST_ASSERT_EQUAL_FLOAT(18.4f, hot.raw_value[0]);
+    TEST_ASSERT_EQUAL_UINT32(500, hot.timestamp[0]);
+    TEST_ASSERT_EQUAL(SensorQuality::GOOD, hot.quality[0]);
+    TEST_ASSERT_EQUAL_FLOAT(1.1f, sm.get_sensor_value(1));
+    TEST_ASSERT_EQUAL(SensorQuality::SUSPECT, sm.get_sensor_quality(1));
+    TEST_ASSERT_EQUAL_UINT32(900, sm.get_sensor_timestamp(1));
+
+    // SensorState keeps mirroring the live values for existing callers
+    auto* sensor = sm.get_sensor_by_id(1);
+    TEST_ASSERT_EQUAL_FLOAT(1.1f, sensor->filtered_value);
+    TEST_ASSERT_EQUAL_FLOAT(1.2f, sensor->raw_value);
+    TEST_ASSERT_EQUAL(SensorQuality::SUSPECT, sensor->quality);
+
+    // Out-of-range IDs (e.g. unmapped 0xFF) read as no data
+    TEST_ASSERT_EQUAL(SensorQuality::UNKNOWN, sm.get_sensor_quality(2));
+    TEST_ASSERT_EQUAL(SensorQuality::UNKNOWN, sm.get_sensor_quality(0xFF));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, sm.get_sensor_value(0xFF));
+}
+
+void test_running_window_matches_rescan() {
+    RunningWindow<8> window;
+    float ring[8];
+    uint8_t n = 0;
+
+    TEST_ASSERT_EQUAL(0, window.count());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, window.mean());
+
+    // Slowly drifting 20 °C signal with small noise, then a negative excursion
+    for (int i = 0; i < 100; i++) {
+        float value = 20.0f + i * 0.01f + ((i * 7) % 5) * 0.003f;
+        if (i >= 60 && i < 70) value = -5.0f + i * 0.1f;
+        window.push(value);
+        ring[i % 8] = value;
+        if (n < 8) n++;
+
+        float sum = 0, lo = ring[0], hi = ring[0];
+        for (uint8_t k = 0; k < n; k++) {
+            sum += ring[k];
+            if (ring[k] < lo) lo = ring[k];
+            if (ring[k] > hi) hi = ring[k];
+        }
+        float mean = sum / n;
+        float var = 0;
+        for (uint8_t k = 0; k < n; k++) var += (ring[k] - mean) * (ring[k] - mean);
+        var /= n;
+
+        TEST_ASSERT_EQUAL(n, window.count());
+        TEST_ASSERT_EQUAL_FLOAT(value, window.latest());
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, mean, window.mean());
+        TEST_ASSERT_EQUAL_FLOAT(lo, window.min());
+        TEST_ASSERT_EQUAL_FLOAT(hi, window.max());
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f + var * 1e-3f, var, window.variance());
+    }
+}
+
+void test_state_manager_base_average() {
+    StateManager sm;
+    sm.register_sensor("glycol", "°C", 0.1f);
+    auto* sensor = sm.get_sensor_by_id(0);
+
+    // 0.0 °C is a real reading, not an empty slot
+    sm.update_sensor_value(0, 2.0f, 100);
+    sm.update_sensor_value(0, 0.0f, 200);
+    sm.update_sensor_value(0, -2.0f, 300);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, sensor->base_average);
+    TEST_ASSERT_EQUAL_FLOAT(-2.0f, sensor->base_samples.min());
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, sensor->base_samples.max());
+
+    // Average covers the latest 8 samples, not stale slots
+    for (int i = 0; i < 8; i++) {
+        sm.update_sensor_value(0, 5.0f, 400 + i * 100);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, sensor->base_average);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, sensor->base_samples.variance());
+    TEST_ASSERT_EQUAL(0, sensor->extra_samples.count());
+}
+
+void test_state_manager_suspect_detector() {
+    StateManager sm;
+    sm.register_sensor("temp", "°C", 0.1f);
+
+    SensorSample sample = {0, true, 18.0f, 18.0f, 18.0f, SensorQuality::GOOD, false};
+    for (int i = 0; i < 8; i++) {
+        sample.raw_value = 18.0f + (i % 2) * 0.1f;
+        sm.ingest_sensor_batch(&sample, 1, i * 333);
+        TEST_ASSERT_EQUAL(SensorQuality::GOOD, sm.get_sensor_quality(0));
+    }
+
+    // Small step within min_steps stays GOOD
+    sample.raw_value = 18.6f;
+    sm.ingest_sensor_batch(&sample, 1, 3000);
+    TEST_ASSERT_EQUAL(SensorQuality::GOOD, sm.get_sensor_quality(0));
+
+    // Spike: flagged but still stored
+    sample.raw_value = 35.0f;
+    TEST_ASSERT_EQUAL_UINT32(0x1, sm.ingest_sensor_batch(&sample, 1, 3333));
+    TEST_ASSERT_EQUAL(SensorQuality::SUSPECT, sm.get_sensor_quality(0));
+    TEST_ASSERT_EQUAL_FLOAT(35.0f, sm.get_sensor_by_id(0)->raw_value);
+
+    // Back to normal
+    sample.raw_value = 18.1f;
+    sm.ingest_sensor_batch(&sample, 1, 3666);
+    TEST_ASSERT_EQUAL(SensorQuality::GOOD, sm.get_sensor_quality(0));
+
+    // Extra samples are checked against the extra ring, which is still empty
+    sample.is_extra = true;
+    sample.raw_value = 35.0f;
+    sm.ingest_sensor_batch(&sample, 1, 4000);
+    TEST_ASSERT_EQUAL(SensorQuality::GOOD, sm.get_sensor_quality(0));
+    TEST_ASSERT_EQUAL(1, sm.get_sensor_by_id(0)->extra_samples.count());
+}
+
+void test_state_manager_scan_benchmark() {
+    const int ITERATIONS = 200000;
+    StateManager sm;
+    char name[16];
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        snprintf(name, sizeof(name), "s%u", i);
+        sm.register_sensor(name, "°C", 0.1f);
+        sm.update_sensor_value(i, 10.0f + i, 100);
+        sm.update_sensor_filtered(i, 10.0f + i, 10.0f + i);
+        sm.set_sensor_quality(i, (i % 4 == 3) ? SensorQuality::BAD : SensorQuality::GOOD);
+    }
+
+    // Typical scan: sum the usable filtered values of every sensor
+    volatile float aos_out = 0, soa_out = 0;
+    using clock = std::chrono::steady_clock;
+
+    auto t0 = clock::now();
+    for (int n = 0; n < ITERATIONS; n++) {
+        float sum = 0;
+        for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+            const SensorState* s = sm.get_sensor_by_id(i);
+            if (s->quality == SensorQuality::GOOD) sum += s->filtered_value;
+        }
+        aos_out = sum;
+    }
+    auto t1 = clock::now();
+    for (int n = 0; n < ITERATIONS; n++) {
+        const SensorHotBlock& hot = sm.get_sensor_hot();
+        float sum = 0;
+        for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+            if (hot.quality[i] == SensorQuality::GOOD) sum += hot.filtered_value[i];
+        }
+        soa_out = sum;
+    }
+    auto t2 = clock::now();
+
+    double aos_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / ITERATIONS;
+    double soa_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / ITERATIONS;
+
+    printf("\n  Full-state scan, %u sensors (filtered_value + quality)\n", MAX_SENSORS);
+    printf("    SensorState array (%4u B stride): %8.1f ns/scan\n",
+           (unsigned)sizeof(SensorState), aos_ns);
+    printf("    SensorHotBlock (SoA):              %8.1f ns/scan (%.1fx)\n",
+           soa_ns, aos_ns / soa_ns);
+
+    TEST_ASSERT_EQUAL_FLOAT(aos_out, soa_out);
+    TEST_ASSERT_TRUE(soa_out > 0.0f);
+}
+
 // Event Bus tests
 
 void test_event_bus_subscribe_publish() {
@@ -226,6 +493,323 @@ void test_event_bus_convenience_methods() {
     TEST_ASSERT_EQUAL_FLOAT(22.3f, received_value);
 }
 
+static void count_event(const Event& e, void* ctx) {
+    *static_cast<float*>(ctx) += e.data.value;
+}
+
+void test_event_bus_handler_context() {
+    EventBus bus;
+    float sum_a = 0, sum_b = 0;
+
+    int a = bus.subscribe(EventType::SENSOR_UPDATE, count_event, &sum_a);
+    int b = bus.subscribe(EventType::SENSOR_UPDATE, count_event, &sum_b);
+    TEST_ASSERT_TRUE(a >= 0 && b >= 0 && a != b);
+    TEST_ASSERT_EQUAL(-1, bus.subscribe(EventType::SENSOR_UPDATE, nullptr, &sum_a));
+
+    bus.publish_sensor_update(1, 2.0f, 0);
+    bus.unsubscribe(a);
+    bus.publish_sensor_update(1, 3.0f, 0);
+
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, sum_a);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, sum_b);
+    TEST_ASSERT_EQUAL(1, bus.get_subscriber_count());
+}
+
+void test_event_bus_slot_reuse() {
+    EventBus bus;
+    float sum = 0;
+
+    // Fill every slot, then free one of each type
+    int first_alarm = -1, first_relay = -1;
+    for (uint8_t i = 0; i < EventBus::MAX_SUBSCRIBERS; i++) {
+        EventType type = (i % 2) ? EventType::ALARM : EventType::RELAY_CHANGE;
+        int id = bus.subscribe(type, count_event, &sum);
+        TEST_ASSERT_TRUE(id >= 0);
+        if (type == EventType::ALARM && first_alarm < 0) first_alarm = id;
+        if (type == EventType::RELAY_CHANGE && first_relay < 0) first_relay = id;
+    }
+    TEST_ASSERT_EQUAL(-1, bus.subscribe(EventType::ALARM, count_event, &sum));
+
+    bus.unsubscribe(first_alarm);
+    bus.unsubscribe(first_relay);
+
+    // A freed node is reused only by its own type
+    TEST_ASSERT_EQUAL(-1, bus.subscribe(EventType::SENSOR_UPDATE, count_event, &sum));
+    TEST_ASSERT_EQUAL(first_alarm, bus.subscribe(EventType::ALARM, count_event, &sum));
+
+    int calls = 0;
+    TEST_ASSERT_EQUAL(first_relay, bus.subscribe(EventType::RELAY_CHANGE, [&](const Event&) { calls++; }));
+    bus.publish_relay_change(1, true, 0);
+    TEST_ASSERT_EQUAL(1, calls);
+}
+
+void test_event_bus_no_reuse_while_publishing() {
+    EventBus bus;
+    float sum = 0;
+    for (uint8_t i = 0; i + 1 < EventBus::MAX_SUBSCRIBERS; i++) {
+        bus.subscribe(EventType::ALARM, count_event, &sum);
+    }
+
+    // The last free slot unsubscribes itself and subscribes again while
+    // its own std::function is still running
+    int self = -1;
+    int resubscribed = 0;
+    int calls = 0;
+    std::string tag = "still alive";
+    self = bus.subscribe(EventType::RELAY_CHANGE, [&, tag](const Event&) {
+        calls++;
+        bus.unsubscribe(self);
+        resubscribed = bus.subscribe(EventType::RELAY_CHANGE, [&](const Event&) { calls += 10; });
+        TEST_ASSERT_EQUAL_STRING("still alive", tag.c_str());
+    });
+    TEST_ASSERT_TRUE(self >= 0);
+
+    bus.publish_relay_change(1, true, 0);
+    TEST_ASSERT_EQUAL(1, calls);
+    TEST_ASSERT_EQUAL(-1, resubscribed);    // Node busy: not reused
+
+    // Once the publish has returned the node is free again
+    TEST_ASSERT_EQUAL(self, bus.subscribe(EventType::RELAY_CHANGE, [&](const Event&) { calls += 100; }));
+    bus.publish_relay_change(1, false, 0);
+    TEST_ASSERT_EQUAL(101, calls);
+}
+
+void test_event_bus_deferred_dispatch() {
+    EventBus bus;
+    float sum = 0;
+    bus.subscribe(EventType::SENSOR_UPDATE, count_event, &sum);
+
+    Event event;
+    event.type = EventType::SENSOR_UPDATE;
+    event.data.value = 1.0f;
+    for (uint8_t i = 0; i < EventBus::DEFERRED_QUEUE_SIZE; i++) {
+        TEST_ASSERT_TRUE(bus.publish_deferred(event));
+    }
+    TEST_ASSERT_FALSE(bus.publish_deferred(event));
+    TEST_ASSERT_EQUAL_UINT32(1, bus.get_deferred_dropped());
+
+    // Nothing is delivered until the queue is drained
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, sum);
+    TEST_ASSERT_EQUAL(10, bus.dispatch_deferred(10));
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, sum);
+    TEST_ASSERT_EQUAL(EventBus::DEFERRED_QUEUE_SIZE - 10, bus.dispatch_deferred());
+    TEST_ASSERT_EQUAL(0, bus.dispatch_deferred());
+    TEST_ASSERT_EQUAL_FLOAT((float)EventBus::DEFERRED_QUEUE_SIZE, sum);
+}
+
+/**
+ * Previous EventBus::publish: lock, scan all slots, copy matching
+ * std::functions, unlock, call. Kept here as the benchmark baseline.
+ */
+class LegacyEventBus {
+public:
+    struct Slot {
+        EventType type;
+        EventCallback callback;
+        bool active = false;
+    };
+
+    void subscribe(EventType type, EventCallback callback) {
+        for (auto& slot : slots_) {
+            if (!slot.active) {
+                slot.type = type;
+                slot.callback = callback;
+                slot.active = true;
+                return;
+            }
+        }
+    }
+
+    void publish(const Event& event) {
+        mutex_.lock();
+        Slot local[EventBus::MAX_SUBSCRIBERS];
+        uint8_t count = 0;
+        for (auto& slot : slots_) {
+            if (slot.active && slot.type == event.type) {
+                local[count++] = slot;
+            }
+        }
+        mutex_.unlock();
+        for (uint8_t i = 0; i < count; i++) {
+            local[i].callback(event);
+        }
+    }
+
+private:
+    Slot slots_[EventBus::MAX_SUBSCRIBERS];
+    std::mutex mutex_;
+};
+
+void test_event_bus_publish_benchmark() {
+    const int ITERATIONS = 100000;
+    // Typical wiring: WebSocket (sensor, relay, alarm) plus a few listeners
+    const EventType types[] = {
+        EventType::SENSOR_UPDATE, EventType::SENSOR_UPDATE, EventType::RELAY_CHANGE,
+        EventType::ALARM, EventType::ALARM, EventType::PLAN_STEP_CHANGE,
+    };
+    // Captures sized like a member-function binding, past std::function's inline buffer
+    struct Sink { volatile float* out; void* owner; void* extra; };
+    volatile float legacy_out = 0, typed_out = 0, function_out = 0;
+
+    LegacyEventBus legacy;
+    EventBus typed;
+    EventBus function;
+    for (EventType type : types) {
+        Sink sink{&legacy_out, nullptr, nullptr};
+        legacy.subscribe(type, [sink](const Event& e) { *sink.out = *sink.out + e.data.value; });
+        Sink fsink{&function_out, nullptr, nullptr};
+        function.subscribe(type, [fsink](const Event& e) { *fsink.out = *fsink.out + e.data.value; });
+        typed.subscribe(type, [](const Event& e, void* ctx) {
+            volatile float* out = static_cast<volatile float*>(ctx);
+            *out = *out + e.data.value;
+        }, (void*)&typed_out);
+    }
+
+    Event event;
+    event.type = EventType::SENSOR_UPDATE;
+    event.data.value = 1.0f;
+
+    using clock = std::chrono::steady_clock;
+    auto t0 = clock::now();
+    for (int i = 0; i < ITERATIONS; i++) legacy.publish(event);
+    auto t1 = clock::now();
+    for (int i = 0; i < ITERATIONS; i++) typed.publish(event);
+    auto t2 = clock::now();
+    for (int i = 0; i < ITERATIONS; i++) function.publish(event);
+    auto t3 = clock::now();
+
+    double legacy_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / ITERATIONS;
+    double typed_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / ITERATIONS;
+    double function_ns = std::chrono::duration<double, std::nano>(t3 - t2).count() / ITERATIONS;
+
+    printf("\n  EventBus publish, %d subscribers (2 matching), %d events\n",
+           (int)(sizeof(types) / sizeof(types[0])), ITERATIONS);
+    printf("    legacy (lock + copy std::function): %8.1f ns/event\n", legacy_ns);
+    printf("    typed list, fn-ptr + ctx:           %8.1f ns/event (%.1fx)\n",
+           typed_ns, legacy_ns / typed_ns);
+    printf("    typed list, stored std::function:   %8.1f ns/event (%.1fx)\n",
+           function_ns, legacy_ns / function_ns);
+
+    TEST_ASSERT_EQUAL_FLOAT(2.0f * ITERATIONS, legacy_out);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f * ITERATIONS, typed_out);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f * ITERATIONS, function_out);
+    TEST_ASSERT_TRUE(typed_ns < legacy_ns);
+}
+
+// Sensor history tests
+
+void test_sensor_history_downsampling() {
+    SensorHistory history;
+    TEST_ASSERT_TRUE(history.allocate(2));
+
+    // Sensor 0 ramps 0..119 over two minutes, sensor 1 is constant
+    for (uint32_t t = 0; t < 120; t++) {
+        history.advance(t);
+        history.store(0, (float)t);
+        history.store(1, 20.5f);
+    }
+    history.advance(120);
+
+    TEST_ASSERT_EQUAL(121, history.get_count(0));
+    TEST_ASSERT_EQUAL(3, history.get_count(1));
+
+    float value;
+    TEST_ASSERT_TRUE(history.get_value(0, 0, 42, value));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 42.0f, value);
+
+    // Minute averages: mean(0..59) = 29.5, mean(60..119) = 89.5
+    TEST_ASSERT_TRUE(history.get_value(0, 1, 0, value));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 29.5f, value);
+    TEST_ASSERT_TRUE(history.get_value(0, 1, 1, value));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 89.5f, value);
+    TEST_ASSERT_TRUE(history.get_value(1, 1, 1, value));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.5f, value);
+
+    // 15 min tier holds the running average of everything so far
+    TEST_ASSERT_TRUE(history.get_value(0, 2, 0, value));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 59.5f, value);
+}
+
+void test_sensor_history_gaps_and_wrap() {
+    SensorHistory history;
+    TEST_ASSERT_TRUE(history.allocate(1));
+
+    history.advance(0);
+    history.store(0, 10.0f);
+    history.advance(5);                 // Seconds 1..4 missing
+    history.store(0, 11.0f);
+
+    float out[8];
+    uint32_t start = 0;
+    uint16_t n = history.query(0, 0, 0, 10, out, 8, &start);
+    TEST_ASSERT_EQUAL(6, n);
+    TEST_ASSERT_EQUAL(0, start);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 10.0f, out[0]);
+    TEST_ASSERT_TRUE(std::isnan(out[2]));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 11.0f, out[5]);
+
+    // Run past the 10 minute window - oldest slots are overwritten
+    for (uint32_t t = 6; t < 1000; t++) {
+        history.advance(t);
+        history.store(0, (float)(t % 100));
+    }
+    TEST_ASSERT_EQUAL(SensorHistory::TIER_CAPACITY[0], history.get_count(0));
+    TEST_ASSERT_EQUAL(400, history.get_oldest_time(0));
+    TEST_ASSERT_EQUAL(999, history.get_newest_time(0));
+
+    n = history.query(0, 0, 950, 953, out, 8, &start);
+    TEST_ASSERT_EQUAL(4, n);
+    TEST_ASSERT_EQUAL(950, start);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 50.0f, out[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 53.0f, out[3]);
+
+    // Ranges older than the 1 s window fall through to the minute tier
+    TEST_ASSERT_EQUAL(0, history.select_tier(500));
+    TEST_ASSERT_EQUAL(1, history.select_tier(100));
+}
+
+void test_sensor_history_fixed_point() {
+    SensorHistory history;
+    TEST_ASSERT_TRUE(history.allocate(1));
+    history.set_resolution(0, 0.001f);
+
+    history.advance(0);
+    history.store(0, 1.2345f);
+    history.advance(1);
+    history.store(0, 1.2374f);
+    history.advance(2);
+    history.store(0, 1.2345f + 40.0f);  // Beyond +/-32.767 of the anchor
+
+    float value;
+    TEST_ASSERT_TRUE(history.get_value(0, 0, 1, value));
+    TEST_ASSERT_FLOAT_WITHIN(0.0005f, 1.2374f, value);
+    TEST_ASSERT_TRUE(history.get_value(0, 0, 2, value));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.2345f + 32.767f, value);
+    TEST_ASSERT_EQUAL(1, history.get_clipped_count());
+
+    TEST_ASSERT_EQUAL(SensorHistory::bytes_per_sensor(), history.get_memory_bytes());
+}
+
+void test_state_manager_sensor_history() {
+    StateManager state;
+    state.register_sensor("temp_1", "C", 0.1f);
+    state.register_sensor("temp_2", "C", 0.1f);
+    state.set_sensor_quality(0, SensorQuality::GOOD);
+    state.set_sensor_quality(1, SensorQuality::BAD);
+    state.update_sensor_filtered(0, 18.5f, 18.5f);
+
+    state.record_sensor_history(10);
+
+    const auto& history = state.get_sensor_history();
+    TEST_ASSERT_TRUE(history.is_allocated());
+    TEST_ASSERT_EQUAL(2, history.get_sensor_count());
+
+    float value;
+    TEST_ASSERT_TRUE(history.get_value(0, 0, 0, value));
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 18.5f, value);
+    TEST_ASSERT_FALSE(history.get_value(1, 0, 0, value));  // BAD quality is a gap
+}
+
 // Data structure tests
 
 void test_sensor_state_initialization() {
@@ -261,11 +845,29 @@ int main(int argc, char **argv) {
     RUN_TEST(test_state_manager_register_fermenter);
 
     // Event Bus tests
+    RUN_TEST(test_state_manager_snapshot_reads);
+    RUN_TEST(test_state_manager_hot_block);
+    RUN_TEST(test_state_manager_generation);
+    RUN_TEST(test_state_manager_scan_benchmark);
+    RUN_TEST(test_running_window_matches_rescan);
+    RUN_TEST(test_state_manager_base_average);
+    RUN_TEST(test_state_manager_suspect_detector);
     RUN_TEST(test_event_bus_subscribe_publish);
     RUN_TEST(test_event_bus_unsubscribe);
     RUN_TEST(test_event_bus_multiple_subscribers);
     RUN_TEST(test_event_bus_filter_by_type);
     RUN_TEST(test_event_bus_convenience_methods);
+    RUN_TEST(test_event_bus_handler_context);
+    RUN_TEST(test_event_bus_slot_reuse);
+    RUN_TEST(test_event_bus_no_reuse_while_publishing);
+    RUN_TEST(test_event_bus_deferred_dispatch);
+    RUN_TEST(test_event_bus_publish_benchmark);
+
+    // Sensor history tests
+    RUN_TEST(test_sensor_history_downsampling);
+    RUN_TEST(test_sensor_history_gaps_and_wrap);
+    RUN_TEST(test_sensor_history_fixed_point);
+    RUN_TEST(test_state_manager_sensor_history);
 
     // Data structure tests
     RUN_TEST(test_sensor_state_initialization);
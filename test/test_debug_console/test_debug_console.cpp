@@ -104,6 +104,25 @@ void test_status_command() {
     TEST_ASSERT_TRUE(output.find("Uptime") != std::string::npos);
 }
 
+void test_status_shows_http_cache_ratio() {
+    HttpCache cache;
+    int sensors = HttpCache::find("/api/sensors");
+    cache.record(sensors, true);
+    cache.record(sensors, true);
+    cache.record(sensors, true);
+    cache.record(sensors, false);
+    g_console->set_http_cache(&cache);
+
+    std::string output = send_command("status");
+    g_console->set_http_cache(nullptr);
+
+    TEST_ASSERT_TRUE(output.find("HTTP cache") != std::string::npos);
+    TEST_ASSERT_TRUE(output.find("/api/sensors") != std::string::npos);
+    TEST_ASSERT_TRUE(output.find("3/4 (75%)") != std::string::npos);
+    // Endpoints without requests are not listed
+    TEST_ASSERT_TRUE(output.find("/api/dashboard") == std::string::npos);
+}
+
 void test_sensors_command() {
     // Update sensor value
     g_state->update_sensor_value(0, 0.5f, 1000);
@@ -254,6 +273,34 @@ void test_modbus_stats() {
     TEST_ASSERT_TRUE(output.find("Errors") != std::string::npos);
 }
 
+void test_modbus_stats_poll_engine() {
+    ModbusModule module(g_modbus, g_time, g_state, g_events);
+    module.initialize(*g_config);
+    g_console->set_modbus_module(&module);
+
+    std::string output = send_command("modbus stats");
+
+    TEST_ASSERT_TRUE(output.find("Poll engine") != std::string::npos);
+    TEST_ASSERT_TRUE(output.find("overruns") != std::string::npos);
+    TEST_ASSERT_TRUE(output.find("Jitter") != std::string::npos);
+
+    g_console->set_modbus_module(nullptr);
+}
+
+void test_modbus_plan() {
+    ModbusModule module(g_modbus, g_time, g_state, g_events);
+    module.initialize(*g_config);
+    g_console->set_modbus_module(&module);
+
+    std::string output = send_command("modbus plan");
+
+    TEST_ASSERT_TRUE(output.find("Poll plan") != std::string::npos);
+    TEST_ASSERT_TRUE(output.find("occupancy") != std::string::npos);
+    TEST_ASSERT_TRUE(output.find("bus(us)") != std::string::npos);
+
+    g_console->set_modbus_module(nullptr);
+}
+
 void test_modbus_read() {
     // Set a register value
     g_modbus->set_register(1, 0, 12345);
@@ -360,6 +407,7 @@ int main(int argc, char **argv) {
     // Help and status
     RUN_TEST(test_help_command);
     RUN_TEST(test_status_command);
+    RUN_TEST(test_status_shows_http_cache_ratio);
     RUN_TEST(test_heap_command);
     RUN_TEST(test_uptime_command);
     RUN_TEST(test_cpu_command);
@@ -399,6 +447,8 @@ int main(int argc, char **argv) {
 
     // MODBUS
     RUN_TEST(test_modbus_stats);
+    RUN_TEST(test_modbus_stats_poll_engine);
+    RUN_TEST(test_modbus_plan);
     RUN_TEST(test_modbus_read);
 
     // Edge cases
@@ -4,9 +4,16 @@
 #include "core/event_bus.h"
 #include "core/config_loader.h"
 #include "modules/http_server.h"
+#include "modules/rest_api.h"
+#include "modules/route_table.h"
 #include "modules/fermentation_plan.h"
 #include "modules/safety_controller.h"
 #include "security/secure_utils.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <thread>
 
 using namespace hal::simulator;
 using namespace core;
@@ -371,6 +378,144 @@ void test_api_sensor_not_found() {
     TEST_ASSERT_EQUAL(404, status);
 }
 
+void test_api_sensor_history() {
+    const char* token = login_with_test_password();
+
+    state->register_sensor("temp_1", "C", 0.1f);
+    state->set_sensor_quality(0, SensorQuality::GOOD);
+    for (uint32_t t = 0; t < 120; t++) {
+        state->update_sensor_filtered(0, 18.0f + (t >= 60 ? 1.0f : 0.0f), 18.0f);
+        state->record_sensor_history(t);
+    }
+
+    int status = server->handle_request("GET", "/api/history/sensor/temp_1?tier=1",
+        nullptr, token, response_buffer, sizeof(response_buffer));
+
+    TEST_ASSERT_EQUAL(200, status);
+    TEST_ASSERT_NOT_NULL(strstr(response_buffer, "\"tier\":1"));
+    TEST_ASSERT_NOT_NULL(strstr(response_buffer, "\"interval_sec\":60"));
+    TEST_ASSERT_NOT_NULL(strstr(response_buffer, "\"samples\":[18.00,19.00]"));
+    TEST_ASSERT_NULL(strstr(response_buffer, "\"next\""));
+
+    // Numeric id and time range on the 1 s tier
+    status = server->handle_request("GET", "/api/history/sensor/0?from=58&to=61",
+        nullptr, token, response_buffer, sizeof(response_buffer));
+
+    TEST_ASSERT_EQUAL(200, status);
+    TEST_ASSERT_NOT_NULL(strstr(response_buffer, "\"tier\":0"));
+    TEST_ASSERT_NOT_NULL(strstr(response_buffer, "\"start\":58"));
+    TEST_ASSERT_NOT_NULL(strstr(response_buffer, "\"samples\":[18.00,18.00,19.00,19.00]"));
+}
+
+void test_api_sensor_history_paged() {
+    const char* token = login_with_test_password();
+
+    state->register_sensor("temp_1", "C", 0.001f);
+    state->set_sensor_quality(0, SensorQuality::GOOD);
+    for (uint32_t t = 0; t < 600; t++) {
+        state->update_sensor_filtered(0, 18.125f, 18.125f);
+        state->record_sensor_history(t);
+    }
+
+    // 600 samples don't fit one response - expect a continuation time
+    int status = server->handle_request("GET", "/api/history/sensor/temp_1?tier=0",
+        nullptr, token, response_buffer, sizeof(response_buffer));
+
+    TEST_ASSERT_EQUAL(200, status);
+    TEST_ASSERT_NOT_NULL(strstr(response_buffer, "\"next\":"));
+    TEST_ASSERT_EQUAL('}', response_buffer[strlen(response_buffer) - 1]);
+
+    status = server->handle_request("GET", "/api/history/sensor/temp_1?tier=9",
+        nullptr, token, response_buffer, sizeof(response_buffer));
+    TEST_ASSERT_EQUAL(400, status);
+
+    status = server->handle_request("GET", "/api/history/sensor/missing",
+        nullptr, token, response_buffer, sizeof(response_buffer));
+    TEST_ASSERT_EQUAL(404, status);
+}
+
+// MODBUS-rate writer against HTTP readers. Snapshot reads must never make
+// the writer wait, and each snapshot must be internally consistent.
+void test_api_sensor_reads_under_writer_load() {
+    const char* token = login_with_test_password();
+    const uint8_t SENSORS = 8;
+    const int READS = 2000;
+    char name[32];
+    for (uint8_t i = 0; i < SENSORS; i++) {
+        snprintf(name, sizeof(name), "load_%u", i);
+        state->register_sensor(name, "°C", 0.01f);
+    }
+
+    std::atomic<bool> stop(false);
+    auto writer = [&]() {
+        for (uint32_t k = 1; !stop.load(); k++) {
+            for (uint8_t i = 0; i < SENSORS; i++) {
+                state->update_sensor_value(i, (float)(k % 100000), k % 100000);
+                state->update_sensor_filtered(i, (float)k, (float)k);
+                state->set_sensor_quality(i, SensorQuality::GOOD);
+            }
+        }
+    };
+
+    // Baseline: readers holding the state mutex, as send_full_state did
+    state->reset_lock_stats();
+    std::thread w1(writer);
+    while (state->get_lock_stats().acquisitions == 0) std::this_thread::yield();
+    float sink = 0;
+    for (int r = 0; r < READS; r++) {
+        auto guard = state->scoped_lock();
+        for (uint8_t i = 0; i < SENSORS; i++) {
+            sink += state->get_sensor_by_id(i)->filtered_value;
+        }
+    }
+    stop = true;
+    w1.join();
+    StateLockStats locked = state->get_lock_stats();
+    (void)sink;
+
+    // Snapshot readers through the HTTP handlers
+    static char buf[4096];
+    stop = false;
+    state->reset_lock_stats();
+    std::thread w2(writer);
+    while (state->get_lock_stats().acquisitions == 0) std::this_thread::yield();
+    int torn = 0;
+    for (int r = 0; r < READS; r++) {
+        int status = server->handle_request("GET", "/api/sensors", nullptr, token, buf, sizeof(buf));
+        TEST_ASSERT_EQUAL(200, status);
+
+        snprintf(name, sizeof(name), "/api/sensor/load_%d", r % SENSORS);
+        status = server->handle_request("GET", name, nullptr, token, buf, sizeof(buf));
+        TEST_ASSERT_EQUAL(200, status);
+
+        // raw/timestamp and filtered/display are written together
+        float raw = -1, filtered = -1, display = -2;
+        unsigned long ts = 0;
+        sscanf(strstr(buf, "\"raw_value\":"), "\"raw_value\":%f", &raw);
+        sscanf(strstr(buf, "\"filtered_value\":"), "\"filtered_value\":%f", &filtered);
+        sscanf(strstr(buf, "\"display_value\":"), "\"display_value\":%f", &display);
+        sscanf(strstr(buf, "\"timestamp\":"), "\"timestamp\":%lu", &ts);
+        if (filtered != display || (unsigned long)raw != ts) torn++;
+    }
+    stop = true;
+    w2.join();
+    StateLockStats snap = state->get_lock_stats();
+
+    printf("\n  State lock under load (%d reads x %u sensors)\n", READS, SENSORS);
+    printf("    locked readers:   %lu acquisitions, %lu contended\n",
+           (unsigned long)locked.acquisitions, (unsigned long)locked.contended);
+    printf("    snapshot readers: %lu acquisitions, %lu contended, "
+           "%lu snapshot reads, %lu retries, %lu fallbacks\n",
+           (unsigned long)snap.acquisitions, (unsigned long)snap.contended,
+           (unsigned long)snap.snapshot_reads, (unsigned long)snap.snapshot_retries,
+           (unsigned long)snap.snapshot_fallbacks);
+
+    TEST_ASSERT_EQUAL(0, torn);
+    TEST_ASSERT_TRUE(snap.snapshot_reads >= (uint32_t)READS * (SENSORS + 1));
+    // Only the writer takes the mutex, apart from rare snapshot fallbacks
+    TEST_ASSERT_TRUE(snap.contended <= snap.snapshot_fallbacks);
+}
+
 void test_api_sensors_quality_states() {
     const char* token = login_with_test_password();
 
@@ -943,6 +1088,835 @@ void test_concurrent_session_replacement() {
     TEST_ASSERT_EQUAL(200, status);
 }
 
+// ============================================
+// STREAMING JSON TESTS
+// ============================================
+
+// Collects JsonWriter output the way httpd_resp_send_chunk would see it
+struct ChunkCollector {
+    std::string data;
+    int chunks = 0;
+    size_t largest = 0;
+
+    static bool write(void* ctx, const char* bytes, size_t len) {
+        auto* self = static_cast<ChunkCollector*>(ctx);
+        self->data.append(bytes, len);
+        self->chunks++;
+        if (len > self->largest) self->largest = len;
+        return true;
+    }
+};
+
+void test_json_writer_escaping_and_numbers() {
+    ChunkCollector out;
+    JsonWriter json(ChunkCollector::write, &out);
+    json.begin_object()
+        .field("name", "tank \"A\"\\1\n\t\x01")
+        .field("utf8", "°C")
+        .field("null_str", (const char*)nullptr)
+        .field("neg", -0.25, 3)
+        .field("tiny_neg", -0.0001, 2)
+        .field("round", 18.4996, 2)
+        .field("nan", NAN, 1)
+        .field("big", -2147483647L)
+        .field("u64", 18446744073709551615ULL)
+        .key("empty").begin_array().end_array()
+        .key("nested").begin_array()
+            .value(1).begin_object().end_object().value(true).null()
+        .end_array()
+    .end_object();
+    TEST_ASSERT_TRUE(json.finish());
+
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"name\":\"tank \\\"A\\\"\\\\1\\n\\t\\u0001\",\"utf8\":\"°C\",\"null_str\":null,"
+        "\"neg\":-0.250,\"tiny_neg\":0.00,\"round\":18.50,\"nan\":null,"
+        "\"big\":-2147483647,\"u64\":18446744073709551615,"
+        "\"empty\":[],\"nested\":[1,{},true,null]}",
+        out.data.c_str());
+    TEST_ASSERT_EQUAL(out.data.size(), json.size());
+}
+
+void test_json_writer_buffer_truncation() {
+    char small[16];
+    JsonBufferSink sink(small, sizeof(small));
+    JsonWriter json(JsonBufferSink::write, &sink);
+    json.begin_object().field("message", "longer than sixteen bytes").end_object();
+
+    TEST_ASSERT_FALSE(json.finish());
+    TEST_ASSERT_TRUE(sink.truncated());
+    TEST_ASSERT_EQUAL(sizeof(small) - 1, strlen(small));
+    TEST_ASSERT_EQUAL_STRING("{\"message\":\"lon", small);
+}
+
+void test_api_sensor_name_escaped() {
+    const char* token = login_with_test_password();
+    state->register_sensor("say \"hi\"", "°C");
+
+    int status = server->handle_request("GET", "/api/sensors",
+        nullptr, token, response_buffer, sizeof(response_buffer));
+
+    TEST_ASSERT_EQUAL(200, status);
+    TEST_ASSERT_NOT_NULL(strstr(response_buffer, "\"name\":\"say \\\"hi\\\"\""));
+}
+
+// A dashboard bigger than the old 4 KB response buffer streams out whole,
+// in chunks no larger than the writer's buffer
+void test_api_dashboard_streams_past_4k() {
+    const char* token = login_with_test_password();
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "fermenter_sensor_%02u", i);
+        state->register_sensor(name, "°C", 0.001f);
+        state->update_sensor_filtered(i, 12.345f + i, 12.345f + i);
+    }
+    for (uint8_t i = 0; i < 16; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "relay_%02u", i);
+        state->register_relay(name, RelayType::SSR);
+    }
+
+    ChunkCollector out;
+    JsonWriter json(ChunkCollector::write, &out);
+    int status = server->handle_request("GET", "/api/dashboard", nullptr, token, json);
+    TEST_ASSERT_TRUE(json.finish());
+
+    TEST_ASSERT_EQUAL(200, status);
+    TEST_ASSERT_TRUE(out.data.size() > 4096);
+    TEST_ASSERT_TRUE(out.chunks > 1);
+    TEST_ASSERT_TRUE(out.largest <= JsonWriter::CHUNK_SIZE);
+    TEST_ASSERT_EQUAL('}', out.data.back());
+    TEST_ASSERT_NOT_NULL(strstr(out.data.c_str(), "\"name\":\"fermenter_sensor_31\",\"value\":43.345"));
+    TEST_ASSERT_NOT_NULL(strstr(out.data.c_str(), "\"can\":{\"state\":\"DISABLED\"}}"));
+
+    // The buffer overload produces the same document when it fits
+    static char big[16384];
+    status = server->handle_request("GET", "/api/dashboard", nullptr, token, big, sizeof(big));
+    TEST_ASSERT_EQUAL(200, status);
+    TEST_ASSERT_EQUAL_STRING(out.data.c_str(), big);
+}
+
+// ============================================================================
+// BINARY SNAPSHOT TESTS
+// ============================================================================
+
+static float snapshot_f32(const uint8_t* p) {
+    uint32_t bits = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+void test_state_snapshot_layout() {
+    setup_test_fermenter(3, "F3");
+    state->update_sensor_filtered(0, 18.5f, 18.5f);
+    state->set_relay_state(1, true, 1000);
+    state->get_fermenter(3)->target_temp = 12.5f;
+    state->get_fermenter(3)->mode = FermenterMode::PLAN;
+    state->get_fermenter(3)->plan_active = true;
+
+    uint8_t buf[SNAPSHOT_MAX_SIZE];
+    size_t len = server->build_state_snapshot(buf, sizeof(buf));
+
+    // Header, 2 sensors, 2 relays, 1 fermenter, no alarms
+    TEST_ASSERT_EQUAL(SNAPSHOT_HEADER_SIZE + 2 * SNAPSHOT_SENSOR_SIZE +
+                      2 * SNAPSHOT_RELAY_SIZE + SNAPSHOT_FERMENTER_SIZE, len);
+    TEST_ASSERT_EQUAL('F', buf[0]);
+    TEST_ASSERT_EQUAL('S', buf[1]);
+    TEST_ASSERT_EQUAL(SNAPSHOT_VERSION, buf[2]);
+    TEST_ASSERT_EQUAL(0, buf[3]);
+    TEST_ASSERT_EQUAL(2, buf[8]);
+    TEST_ASSERT_EQUAL(2, buf[9]);
+    TEST_ASSERT_EQUAL(1, buf[10]);
+    TEST_ASSERT_EQUAL(0, buf[11]);
+
+    SensorSnapshot snap;
+    TEST_ASSERT_TRUE(state->read_sensor(0, snap));
+    const uint8_t* sensor = buf + SNAPSHOT_HEADER_SIZE;
+    TEST_ASSERT_EQUAL(0, sensor[0]);
+    TEST_ASSERT_EQUAL((uint8_t)snap.quality, sensor[1]);
+    TEST_ASSERT_EQUAL_FLOAT(18.5f, snapshot_f32(sensor + 2));
+
+    const uint8_t* relay = sensor + 2 * SNAPSHOT_SENSOR_SIZE + SNAPSHOT_RELAY_SIZE;
+    TEST_ASSERT_EQUAL(1, relay[0]);
+    TEST_ASSERT_EQUAL(1, relay[1]);
+
+    const uint8_t* ferm = relay + SNAPSHOT_RELAY_SIZE;
+    TEST_ASSERT_EQUAL(3, ferm[0]);
+    TEST_ASSERT_EQUAL((uint8_t)FermenterMode::PLAN, ferm[1]);
+    TEST_ASSERT_EQUAL(0x01, ferm[2]);
+    TEST_ASSERT_EQUAL_FLOAT(12.5f, snapshot_f32(ferm + 8));
+
+    // Too small a buffer is reported, not silently truncated
+    TEST_ASSERT_EQUAL(0, server->build_state_snapshot(buf, len - 1));
+}
+
+void test_state_snapshot_writer_rules() {
+    uint8_t buf[64];
+
+    // Sections must come in order
+    SnapshotWriter out_of_order(buf, sizeof(buf), 1234, SNAPSHOT_FLAG_DELTA);
+    TEST_ASSERT_TRUE(out_of_order.add_relay(0, true));
+    TEST_ASSERT_FALSE(out_of_order.add_sensor(0, 1.0f, SensorQuality::GOOD));
+    TEST_ASSERT_EQUAL(0, out_of_order.finish());
+
+    SnapshotWriter delta(buf, sizeof(buf), 0x01020304, SNAPSHOT_FLAG_DELTA);
+    TEST_ASSERT_TRUE(delta.add_alarm(2, SNAPSHOT_ALARM_ACTIVE));
+    TEST_ASSERT_EQUAL(SNAPSHOT_HEADER_SIZE + SNAPSHOT_ALARM_SIZE, delta.finish());
+    TEST_ASSERT_EQUAL(SNAPSHOT_FLAG_DELTA, buf[3]);
+    TEST_ASSERT_EQUAL(0x04, buf[4]);  // Little-endian timestamp
+    TEST_ASSERT_EQUAL(0x01, buf[7]);
+    TEST_ASSERT_EQUAL(1, buf[11]);
+
+    FermenterAlarmState alarm;
+    TEST_ASSERT_EQUAL(0, SnapshotWriter::alarm_bits(alarm));
+    alarm.temp_high_alarm = true;
+    alarm.sensor_failure_alarm = true;
+    TEST_ASSERT_EQUAL(SNAPSHOT_ALARM_ACTIVE | SNAPSHOT_ALARM_TEMP_HIGH | SNAPSHOT_ALARM_SENSOR_FAILURE,
+                      SnapshotWriter::alarm_bits(alarm));
+}
+
+void test_state_content_negotiation() {
+    TEST_ASSERT_TRUE(HttpServer::accepts_snapshot("application/vnd.fermenter.snapshot"));
+    TEST_ASSERT_TRUE(HttpServer::accepts_snapshot("application/json;q=0.5, application/octet-stream"));
+    TEST_ASSERT_TRUE(HttpServer::accepts_snapshot("application/vnd.fermenter.snapshot; q=0.9"));
+    TEST_ASSERT_FALSE(HttpServer::accepts_snapshot("application/vnd.fermenter.snapshot;q=0"));
+    TEST_ASSERT_FALSE(HttpServer::accepts_snapshot("application/json, */*"));
+    TEST_ASSERT_FALSE(HttpServer::accepts_snapshot("application/vnd.fermenter.snapshotx"));
+    TEST_ASSERT_FALSE(HttpServer::accepts_snapshot(nullptr));
+
+    // SCADA pollers negotiate on the dashboard URL they already use
+    TEST_ASSERT_TRUE(HttpServer::serves_snapshot("/api/state"));
+    TEST_ASSERT_TRUE(HttpServer::serves_snapshot("/api/dashboard"));
+    TEST_ASSERT_TRUE(HttpServer::serves_snapshot("/api/dashboard?t=1"));
+    TEST_ASSERT_FALSE(HttpServer::serves_snapshot("/api/sensors"));
+    TEST_ASSERT_FALSE(HttpServer::serves_snapshot("/api/dashboardx"));
+
+    // Without negotiation /api/state is the JSON state document
+    const char* token = login_with_test_password();
+    int status = server->handle_request("GET", "/api/state",
+        nullptr, token, response_buffer, sizeof(response_buffer));
+    TEST_ASSERT_EQUAL(200, status);
+    TEST_ASSERT_NOT_NULL(strstr(response_buffer, "\"type\":\"state\""));
+
+    status = server->handle_request("GET", "/api/state",
+        nullptr, nullptr, response_buffer, sizeof(response_buffer));
+    TEST_ASSERT_EQUAL(401, status);
+}
+
+// ============================================================================
+// CONDITIONAL GET TESTS
+// ============================================================================
+
+void test_conditional_get_not_modified() {
+    const char* token = login_with_test_password();
+    state->register_sensor("temp", "°C");
+    char etag[HttpCache::ETAG_SIZE];
+    char etag2[HttpCache::ETAG_SIZE];
+
+    TEST_ASSERT_EQUAL(0, server->check_not_modified("/api/sensors", token, nullptr, etag, sizeof(etag)));
+    TEST_ASSERT_EQUAL('"', etag[0]);
+
+    // Unchanged state: 304, same tag
+    TEST_ASSERT_EQUAL(304, server->check_not_modified("/api/sensors", token, etag, etag2, sizeof(etag2)));
+    TEST_ASSERT_EQUAL_STRING(etag, etag2);
+
+    // Any mutation invalidates it
+    state->update_sensor_filtered(0, 19.0f, 19.0f);
+    TEST_ASSERT_EQUAL(0, server->check_not_modified("/api/sensors", token, etag, etag2, sizeof(etag2)));
+    TEST_ASSERT_TRUE(strcmp(etag, etag2) != 0);
+
+    int index = HttpCache::find("/api/sensors");
+    TEST_ASSERT_EQUAL(3, server->get_cache_stats().requests(index));
+    TEST_ASSERT_EQUAL(1, server->get_cache_stats().hits(index));
+
+    // No 304 (and no tag) without auth or for other endpoints
+    TEST_ASSERT_EQUAL(0, server->check_not_modified("/api/sensors", nullptr, etag2, etag, sizeof(etag)));
+    TEST_ASSERT_EQUAL_STRING("", etag);
+    TEST_ASSERT_EQUAL(0, server->check_not_modified("/api/config", token, "*", etag, sizeof(etag)));
+    TEST_ASSERT_EQUAL_STRING("", etag);
+}
+
+void test_conditional_get_survives_telemetry() {
+    const char* token = login_with_test_password();
+    state->register_sensor("temp", "°C");
+    state->register_relay("chiller", RelayType::SSR);
+    state->set_relay_state(0, true, 500);
+    char etag[HttpCache::ETAG_SIZE];
+    char etag2[HttpCache::ETAG_SIZE];
+
+    server->check_not_modified("/api/relays", token, nullptr, etag, sizeof(etag));
+    char sensors_etag[HttpCache::ETAG_SIZE];
+    server->check_not_modified("/api/sensors", token, nullptr, sensors_etag, sizeof(sensors_etag));
+
+    // A few control_loop ticks: telemetry every tick, new readings, the
+    // relay rewritten with the values it already has
+    for (int tick = 0; tick < 5; tick++) {
+        sim_time.advance_millis(100);
+        state->update_system_uptime(sim_time.millis() / 1000);
+        state->update_free_heap(200000 - tick * 64);
+        state->update_cpu_usage(10.0f + tick);
+        state->update_modbus_stats(100 + tick, tick);
+        state->update_sensor_filtered(0, 18.0f + tick * 0.1f, 18.0f + tick * 0.1f);
+        state->set_relay_state(0, true, 500);
+        state->set_relay_duty_cycle(0, 0.0f);
+    }
+    TEST_ASSERT_EQUAL(304, server->check_not_modified("/api/relays", token, etag, etag2, sizeof(etag2)));
+    TEST_ASSERT_EQUAL(0, server->check_not_modified("/api/sensors", token, sensors_etag, etag2,
+                                                    sizeof(etag2)));
+
+    // Counters are folded in by the clock where they are shown
+    server->check_not_modified("/api/modbus/stats", token, nullptr, sensors_etag,
+                               sizeof(sensors_etag));
+    state->update_modbus_stats(200, 1);
+    TEST_ASSERT_EQUAL(304, server->check_not_modified("/api/modbus/stats", token, sensors_etag,
+                                                      etag2, sizeof(etag2)));
+    sim_time.advance_millis(1000);
+    TEST_ASSERT_EQUAL(0, server->check_not_modified("/api/modbus/stats", token, sensors_etag,
+                                                    etag2, sizeof(etag2)));
+
+    // A real relay change still invalidates it
+    state->set_relay_state(0, false, sim_time.millis());
+    TEST_ASSERT_EQUAL(0, server->check_not_modified("/api/relays", token, etag, etag2, sizeof(etag2)));
+}
+
+void test_conditional_get_direct_writes_and_clock() {
+    const char* token = login_with_test_password();
+    setup_test_fermenter(2, "F2");
+    char etag[HttpCache::ETAG_SIZE];
+    char etag2[HttpCache::ETAG_SIZE];
+
+    // Handlers writing through get_fermenter() bump the generation
+    server->check_not_modified("/api/fermenter/2", token, nullptr, etag, sizeof(etag));
+    int status = server->handle_request("POST", "/api/fermenter/2",
+        "{\"setpoint\":14.0}", token, response_buffer, sizeof(response_buffer));
+    TEST_ASSERT_EQUAL(200, status);
+    TEST_ASSERT_EQUAL(0, server->check_not_modified("/api/fermenter/2", token, etag, etag2, sizeof(etag2)));
+
+    // Bodies with a seconds clock revalidate once per second
+    server->check_not_modified("/api/state", token, nullptr, etag, sizeof(etag));
+    sim_time.advance_millis(200);
+    TEST_ASSERT_EQUAL(304, server->check_not_modified("/api/state", token, etag, etag2, sizeof(etag2)));
+    sim_time.advance_millis(1000);
+    TEST_ASSERT_EQUAL(0, server->check_not_modified("/api/state", token, etag, etag2, sizeof(etag2)));
+
+    // The binary representation has its own tag
+    server->check_not_modified("/api/state", token, nullptr, etag, sizeof(etag), "bin");
+    TEST_ASSERT_EQUAL(0, server->check_not_modified("/api/state", token, etag, etag2, sizeof(etag2)));
+}
+
+void test_conditional_get_matching() {
+    TEST_ASSERT_TRUE(HttpCache::matches("\"g1\"", "\"g1\""));
+    TEST_ASSERT_TRUE(HttpCache::matches("\"g0\", W/\"g1\"", "\"g1\""));
+    TEST_ASSERT_TRUE(HttpCache::matches("*", "\"g1\""));
+    TEST_ASSERT_FALSE(HttpCache::matches("\"g10\"", "\"g1\""));
+    TEST_ASSERT_FALSE(HttpCache::matches("", "\"g1\""));
+    TEST_ASSERT_FALSE(HttpCache::matches(nullptr, "\"g1\""));
+
+    TEST_ASSERT_TRUE(HttpCache::find("/api/sensor/temp") >= 0);
+    TEST_ASSERT_EQUAL(-1, HttpCache::find("/api/sensor/"));
+    TEST_ASSERT_EQUAL(-1, HttpCache::find("/api/sensor/temp/config"));
+    TEST_ASSERT_EQUAL(-1, HttpCache::find("/api/dashboard?t=1"));
+}
+
+// ============================================================================
+// STATIC ASSET TESTS
+// ============================================================================
+
+static const char* TEST_MANIFEST =
+    "# assets v1\n"
+    "/admin/index.html ba88d004f11b 116845 18822\n"
+    "/app.js 0123456789ab 4000 0\n"
+    "not a line\n"
+    "/short 12\n";
+
+void test_static_asset_headers() {
+    AssetManifest manifest;
+    TEST_ASSERT_EQUAL(2, manifest.load(TEST_MANIFEST));
+    TEST_ASSERT_EQUAL(0, manifest.find("/admin/index.html"));
+    TEST_ASSERT_EQUAL(-1, manifest.find("/admin/"));
+
+    // Entry page: gzip, revalidate with the hash as ETag
+    AssetResponse asset;
+    TEST_ASSERT_TRUE(resolve_asset(manifest, "/admin/index.html", nullptr,
+                                   "gzip, deflate, br", nullptr, asset));
+    TEST_ASSERT_EQUAL(200, asset.status);
+    TEST_ASSERT_TRUE(asset.gzip);
+    TEST_ASSERT_EQUAL(18822, asset.length);
+    TEST_ASSERT_EQUAL_STRING("/admin/index.html.gz", asset.file);
+    TEST_ASSERT_EQUAL_STRING("\"ba88d004f11b-gz\"", asset.etag);
+    TEST_ASSERT_EQUAL_STRING(ASSET_CACHE_REVALIDATE, asset.cache_control);
+
+    // Revalidation answers 304; the uncompressed variant has its own ETag
+    TEST_ASSERT_TRUE(resolve_asset(manifest, "/admin/index.html", nullptr,
+                                   "gzip", "\"ba88d004f11b-gz\"", asset));
+    TEST_ASSERT_EQUAL(304, asset.status);
+    TEST_ASSERT_TRUE(resolve_asset(manifest, "/admin/index.html", nullptr,
+                                   "identity", "\"ba88d004f11b-gz\"", asset));
+    TEST_ASSERT_EQUAL(200, asset.status);
+    TEST_ASSERT_FALSE(asset.gzip);
+    TEST_ASSERT_EQUAL(116845, asset.length);
+    TEST_ASSERT_EQUAL_STRING("/admin/index.html", asset.file);
+
+    // Versioned URL is immutable; a stale hash only revalidates
+    TEST_ASSERT_TRUE(resolve_asset(manifest, "/app.js", "v=0123456789ab", "gzip", nullptr, asset));
+    TEST_ASSERT_EQUAL_STRING(ASSET_CACHE_IMMUTABLE, asset.cache_control);
+    TEST_ASSERT_FALSE(asset.gzip);  // No .gz sibling
+    TEST_ASSERT_TRUE(resolve_asset(manifest, "/app.js", "v=0000", "gzip", nullptr, asset));
+    TEST_ASSERT_EQUAL_STRING(ASSET_CACHE_REVALIDATE, asset.cache_control);
+
+    TEST_ASSERT_FALSE(resolve_asset(manifest, "/config.json", nullptr, "gzip", nullptr, asset));
+    TEST_ASSERT_EQUAL(0, manifest.load("# assets v2\n/app.js 01 1 0\n"));
+}
+
+void test_static_asset_negotiation() {
+    TEST_ASSERT_TRUE(accepts_gzip("gzip"));
+    TEST_ASSERT_TRUE(accepts_gzip("deflate, gzip;q=0.8"));
+    TEST_ASSERT_TRUE(accepts_gzip("*"));
+    TEST_ASSERT_FALSE(accepts_gzip("gzip;q=0"));
+    TEST_ASSERT_FALSE(accepts_gzip("br, deflate"));
+    TEST_ASSERT_FALSE(accepts_gzip("x-gzip"));
+    TEST_ASSERT_FALSE(accepts_gzip(nullptr));
+
+    TEST_ASSERT_TRUE(asset_version_matches("v=abc", "abc"));
+    TEST_ASSERT_TRUE(asset_version_matches("x=1&v=abc", "abc"));
+    TEST_ASSERT_FALSE(asset_version_matches("v=abcd", "abc"));
+    TEST_ASSERT_FALSE(asset_version_matches("vv=abc", "abc"));
+
+    // Extension match, not substring (".js" used to win for .json)
+    TEST_ASSERT_EQUAL_STRING("application/json", asset_content_type("/spiffs/config.json"));
+    TEST_ASSERT_EQUAL_STRING("application/javascript", asset_content_type("/app.js.gz"));
+    TEST_ASSERT_EQUAL_STRING("text/html", asset_content_type("/admin/index.html"));
+    TEST_ASSERT_EQUAL_STRING("text/plain", asset_content_type("/html"));
+}
+
+void test_static_asset_cache_budget() {
+    // Without PSRAM the internal budget still keeps the gzipped admin page hot
+    AssetCache internal(asset_cache_budget(false));
+    TEST_ASSERT_TRUE(internal.admits(19 * 1024));
+    TEST_ASSERT_FALSE(internal.admits(64 * 1024));
+    TEST_ASSERT_EQUAL(ASSET_CACHE_PSRAM_BUDGET, asset_cache_budget(true));
+}
+
+void test_static_asset_hot_cache() {
+    AssetCache cache(1000);
+    TEST_ASSERT_TRUE(cache.admits(500));
+    TEST_ASSERT_FALSE(cache.admits(501));
+
+    uint8_t* a = AssetCache::alloc(400);
+    uint8_t* b = AssetCache::alloc(400);
+    memset(a, 'a', 400);
+    TEST_ASSERT_TRUE(cache.insert(AssetCache::key(0, true), a, 400));
+    cache.release(a);
+    TEST_ASSERT_TRUE(cache.insert(AssetCache::key(1, true), b, 400));
+    cache.release(b);
+    TEST_ASSERT_EQUAL(800, cache.used());
+
+    size_t len = 0;
+    const uint8_t* hit = cache.acquire(AssetCache::key(0, true), len);
+    TEST_ASSERT_TRUE(hit == a);
+    TEST_ASSERT_EQUAL(400, len);
+    TEST_ASSERT_EQUAL('a', hit[0]);
+
+    // Over budget: the least recently used unpinned body (b) goes
+    uint8_t* c = AssetCache::alloc(400);
+    TEST_ASSERT_TRUE(cache.insert(AssetCache::key(2, false), c, 400));
+    cache.release(c);
+    TEST_ASSERT_NULL(cache.acquire(AssetCache::key(1, true), len));
+
+    // Shrinking the budget evicts unpinned bodies only; a stays while sent
+    cache.set_budget(600);
+    TEST_ASSERT_EQUAL(400, cache.used());
+    TEST_ASSERT_NULL(cache.acquire(AssetCache::key(2, false), len));
+    cache.release(hit);
+    hit = cache.acquire(AssetCache::key(0, true), len);
+    TEST_ASSERT_TRUE(hit == a);
+    cache.release(hit);
+    TEST_ASSERT_EQUAL(2, cache.hits());
+    TEST_ASSERT_EQUAL(2, cache.misses());
+
+    // Duplicate key: caller keeps the buffer
+    uint8_t* dup = AssetCache::alloc(10);
+    TEST_ASSERT_FALSE(cache.insert(AssetCache::key(0, true), dup, 10));
+    AssetCache::free_buffer(dup);
+}
+
+/**
+ * /api/sensors as built before the streaming writer: one snprintf per
+ * element into a fixed buffer. Kept here as the benchmark baseline.
+ */
+static int legacy_sensors_json(StateManager& sm, char* response, size_t response_size) {
+    static const char* QUALITY[] = {"GOOD", "BAD", "SUSPECT", "WARMING_UP", "UNKNOWN"};
+    int offset = snprintf(response, response_size, "{\"sensors\":[");
+    uint8_t count = sm.get_sensor_count();
+    for (uint8_t i = 0; i < count && offset < (int)response_size - 150; i++) {
+        auto* sensor = sm.get_sensor_by_id(i);
+        SensorSnapshot snap;
+        if (sensor && sm.read_sensor(i, snap)) {
+            if (i > 0) offset += snprintf(response + offset, response_size - offset, ",");
+            offset += snprintf(response + offset, response_size - offset,
+                "{\"name\":\"%s\",\"value\":%.3f,\"unit\":\"%s\",\"quality\":\"%s\"}",
+                sensor->name, snap.filtered_value, sensor->unit,
+                QUALITY[(int)snap.quality < 4 ? (int)snap.quality : 4]);
+        }
+    }
+    offset += snprintf(response + offset, response_size - offset, "]}");
+    return offset;
+}
+
+void test_json_serialization_benchmark() {
+    const char* token = login_with_test_password();
+    const int ROUNDS = 2000;
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "sensor_%02u", i);
+        state->register_sensor(name, "°C", 0.01f);
+        state->update_sensor_filtered(i, 18.0f + i * 0.137f, 18.0f);
+        state->set_sensor_quality(i, SensorQuality::GOOD);
+    }
+
+    using clock = std::chrono::steady_clock;
+    static char buf[4096];
+    size_t legacy_bytes = 0;
+    size_t writer_bytes = 0;
+
+    auto t0 = clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        legacy_bytes += legacy_sensors_json(*state, buf, sizeof(buf));
+    }
+    auto t1 = clock::now();
+    ChunkCollector out;
+    for (int r = 0; r < ROUNDS; r++) {
+        out.data.clear();
+        JsonWriter json(ChunkCollector::write, &out);
+        server->handle_request("GET", "/api/sensors", nullptr, token, json);
+        json.finish();
+        writer_bytes += json.size();
+    }
+    auto t2 = clock::now();
+
+    double legacy_s = std::chrono::duration<double>(t1 - t0).count();
+    double writer_s = std::chrono::duration<double>(t2 - t1).count();
+    printf("\n  /api/sensors with %u sensors, %d responses\n", MAX_SENSORS, ROUNDS);
+    printf("    snprintf chain: %7.1f MB/s (%6.2f us/response)\n",
+           legacy_bytes / legacy_s / 1e6, legacy_s * 1e6 / ROUNDS);
+    printf("    JsonWriter:     %7.1f MB/s (%6.2f us/response, incl. auth + routing)\n",
+           writer_bytes / writer_s / 1e6, writer_s * 1e6 / ROUNDS);
+
+    legacy_sensors_json(*state, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING(buf, out.data.c_str());
+    TEST_ASSERT_TRUE(writer_s < legacy_s);
+}
+
+// ============================================
+// ROUTE TABLE TESTS
+// ============================================
+
+enum class TestRoute : uint8_t { LIST, ITEM, ITEM_SET, ITEM_PLAN, ITEM_DELETE, NAMED };
+
+struct TestRoutes {
+    static constexpr RouteDef<TestRoute> ROUTES[] = {
+        {RouteMethod::GET,    "/items",                 TestRoute::LIST},
+        {RouteMethod::GET,    "/items/{id:int}",        TestRoute::ITEM},
+        {RouteMethod::POST | RouteMethod::PUT, "/items/{id:int}", TestRoute::ITEM_SET},
+        {RouteMethod::GET,    "/items/{id:int}/plan",   TestRoute::ITEM_PLAN},
+        {RouteMethod::DELETE, "/items/{id:int}",        TestRoute::ITEM_DELETE},
+        {RouteMethod::GET,    "/named/{name}/on",       TestRoute::NAMED},
+    };
+    static constexpr RouteTrie<TestRoute, route_trie_nodes(ROUTES), std::size(ROUTES)> ROUTER{ROUTES};
+    static_assert(ROUTER.valid(), "test routes");
+};
+
+void test_route_trie_typed_params() {
+    RouteMatch m;
+    TestRoute id;
+
+    TEST_ASSERT_TRUE(TestRoutes::ROUTER.match(RouteMethod::GET, "/items/42/plan", m, id));
+    TEST_ASSERT_TRUE(id == TestRoute::ITEM_PLAN);
+    TEST_ASSERT_EQUAL(1, m.count);
+    TEST_ASSERT_EQUAL_UINT32(42, m.get_int(0));
+
+    TEST_ASSERT_TRUE(TestRoutes::ROUTER.match(RouteMethod::GET, "/named/pump_1/on", m, id));
+    TEST_ASSERT_TRUE(id == TestRoute::NAMED);
+    char name[8];
+    TEST_ASSERT_TRUE(m.get_str(0, name, sizeof(name)));
+    TEST_ASSERT_EQUAL_STRING("pump_1", name);
+    TEST_ASSERT_FALSE(m.get_str(0, name, 6));       // Does not fit
+    TEST_ASSERT_FALSE(m.get_str(1, name, sizeof(name)));
+
+    // Non-digits, empty and over-long ints don't match
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(RouteMethod::GET, "/items/4x", m, id));
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(RouteMethod::GET, "/items/", m, id));
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(RouteMethod::GET, "/items/1234567890", m, id));
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(RouteMethod::GET, "/named//on", m, id));
+
+    // Exact segments only (no prefix/substring matches)
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(RouteMethod::GET, "/items/1/plans", m, id));
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(RouteMethod::GET, "/items/1/xplan", m, id));
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(RouteMethod::GET, "/item", m, id));
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(RouteMethod::GET, "/itemsx", m, id));
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(RouteMethod::GET, "/named/a/b/on", m, id));
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(RouteMethod::GET, nullptr, m, id));
+}
+
+void test_route_trie_method_and_query() {
+    RouteMatch m;
+    TestRoute id;
+
+    TEST_ASSERT_TRUE(TestRoutes::ROUTER.match(RouteMethod::GET, "/items/7", m, id));
+    TEST_ASSERT_TRUE(id == TestRoute::ITEM);
+    TEST_ASSERT_TRUE(TestRoutes::ROUTER.match(RouteMethod::PUT, "/items/7", m, id));
+    TEST_ASSERT_TRUE(id == TestRoute::ITEM_SET);
+    TEST_ASSERT_TRUE(TestRoutes::ROUTER.match(RouteMethod::POST, "/items/7", m, id));
+    TEST_ASSERT_TRUE(id == TestRoute::ITEM_SET);
+    TEST_ASSERT_TRUE(TestRoutes::ROUTER.match(RouteMethod::DELETE, "/items/7", m, id));
+    TEST_ASSERT_TRUE(id == TestRoute::ITEM_DELETE);
+
+    // Known path, wrong method
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(RouteMethod::POST, "/items", m, id));
+    TEST_ASSERT_TRUE(m.path_found);
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(RouteMethod::GET, "/nothing", m, id));
+    TEST_ASSERT_FALSE(m.path_found);
+    TEST_ASSERT_FALSE(TestRoutes::ROUTER.match(0, "/items", m, id));
+    TEST_ASSERT_EQUAL(0, RouteMethod::from_string("PATCH"));
+
+    // Query string ends the path
+    TEST_ASSERT_TRUE(TestRoutes::ROUTER.match(RouteMethod::GET, "/items/12?full=1&x=2", m, id));
+    TEST_ASSERT_TRUE(id == TestRoute::ITEM);
+    TEST_ASSERT_EQUAL_UINT32(12, m.get_int(0));
+    TEST_ASSERT_EQUAL_STRING("full=1&x=2", m.query);
+    TEST_ASSERT_TRUE(TestRoutes::ROUTER.match(RouteMethod::GET, "/items", m, id));
+    TEST_ASSERT_NULL(m.query);
+}
+
+enum class BadRoute : uint8_t { A, B };
+
+// Routing never backtracks: a parameter can't share a node with literals
+constexpr RouteDef<BadRoute> MIXED_ROUTES[] = {
+    {RouteMethod::GET, "/x/{name}", BadRoute::A},
+    {RouteMethod::GET, "/x/all",    BadRoute::B},
+};
+constexpr RouteDef<BadRoute> DUPLICATE_ROUTES[] = {
+    {RouteMethod::GET | RouteMethod::POST, "/x/{id:int}", BadRoute::A},
+    {RouteMethod::POST,                    "/x/{n:int}",  BadRoute::B},
+};
+constexpr RouteDef<BadRoute> PARTIAL_SEGMENT_ROUTES[] = {
+    {RouteMethod::GET, "/x/{id:int}.json", BadRoute::A},
+};
+static_assert(!RouteTrie<BadRoute, route_trie_nodes(MIXED_ROUTES), 2>(MIXED_ROUTES).valid(),
+              "mixed literal/param children");
+static_assert(!RouteTrie<BadRoute, route_trie_nodes(DUPLICATE_ROUTES), 2>(DUPLICATE_ROUTES).valid(),
+              "duplicate route");
+static_assert(!RouteTrie<BadRoute, route_trie_nodes(PARTIAL_SEGMENT_ROUTES), 1>(PARTIAL_SEGMENT_ROUTES).valid(),
+              "parameter must be a whole segment");
+
+void test_route_tables_resolve_every_endpoint() {
+    RouteMatch m;
+    HttpServer::ApiRoute api;
+    for (const auto& route : HttpServer::ROUTES) {
+        char path[64];
+        const char* in = route.pattern;
+        char* out = path;
+        while (*in) {                       // Fill in parameters
+            if (*in == '{') {
+                *out++ = '1';
+                in = strchr(in, '}') + 1;
+            } else {
+                *out++ = *in++;
+            }
+        }
+        *out = '\0';
+        uint8_t method = (route.methods & RouteMethod::GET) ? RouteMethod::GET : RouteMethod::POST;
+        TEST_ASSERT_TRUE_MESSAGE(HttpServer::ROUTER.match(method, path, m, api), path);
+        TEST_ASSERT_TRUE(api == route.id);
+    }
+    // Each pattern/method owns one trie node chain; the count is exact
+    TEST_ASSERT_EQUAL(route_trie_nodes(HttpServer::ROUTES), HttpServer::ROUTER.node_count());
+    TEST_ASSERT_EQUAL(route_trie_nodes(RestApiHandler::ROUTES), RestApiHandler::ROUTER.node_count());
+}
+
+void test_api_query_string_and_numeric_ids() {
+    const char* token = login_with_test_password();
+
+    // Query strings no longer break exact routes
+    TEST_ASSERT_EQUAL(200, server->handle_request("GET", "/api/status?nocache=1",
+        nullptr, token, response_buffer, sizeof(response_buffer)));
+
+    setup_test_fermenter(1, "F1");
+    TEST_ASSERT_EQUAL(200, server->handle_request("GET", "/api/fermenter/1",
+        nullptr, token, response_buffer, sizeof(response_buffer)));
+    // atoi() used to read these as fermenter 1
+    TEST_ASSERT_EQUAL(404, server->handle_request("GET", "/api/fermenter/1abc",
+        nullptr, token, response_buffer, sizeof(response_buffer)));
+    TEST_ASSERT_EQUAL(404, server->handle_request("GET", "/api/fermenter/257",
+        nullptr, token, response_buffer, sizeof(response_buffer)));
+    TEST_ASSERT_EQUAL(404, server->handle_request("POST", "/api/pid/1/extra",
+        "{}", token, response_buffer, sizeof(response_buffer)));
+}
+
+/**
+ * HttpServer and RestApiHandler routing as done before the route table:
+ * ordered strcmp/strncmp/strstr chains with atoi ids. Kept here as the
+ * benchmark baseline; returns a route number (-1 = not found).
+ */
+static int legacy_api_route(const char* method, const char* path, int& param) {
+    bool get = strcmp(method, "GET") == 0;
+    bool post = strcmp(method, "POST") == 0;
+    if (strcmp(path, "/api/setup") == 0) {
+        if (get) return 0;
+        if (post) return 1;
+    }
+    if (strcmp(path, "/api/login") == 0 && post) return 2;
+    if (strcmp(path, "/api/health") == 0 && get) return 3;
+    if (strcmp(path, "/api/info") == 0 && get) return 4;
+    if (strcmp(path, "/api/ssl/status") == 0 && get) return 5;
+    if (strcmp(path, "/api/logout") == 0 && post) return 6;
+    if (strcmp(path, "/api/password") == 0 && post) return 7;
+    if (strcmp(path, "/api/factory_reset") == 0 && post) return 8;
+    if (get) {
+        if (strcmp(path, "/api/status") == 0) return 9;
+        if (strcmp(path, "/api/sensors") == 0) return 10;
+        if (strncmp(path, "/api/sensor/", 12) == 0) return 11;
+        if (strcmp(path, "/api/relays") == 0) return 12;
+        if (strcmp(path, "/api/fermenters") == 0) return 13;
+        if (strncmp(path, "/api/fermenter/", 15) == 0) { param = atoi(path + 15); return 14; }
+        if (strncmp(path, "/api/pid/", 9) == 0) { param = atoi(path + 9); return 15; }
+        if (strcmp(path, "/api/alarms") == 0) return 16;
+        if (strcmp(path, "/api/modbus/stats") == 0) return 17;
+        if (strcmp(path, "/api/inputs") == 0) return 18;
+        if (strcmp(path, "/api/outputs") == 0) return 19;
+        if (strcmp(path, "/api/config") == 0) return 20;
+        if (strcmp(path, "/api/modules") == 0) return 21;
+        if (strcmp(path, "/api/wifi") == 0) return 22;
+        if (strcmp(path, "/api/can/status") == 0) return 23;
+        if (strcmp(path, "/api/firmware/info") == 0) return 24;
+        if (strcmp(path, "/api/firmware/status") == 0) return 25;
+        if (strcmp(path, "/api/cpu/history") == 0) return 26;
+        if (strcmp(path, "/api/network/history") == 0) return 27;
+        if (strncmp(path, "/api/history/sensor/", 20) == 0) return 28;
+        if (strcmp(path, "/api/wifi/summary") == 0) return 29;
+        if (strcmp(path, "/api/dashboard") == 0) return 30;
+        if (strcmp(path, "/api/state") == 0) return 31;
+    } else if (post) {
+        if (strncmp(path, "/api/relay/", 11) == 0) return 32;
+        if (strncmp(path, "/api/fermenter/", 15) == 0) { param = atoi(path + 15); return 33; }
+        if (strncmp(path, "/api/pid/", 9) == 0) { param = atoi(path + 9); return 34; }
+        if (strncmp(path, "/api/output/", 12) == 0) { param = atoi(path + 12); return 35; }
+        if (strcmp(path, "/api/reboot") == 0) return 36;
+        if (strcmp(path, "/api/firmware/download") == 0) return 37;
+        if (strcmp(path, "/api/firmware/confirm") == 0) return 38;
+        if (strcmp(path, "/api/firmware/rollback") == 0) return 39;
+    }
+    return -1;
+}
+
+static int legacy_rest_route(HttpMethod method, const char* path, int& param) {
+    if (strcmp(path, "/sensors") == 0 && method == HttpMethod::GET) return 0;
+    if (strncmp(path, "/sensors/", 9) == 0 && method == HttpMethod::GET) return 1;
+    if (strcmp(path, "/relays") == 0 && method == HttpMethod::GET) return 2;
+    if (strncmp(path, "/relays/", 8) == 0) {
+        if (strstr(path + 8, "/on") && method == HttpMethod::POST) return 3;
+        if (strstr(path + 8, "/off") && method == HttpMethod::POST) return 4;
+    }
+    if (strcmp(path, "/fermenters") == 0 && method == HttpMethod::GET) return 5;
+    if (strncmp(path, "/fermenters/", 12) == 0) {
+        param = atoi(path + 12);
+        if (param < 1 || param > 8) return -1;
+        if (strstr(path + 12, "/plan") && method == HttpMethod::POST) return 6;
+        if (strstr(path + 12, "/plan") && method == HttpMethod::GET) return 7;
+        if (strstr(path + 12, "/plan") && method == HttpMethod::DELETE) return 8;
+        if (strstr(path + 12, "/setpoint") && method == HttpMethod::PUT) return 9;
+        if (method == HttpMethod::GET) return 10;
+    }
+    if (strcmp(path, "/system/status") == 0 && method == HttpMethod::GET) return 11;
+    if (strcmp(path, "/config") == 0 && method == HttpMethod::GET) return 12;
+    return -1;
+}
+
+void test_routing_benchmark() {
+    // Every endpoint of both tables, plus misses
+    static const struct { const char* method; const char* path; } API_REQUESTS[] = {
+        {"GET", "/api/setup"}, {"POST", "/api/setup"}, {"POST", "/api/login"},
+        {"GET", "/api/health"}, {"GET", "/api/info"}, {"GET", "/api/ssl/status"},
+        {"POST", "/api/logout"}, {"POST", "/api/password"}, {"POST", "/api/factory_reset"},
+        {"GET", "/api/status"}, {"GET", "/api/sensors"}, {"GET", "/api/sensor/fermenter_1_temp"},
+        {"GET", "/api/relays"}, {"GET", "/api/fermenters"}, {"GET", "/api/fermenter/3"},
+        {"GET", "/api/pid/3"}, {"GET", "/api/alarms"}, {"GET", "/api/modbus/stats"},
+        {"GET", "/api/inputs"}, {"GET", "/api/outputs"}, {"GET", "/api/config"},
+        {"GET", "/api/modules"}, {"GET", "/api/wifi"}, {"GET", "/api/can/status"},
+        {"GET", "/api/firmware/info"}, {"GET", "/api/firmware/status"},
+        {"GET", "/api/cpu/history"}, {"GET", "/api/network/history"},
+        {"GET", "/api/history/sensor/glycol_temp?tier=1&from=60"},
+        {"GET", "/api/wifi/summary"}, {"GET", "/api/dashboard"}, {"GET", "/api/state"},
+        {"POST", "/api/relay/glycol_pump"}, {"POST", "/api/fermenter/3"}, {"POST", "/api/pid/3"},
+        {"POST", "/api/output/5"}, {"POST", "/api/reboot"}, {"POST", "/api/firmware/download"},
+        {"POST", "/api/firmware/confirm"}, {"POST", "/api/firmware/rollback"},
+        {"GET", "/api/nonexistent"}, {"PUT", "/api/sensors"},
+    };
+    static const struct { HttpMethod method; const char* path; } REST_REQUESTS[] = {
+        {HttpMethod::GET, "/sensors"}, {HttpMethod::GET, "/sensors/fermenter_1_temp"},
+        {HttpMethod::GET, "/relays"}, {HttpMethod::POST, "/relays/glycol_pump/on"},
+        {HttpMethod::POST, "/relays/glycol_pump/off"}, {HttpMethod::GET, "/fermenters"},
+        {HttpMethod::POST, "/fermenters/3/plan"}, {HttpMethod::GET, "/fermenters/3/plan"},
+        {HttpMethod::DELETE, "/fermenters/3/plan"}, {HttpMethod::PUT, "/fermenters/3/setpoint"},
+        {HttpMethod::GET, "/fermenters/3"}, {HttpMethod::GET, "/system/status"},
+        {HttpMethod::GET, "/config"}, {HttpMethod::GET, "/invalid/endpoint"},
+    };
+    const int ROUNDS = 20000;
+    const int REQUESTS = (int)(std::size(API_REQUESTS) + std::size(REST_REQUESTS));
+
+    using clock = std::chrono::steady_clock;
+    volatile long sink = 0;
+    int legacy_hits = 0;
+    int trie_hits = 0;
+
+    auto t0 = clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (const auto& req : API_REQUESTS) {
+            int param = 0;
+            int route = legacy_api_route(req.method, req.path, param);
+            legacy_hits += route >= 0;
+            sink = sink + route + param;
+        }
+        for (const auto& req : REST_REQUESTS) {
+            int param = 0;
+            int route = legacy_rest_route(req.method, req.path, param);
+            legacy_hits += route >= 0;
+            sink = sink + route + param;
+        }
+    }
+    auto t1 = clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        RouteMatch m;
+        for (const auto& req : API_REQUESTS) {
+            HttpServer::ApiRoute route;
+            bool hit = HttpServer::ROUTER.match(RouteMethod::from_string(req.method),
+                                                req.path, m, route);
+            trie_hits += hit;
+            sink = sink + (hit ? (int)route : -1) + (int)m.get_int(0);
+        }
+        for (const auto& req : REST_REQUESTS) {
+            RestApiHandler::Route route;
+            bool hit = RestApiHandler::ROUTER.match(1u << (int)req.method, req.path, m, route);
+            trie_hits += hit;
+            sink = sink + (hit ? (int)route : -1) + (int)m.get_int(0);
+        }
+    }
+    auto t2 = clock::now();
+
+    double legacy_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / ROUNDS / REQUESTS;
+    double trie_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / ROUNDS / REQUESTS;
+    printf("\n  Routing %d requests (%zu HttpServer + %zu RestApiHandler), %d rounds\n",
+           REQUESTS, std::size(API_REQUESTS), std::size(REST_REQUESTS), ROUNDS);
+    printf("    strcmp chain: %6.1f ns/route\n", legacy_ns);
+    printf("    route trie:   %6.1f ns/route (%zu + %zu nodes)\n", trie_ns,
+           HttpServer::ROUTER.node_count(), RestApiHandler::ROUTER.node_count());
+
+    // The trie only misses the #ifdef'd endpoints this build leaves out
+    TEST_ASSERT_EQUAL((REQUESTS - 3) * ROUNDS, legacy_hits);
+    TEST_ASSERT_TRUE(trie_hits > 0 && trie_hits <= legacy_hits);
+    TEST_ASSERT_TRUE(trie_ns < legacy_ns);
+}
+
 // ============================================
 // FIRST-BOOT PROVISIONING TESTS
 // ============================================
@@ -1288,6 +2262,9 @@ int main(int argc, char **argv) {
     RUN_TEST(test_api_sensors_with_data);
     RUN_TEST(test_api_sensor_individual);
     RUN_TEST(test_api_sensor_not_found);
+    RUN_TEST(test_api_sensor_history);
+    RUN_TEST(test_api_sensor_history_paged);
+    RUN_TEST(test_api_sensor_reads_under_writer_load);
     RUN_TEST(test_api_sensors_quality_states);
 
     // Relays API tests
@@ -1346,6 +2323,35 @@ int main(int argc, char **argv) {
     RUN_TEST(test_many_sensors);
     RUN_TEST(test_concurrent_session_replacement);
 
+    // Streaming JSON tests
+    RUN_TEST(test_json_writer_escaping_and_numbers);
+    RUN_TEST(test_json_writer_buffer_truncation);
+    RUN_TEST(test_api_sensor_name_escaped);
+    RUN_TEST(test_api_dashboard_streams_past_4k);
+    RUN_TEST(test_json_serialization_benchmark);
+
+    // Route table
+    RUN_TEST(test_route_trie_typed_params);
+    RUN_TEST(test_route_trie_method_and_query);
+    RUN_TEST(test_route_tables_resolve_every_endpoint);
+    RUN_TEST(test_api_query_string_and_numeric_ids);
+    RUN_TEST(test_routing_benchmark);
+
+    // Binary snapshot tests
+    RUN_TEST(test_state_snapshot_layout);
+    RUN_TEST(test_state_snapshot_writer_rules);
+    RUN_TEST(test_state_content_negotiation);
+
+    // Conditional GET tests
+    RUN_TEST(test_conditional_get_not_modified);
+    RUN_TEST(test_conditional_get_survives_telemetry);
+    RUN_TEST(test_conditional_get_direct_writes_and_clock);
+    RUN_TEST(test_conditional_get_matching);
+    RUN_TEST(test_static_asset_headers);
+    RUN_TEST(test_static_asset_negotiation);
+    RUN_TEST(test_static_asset_cache_budget);
+    RUN_TEST(test_static_asset_hot_cache);
+
     // First-boot provisioning tests
     RUN_TEST(test_not_provisioned_login_rejected);
     RUN_TEST(test_setup_endpoint_creates_password);
@@ -0,0 +1,354 @@
+#include <unity.h>
+#include "hal/modbus_rtu.h"
+#include "hal/simulator/rtu_line.h"
+#include <cstdio>
+
+using namespace hal;
+using namespace hal::simulator;
+
+// Test fixtures
+static SimulatorRtuLine* line;
+static ModbusRtuMaster* master;
+
+static constexpr uint32_t TEST_BAUD = 9600;
+static constexpr uint8_t NUM_SLAVES = 8;
+
+void setUp(void) {
+    line = new SimulatorRtuLine(TEST_BAUD);
+    master = new ModbusRtuMaster(line, TEST_BAUD, 100);
+    for (uint8_t addr = 1; addr <= NUM_SLAVES; addr++) {
+        line->add_slave(addr, 2000);
+        line->set_register(addr, 0, 180 + addr);
+        line->set_register(addr, 1, 200 + addr);
+    }
+}
+
+void tearDown(void) {
+    delete master;
+    delete line;
+}
+
+// Completion recorder used as callback context
+struct Completion {
+    uint8_t slaves[ModbusRtuMaster::QUEUE_SIZE];
+    ModbusStatus status[ModbusRtuMaster::QUEUE_SIZE];
+    uint8_t count;
+};
+
+static void record_completion(const ModbusRequest& request, ModbusStatus status, void* ctx) {
+    Completion* c = static_cast<Completion*>(ctx);
+    c->slaves[c->count] = request.slave_addr;
+    c->status[c->count] = status;
+    c->count++;
+}
+
+static ModbusRequest make_read(uint8_t slave, uint16_t* buf, Completion* done = nullptr) {
+    ModbusRequest req;
+    req.slave_addr = slave;
+    req.function = ModbusFunction::READ_HOLDING_REGISTERS;
+    req.start_reg = 0;
+    req.count = 2;
+    req.data = buf;
+    if (done) {
+        req.callback = record_completion;
+        req.ctx = done;
+    }
+    return req;
+}
+
+static void run_until_idle(uint32_t step_us) {
+    for (int i = 0; i < 100000 && !master->is_idle(); i++) {
+        master->process();
+        line->advance_us(step_us);
+    }
+}
+
+// =============================================================================
+// Framing Tests
+// =============================================================================
+
+void test_crc16_known_vector() {
+    // Read 1 holding register at 0 from slave 1 -> CRC 0x0A84 (84 0A on the wire)
+    const uint8_t frame[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x01};
+    TEST_ASSERT_EQUAL_HEX16(0x0A84, ModbusRtuMaster::crc16(frame, sizeof(frame)));
+}
+
+void test_silent_interval_from_baudrate() {
+    // 9600 baud: 11 bits = 1146us per char, 3.5 chars = 4011us
+    TEST_ASSERT_EQUAL(1146, master->get_char_time_us());
+    TEST_ASSERT_EQUAL(4011, master->get_silent_interval_us());
+
+    // Above 19200 the spec fixes t3.5 at 1750us
+    master->set_baudrate(115200);
+    TEST_ASSERT_EQUAL(1750, master->get_silent_interval_us());
+}
+
+// =============================================================================
+// Synchronous Helper Tests
+// =============================================================================
+
+void test_execute_read() {
+    uint16_t buf[2] = {0, 0};
+    ModbusStatus status = master->execute(make_read(3, buf));
+
+    TEST_ASSERT_EQUAL(ModbusStatus::OK, status);
+    TEST_ASSERT_EQUAL(183, buf[0]);
+    TEST_ASSERT_EQUAL(203, buf[1]);
+    TEST_ASSERT_EQUAL(1, master->get_transaction_count());
+    TEST_ASSERT_EQUAL(0, master->get_error_count());
+}
+
+void test_execute_write_single_and_multiple() {
+    uint16_t value = 1234;
+    ModbusRequest req;
+    req.slave_addr = 2;
+    req.function = ModbusFunction::WRITE_SINGLE_REGISTER;
+    req.start_reg = 10;
+    req.count = 1;
+    req.data = &value;
+    TEST_ASSERT_EQUAL(ModbusStatus::OK, master->execute(req));
+    TEST_ASSERT_EQUAL(1234, line->get_register(2, 10));
+
+    uint16_t values[3] = {7, 8, 9};
+    req.function = ModbusFunction::WRITE_MULTIPLE_REGISTERS;
+    req.start_reg = 20;
+    req.count = 3;
+    req.data = values;
+    TEST_ASSERT_EQUAL(ModbusStatus::OK, master->execute(req));
+    TEST_ASSERT_EQUAL(9, line->get_register(2, 22));
+}
+
+void test_execute_sleeps_until_line_events() {
+    // A dead slave costs one wait for the request and one for the timeout,
+    // not a poll every character time
+    uint16_t buf[2];
+    uint32_t start = line->micros();
+    TEST_ASSERT_EQUAL(ModbusStatus::TIMEOUT, master->execute(make_read(42, buf)));
+    TEST_ASSERT_LESS_OR_EQUAL(2, line->get_event_waits());
+    TEST_ASSERT_UINT32_WITHIN(20000, 110000, line->micros() - start);
+
+    // A live slave wakes the master on its response bytes
+    TEST_ASSERT_EQUAL(ModbusStatus::OK, master->execute(make_read(3, buf)));
+    TEST_ASSERT_EQUAL(183, buf[0]);
+}
+
+void test_execute_rejects_invalid() {
+    uint16_t buf[126];
+    ModbusRequest req = make_read(1, buf);
+    req.count = 126;
+    TEST_ASSERT_NOT_EQUAL(ModbusStatus::OK, master->execute(req));
+    TEST_ASSERT_EQUAL(0, line->get_frames_sent());
+}
+
+// =============================================================================
+// Asynchronous Queue Tests
+// =============================================================================
+
+void test_submit_returns_immediately() {
+    uint16_t buf[2];
+    TEST_ASSERT_TRUE(master->submit(make_read(1, buf)));
+    TEST_ASSERT_EQUAL(1, master->pending());
+    TEST_ASSERT_EQUAL(0, line->micros());  // No time consumed by submit
+}
+
+void test_pipelined_reads_complete_in_order() {
+    uint16_t bufs[NUM_SLAVES][2];
+    Completion done = {};
+
+    for (uint8_t i = 0; i < NUM_SLAVES; i++) {
+        TEST_ASSERT_TRUE(master->submit(make_read(i + 1, bufs[i], &done)));
+    }
+    run_until_idle(100);
+
+    TEST_ASSERT_EQUAL(NUM_SLAVES, done.count);
+    for (uint8_t i = 0; i < NUM_SLAVES; i++) {
+        TEST_ASSERT_EQUAL(i + 1, done.slaves[i]);
+        TEST_ASSERT_EQUAL(ModbusStatus::OK, done.status[i]);
+        TEST_ASSERT_EQUAL(181 + i, bufs[i][0]);
+    }
+}
+
+void test_inter_frame_gap_respected() {
+    uint16_t bufs[4][2];
+    for (uint8_t i = 0; i < 4; i++) {
+        master->submit(make_read(i + 1, bufs[i]));
+    }
+    run_until_idle(50);
+
+    // Each request waits for the previous response plus t3.5 of silence
+    const auto& starts = line->get_frame_starts();
+    TEST_ASSERT_EQUAL(4, starts.size());
+    uint32_t frame_us = 8 * master->get_char_time_us() + 2000 + 9 * master->get_char_time_us();
+    for (size_t i = 1; i < starts.size(); i++) {
+        TEST_ASSERT_TRUE(starts[i] - starts[i - 1] >= frame_us + master->get_silent_interval_us());
+    }
+}
+
+void test_queue_full_rejected() {
+    uint16_t buf[2];
+    for (uint8_t i = 0; i < ModbusRtuMaster::QUEUE_SIZE; i++) {
+        TEST_ASSERT_TRUE(master->submit(make_read(1, buf)));
+    }
+    TEST_ASSERT_FALSE(master->submit(make_read(1, buf)));
+}
+
+// =============================================================================
+// Error Handling Tests
+// =============================================================================
+
+void test_timeout_does_not_block_queue() {
+    uint16_t missing[2], present[2];
+    Completion done = {};
+
+    master->submit(make_read(42, missing, &done));  // No such slave
+    master->submit(make_read(1, present, &done));
+    run_until_idle(500);
+
+    TEST_ASSERT_EQUAL(2, done.count);
+    TEST_ASSERT_EQUAL(ModbusStatus::TIMEOUT, done.status[0]);
+    TEST_ASSERT_EQUAL(ModbusStatus::OK, done.status[1]);
+    TEST_ASSERT_EQUAL(181, present[0]);
+    TEST_ASSERT_EQUAL(1, master->get_error_count());
+}
+
+void test_crc_error_detected() {
+    uint16_t buf[2] = {0, 0};
+    line->corrupt_next_response();
+    TEST_ASSERT_EQUAL(ModbusStatus::CRC_ERROR, master->execute(make_read(1, buf)));
+    TEST_ASSERT_EQUAL(0, buf[0]);
+}
+
+void test_exception_frame_ends_on_length() {
+    uint16_t buf[2];
+    ModbusRequest req = make_read(1, buf);
+    req.start_reg = 100;  // Unmapped -> illegal data address
+    TEST_ASSERT_EQUAL(ModbusStatus::EXCEPTION, master->execute(req));
+}
+
+void test_failed_transactions_are_counted() {
+    // Same accounting as the synchronous drivers: attempts, then errors
+    uint16_t missing[2], present[2];
+    master->execute(make_read(42, missing));
+    master->execute(make_read(1, present));
+    TEST_ASSERT_EQUAL(2, master->get_transaction_count());
+    TEST_ASSERT_EQUAL(1, master->get_error_count());
+}
+
+// =============================================================================
+// Throughput Benchmark (virtual time on the simulated line)
+// =============================================================================
+
+/**
+ * Previous SerialModbus behaviour: write, sleep 10ms, then poll in 10ms steps
+ */
+static bool legacy_read(SimulatorRtuLine* l, uint8_t slave, uint16_t* out) {
+    uint8_t req[8] = {slave, 0x03, 0, 0, 0, 2, 0, 0};
+    uint16_t crc = ModbusRtuMaster::crc16(req, 6);
+    req[6] = crc & 0xFF;
+    req[7] = crc >> 8;
+    l->write(req, 8);
+
+    l->wait_us(10000);
+    uint8_t resp[9];
+    size_t got = 0;
+    int retries = 100;
+    while (got < sizeof(resp) && retries > 0) {
+        size_t n = l->read(resp + got, sizeof(resp) - got);
+        if (n > 0) {
+            got += n;
+        } else {
+            l->wait_us(10000);
+            retries--;
+        }
+    }
+    if (got < sizeof(resp)) return false;
+    out[0] = (resp[3] << 8) | resp[4];
+    out[1] = (resp[5] << 8) | resp[6];
+    return true;
+}
+
+void test_benchmark_transactions_per_second() {
+    const int CYCLES = 50;
+    const uint32_t BENCH_BAUD = 57600;  // Rate used by the simulator build
+    uint16_t bufs[NUM_SLAVES][2];
+
+    line->set_baudrate(BENCH_BAUD);
+    master->set_baudrate(BENCH_BAUD);
+
+    // Before: fixed sleeps
+    uint32_t t0 = line->micros();
+    for (int c = 0; c < CYCLES; c++) {
+        for (uint8_t i = 0; i < NUM_SLAVES; i++) {
+            TEST_ASSERT_TRUE(legacy_read(line, i + 1, bufs[i]));
+        }
+    }
+    uint32_t legacy_us = line->micros() - t0;
+
+    // After: blocking execute() with silence-based end-of-frame
+    t0 = line->micros();
+    line->advance_us(10000);  // Let the bus settle
+    for (int c = 0; c < CYCLES; c++) {
+        for (uint8_t i = 0; i < NUM_SLAVES; i++) {
+            TEST_ASSERT_EQUAL(ModbusStatus::OK, master->execute(make_read(i + 1, bufs[i])));
+        }
+    }
+    uint32_t sync_us = line->micros() - t0;
+
+    // After: all slaves queued, driven by process() every 200us
+    t0 = line->micros();
+    for (int c = 0; c < CYCLES; c++) {
+        for (uint8_t i = 0; i < NUM_SLAVES; i++) {
+            TEST_ASSERT_TRUE(master->submit(make_read(i + 1, bufs[i])));
+        }
+        run_until_idle(200);
+    }
+    uint32_t async_us = line->micros() - t0;
+
+    uint32_t total = CYCLES * NUM_SLAVES;
+    printf("\n  MODBUS RTU @%lu baud, %u slaves, %u transactions (virtual time)\n",
+           (unsigned long)BENCH_BAUD, NUM_SLAVES, (unsigned)total);
+    printf("    fixed 10ms sleeps:   %7.1f TPS (%lu ms)\n",
+           total * 1e6 / legacy_us, (unsigned long)(legacy_us / 1000));
+    printf("    t3.5 sync execute:   %7.1f TPS (%lu ms)\n",
+           total * 1e6 / sync_us, (unsigned long)(sync_us / 1000));
+    printf("    t3.5 async queue:    %7.1f TPS (%lu ms)\n",
+           total * 1e6 / async_us, (unsigned long)(async_us / 1000));
+
+    TEST_ASSERT_TRUE(sync_us < legacy_us);
+    TEST_ASSERT_TRUE(async_us < legacy_us);
+}
+
+// =============================================================================
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+
+    // Framing tests
+    RUN_TEST(test_crc16_known_vector);
+    RUN_TEST(test_silent_interval_from_baudrate);
+
+    // Synchronous helper tests
+    RUN_TEST(test_execute_read);
+    RUN_TEST(test_execute_write_single_and_multiple);
+    RUN_TEST(test_execute_sleeps_until_line_events);
+    RUN_TEST(test_execute_rejects_invalid);
+
+    // Asynchronous queue tests
+    RUN_TEST(test_submit_returns_immediately);
+    RUN_TEST(test_pipelined_reads_complete_in_order);
+    RUN_TEST(test_inter_frame_gap_respected);
+    RUN_TEST(test_queue_full_rejected);
+
+    // Error handling tests
+    RUN_TEST(test_timeout_does_not_block_queue);
+    RUN_TEST(test_crc_error_detected);
+    RUN_TEST(test_exception_frame_ends_on_length);
+    RUN_TEST(test_failed_transactions_are_counted);
+
+    // Benchmark
+    RUN_TEST(test_benchmark_transactions_per_second);
+
+    return UNITY_END();
+}
@@ -1,11 +1,23 @@
 #include <unity.h>
 #include "modules/filters.h"
+#include "modules/filter_bank.h"
 #include "modules/pid_controller.h"
 #include "modules/modbus_module.h"
+#include "modules/history_log.h"
+#include "modules/relay_output.h"
+#include "modules/ws_broadcast_log.h"
+#include "modules/ws_delta_aggregator.h"
+#include "modules/ws_subscription.h"
 #include "hal/simulator/hal_simulator.h"
 #include "core/state_manager.h"
 #include "core/event_bus.h"
+#include "core/config_loader.h"
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
 
 using namespace modules;
 using namespace core;
@@ -119,6 +131,114 @@ void test_median_filter_outlier_rejection() {
     TEST_ASSERT_EQUAL_FLOAT(18.3f, filter.get_value());
 }
 
+/**
+ * Previous MedianFilter: copy the ring and bubble-sort it on every read.
+ * Kept here as the reference for equivalence and benchmark tests.
+ */
+template <uint8_t MAX>
+class LegacyMedianFilter {
+public:
+    explicit LegacyMedianFilter(uint8_t window_size)
+        : window_size_(window_size > MAX ? MAX : window_size), index_(0), count_(0), buffer_{} {
+        if (window_size_ % 2 == 0) window_size_--;
+        if (window_size_ < 3) window_size_ = 3;
+    }
+
+    float update(float value) {
+        buffer_[index_] = value;
+        index_ = (index_ + 1) % window_size_;
+        if (count_ < window_size_) count_++;
+        return get_value();
+    }
+
+    float get_value() const {
+        if (count_ == 0) return 0;
+        float sorted[MAX];
+        for (uint8_t i = 0; i < count_; i++) sorted[i] = buffer_[i];
+        core::bubble_sort(sorted, count_);
+        return sorted[count_ / 2];
+    }
+
+private:
+    uint8_t window_size_;
+    uint8_t index_;
+    uint8_t count_;
+    float buffer_[MAX];
+};
+
+// Noisy pressure signal with spikes and repeated values
+static float median_test_signal(uint32_t& seed, int i) {
+    seed = seed * 1103515245u + 12345u;
+    float noise = ((seed >> 16) % 200) * 0.001f;
+    float value = 1.2f + 0.001f * i + noise;
+    if ((seed >> 8) % 17 == 0) value += 5.0f;     // Spike
+    if ((seed >> 4) % 11 == 0) value = 1.5f;      // Duplicate
+    return value;
+}
+
+void test_median_filter_matches_legacy() {
+    const uint8_t windows[] = {2, 3, 5, 8, 9, 15, 31, 40};
+    for (uint8_t w : windows) {
+        MedianFilter filter(w);
+        LegacyMedianFilter<MedianFilter::MAX_WINDOW> legacy(w);
+        uint32_t seed = 42 + w;
+        for (int i = 0; i < 500; i++) {
+            float value = median_test_signal(seed, i);
+            float expected = legacy.update(value);
+            TEST_ASSERT_EQUAL_FLOAT(expected, filter.update(value));
+            TEST_ASSERT_EQUAL_FLOAT(expected, filter.get_value());
+        }
+    }
+
+    MedianFilter wide(31);
+    TEST_ASSERT_EQUAL(31, wide.get_window_size());
+    for (int i = 0; i < 30; i++) wide.update((float)i);
+    TEST_ASSERT_FALSE(wide.is_ready());
+    wide.update(30.0f);
+    TEST_ASSERT_TRUE(wide.is_ready());
+    TEST_ASSERT_EQUAL_FLOAT(15.0f, wide.get_value());
+    wide.reset();
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, wide.get_value());
+}
+
+void test_median_filter_benchmark() {
+    const int SAMPLES = 20000;
+    float signal[256];
+    uint32_t seed = 7;
+    for (int i = 0; i < 256; i++) signal[i] = median_test_signal(seed, i);
+
+    using clock = std::chrono::steady_clock;
+    volatile float sink = 0;
+
+    printf("\n  Median filter, update + get_value per sample (as ModbusModule calls it)\n");
+    const uint8_t windows[] = {5, 9, 31};
+    for (uint8_t w : windows) {
+        LegacyMedianFilter<MedianFilter::MAX_WINDOW> legacy(w);
+        MedianFilter filter(w);
+
+        auto t0 = clock::now();
+        for (int i = 0; i < SAMPLES; i++) {
+            legacy.update(signal[i & 255]);
+            sink = legacy.get_value();
+        }
+        auto t1 = clock::now();
+        for (int i = 0; i < SAMPLES; i++) {
+            filter.update(signal[i & 255]);
+            sink = filter.get_value();
+        }
+        auto t2 = clock::now();
+
+        double legacy_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / SAMPLES;
+        double sorted_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / SAMPLES;
+        printf("    window %2u: bubble sort %8.1f ns, sorted window %6.1f ns (%.1fx)\n",
+               w, legacy_ns, sorted_ns, legacy_ns / sorted_ns);
+
+        TEST_ASSERT_EQUAL_FLOAT(legacy.get_value(), filter.get_value());
+        if (w >= 9) TEST_ASSERT_TRUE(sorted_ns < legacy_ns);
+    }
+    (void)sink;
+}
+
 // Dual Rate Filter tests
 
 void test_dual_rate_filter_blend() {
@@ -141,6 +261,122 @@ void test_dual_rate_filter_extra_priority() {
     TEST_ASSERT_EQUAL_FLOAT(18.0f, filter.get_value());
 }
 
+
+// Filter bank tests
+
+// Counts operator new calls so tests can check for heap-free paths
+static size_t g_heap_allocs = 0;
+
+__attribute__((noinline)) void* operator new(size_t size) {
+    g_heap_allocs++;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+
+void test_filter_bank_matches_filters() {
+    FilterBank bank;
+    TEST_ASSERT_TRUE(bank.add(FilterType::EMA, 0.4f, 5));
+    TEST_ASSERT_TRUE(bank.add(FilterType::MOVING_AVERAGE, 0.3f, 4));
+    TEST_ASSERT_TRUE(bank.add(FilterType::MEDIAN, 0.3f, 7));
+    TEST_ASSERT_TRUE(bank.add(FilterType::DUAL_RATE, 0.3f, 5));
+    TEST_ASSERT_TRUE(bank.add(FilterType::NONE, 0.3f, 5));
+    TEST_ASSERT_EQUAL(5, bank.size());
+
+    EMAFilter ema(0.4f);
+    MovingAverageFilter ma(4);
+    MedianFilter median(7);
+    DualRateFilter dual(0.3f);
+
+    for (int i = 0; i < 50; i++) {
+        float value = 10.0f + (i % 7) * 0.5f + ((i % 13 == 0) ? 20.0f : 0.0f);
+        bool extra = (i % 3) != 0;
+        // Unity may evaluate its arguments more than once
+        float expected[4] = {
+            ema.update(value), ma.update(value), median.update(value),
+            extra ? dual.update_extra(value) : dual.update_base(value)};
+        for (uint8_t f = 0; f < 4; f++) {
+            float got = bank.update(f, value, extra);
+            TEST_ASSERT_EQUAL_FLOAT(expected[f], got);
+        }
+        float passthrough = bank.update(4, value, extra);
+        TEST_ASSERT_EQUAL_FLOAT(value, passthrough);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(median.get_value(), bank.get_value(2));
+    TEST_ASSERT_NULL(bank.get(4));
+
+    auto* d = static_cast<const DualRateFilter*>(bank.get(3));
+    TEST_ASSERT_EQUAL_FLOAT(dual.get_base_value(), d->get_base_value());
+    TEST_ASSERT_EQUAL_FLOAT(dual.get_extra_value(), d->get_extra_value());
+
+    bank.reset(0);
+    TEST_ASSERT_FALSE(bank.is_ready(0));
+
+    // Every slot fits even the largest filter; only a full bank refuses
+    bank.clear();
+    TEST_ASSERT_EQUAL(0, bank.get_arena_used());
+    for (uint8_t i = 0; i < FilterBank::CAPACITY; i++) {
+        TEST_ASSERT_TRUE(bank.add(FilterType::MEDIAN, 0.3f, 31));
+    }
+    TEST_ASSERT_EQUAL(FilterType::MEDIAN, bank.get_type(FilterBank::CAPACITY - 1));
+    TEST_ASSERT_TRUE(bank.get_arena_used() <= FilterBank::ARENA_BYTES);
+    TEST_ASSERT_FALSE(bank.add(FilterType::EMA, 0.3f, 5));
+    TEST_ASSERT_EQUAL(FilterBank::CAPACITY, bank.size());
+}
+
+void test_filter_bank_benchmark() {
+    const int CYCLES = 20000;
+    const FilterType types[] = {FilterType::EMA, FilterType::EMA, FilterType::EMA,
+                                FilterType::MOVING_AVERAGE, FilterType::MEDIAN};
+
+    // Before: one heap object per sensor behind IFilter
+    std::unique_ptr<IFilter> legacy[MAX_SENSORS];
+    FilterBank bank;
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        FilterType type = types[i % 5];
+        bank.add(type, 0.3f, 5);
+        switch (type) {
+            case FilterType::EMA: legacy[i] = std::make_unique<EMAFilter>(0.3f); break;
+            case FilterType::MOVING_AVERAGE: legacy[i] = std::make_unique<MovingAverageFilter>(5); break;
+            default: legacy[i] = std::make_unique<MedianFilter>(5); break;
+        }
+    }
+
+    volatile float legacy_out = 0, bank_out = 0;
+    using clock = std::chrono::steady_clock;
+
+    auto t0 = clock::now();
+    for (int c = 0; c < CYCLES; c++) {
+        float sum = 0;
+        for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+            sum += legacy[i]->update(18.0f + ((c + i) & 7) * 0.1f);
+        }
+        legacy_out = sum;
+    }
+    auto t1 = clock::now();
+    for (int c = 0; c < CYCLES; c++) {
+        float sum = 0;
+        for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+            sum += bank.update(i, 18.0f + ((c + i) & 7) * 0.1f);
+        }
+        bank_out = sum;
+    }
+    auto t2 = clock::now();
+
+    double legacy_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / (CYCLES * MAX_SENSORS);
+    double bank_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / (CYCLES * MAX_SENSORS);
+
+    printf("\n  Filter update, %u sensors (EMA/MA/median mix), arena %u B\n",
+           MAX_SENSORS, (unsigned)bank.get_arena_used());
+    printf("    unique_ptr<IFilter>, virtual: %6.1f ns/sample\n", legacy_ns);
+    printf("    FilterBank, tagged switch:    %6.1f ns/sample (%.1fx)\n",
+           bank_ns, legacy_ns / bank_ns);
+
+    TEST_ASSERT_EQUAL_FLOAT(legacy_out, bank_out);
+}
+
 // No Filter tests
 
 void test_no_filter_passthrough() {
@@ -237,6 +473,255 @@ void test_pid_derivative_on_measurement() {
     TEST_ASSERT_EQUAL_FLOAT(-5.0f, output);
 }
 
+void test_pid_dt_invariance() {
+    // Same 20 s of error at 1 s and 5 s steps gives the same integral
+    PIDController fast(0.0f, 0.1f, 0.0f);
+    PIDController slow(0.0f, 0.1f, 0.0f);
+
+    for (int i = 0; i < 20; i++) fast.compute(20.0f, 18.0f, 1.0f);
+    for (int i = 0; i < 4; i++) slow.compute(20.0f, 18.0f, 5.0f);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 4.0f, fast.get_integral());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, fast.get_integral(), slow.get_integral());
+
+    // Derivative is per second: a 5 degree change over 5 s = -1
+    PIDController d(0.0f, 0.0f, 1.0f);
+    d.set_output_limits(-100.0f, 100.0f);
+    d.compute(20.0f, 10.0f, 5.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -1.0f, d.compute(20.0f, 15.0f, 5.0f));
+
+    // Zero dt leaves the controller untouched
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -1.0f, d.compute(20.0f, 30.0f, 0.0f));
+}
+
+void test_pid_derivative_filter() {
+    PIDController pid(0.0f, 0.0f, 1.0f);
+    pid.set_output_limits(-100.0f, 100.0f);
+    pid.set_derivative_filter(4.0f);  // tau = 4 s, alpha = dt / (tau + dt) = 0.2
+
+    pid.compute(20.0f, 10.0f, 1.0f);
+    float out = pid.compute(20.0f, 15.0f, 1.0f);  // Step of 5/s
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -1.0f, out);
+
+    // Steady input: the filtered rate decays instead of dropping to 0
+    out = pid.compute(20.0f, 15.0f, 1.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -0.8f, out);
+
+    pid.reset();
+    pid.compute(20.0f, 10.0f, 1.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -1.0f, pid.compute(20.0f, 15.0f, 1.0f));
+}
+
+void test_pid_scheduler_intervals_and_stagger() {
+    PIDScheduler sched;
+    sched.configure(8);
+    for (uint8_t i = 0; i < 8; i++) sched.set_interval(i, 5000);
+
+    // Phases spread across the interval
+    TEST_ASSERT_EQUAL_UINT32(0, sched.get_phase_ms(0));
+    TEST_ASSERT_EQUAL_UINT32(625, sched.get_phase_ms(1));
+    TEST_ASSERT_EQUAL_UINT32(4375, sched.get_phase_ms(7));
+
+    // 20 s of 100 ms ticks: every loop runs 4 times, never two on one tick
+    uint32_t max_per_tick = 0;
+    float dt_s = 0;
+    for (uint32_t now = 0; now < 20000; now += 100) {
+        uint32_t n = 0;
+        for (uint8_t i = 0; i < 8; i++) {
+            if (sched.due(i, now, dt_s)) {
+                n++;
+                TEST_ASSERT_FLOAT_WITHIN(0.001f, 5.0f, dt_s);
+            }
+        }
+        if (n > max_per_tick) max_per_tick = n;
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, max_per_tick);
+    for (uint8_t i = 0; i < 8; i++) {
+        TEST_ASSERT_EQUAL_UINT32(4, sched.get_run_count(i));
+    }
+
+    // Per-loop interval override
+    sched.set_interval(2, 10000);
+    TEST_ASSERT_EQUAL_UINT32(2500, sched.get_phase_ms(2));
+    uint32_t runs = sched.get_run_count(2);
+    for (uint32_t now = 20000; now < 40000; now += 100) {
+        sched.due(2, now, dt_s);
+    }
+    TEST_ASSERT_EQUAL_UINT32(runs + 2, sched.get_run_count(2));
+}
+
+void test_pid_scheduler_measured_dt() {
+    PIDScheduler sched;
+    sched.configure(1);
+    sched.set_interval(0, 1000);
+    float dt_s = 0;
+
+    TEST_ASSERT_TRUE(sched.due(0, 0, dt_s));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.0f, dt_s);  // First run: nominal
+
+    // A late tick reports the real elapsed time, next run stays on the grid
+    TEST_ASSERT_FALSE(sched.due(0, 900, dt_s));
+    TEST_ASSERT_TRUE(sched.due(0, 1300, dt_s));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.3f, dt_s);
+    TEST_ASSERT_TRUE(sched.due(0, 2000, dt_s));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.7f, dt_s);
+
+    // A stall longer than two intervals falls back to nominal dt
+    TEST_ASSERT_TRUE(sched.due(0, 10000, dt_s));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.0f, dt_s);
+    TEST_ASSERT_FALSE(sched.due(0, 10500, dt_s));
+    TEST_ASSERT_TRUE(sched.due(0, 11000, dt_s));
+}
+
+// Fixed-point DSP tests
+
+static const uint32_t FX_GOLDEN_HASH = 0xFBF7C438;
+
+void test_q16_16_arithmetic() {
+    using core::Q16_16;
+    TEST_ASSERT_EQUAL_INT32(0x00018000, Q16_16(1.5f).raw());
+    TEST_ASSERT_EQUAL_INT32(-0x00018000, Q16_16(-1.5f).raw());
+    TEST_ASSERT_EQUAL_FLOAT(2.25f, (Q16_16(1.5f) * Q16_16(1.5f)).to_float());
+    TEST_ASSERT_EQUAL_FLOAT(-0.75f, (Q16_16(-1.5f) / Q16_16(2.0f)).to_float());
+    TEST_ASSERT_FLOAT_WITHIN(1.0f / 65536, 0.1f, Q16_16(0.1f).to_float());
+
+    // Products and quotients round to nearest, symmetric around zero
+    Q16_16 lsb = Q16_16::from_raw(1);
+    TEST_ASSERT_EQUAL_INT32(1, (lsb * Q16_16(0.5f)).raw());
+    TEST_ASSERT_EQUAL_INT32(-1, (-lsb * Q16_16(0.5f)).raw());
+    TEST_ASSERT_EQUAL_INT32(21845, (Q16_16(1.0f) / Q16_16(3.0f)).raw());
+    TEST_ASSERT_EQUAL_INT32(43691, (Q16_16(2.0f) / Q16_16(3.0f)).raw());
+
+    // Saturates instead of wrapping
+    Q16_16 big = Q16_16(30000.0f);
+    TEST_ASSERT_EQUAL_INT32(Q16_16::RAW_MAX, (big + big).raw());
+    TEST_ASSERT_EQUAL_INT32(Q16_16::RAW_MIN, (-big - big).raw());
+    TEST_ASSERT_EQUAL_INT32(Q16_16::RAW_MAX, (big * big).raw());
+    TEST_ASSERT_EQUAL_INT32(Q16_16::RAW_MAX, Q16_16(1e9f).raw());
+    TEST_ASSERT_EQUAL_INT32(Q16_16::RAW_MAX, (Q16_16(1.0f) / Q16_16()).raw());
+    TEST_ASSERT_TRUE(Q16_16(-2.0f) < Q16_16(1.0f));
+}
+
+/**
+ * Synthetic MODBUS traces (uint16 registers) shaped like the recorded
+ * ones: fermenter temperature (0.1 °C/LSB) cooling from 20 to 12 °C with
+ * sensor noise, and a pressure transducer (0.01 bar/LSB) with spikes
+ */
+static const int FX_TRACE_LEN = 2048;
+
+static void make_fx_traces(uint16_t* temp, uint16_t* pressure) {
+    uint32_t seed = 12345;
+    for (int i = 0; i < FX_TRACE_LEN; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int noise = (int)((seed >> 16) % 5) - 2;
+        temp[i] = (uint16_t)(200 - (80 * i) / FX_TRACE_LEN + noise);
+        int spike = ((seed >> 8) % 53 == 0) ? 150 : 0;
+        pressure[i] = (uint16_t)(80 + (40 * i) / FX_TRACE_LEN + noise * 2 + spike);
+    }
+}
+
+// Golden Q16.16 result over the temperature trace; the same bits must
+// come out on the ESP32 (the math is integer-only)
+void test_fixed_point_deterministic_trace() {
+    static uint16_t temp[FX_TRACE_LEN], pressure[FX_TRACE_LEN];
+    make_fx_traces(temp, pressure);
+
+    using core::Q16_16;
+    BasicEMAFilter<Q16_16> ema(0.3f);
+    BasicMovingAverageFilter<Q16_16> ma(8);
+    BasicMedianFilter<Q16_16> median(15);
+    BasicPIDController<Q16_16> pid(2.0f, 0.1f, 1.0f);
+    pid.set_derivative_filter(5.0f);
+
+    const Q16_16 temp_scale(0.1f);
+    const Q16_16 press_scale(0.01f);
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < FX_TRACE_LEN; i++) {
+        Q16_16 t = Q16_16::from_int(temp[i]) * temp_scale;
+        Q16_16 p = Q16_16::from_int(pressure[i]) * press_scale;
+        Q16_16 e = ema.update_value(t);
+        Q16_16 out[4] = {e, ma.update_value(t), median.update_value(p),
+                         pid.compute_value(Q16_16(16.0f), e, Q16_16(1.0f))};
+        for (Q16_16 v : out) hash = (hash ^ (uint32_t)v.raw()) * 16777619u;
+    }
+    printf("\n  Q16.16 trace hash: 0x%08X\n", (unsigned)hash);
+    TEST_ASSERT_EQUAL_HEX32(FX_GOLDEN_HASH, hash);
+}
+
+template <typename F, typename T>
+static double fx_time_ns(F&& step, const T* in, T* out) {
+    using clock = std::chrono::steady_clock;
+    const int REPEAT = 20;
+    auto t0 = clock::now();
+    for (int r = 0; r < REPEAT; r++) {
+        for (int i = 0; i < FX_TRACE_LEN; i++) out[i] = step(in[i]);
+    }
+    auto t1 = clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / (REPEAT * FX_TRACE_LEN);
+}
+
+void test_fixed_point_benchmark() {
+    static uint16_t temp[FX_TRACE_LEN], pressure[FX_TRACE_LEN];
+    make_fx_traces(temp, pressure);
+
+    using core::Q16_16;
+    static float tf[FX_TRACE_LEN], pf[FX_TRACE_LEN], of[FX_TRACE_LEN];
+    static Q16_16 tq[FX_TRACE_LEN], pq[FX_TRACE_LEN], oq[FX_TRACE_LEN];
+    for (int i = 0; i < FX_TRACE_LEN; i++) {
+        tf[i] = temp[i] * 0.1f;
+        pf[i] = pressure[i] * 0.01f;
+        tq[i] = Q16_16::from_int(temp[i]) * Q16_16(0.1f);
+        pq[i] = Q16_16::from_int(pressure[i]) * Q16_16(0.01f);
+    }
+
+    // Differences are mostly the Q16.16 rounding of the 0.1 / 0.01 scales
+    printf("\n  Float vs Q16.16 over %d-sample traces (host)\n", FX_TRACE_LEN);
+    printf("    %-18s %9s %9s %10s\n", "stage", "float ns", "Q16 ns", "max |err|");
+
+    auto report = [&](const char* name, double f_ns, double q_ns, float limit) {
+        float max_err = 0;
+        for (int i = 0; i < FX_TRACE_LEN; i++) {
+            float err = std::fabs(of[i] - oq[i].to_float());
+            if (err > max_err) max_err = err;
+        }
+        printf("    %-18s %9.1f %9.1f %10.5f\n", name, f_ns, q_ns, max_err);
+        TEST_ASSERT_TRUE(max_err < limit);
+    };
+
+    {
+        BasicEMAFilter<float> f(0.3f);
+        BasicEMAFilter<Q16_16> q(0.3f);
+        double f_ns = fx_time_ns([&](float v) { return f.update_value(v); }, tf, of);
+        double q_ns = fx_time_ns([&](Q16_16 v) { return q.update_value(v); }, tq, oq);
+        report("EMA a=0.3 (temp)", f_ns, q_ns, 0.005f);
+    }
+    {
+        BasicMovingAverageFilter<float> f(16);
+        BasicMovingAverageFilter<Q16_16> q(16);
+        double f_ns = fx_time_ns([&](float v) { return f.update_value(v); }, tf, of);
+        double q_ns = fx_time_ns([&](Q16_16 v) { return q.update_value(v); }, tq, oq);
+        report("MA w=16 (temp)", f_ns, q_ns, 0.005f);
+    }
+    {
+        BasicMedianFilter<float> f(31);
+        BasicMedianFilter<Q16_16> q(31);
+        double f_ns = fx_time_ns([&](float v) { return f.update_value(v); }, pf, of);
+        double q_ns = fx_time_ns([&](Q16_16 v) { return q.update_value(v); }, pq, oq);
+        report("median w=31 (bar)", f_ns, q_ns, 0.002f);
+    }
+    {
+        BasicPIDController<float> f(2.0f, 0.1f, 1.0f);
+        BasicPIDController<Q16_16> q(2.0f, 0.1f, 1.0f);
+        f.set_derivative_filter(5.0f);
+        q.set_derivative_filter(5.0f);
+        const float sp = 16.0f, dt = 1.0f;
+        const Q16_16 sp_q(sp), dt_q(dt);
+        double f_ns = fx_time_ns([&](float v) { return f.compute_value(sp, v, dt); }, tf, of);
+        double q_ns = fx_time_ns([&](Q16_16 v) { return q.compute_value(sp_q, v, dt_q); }, tq, oq);
+        report("PID (temp)", f_ns, q_ns, 0.1f);   // % output
+    }
+}
+
 // PID Autotuner tests
 
 void test_autotuner_start() {
@@ -453,6 +938,1242 @@ void test_4to20ma_boundary_max() {
     TEST_ASSERT_EQUAL(SensorQuality::GOOD, sensor->quality);
 }
 
+// Non-blocking poll engine tests
+
+/**
+ * MODBUS stub whose transactions take bus time
+ * Advances simulated time per transaction like a real RS-485 round trip
+ */
+class SlowModbus : public hal::simulator::SimulatorModbus {
+public:
+    SlowModbus(hal::simulator::SimulatorTime* time, uint32_t latency_ms)
+        : time_(time), latency_ms_(latency_ms) {}
+
+    bool read_holding_registers(uint8_t slave_addr, uint16_t start_reg,
+                                uint16_t count, uint16_t* data) override {
+        time_->advance_millis(latency_ms_);
+        return SimulatorModbus::read_holding_registers(slave_addr, start_reg, count, data);
+    }
+
+private:
+    hal::simulator::SimulatorTime* time_;
+    uint32_t latency_ms_;
+};
+
+static void setup_poll_config(SystemConfig& config) {
+    config.hardware.modbus_device_count = 1;
+    auto& dev = config.hardware.modbus_devices[0];
+    dev.address = 1;
+    strcpy(dev.type, "pt1000_8ch");
+    strcpy(dev.name, "Test PT1000");
+    dev.register_count = 2;
+
+    strcpy(dev.registers[0].name, "poll_temp_1");
+    dev.registers[0].reg = 0;
+    dev.registers[0].scale = 0.1f;
+    dev.registers[0].filter = FilterType::NONE;
+
+    strcpy(dev.registers[1].name, "poll_temp_2");
+    dev.registers[1].reg = 1;
+    dev.registers[1].scale = 0.1f;
+    dev.registers[1].filter = FilterType::NONE;
+    dev.registers[1].extra_samples_per_second = 2;
+}
+
+void test_poll_runs_only_due_transactions() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    EventBus events;
+    SystemConfig config;
+    setup_poll_config(config);
+
+    state.register_sensor("poll_temp_1", "°C", 0.1f);
+    state.register_sensor("poll_temp_2", "°C", 0.1f);
+    modbus.set_register(1, 0, 185);
+
+    ModbusModule module(&modbus, &time, &state, &events);
+    module.initialize(config);
+
+    // t=0: only the first base bulk read is due
+    TEST_ASSERT_EQUAL(1, module.poll());
+    TEST_ASSERT_EQUAL(0, time.millis());  // Never sleeps
+    TEST_ASSERT_TRUE(module.is_cycle_active());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 18.5f, module.get_sensor_value("poll_temp_1"));
+
+    // Step through the cycle at a 100ms tick
+    uint32_t executed = 1;
+    for (int tick = 1; tick < 10; tick++) {
+        time.advance_millis(100);
+        executed += module.poll();
+    }
+    TEST_ASSERT_EQUAL(module.get_transaction_count(), executed);
+    TEST_ASSERT_FALSE(module.is_cycle_active());
+
+    const PollStats& stats = module.get_poll_stats();
+    TEST_ASSERT_EQUAL(1, stats.cycles);
+    TEST_ASSERT_EQUAL(0, stats.overruns);
+    TEST_ASSERT_EQUAL(0, stats.max_call_ms);
+    TEST_ASSERT_LESS_THAN(100, stats.max_jitter_ms);
+
+    // Next cycle waits for the 1000ms grid point
+    TEST_ASSERT_EQUAL(0, module.poll());
+    time.advance_millis(100);
+    TEST_ASSERT_EQUAL(1, module.poll());
+}
+
+void test_poll_fills_base_and_extra_rings() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    EventBus events;
+    SystemConfig config;
+    setup_poll_config(config);
+
+    state.register_sensor("poll_temp_1", "°C", 0.1f);
+    state.register_sensor("poll_temp_2", "°C", 0.1f);
+    modbus.set_register(1, 0, 185);
+    modbus.set_register(1, 1, 0);   // A real 0.0 °C reading
+
+    ModbusModule module(&modbus, &time, &state, &events);
+    module.initialize(config);
+
+    for (int tick = 0; tick < 10; tick++) {
+        module.poll();
+        time.advance_millis(100);
+    }
+
+    // Base reads land in the base ring, priority extras in the extra ring
+    auto* s1 = state.get_sensor_by_id(0);
+    auto* s2 = state.get_sensor_by_id(1);
+    TEST_ASSERT_EQUAL(config.scheduler.base_samples_per_cycle, s1->base_samples.count());
+    TEST_ASSERT_EQUAL(0, s1->extra_samples.count());
+    TEST_ASSERT_EQUAL(config.scheduler.base_samples_per_cycle, s2->base_samples.count());
+    TEST_ASSERT_EQUAL(2, s2->extra_samples.count());
+
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 18.5f, s1->base_average);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, s2->base_average);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, s2->extra_average);
+    TEST_ASSERT_EQUAL(SensorQuality::GOOD, s2->quality);
+}
+
+void test_modbus_dual_rate_filter_and_heap_free_reinit() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    EventBus events;
+    SystemConfig config;
+    setup_poll_config(config);
+    config.hardware.modbus_devices[0].registers[1].filter = FilterType::DUAL_RATE;
+    config.hardware.modbus_devices[0].registers[1].filter_alpha = 0.5f;
+
+    state.register_sensor("poll_temp_1", "°C", 0.1f);
+    state.register_sensor("poll_temp_2", "°C", 0.1f);
+    modbus.set_register(1, 1, 200);
+
+    ModbusModule module(&modbus, &time, &state, &events);
+    module.initialize(config);
+
+    size_t before = g_heap_allocs;
+    module.initialize(config);
+    TEST_ASSERT_EQUAL(0, g_heap_allocs - before);
+    TEST_ASSERT_EQUAL(FilterType::DUAL_RATE, module.get_filters().get_type(1));
+
+    // Base reads feed the base EMA, priority extras the extra EMA
+    for (int tick = 0; tick < 10; tick++) {
+        module.poll();
+        time.advance_millis(100);
+    }
+    auto* dual = static_cast<const DualRateFilter*>(module.get_filters().get(1));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f, dual->get_base_value());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f, dual->get_extra_value());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f, module.get_sensor_value("poll_temp_2"));
+}
+
+void test_poll_budget_and_overrun() {
+    hal::simulator::SimulatorTime time;
+    SlowModbus modbus(&time, 400);
+    StateManager state;
+    EventBus events;
+    SystemConfig config;
+    setup_poll_config(config);
+
+    state.register_sensor("poll_temp_1", "°C", 0.1f);
+    state.register_sensor("poll_temp_2", "°C", 0.1f);
+
+    ModbusModule module(&modbus, &time, &state, &events);
+    module.initialize(config);
+
+    // Everything is due, but the budget stops after one slow transaction
+    time.set_millis(999);
+    TEST_ASSERT_EQUAL(1, module.poll(50));
+
+    while (module.is_cycle_active()) {
+        module.poll(50);
+    }
+
+    const PollStats& stats = module.get_poll_stats();
+    TEST_ASSERT_EQUAL(1, stats.cycles);
+    TEST_ASSERT_EQUAL(1, stats.overruns);
+    TEST_ASSERT_EQUAL(400, stats.max_call_ms);
+    TEST_ASSERT_GREATER_THAN(400, stats.max_jitter_ms);
+}
+
+void test_poll_cycle_blocking_stats() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    EventBus events;
+    SystemConfig config;
+    setup_poll_config(config);
+
+    state.register_sensor("poll_temp_1", "°C", 0.1f);
+    state.register_sensor("poll_temp_2", "°C", 0.1f);
+
+    ModbusModule module(&modbus, &time, &state, &events);
+    module.initialize(config);
+
+    module.poll_cycle();
+
+    // Blocking design holds the caller until the last scheduled transaction
+    const PollStats& stats = module.get_poll_stats();
+    TEST_ASSERT_EQUAL(1, stats.cycles);
+    TEST_ASSERT_EQUAL(module.get_transaction_count(), stats.transactions);
+    TEST_ASSERT_GREATER_THAN(500, stats.max_call_ms);
+}
+
+// Register planner tests
+
+static void add_plan_register(ModbusDeviceDef& dev, const char* name, uint16_t reg) {
+    auto& r = dev.registers[dev.register_count++];
+    strcpy(r.name, name);
+    r.reg = reg;
+    r.scale = 0.1f;
+    r.filter = FilterType::NONE;
+}
+
+static void setup_plan_device(SystemConfig& config, uint8_t address) {
+    auto& dev = config.hardware.modbus_devices[config.hardware.modbus_device_count++];
+    dev.address = address;
+    strcpy(dev.type, "analog_8ch");
+    strcpy(dev.name, "Plan Test");
+    dev.register_count = 0;
+}
+
+void test_modbus_module_filters_every_median_sensor() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    SystemConfig config;
+    config.sensor_timing.window_size = 5;
+
+    // 2 x 16 MEDIAN registers: MAX_SENSORS filters of the largest kind
+    for (uint8_t d = 0; d < 2; d++) {
+        setup_plan_device(config, d + 1);
+        auto& dev = config.hardware.modbus_devices[d];
+        for (uint16_t r = 0; r < 16; r++) {
+            char name[16];
+            snprintf(name, sizeof(name), "median_%u_%u", d, r);
+            add_plan_register(dev, name, r);
+            dev.registers[r].filter = FilterType::MEDIAN;
+        }
+    }
+
+    ModbusModule module(&modbus, &time, &state, nullptr);
+    TEST_ASSERT_TRUE(module.initialize(config));
+    TEST_ASSERT_EQUAL(MAX_SENSORS, module.get_filters().size());
+    for (uint8_t i = 0; i < MAX_SENSORS; i++) {
+        TEST_ASSERT_EQUAL(FilterType::MEDIAN, module.get_filters().get_type(i));
+        TEST_ASSERT_NOT_NULL(module.get_filters().get(i));
+    }
+}
+
+void test_planner_splits_sparse_registers() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    SystemConfig config;
+    config.scheduler.base_samples_per_cycle = 1;
+
+    setup_plan_device(config, 1);
+    auto& dev = config.hardware.modbus_devices[0];
+    add_plan_register(dev, "sparse_a", 0);
+    add_plan_register(dev, "sparse_b", 1);
+    add_plan_register(dev, "sparse_c", 100);
+    add_plan_register(dev, "sparse_d", 101);
+
+    ModbusModule module(&modbus, &time, &state, nullptr);
+    module.initialize(config);
+
+    // Reading 98 unused registers costs more than a second frame
+    TEST_ASSERT_EQUAL(2, module.get_transaction_count());
+    TEST_ASSERT_EQUAL(0, module.get_transaction(0)->start_reg);
+    TEST_ASSERT_EQUAL(2, module.get_transaction(0)->count);
+    TEST_ASSERT_EQUAL(100, module.get_transaction(1)->start_reg);
+    TEST_ASSERT_EQUAL(2, module.get_transaction(1)->count);
+    TEST_ASSERT_EQUAL(4, module.get_bus_plan().registers_read);
+}
+
+void test_planner_merges_small_gaps() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    SystemConfig config;
+    config.scheduler.base_samples_per_cycle = 1;
+
+    setup_plan_device(config, 1);
+    auto& dev = config.hardware.modbus_devices[0];
+    add_plan_register(dev, "gap_a", 3);
+    add_plan_register(dev, "gap_b", 0);   // Unsorted on purpose
+
+    ModbusModule module(&modbus, &time, &state, nullptr);
+    module.initialize(config);
+
+    // Two unused registers are cheaper than a second frame overhead
+    TEST_ASSERT_EQUAL(1, module.get_transaction_count());
+    TEST_ASSERT_EQUAL(0, module.get_transaction(0)->start_reg);
+    TEST_ASSERT_EQUAL(4, module.get_transaction(0)->count);
+
+    const BusPlan& plan = module.get_bus_plan();
+    TEST_ASSERT_EQUAL(4, plan.registers_read);
+    TEST_ASSERT_EQUAL(2, plan.registers_used);
+    TEST_ASSERT_EQUAL(module.estimate_read_us(4), plan.bus_us_per_cycle);
+}
+
+void test_planner_reads_all_registers_past_16() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    SystemConfig config;
+    config.scheduler.base_samples_per_cycle = 1;
+
+    // Two device definitions on the same address: 20 registers in one block
+    char names[20][16];
+    for (uint8_t d = 0; d < 2; d++) {
+        setup_plan_device(config, 5);
+        for (uint8_t r = 0; r < 10; r++) {
+            uint8_t reg = d * 10 + r;
+            snprintf(names[reg], sizeof(names[reg]), "wide_%u", reg);
+            add_plan_register(config.hardware.modbus_devices[d], names[reg], reg);
+            state.register_sensor(names[reg], "°C", 0.1f);
+            modbus.set_register(5, reg, 100 + reg);
+        }
+    }
+
+    ModbusModule module(&modbus, &time, &state, nullptr);
+    module.initialize(config);
+    module.poll_cycle();
+
+    // Nothing is dropped: the last register is read and converted
+    TEST_ASSERT_EQUAL(20, module.get_bus_plan().registers_used);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 11.9f, module.get_sensor_value("wide_19"));
+    TEST_ASSERT_EQUAL(SensorQuality::GOOD, module.get_sensor_quality("wide_19"));
+}
+
+void test_planner_single_reads_when_bulk_disabled() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    SystemConfig config;
+    config.scheduler.base_samples_per_cycle = 2;
+    config.scheduler.bulk_read_enabled = false;
+
+    setup_plan_device(config, 1);
+    auto& dev = config.hardware.modbus_devices[0];
+    add_plan_register(dev, "single_a", 0);
+    add_plan_register(dev, "single_b", 1);
+    add_plan_register(dev, "single_c", 2);
+
+    ModbusModule module(&modbus, &time, &state, nullptr);
+    module.initialize(config);
+
+    const BusPlan& plan = module.get_bus_plan();
+    TEST_ASSERT_EQUAL(3, plan.spans_per_sample);
+    TEST_ASSERT_EQUAL(6, module.get_transaction_count());
+
+    // Back-to-back reads are spaced by their planned bus time
+    uint32_t slot_ms = (module.estimate_read_us(1) + 999) / 1000;
+    TEST_ASSERT_EQUAL(slot_ms, module.get_transaction(1)->time_ms);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 6 * module.estimate_read_us(1) / 10000.0f, plan.occupancy_pct);
+}
+
+// EDF poll scheduler tests
+
+static void setup_edf_config(SystemConfig& config) {
+    setup_plan_device(config, 1);
+    auto& temps = config.hardware.modbus_devices[0];
+    add_plan_register(temps, "edf_glycol", 0);
+    add_plan_register(temps, "edf_temp", 1);
+    temps.registers[1].priority = SensorPriority::HIGH;
+    temps.registers[1].extra_samples_per_second = 5;
+
+    setup_plan_device(config, 2);
+    auto& analog = config.hardware.modbus_devices[1];
+    add_plan_register(analog, "edf_pressure_1", 0);
+    add_plan_register(analog, "edf_pressure_2", 1);
+    for (uint8_t r = 0; r < 2; r++) {
+        analog.registers[r].priority = SensorPriority::CRITICAL;
+        analog.registers[r].extra_samples_per_second = 10;
+    }
+}
+
+void test_edf_schedule_is_ordered_and_fits_cycle() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    SystemConfig config;
+    setup_edf_config(config);
+
+    ModbusModule module(&modbus, &time, &state, nullptr);
+    TEST_ASSERT_TRUE(module.initialize(config));
+    TEST_ASSERT_EQUAL_STRING("", module.get_schedule_error());
+
+    // 2 spans x 3 base samples + 5 + 10 + 10 extras
+    TEST_ASSERT_EQUAL(31, module.get_transaction_count());
+
+    // Transactions never overlap on the bus and stay inside the cycle
+    for (uint8_t i = 1; i < module.get_transaction_count(); i++) {
+        const auto* prev = module.get_transaction(i - 1);
+        const auto* cur = module.get_transaction(i);
+        TEST_ASSERT_TRUE(cur->time_ms * 1000 >= prev->time_ms * 1000 + prev->cost_us);
+        TEST_ASSERT_LESS_THAN(config.scheduler.base_cycle_ms, cur->time_ms);
+    }
+}
+
+void test_edf_critical_latency_bounded() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    SystemConfig config;
+    setup_edf_config(config);
+
+    state.register_sensor("edf_glycol", "°C", 0.1f);
+    state.register_sensor("edf_temp", "°C", 0.1f);
+    state.register_sensor("edf_pressure_1", "bar", 0.01f);
+    state.register_sensor("edf_pressure_2", "bar", 0.01f);
+
+    ModbusModule module(&modbus, &time, &state, nullptr);
+    TEST_ASSERT_TRUE(module.initialize(config));
+
+    // 10 extras/s: period 100 ms, must start within 25 ms of release
+    const BusPlan& plan = module.get_bus_plan();
+    uint8_t critical = static_cast<uint8_t>(SensorPriority::CRITICAL);
+    uint8_t high = static_cast<uint8_t>(SensorPriority::HIGH);
+    TEST_ASSERT_LESS_OR_EQUAL(125, plan.max_gap_ms[critical]);
+    TEST_ASSERT_LESS_OR_EQUAL(300, plan.max_gap_ms[high]);
+
+    // Run three cycles at a 1 ms tick and measure real sample gaps
+    for (int tick = 0; tick < 3000; tick++) {
+        module.poll();
+        time.advance_millis(1);
+    }
+
+    const PollStats& stats = module.get_poll_stats();
+    TEST_ASSERT_EQUAL(0, stats.overruns);
+    TEST_ASSERT_GREATER_THAN(0, stats.max_sample_gap_ms[critical]);
+    TEST_ASSERT_LESS_OR_EQUAL(plan.max_gap_ms[critical], stats.max_sample_gap_ms[critical]);
+}
+
+static uint8_t count_base_reads(const ModbusModule& module) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < module.get_transaction_count(); i++) {
+        if (!module.get_transaction(i)->is_extra) count++;
+    }
+    return count;
+}
+
+void test_edf_thins_extras_when_oversubscribed() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    SystemConfig config;
+    setup_edf_config(config);
+    config.scheduler.transaction_time_ms = 40;  // Slow bus
+
+    ModbusModule module(&modbus, &time, &state, nullptr);
+    TEST_ASSERT_TRUE(module.initialize(config));
+    TEST_ASSERT_TRUE(strstr(module.get_schedule_error(), "extra samples per cycle") != nullptr);
+
+    // Base reads kept, the HIGH sensor thinned before the CRITICAL ones
+    TEST_ASSERT_EQUAL(6, count_base_reads(module));
+    TEST_ASSERT_TRUE(strstr(module.get_schedule_error(), "'edf_temp' thinned first") != nullptr);
+    TEST_ASSERT_LESS_THAN(31, module.get_transaction_count());
+    const auto* last = module.get_transaction(module.get_transaction_count() - 1);
+    TEST_ASSERT_LESS_THAN(config.scheduler.base_cycle_ms, last->time_ms);
+}
+
+void test_edf_thins_extras_on_deadline_miss() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    SystemConfig config;
+    setup_edf_config(config);
+    config.scheduler.transaction_time_ms = 10;
+
+    // Bus is only ~60% loaded, but eight critical sensors released together
+    // cannot all start within their windows (25 ms at 10/s, 62 ms at 4/s)
+    auto& analog = config.hardware.modbus_devices[1];
+    char names[6][16];
+    for (uint8_t r = 0; r < 6; r++) {
+        snprintf(names[r], sizeof(names[r]), "edf_extra_%u", r);
+        add_plan_register(analog, names[r], 2 + r);
+        analog.registers[2 + r].priority = SensorPriority::CRITICAL;
+        analog.registers[2 + r].extra_samples_per_second = 4;
+    }
+
+    ModbusModule module(&modbus, &time, &state, nullptr);
+    TEST_ASSERT_TRUE(module.initialize(config));
+    TEST_ASSERT_TRUE(strstr(module.get_schedule_error(), "'edf_temp' thinned first") != nullptr);
+    TEST_ASSERT_EQUAL(6, count_base_reads(module));
+    TEST_ASSERT_GREATER_THAN(6, module.get_transaction_count());  // Some extras survive
+}
+
+void test_edf_keeps_base_reads_when_bus_too_slow() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    SystemConfig config;
+    setup_edf_config(config);
+    config.scheduler.transaction_time_ms = 200;  // 6 base reads alone exceed the cycle
+
+    ModbusModule module(&modbus, &time, &state, nullptr);
+    TEST_ASSERT_TRUE(module.initialize(config));
+    TEST_ASSERT_TRUE(strstr(module.get_schedule_error(), "base reads start up to") != nullptr);
+    TEST_ASSERT_EQUAL(6, module.get_transaction_count());
+    TEST_ASSERT_EQUAL(6, count_base_reads(module));
+}
+
+void test_edf_reports_min_sample_spacing() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    SystemConfig config;
+    setup_edf_config(config);
+    config.scheduler.base_samples_per_cycle = 20;  // Every 50 ms
+    config.scheduler.min_sample_spacing_ms = 100;
+
+    ModbusModule module(&modbus, &time, &state, nullptr);
+    TEST_ASSERT_TRUE(module.initialize(config));
+    TEST_ASSERT_TRUE(strstr(module.get_schedule_error(), "min_sample_spacing_ms") != nullptr);
+    TEST_ASSERT_EQUAL(40, count_base_reads(module));
+}
+
+void test_edf_no_extras_without_fill_idle_windows() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    SystemConfig config;
+    setup_edf_config(config);
+    config.scheduler.fill_idle_windows = false;
+
+    ModbusModule module(&modbus, &time, &state, nullptr);
+    TEST_ASSERT_TRUE(module.initialize(config));
+    TEST_ASSERT_EQUAL(6, module.get_transaction_count());  // Base reads only
+}
+
+// Batch ingest tests
+
+static void setup_batch_config(SystemConfig& config, StateManager& state,
+                               hal::simulator::SimulatorModbus& modbus) {
+    ConfigLoader::load_defaults(config);
+    config.hardware.modbus_device_count = 2;
+    char name[32];
+    for (uint8_t d = 0; d < 2; d++) {
+        auto& dev = config.hardware.modbus_devices[d];
+        dev.address = d + 1;
+        snprintf(dev.name, sizeof(dev.name), "Batch %u", d);
+        strcpy(dev.type, "pt1000_16ch");
+        dev.register_count = 16;
+        for (uint8_t r = 0; r < 16; r++) {
+            snprintf(name, sizeof(name), "batch_%u_%u", d, r);
+            strcpy(dev.registers[r].name, name);
+            dev.registers[r].reg = r;
+            dev.registers[r].scale = 0.1f;
+            dev.registers[r].filter = FilterType::NONE;
+            state.register_sensor(name, "°C", 0.1f);
+            modbus.set_register(d + 1, r, 100 + d * 16 + r);
+        }
+    }
+}
+
+static void count_batch(const Event& e, void* ctx) {
+    uint32_t* stats = static_cast<uint32_t*>(ctx);
+    stats[0]++;
+    stats[1] |= e.data.mask;
+}
+
+void test_modbus_batch_ingest_one_lock_per_transaction() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorModbus modbus;
+    StateManager state;
+    EventBus events;
+    SystemConfig config;
+    setup_batch_config(config, state, modbus);
+
+    uint32_t batch_stats[2] = {0, 0};  // events, union of masks
+    events.subscribe(EventType::SENSORS_UPDATED, count_batch, batch_stats);
+
+    ModbusModule module(&modbus, &time, &state, &events);
+    TEST_ASSERT_TRUE(module.initialize(config));
+
+    state.reset_lock_stats();
+    uint16_t transactions = module.poll();
+    TEST_ASSERT_TRUE(transactions > 0);
+
+    // One lock and one event per transaction, each covering a whole device
+    TEST_ASSERT_EQUAL_UINT32(transactions, state.get_lock_stats().acquisitions);
+    TEST_ASSERT_EQUAL_UINT32(transactions, batch_stats[0]);
+    TEST_ASSERT_TRUE(batch_stats[1] == 0x0000FFFFu || batch_stats[1] == 0xFFFFFFFFu);
+
+    auto* sensor = state.get_sensor("batch_0_5");
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 10.5f, sensor->raw_value);
+    TEST_ASSERT_EQUAL(SensorQuality::GOOD, sensor->quality);
+
+    // Bus failure: quality-only batch, still one lock, no update event
+    modbus.set_inject_error(true);
+    state.reset_lock_stats();
+    batch_stats[0] = 0;
+    time.advance_millis(config.scheduler.base_cycle_ms);
+    transactions = module.poll();
+    TEST_ASSERT_TRUE(transactions > 0);
+    TEST_ASSERT_EQUAL_UINT32(transactions, state.get_lock_stats().acquisitions);
+    TEST_ASSERT_EQUAL_UINT32(0, batch_stats[0]);
+    TEST_ASSERT_EQUAL(SensorQuality::BAD, state.get_sensor("batch_1_15")->quality);
+}
+
+void test_modbus_batch_ingest_benchmark() {
+    const int CYCLES = 2000;
+    StateManager state;
+    hal::simulator::SimulatorModbus modbus;
+    SystemConfig config;
+    setup_batch_config(config, state, modbus);
+
+    // Two 16-register bulk reads, as ModbusModule decodes them
+    SensorSample batch[2][16];
+    for (uint8_t d = 0; d < 2; d++) {
+        for (uint8_t r = 0; r < 16; r++) {
+            SensorSample& s = batch[d][r];
+            s.sensor_id = d * 16 + r;
+            s.has_value = true;
+            s.raw_value = s.filtered_value = s.display_value = 18.0f + r * 0.1f;
+            s.quality = SensorQuality::GOOD;
+            s.is_extra = false;
+        }
+    }
+
+    using clock = std::chrono::steady_clock;
+
+    // Before: three locked setters per sensor
+    state.reset_lock_stats();
+    auto t0 = clock::now();
+    for (int c = 0; c < CYCLES; c++) {
+        for (uint8_t d = 0; d < 2; d++) {
+            for (uint8_t r = 0; r < 16; r++) {
+                const SensorSample& s = batch[d][r];
+                state.update_sensor_value(s.sensor_id, s.raw_value, c);
+                state.update_sensor_filtered(s.sensor_id, s.filtered_value, s.display_value);
+                state.set_sensor_quality(s.sensor_id, s.quality);
+            }
+        }
+    }
+    auto t1 = clock::now();
+    uint32_t legacy_locks = state.get_lock_stats().acquisitions / CYCLES;
+
+    // After: one batch per transaction
+    state.reset_lock_stats();
+    uint32_t mask = 0;
+    auto t2 = clock::now();
+    for (int c = 0; c < CYCLES; c++) {
+        mask = state.ingest_sensor_batch(batch[0], 16, c);
+        mask |= state.ingest_sensor_batch(batch[1], 16, c);
+    }
+    auto t3 = clock::now();
+    uint32_t batch_locks = state.get_lock_stats().acquisitions / CYCLES;
+
+    double legacy_us = std::chrono::duration<double, std::micro>(t1 - t0).count() / CYCLES;
+    double batch_us = std::chrono::duration<double, std::micro>(t3 - t2).count() / CYCLES;
+
+    printf("\n  Sensor ingest, 32 sensors in 2 transactions, %d cycles\n", CYCLES);
+    printf("    per-sensor setters: %3lu locks/cycle, %7.2f us/cycle\n",
+           (unsigned long)legacy_locks, legacy_us);
+    printf("    batch ingest:       %3lu locks/cycle, %7.2f us/cycle (%.1fx)\n",
+           (unsigned long)batch_locks, batch_us, legacy_us / batch_us);
+
+    TEST_ASSERT_EQUAL_UINT32(96, legacy_locks);
+    TEST_ASSERT_EQUAL_UINT32(2, batch_locks);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFFu, mask);
+    TEST_ASSERT_EQUAL_FLOAT(19.5f, state.get_sensor_by_id(31)->filtered_value);
+}
+
+// Time-proportional output tests
+
+// Run the driver for `ms` at 100 ms ticks; returns ON time observed
+static uint32_t run_output(TimeProportionalOutput& out, StateManager& state,
+                           uint8_t relay, uint32_t& now, uint32_t ms) {
+    uint32_t on_ms = 0;
+    for (uint32_t t = 0; t < ms; t += 100) {
+        out.update(now);
+        if (state.get_relay_by_id(relay)->state) on_ms += 100;
+        now += 100;
+    }
+    return on_ms;
+}
+
+void test_time_proportional_window() {
+    StateManager state;
+    state.register_relay("tp_ssr", RelayType::SSR);
+    TimeProportionalOutput out(&state);
+    out.configure(60000, 100);
+
+    uint32_t now = 1000;
+    out.set_duty(0, 30.0f);
+    TEST_ASSERT_EQUAL_FLOAT(30.0f, state.get_relay_by_id(0)->duty_cycle);
+
+    // 30% of 60 s = 18 s ON, then 42 s OFF
+    TEST_ASSERT_EQUAL(18000, run_output(out, state, 0, now, 60000));
+    TEST_ASSERT_EQUAL(18000, out.get_on_time_ms(0));
+    TEST_ASSERT_EQUAL(2, out.get_switch_count(0));
+    TEST_ASSERT_EQUAL(18000, run_output(out, state, 0, now, 60000));
+
+    // Edge lands on the tick that ends the ON time
+    out.update(now + 17900);
+    TEST_ASSERT_TRUE(state.get_relay_by_id(0)->state);
+    out.update(now + 18000);
+    TEST_ASSERT_FALSE(state.get_relay_by_id(0)->state);
+}
+
+void test_time_proportional_min_on_carries_demand() {
+    StateManager state;
+    state.register_relay("tp_valve", RelayType::SOLENOID_NC);
+    TimeProportionalOutput out(&state);
+    out.configure(60000, 100);
+
+    // 5% = 3 s per window, below the 10 s solenoid minimum
+    uint32_t now = 0;
+    out.set_duty(0, 5.0f);
+    uint32_t on_ms = run_output(out, state, 0, now, 20 * 60000);
+
+    // Average is kept (5% of 20 min = 60 s) without any pulse < 10 s
+    TEST_ASSERT_UINT32_WITHIN(10000, 60000, on_ms);
+    uint32_t on_edges = (out.get_switch_count(0) + 1) / 2;
+    TEST_ASSERT_TRUE(on_edges >= 5 && on_edges <= 7);
+    TEST_ASSERT_TRUE(on_ms / on_edges >= 10000);
+}
+
+void test_time_proportional_min_off_and_saturation() {
+    StateManager state;
+    state.register_relay("tp_valve", RelayType::SOLENOID_NC);
+    TimeProportionalOutput out(&state);
+    out.configure(60000, 100);
+
+    // 95% leaves a 3 s gap, below the 10 s minimum OFF time
+    uint32_t now = 0;
+    out.set_duty(0, 95.0f);
+    uint32_t on_ms = run_output(out, state, 0, now, 10 * 60000);
+    // Short gaps are merged: ~1 OFF period every 3 windows instead of 10
+    TEST_ASSERT_UINT32_WITHIN(20000, 570000, on_ms);
+    TEST_ASSERT_TRUE(out.get_switch_count(0) <= 8);
+
+    // 100% holds the relay ON continuously
+    out.set_duty(0, 100.0f);
+    run_output(out, state, 0, now, 60000);
+    uint32_t edges = out.get_switch_count(0);
+    TEST_ASSERT_EQUAL(60000, run_output(out, state, 0, now, 60000));
+    TEST_ASSERT_EQUAL(edges, out.get_switch_count(0));
+}
+
+void test_time_proportional_force_off() {
+    StateManager state;
+    state.register_relay("tp_valve", RelayType::SOLENOID_NC);
+    TimeProportionalOutput out(&state);
+    out.configure(60000, 100);
+
+    uint32_t now = 0;
+    out.set_duty(0, 50.0f);
+    run_output(out, state, 0, now, 1000);
+    TEST_ASSERT_TRUE(state.get_relay_by_id(0)->state);
+
+    // Safety path ignores the minimum ON time
+    out.force_off(0, now);
+    TEST_ASSERT_FALSE(state.get_relay_by_id(0)->state);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, state.get_relay_by_id(0)->duty_cycle);
+
+    // Demand returns, but the valve rests for its minimum OFF time first
+    out.set_duty(0, 50.0f);
+    out.update(now + 5000);
+    TEST_ASSERT_FALSE(state.get_relay_by_id(0)->state);
+    out.update(now + 10000);
+    TEST_ASSERT_TRUE(state.get_relay_by_id(0)->state);
+
+    // Released relays are left alone
+    out.release(0);
+    state.set_relay_state(0, false, now);
+    out.update(now + 11000);
+    TEST_ASSERT_FALSE(state.get_relay_by_id(0)->state);
+}
+
+void test_time_proportional_force_off_idempotent() {
+    StateManager state;
+    state.register_relay("tp_valve", RelayType::SOLENOID_NC);
+    TimeProportionalOutput out(&state);
+    out.configure(60000, 100);
+
+    uint32_t now = 0;
+    out.set_duty(0, 50.0f);
+    run_output(out, state, 0, now, 1000);
+    out.force_off(0, now);
+    TEST_ASSERT_FALSE(state.get_relay_by_id(0)->state);
+
+    // Control loop keeps forcing while the sensor is bad: no state writes
+    uint32_t generation = state.get_generation();
+    for (uint32_t t = 100; t <= 4000; t += 100) {
+        out.force_off(0, now + t);
+    }
+    TEST_ASSERT_EQUAL_UINT32(generation, state.get_generation());
+
+    // Minimum OFF time still counts from the real switch-off
+    out.set_duty(0, 50.0f);
+    out.update(now + 10000);
+    TEST_ASSERT_TRUE(state.get_relay_by_id(0)->state);
+}
+
+// History log tests
+
+struct LoggedRecords {
+    uint32_t boots = 0;
+    uint32_t names = 0;
+    uint32_t snapshots = 0;
+    uint32_t relay_changes = 0;
+    uint32_t plan_steps = 0;
+    uint32_t last_timestamp = 0;
+    bool ordered = true;
+    float last_value = 0.0f;
+};
+
+static LoggedRecords read_history(HistoryLog& log) {
+    LoggedRecords r;
+    log.read_records([&r](uint8_t type, uint32_t ts, const uint8_t* data, uint8_t len) {
+        if (ts < r.last_timestamp) r.ordered = false;
+        r.last_timestamp = ts;
+        switch (type) {
+            case HistoryLog::RECORD_BOOT: r.boots++; break;
+            case HistoryLog::RECORD_NAME: r.names++; break;
+            case HistoryLog::RECORD_SENSORS:
+                r.snapshots++;
+                if (len >= 5) memcpy(&r.last_value, data + 1, sizeof(float));
+                break;
+            case HistoryLog::RECORD_RELAY: r.relay_changes++; break;
+            case HistoryLog::RECORD_PLAN_STEP: r.plan_steps++; break;
+        }
+    });
+    return r;
+}
+
+static void setup_history_state(StateManager& state) {
+    state.register_sensor("hist_temp", "C", 0.1f);
+    state.register_sensor("hist_pressure", "bar", 0.01f);
+    state.register_relay("hist_cooling", RelayType::SOLENOID_NC);
+    state.set_sensor_quality(0, SensorQuality::GOOD);
+    state.set_sensor_quality(1, SensorQuality::GOOD);
+}
+
+void test_history_log_batches_into_blocks() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorStorage storage;
+    hal::simulator::SimulatorFlash flash(16 * 4096);
+    StateManager state;
+    SystemConfig config;
+    config.persistence.state_snapshot_interval_ms = 1000;
+    setup_history_state(state);
+    time.set_unix_time(1700000000);
+
+    HistoryLog log(&flash, &storage, &time, &state);
+    TEST_ASSERT_TRUE(log.initialize(config));
+
+    // 20 snapshots of 2 sensors (15 bytes each) plus a relay toggle every 5 s
+    for (int i = 1; i <= 20; i++) {
+        time.advance_millis(1000);
+        time.advance_unix_time(1);
+        state.update_sensor_filtered(0, 18.0f + i, 18.0f);
+        state.set_relay_state(0, (i / 5) % 2 == 1, time.millis());
+        log.update();
+    }
+
+    // Only full blocks reach flash; the remainder is still buffered
+    TEST_ASSERT_EQUAL(1, log.get_stats().blocks_written);
+    TEST_ASSERT_EQUAL(1, log.get_stats().sectors_erased);
+    TEST_ASSERT_TRUE(log.get_pending_bytes() > 0);
+
+    log.flush();
+    LoggedRecords r = read_history(log);
+    TEST_ASSERT_EQUAL(1, r.boots);
+    TEST_ASSERT_EQUAL(3, r.names);
+    TEST_ASSERT_EQUAL(20, r.snapshots);
+    TEST_ASSERT_EQUAL(5, r.relay_changes);      // Initial state + 4 toggles
+    TEST_ASSERT_TRUE(r.ordered);
+    TEST_ASSERT_EQUAL_FLOAT(38.0f, r.last_value);
+}
+
+void test_history_log_recovers_after_reboot() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorStorage storage;
+    hal::simulator::SimulatorFlash flash(16 * 4096);
+    StateManager state;
+    SystemConfig config;
+    config.persistence.state_snapshot_interval_ms = 1000;
+    setup_history_state(state);
+
+    uint32_t head;
+    uint32_t sequence;
+    {
+        HistoryLog log(&flash, &storage, &time, &state);
+        TEST_ASSERT_TRUE(log.initialize(config));
+        for (int i = 0; i < 300; i++) {
+            time.advance_millis(1000);
+            log.update();
+        }
+        log.flush();
+        head = log.get_head();
+        sequence = log.get_sequence();
+        TEST_ASSERT_TRUE(head > 16);    // Spans more than one sector
+    }
+
+    // Reboot: resume from the NVS checkpoint
+    HistoryLog log(&flash, &storage, &time, &state);
+    TEST_ASSERT_TRUE(log.initialize(config));
+    TEST_ASSERT_TRUE(log.get_stats().recovered_from_checkpoint);
+    TEST_ASSERT_EQUAL(head, log.get_head());
+    TEST_ASSERT_EQUAL(sequence, log.get_sequence());
+
+    log.flush();
+    LoggedRecords r = read_history(log);
+    TEST_ASSERT_EQUAL(2, r.boots);
+    TEST_ASSERT_EQUAL(300, r.snapshots);
+
+    // Lost checkpoint: full scan finds the same position
+    storage.reset();
+    HistoryLog rescanned(&flash, &storage, &time, &state);
+    TEST_ASSERT_TRUE(rescanned.initialize(config));
+    TEST_ASSERT_FALSE(rescanned.get_stats().recovered_from_checkpoint);
+    TEST_ASSERT_EQUAL(log.get_head(), rescanned.get_head());
+}
+
+void test_history_log_skips_torn_block() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorStorage storage;
+    hal::simulator::SimulatorFlash flash(16 * 4096);
+    StateManager state;
+    SystemConfig config;
+    config.persistence.state_snapshot_interval_ms = 1000;
+    setup_history_state(state);
+
+    HistoryLog log(&flash, &storage, &time, &state);
+    TEST_ASSERT_TRUE(log.initialize(config));
+    for (int i = 0; i < 40; i++) {
+        time.advance_millis(1000);
+        log.update();
+    }
+    log.flush();
+
+    // Power fails halfway through the next block
+    for (int i = 0; i < 20; i++) {
+        time.advance_millis(1000);
+        log.update();
+    }
+    uint32_t good_sequence = log.get_sequence();
+    uint32_t lost_snapshots = log.get_pending_bytes() / 15;
+    TEST_ASSERT_TRUE(lost_snapshots > 0);
+    flash.fail_after(HistoryLog::HEADER_SIZE + 4);
+    log.flush();
+    flash.restore_power();
+
+    HistoryLog recovered(&flash, &storage, &time, &state);
+    TEST_ASSERT_TRUE(recovered.initialize(config));
+    TEST_ASSERT_EQUAL(good_sequence, recovered.get_sequence());   // Torn block not counted
+    TEST_ASSERT_EQUAL(16, recovered.get_head());                  // Next sector
+
+    recovered.flush();
+    LoggedRecords r = read_history(recovered);
+    TEST_ASSERT_EQUAL(60 - lost_snapshots, r.snapshots);
+}
+
+void test_history_log_wraps_and_levels_wear() {
+    hal::simulator::SimulatorTime time;
+    hal::simulator::SimulatorStorage storage;
+    hal::simulator::SimulatorFlash flash(4 * 4096);
+    StateManager state;
+    SystemConfig config;
+    config.persistence.state_snapshot_interval_ms = 1000;
+    setup_history_state(state);
+    time.set_unix_time(1700000000);
+
+    HistoryLog log(&flash, &storage, &time, &state);
+    TEST_ASSERT_TRUE(log.initialize(config));
+
+    // ~3 laps of a 64-block ring
+    for (int i = 0; i < 3000; i++) {
+        time.advance_millis(1000);
+        time.advance_unix_time(1);
+        log.update();
+    }
+
+    for (size_t s = 0; s < 4; s++) {
+        uint32_t erases = flash.get_erase_count(s);
+        TEST_ASSERT_TRUE(erases >= 2 && erases <= 4);
+    }
+
+    // Oldest data is overwritten, what remains is still in order
+    LoggedRecords r = read_history(log);
+    TEST_ASSERT_TRUE(r.ordered);
+    TEST_ASSERT_EQUAL(0, r.boots);
+    TEST_ASSERT_TRUE(r.snapshots > 900 && r.snapshots < 1100);
+}
+
+// WebSocket broadcast log tests
+
+void test_ws_log_cursors_read_in_order() {
+    WsBroadcastLog<256> log;
+    uint32_t fast = log.head();
+    uint32_t slow = log.head();
+    uint8_t out[64];
+    size_t len = 0;
+    uint8_t flags = 0;
+
+    // Messages straddle the ring end several times
+    char msg[16];
+    for (int i = 0; i < 40; i++) {
+        int n = snprintf(msg, sizeof(msg), "msg-%d", i);
+        TEST_ASSERT_TRUE(log.append(msg, n, i % 2 ? WS_LOG_BINARY : 0));
+        TEST_ASSERT_TRUE(log.read(fast, out, len, flags) == WsLogRead::MESSAGE);
+        TEST_ASSERT_EQUAL(n, len);
+        TEST_ASSERT_EQUAL(0, memcmp(out, msg, n));
+        TEST_ASSERT_EQUAL(i % 2 ? WS_LOG_BINARY : 0, flags);
+        TEST_ASSERT_TRUE(log.read(fast, out, len, flags) == WsLogRead::EMPTY);
+    }
+    TEST_ASSERT_EQUAL(0, log.backlog(fast));
+
+    // The lagging reader was overtaken: it skips to the oldest retained one
+    TEST_ASSERT_EQUAL(0, log.backlog(slow));
+    TEST_ASSERT_TRUE(log.read(slow, out, len, flags) == WsLogRead::OVERRUN);
+    TEST_ASSERT_EQUAL(1, log.overruns());
+    int last = -1;
+    while (log.read(slow, out, len, flags) == WsLogRead::MESSAGE) {
+        out[len] = '\0';
+        last = atoi(reinterpret_cast<char*>(out) + 4);
+    }
+    TEST_ASSERT_EQUAL(39, last);
+
+    TEST_ASSERT_FALSE(log.append(out, WsBroadcastLog<256>::MAX_MESSAGE + 1));
+    TEST_ASSERT_FALSE(log.append(out, 0));
+}
+
+void test_ws_log_publish_cost_independent_of_readers() {
+    // Producer work is one append; readers only cost when they drain
+    WsBroadcastLog<8192> log;
+    uint32_t cursors[16];
+    for (auto& c : cursors) c = log.head();
+
+    const char msg[] = "{\"type\":\"sensor\",\"id\":3,\"value\":20.50,\"quality\":\"GOOD\"}";
+    for (int i = 0; i < 50; i++) {
+        log.append(msg, sizeof(msg) - 1);
+    }
+    TEST_ASSERT_EQUAL(50, log.appended());
+    TEST_ASSERT_EQUAL(50 * (sizeof(msg) - 1 + WsBroadcastLog<8192>::RECORD_HEADER),
+                      log.backlog(cursors[15]));
+
+    // Every reader sees the same 50 messages through its own cursor
+    uint8_t out[WsBroadcastLog<8192>::MAX_MESSAGE];
+    size_t len = 0;
+    uint8_t flags = 0;
+    for (auto& c : cursors) {
+        int count = 0;
+        while (log.read(c, out, len, flags) == WsLogRead::MESSAGE) count++;
+        TEST_ASSERT_EQUAL(50, count);
+    }
+    TEST_ASSERT_EQUAL(0, log.overruns());
+}
+
+// WebSocket delta aggregator tests
+
+void test_ws_delta_deadband_and_relay_toggle() {
+    WsDeltaAggregator agg;
+    agg.set_interval(1000);
+    TEST_ASSERT_EQUAL_FLOAT(0.05f, WsDeltaAggregator::unit_deadband("°C"));
+    TEST_ASSERT_EQUAL_FLOAT(0.005f, WsDeltaAggregator::unit_deadband("bar"));
+    TEST_ASSERT_EQUAL_FLOAT(WsDeltaAggregator::DEFAULT_DEADBAND, WsDeltaAggregator::unit_deadband("rpm"));
+    agg.set_deadband(0, 0.05f);
+
+    // First sample always goes out
+    agg.sensor_sample(0, 20.0f, core::SensorQuality::GOOD);
+    TEST_ASSERT_TRUE(agg.due(1000));
+    TEST_ASSERT_FALSE(agg.due(999));
+    auto batch = agg.flush(1000);
+    TEST_ASSERT_EQUAL_HEX32(0x1, batch.sensors);
+
+    // Noise inside the deadband is not pushed, drift past it is
+    agg.sensor_sample(0, 20.03f, core::SensorQuality::GOOD);
+    agg.sensor_sample(0, 19.97f, core::SensorQuality::GOOD);
+    TEST_ASSERT_FALSE(agg.pending());
+    agg.sensor_sample(0, 20.06f, core::SensorQuality::GOOD);
+    agg.sensor_sample(0, 20.08f, core::SensorQuality::GOOD);
+    TEST_ASSERT_FALSE(agg.due(1500));
+    batch = agg.flush(2000);
+    TEST_ASSERT_EQUAL_HEX32(0x1, batch.sensors);
+    TEST_ASSERT_EQUAL_FLOAT(20.08f, agg.value(0));   // Latest value, not the first
+
+    // Quality change is pushed even without a value change
+    agg.sensor_sample(0, 20.08f, core::SensorQuality::SUSPECT);
+    TEST_ASSERT_TRUE(agg.pending());
+    agg.flush(3000);
+
+    // A relay toggled back within one interval sends nothing
+    agg.relay_change(4, true);
+    TEST_ASSERT_TRUE(agg.pending());
+    agg.relay_change(4, false);
+    TEST_ASSERT_FALSE(agg.pending());
+    agg.relay_change(4, true);
+    batch = agg.flush(4000);
+    TEST_ASSERT_EQUAL_HEX32(0x10, batch.relays);
+    TEST_ASSERT_TRUE(agg.relay(4));
+    TEST_ASSERT_EQUAL(4, agg.frames());
+}
+
+void test_ws_delta_frame_rate_reduction() {
+    // Simulator feed: 32 sensors (EMA-filtered, 0.1 resolution plus noise)
+    // sampled at 5 Hz for 60 s, one SENSORS_UPDATED batch per sample
+    constexpr int SENSORS = 32;
+    constexpr int PERIOD_MS = 200;
+    constexpr int DURATION_MS = 60000;
+    WsDeltaAggregator agg;
+    agg.set_interval(1000);
+    EMAFilter* filters[SENSORS];
+    float legacy_sent[SENSORS];
+    for (int i = 0; i < SENSORS; i++) {
+        filters[i] = new EMAFilter(0.3f);
+        legacy_sent[i] = 0.0f;
+        agg.set_deadband(i, WsDeltaAggregator::unit_deadband(i % 4 == 3 ? "bar" : "°C"));
+    }
+
+    uint32_t seed = 12345;
+    uint32_t legacy_frames = 0;
+    for (int t = 0; t < DURATION_MS; t += PERIOD_MS) {
+        bool changed = false;
+        for (int i = 0; i < SENSORS; i++) {
+            seed = seed * 1103515245u + 12345u;
+            float noise = ((seed >> 16) % 5 - 2) * 0.1f;        // +-2 counts
+            float base = (i % 4 == 3) ? 1.2f : 18.0f + i * 0.1f + t / 600000.0f;
+            float value = filters[i]->update(base + noise * (i % 4 == 3 ? 0.1f : 1.0f));
+
+            // Previous policy: one JSON frame per sample moving >= 0.01
+            if (std::fabs(value - legacy_sent[i]) >= 0.01f) {
+                legacy_sent[i] = value;
+                legacy_frames++;
+                changed = true;
+            }
+            agg.sensor_sample(i, value, core::SensorQuality::GOOD);
+        }
+        if (changed) legacy_frames++;                           // Plus one binary delta
+        if (agg.due(t)) agg.flush(t);
+    }
+    for (auto* f : filters) delete f;
+
+    float seconds = DURATION_MS / 1000.0f;
+    float legacy_fps = legacy_frames / seconds;
+    float batched_fps = agg.frames() / seconds;
+    printf("\n  WebSocket frames per client, %d sensors at %d Hz for %.0f s\n",
+           SENSORS, 1000 / PERIOD_MS, seconds);
+    printf("    per-sample frames:     %7.1f frames/s\n", legacy_fps);
+    printf("    batched + deadband:    %7.1f frames/s (%.0fx fewer)\n",
+           batched_fps, legacy_fps / batched_fps);
+
+    TEST_ASSERT_TRUE(agg.frames() <= DURATION_MS / 1000 + 1);
+    TEST_ASSERT_TRUE(legacy_frames >= 10 * agg.frames());
+}
+
+// WebSocket subscription tests
+
+void test_ws_subscription_parse() {
+    core::StateManager state;
+    state.register_sensor("f1_temp", "°C");
+    state.register_sensor("f1_pressure", "bar");
+    state.register_sensor("f2_temp", "°C");
+    state.register_relay("f1_cooling", core::RelayType::SOLENOID_NC);
+    state.register_relay("f2_cooling", core::RelayType::SOLENOID_NC);
+    core::FermenterDef def = {};
+    def.id = 2;
+    strcpy(def.name, "F2");
+    strcpy(def.temp_sensor, "f2_temp");
+    strcpy(def.cooling_relay, "f2_cooling");   // No pressure sensor/spunding relay
+    TEST_ASSERT_TRUE(state.register_fermenter(def));
+
+    // Default: everything
+    WsSubscription all;
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, all.sensors);
+    TEST_ASSERT_TRUE(all.wants_alarm(8));
+
+    // Fermenter expands to its sensors, relays and alarms
+    auto s = WsSubscription::parse(
+        "{\"type\":\"subscribe\",\"fermenters\":[2],\"sensors\":[0, 5]}", &state);
+    TEST_ASSERT_EQUAL_HEX32((1u << 0) | (1u << 2) | (1u << 5), s.sensors);
+    TEST_ASSERT_EQUAL_HEX32(1u << 1, s.relays);
+    TEST_ASSERT_TRUE(s.wants_alarm(2));
+    TEST_ASSERT_FALSE(s.wants_alarm(1));
+
+    // Event classes; "sensors" as a string is not the sensors key
+    s = WsSubscription::parse("{\"type\":\"subscribe\",\"events\":[\"sensors\",\"alarms\"]}", &state);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, s.sensors);
+    TEST_ASSERT_EQUAL_HEX32(0, s.relays);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, s.fermenters);
+
+    s = WsSubscription::parse("{\"type\": \"subscribe\", \"events\": [\"all\"]}", &state);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, s.relays);
+
+    // Nothing listed: nothing; out-of-range ids are ignored
+    s = WsSubscription::parse("{\"type\":\"subscribe\",\"sensors\":[40],\"fermenters\":[9]}", &state);
+    TEST_ASSERT_EQUAL_HEX32(0, s.sensors | s.relays | s.fermenters);
+}
+
+void test_ws_fanout_skips_unsubscribed_clients() {
+    WsSubscription all;
+    WsSubscription f1 = WsSubscription::none();
+    f1.sensors = 0x3;
+    f1.relays = 0x1;
+    WsSubscription f2 = WsSubscription::none();
+    f2.sensors = 0xC;
+
+    // Batch with sensors 0 and 1 changed: f2 gets nothing
+    WsFanout fanout;
+    TEST_ASSERT_TRUE(fanout.add(0, all, 0x3, 0, false));
+    TEST_ASSERT_TRUE(fanout.add(1, all, 0x3, 0, true));
+    TEST_ASSERT_TRUE(fanout.add(2, f1, 0x3, 0, false));     // Same slice as slot 0
+    TEST_ASSERT_FALSE(fanout.add(3, f2, 0x3, 0, false));
+    TEST_ASSERT_EQUAL(2, fanout.count);
+    TEST_ASSERT_EQUAL_HEX8(0x05, fanout.groups[0].audience);
+    TEST_ASSERT_EQUAL_HEX8(0x02, fanout.groups[1].audience);
+
+    // Queued once per group; readers skip what is not addressed to them
+    WsBroadcastLog<1024> log;
+    uint32_t cursors[4];
+    for (auto& c : cursors) c = log.head();
+    log.append("a", 1, 0, 0x05);
+    log.append("b", 1, WS_LOG_BINARY, 0x02);
+    log.append("c", 1, 0, WS_LOG_EVERYONE);
+
+    uint8_t out[WsBroadcastLog<1024>::MAX_MESSAGE];
+    size_t len = 0;
+    uint8_t flags = 0;
+    const char* expected[4] = {"ac", "bc", "ac", "c"};
+    for (int slot = 0; slot < 4; slot++) {
+        char got[4] = {};
+        int n = 0;
+        while (log.read(cursors[slot], out, len, flags, 1u << slot) == WsLogRead::MESSAGE) {
+            got[n++] = (char)out[0];
+        }
+        TEST_ASSERT_EQUAL_STRING(expected[slot], got);
+        TEST_ASSERT_EQUAL(0, log.backlog(cursors[slot]));
+    }
+}
+
 void test_filter_noise_smoothing() {
     EMAFilter filter(0.3f);
 
@@ -504,10 +2225,14 @@ int main(int argc, char **argv) {
     // Median Filter tests
     RUN_TEST(test_median_filter_basic);
     RUN_TEST(test_median_filter_outlier_rejection);
+    RUN_TEST(test_median_filter_matches_legacy);
+    RUN_TEST(test_median_filter_benchmark);
 
     // Dual Rate Filter tests
     RUN_TEST(test_dual_rate_filter_blend);
     RUN_TEST(test_dual_rate_filter_extra_priority);
+    RUN_TEST(test_filter_bank_matches_filters);
+    RUN_TEST(test_filter_bank_benchmark);
 
     // No Filter tests
     RUN_TEST(test_no_filter_passthrough);
@@ -520,6 +2245,13 @@ int main(int argc, char **argv) {
     RUN_TEST(test_pid_reset);
     RUN_TEST(test_pid_bumpless_transfer);
     RUN_TEST(test_pid_derivative_on_measurement);
+    RUN_TEST(test_pid_dt_invariance);
+    RUN_TEST(test_pid_derivative_filter);
+    RUN_TEST(test_pid_scheduler_intervals_and_stagger);
+    RUN_TEST(test_pid_scheduler_measured_dt);
+    RUN_TEST(test_q16_16_arithmetic);
+    RUN_TEST(test_fixed_point_deterministic_trace);
+    RUN_TEST(test_fixed_point_benchmark);
 
     // Autotuner tests
     RUN_TEST(test_autotuner_start);
@@ -532,6 +2264,56 @@ int main(int argc, char **argv) {
     RUN_TEST(test_4to20ma_boundary_min);
     RUN_TEST(test_4to20ma_boundary_max);
 
+    // Non-blocking poll engine tests
+    RUN_TEST(test_poll_runs_only_due_transactions);
+    RUN_TEST(test_poll_fills_base_and_extra_rings);
+    RUN_TEST(test_modbus_dual_rate_filter_and_heap_free_reinit);
+    RUN_TEST(test_poll_budget_and_overrun);
+    RUN_TEST(test_poll_cycle_blocking_stats);
+
+    // Register planner tests
+    RUN_TEST(test_modbus_module_filters_every_median_sensor);
+    RUN_TEST(test_planner_splits_sparse_registers);
+    RUN_TEST(test_planner_merges_small_gaps);
+    RUN_TEST(test_planner_reads_all_registers_past_16);
+    RUN_TEST(test_planner_single_reads_when_bulk_disabled);
+
+    // EDF poll scheduler tests
+    RUN_TEST(test_edf_schedule_is_ordered_and_fits_cycle);
+    RUN_TEST(test_edf_critical_latency_bounded);
+    RUN_TEST(test_edf_thins_extras_when_oversubscribed);
+    RUN_TEST(test_edf_thins_extras_on_deadline_miss);
+    RUN_TEST(test_edf_keeps_base_reads_when_bus_too_slow);
+    RUN_TEST(test_edf_reports_min_sample_spacing);
+    RUN_TEST(test_edf_no_extras_without_fill_idle_windows);
+    RUN_TEST(test_modbus_batch_ingest_one_lock_per_transaction);
+    RUN_TEST(test_modbus_batch_ingest_benchmark);
+
+    // Time-proportional output tests
+    RUN_TEST(test_time_proportional_window);
+    RUN_TEST(test_time_proportional_min_on_carries_demand);
+    RUN_TEST(test_time_proportional_min_off_and_saturation);
+    RUN_TEST(test_time_proportional_force_off);
+    RUN_TEST(test_time_proportional_force_off_idempotent);
+
+    // History log tests
+    RUN_TEST(test_history_log_batches_into_blocks);
+    RUN_TEST(test_history_log_recovers_after_reboot);
+    RUN_TEST(test_history_log_skips_torn_block);
+    RUN_TEST(test_history_log_wraps_and_levels_wear);
+
+    // WebSocket broadcast log tests
+    RUN_TEST(test_ws_log_cursors_read_in_order);
+    RUN_TEST(test_ws_log_publish_cost_independent_of_readers);
+
+    // WebSocket delta aggregator tests
+    RUN_TEST(test_ws_delta_deadband_and_relay_toggle);
+    RUN_TEST(test_ws_delta_frame_rate_reduction);
+
+    // WebSocket subscription tests
+    RUN_TEST(test_ws_subscription_parse);
+    RUN_TEST(test_ws_fanout_skips_unsubscribed_clients);
+
     // Noise smoothing tests
     RUN_TEST(test_filter_noise_smoothing);
     RUN_TEST(test_moving_avg_noise_smoothing);
@@ -0,0 +1,448 @@
+#include <unity.h>
+#include "modules/mqtt_spool.h"
+#include "modules/mqtt_publisher.h"
+#include "hal/simulator/hal_simulator.h"
+#include "hal/simulator/posix_mqtt.h"
+#include "core/state_manager.h"
+#include "core/event_bus.h"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace modules;
+using namespace core;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// =============================================================================
+// MqttSpool Tests
+// =============================================================================
+
+void test_spool_keeps_order_until_acked() {
+    MqttSpool spool;
+    TEST_ASSERT_TRUE(spool.allocate(1024));
+    TEST_ASSERT_TRUE(spool.push("t/a", "one", 3));
+    TEST_ASSERT_TRUE(spool.push("t/b", "two", 3, MqttSpool::FLAG_RETAIN));
+    TEST_ASSERT_TRUE(spool.push("t/c", "three", 5));
+    TEST_ASSERT_EQUAL(3, spool.count());
+
+    MqttSpool::Message msg;
+    uint8_t payload[256];
+    uint32_t offsets[3];
+    const char* topics[3] = {"t/a", "t/b", "t/c"};
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(spool.next_unsent(msg, payload));
+        TEST_ASSERT_EQUAL_STRING(topics[i], msg.topic);
+        offsets[i] = msg.offset;
+        spool.mark_sent(msg.offset);
+    }
+    TEST_ASSERT_FALSE(spool.has_unsent());
+    TEST_ASSERT_TRUE(spool.read(offsets[1], msg, payload));
+    TEST_ASSERT_EQUAL(MqttSpool::FLAG_RETAIN, msg.flags);
+    TEST_ASSERT_TRUE(memcmp(payload, "two", 3) == 0);
+
+    // Out-of-order ack only frees memory once the oldest is acked
+    size_t bytes = spool.bytes();
+    spool.ack(offsets[1]);
+    TEST_ASSERT_FALSE(spool.contains(offsets[1]));
+    TEST_ASSERT_EQUAL(bytes, spool.bytes());
+    spool.ack(offsets[0]);
+    TEST_ASSERT_EQUAL(1, spool.count());
+    spool.ack(offsets[2]);
+    TEST_ASSERT_EQUAL(0, spool.count());
+    TEST_ASSERT_EQUAL(0, spool.bytes());
+}
+
+void test_spool_drops_oldest_when_full() {
+    MqttSpool spool;
+    TEST_ASSERT_TRUE(spool.allocate(256));
+    TEST_ASSERT_FALSE(spool.allocate(300));     // Not a power of two
+    TEST_ASSERT_TRUE(spool.allocate(256));
+
+    char payload[60];
+    memset(payload, 'x', sizeof(payload));
+    TEST_ASSERT_FALSE(spool.push("t/big", payload, sizeof(payload)));     // > max_record()
+
+    // 8 + 3 + 40 = 51-byte records: 5 fit in 256
+    for (int i = 0; i < 8; i++) {
+        payload[0] = (char)('0' + i);
+        TEST_ASSERT_TRUE(spool.push("t/x", payload, 40));
+    }
+    TEST_ASSERT_EQUAL(5, spool.count());
+    TEST_ASSERT_EQUAL(3, spool.dropped());
+    TEST_ASSERT_TRUE(spool.bytes() <= spool.capacity());
+
+    // Oldest surviving message is the fourth one pushed
+    MqttSpool::Message msg;
+    uint8_t out[64];
+    TEST_ASSERT_TRUE(spool.next_unsent(msg, out));
+    TEST_ASSERT_EQUAL('3', out[0]);
+    TEST_ASSERT_EQUAL(40, msg.len);
+}
+
+void test_spool_rewind_resends_unacked() {
+    MqttSpool spool;
+    TEST_ASSERT_TRUE(spool.allocate(1024));
+    spool.push("t/a", "1", 1);
+    spool.push("t/b", "2", 1);
+    spool.push("t/c", "3", 1);
+
+    MqttSpool::Message msg;
+    uint8_t payload[256];
+    uint32_t second = 0;
+    for (int i = 0; i < 3; i++) {
+        spool.next_unsent(msg, payload);
+        if (i == 1) second = msg.offset;
+        spool.mark_sent(msg.offset);
+    }
+    spool.ack(second);
+
+    // After a reconnect: everything not acked, in order
+    spool.rewind();
+    TEST_ASSERT_TRUE(spool.next_unsent(msg, payload));
+    TEST_ASSERT_EQUAL_STRING("t/a", msg.topic);
+    spool.mark_sent(msg.offset);
+    TEST_ASSERT_TRUE(spool.next_unsent(msg, payload));
+    TEST_ASSERT_EQUAL_STRING("t/c", msg.topic);
+    spool.mark_sent(msg.offset);
+    TEST_ASSERT_FALSE(spool.next_unsent(msg, payload));
+}
+
+// =============================================================================
+// MqttPublisher Tests
+// =============================================================================
+
+struct PublisherFixture {
+    hal::simulator::SimulatorMqtt mqtt;
+    hal::simulator::SimulatorTime time;
+    StateManager state;
+    EventBus events;
+    MQTTConfig config;
+    MqttPublisher* publisher;
+
+    PublisherFixture() : publisher(nullptr) {
+        strcpy(config.broker, "localhost");
+        strcpy(config.topic_prefix, "brewery/f1");
+        config.publish_interval_ms = 1000;
+        config.reconnect_delay_ms = 500;
+        config.enabled = true;
+
+        state.register_sensor("fermenter_1_temp", "°C");
+        state.register_sensor("fermenter_1_pressure", "bar");
+        state.register_relay("f1_cooling", RelayType::SOLENOID_NC);
+        FermenterDef def = {};
+        def.id = 1;
+        strcpy(def.name, "F1");
+        strcpy(def.temp_sensor, "fermenter_1_temp");
+        strcpy(def.pressure_sensor, "fermenter_1_pressure");
+        strcpy(def.cooling_relay, "f1_cooling");
+        state.register_fermenter(def);
+
+        publisher = new MqttPublisher(&mqtt, &time, &state, &events, config, "ctrl-01");
+    }
+
+    ~PublisherFixture() { delete publisher; }
+
+    /** Sensor sample, as the MODBUS module reports it */
+    void sample(float temp) {
+        state.update_sensor_value(0, temp, time.millis());
+        state.update_sensor_filtered(0, temp, temp);
+        events.publish_sensors_updated(0x1, time.millis());
+    }
+
+    /** Run process() every 10 ms for ms */
+    void run(uint32_t ms) {
+        for (uint32_t t = 0; t < ms; t += 10) {
+            time.advance_millis(10);
+            publisher->process();
+        }
+    }
+
+    int count(const char* leaf) const {
+        std::string name = std::string(config.topic_prefix) + "/" + leaf;
+        int n = 0;
+        for (const auto& p : mqtt.get_published()) n += p.topic == name ? 1 : 0;
+        return n;
+    }
+};
+
+void test_mqtt_publisher_requires_broker() {
+    PublisherFixture f;
+    f.config.broker[0] = '\0';
+    TEST_ASSERT_FALSE(f.publisher->initialize());
+}
+
+void test_mqtt_publisher_batches_per_interval() {
+    PublisherFixture f;
+    TEST_ASSERT_TRUE(f.publisher->initialize());
+    TEST_ASSERT_EQUAL_STRING("brewery/f1/status", f.mqtt.get_will_topic().c_str());
+    f.publisher->process();
+    TEST_ASSERT_TRUE(f.publisher->is_connected());
+    TEST_ASSERT_EQUAL(1, f.count("status"));
+    TEST_ASSERT_TRUE(f.mqtt.get_published()[0].retain);
+
+    // 5 Hz samples and two relay toggles over 3 s: one message per kind per second
+    for (int i = 0; i < 15; i++) {
+        f.sample(18.0f + i * 0.1f);
+        if (i == 4 || i == 9) f.state.set_relay_state(0, i == 4, f.time.millis());
+        if (i == 4 || i == 9) f.events.publish_relay_change(0, i == 4, f.time.millis());
+        f.run(200);
+    }
+    TEST_ASSERT_EQUAL(3, f.count("sensors"));
+    TEST_ASSERT_EQUAL(2, f.count("relays"));
+    TEST_ASSERT_TRUE(f.count("fermenters") >= 1);
+    f.publisher->process();                                     // Last PUBACKs
+
+    for (const auto& p : f.mqtt.get_published()) {
+        TEST_ASSERT_EQUAL(1, p.qos);
+        if (p.topic == "brewery/f1/sensors") {
+            TEST_ASSERT_TRUE(p.payload.find("\"ts\":1700000000") != std::string::npos);
+            TEST_ASSERT_TRUE(p.payload.find("\"name\":\"fermenter_1_temp\"") != std::string::npos);
+            TEST_ASSERT_TRUE(p.payload.find("fermenter_1_pressure") == std::string::npos);
+        }
+    }
+    TEST_ASSERT_EQUAL(0, f.publisher->get_spool().count());     // All acked
+    TEST_ASSERT_EQUAL(0, f.publisher->get_inflight());
+}
+
+void test_mqtt_publisher_retries_unacked() {
+    PublisherFixture f;
+    f.mqtt.set_auto_ack(false);
+    f.publisher->initialize();
+    f.publisher->process();
+    f.sample(18.0f);
+    f.run(1000);
+
+    size_t sent = f.mqtt.get_published().size();
+    TEST_ASSERT_TRUE(f.publisher->get_inflight() > 0);
+    f.run(MqttPublisher::ACK_TIMEOUT_MS - 100);
+    TEST_ASSERT_EQUAL(0, f.publisher->get_stats().retries);
+
+    f.run(200);
+    TEST_ASSERT_TRUE(f.publisher->get_stats().retries > 0);
+    const auto& published = f.mqtt.get_published();
+    TEST_ASSERT_TRUE(published.size() > sent);
+    // A resend is the spooled message unchanged, under a new packet id
+    bool same = false;
+    for (size_t i = 0; i < sent; i++) {
+        same |= published[i].topic == published[sent].topic &&
+                published[i].payload == published[sent].payload &&
+                published[i].msg_id != published[sent].msg_id;
+    }
+    TEST_ASSERT_TRUE(same);
+
+    // Acknowledging the resends empties the spool
+    for (size_t i = sent; i < published.size(); i++) f.mqtt.ack(published[i].msg_id);
+    f.publisher->process();
+    TEST_ASSERT_EQUAL(0, f.publisher->get_spool().count());
+}
+
+void test_mqtt_publisher_spools_offline_and_replays() {
+    PublisherFixture f;
+    f.publisher->initialize();
+    f.publisher->process();
+    f.run(1000);
+    f.publisher->process();
+    f.mqtt.clear_published();
+
+    // Broker gone for 5 s; samples keep being batched (sensors + fermenters)
+    f.mqtt.set_broker_up(false);
+    for (int i = 0; i < 5; i++) {
+        f.time.advance_unix_time(1);
+        f.sample(20.0f + i);
+        f.state.update_fermenter_temps(1, 20.0f + i, 18.0f);
+        f.run(1000);
+    }
+    TEST_ASSERT_FALSE(f.publisher->is_connected());
+    TEST_ASSERT_EQUAL(0, f.mqtt.get_published().size());
+    TEST_ASSERT_EQUAL(10, f.publisher->get_spool().count());
+
+    // Back up: reconnect, then the backlog goes out oldest first with its own ts
+    f.mqtt.set_broker_up(true);
+    f.run(1000);
+    TEST_ASSERT_TRUE(f.publisher->is_connected());
+    TEST_ASSERT_EQUAL(2, f.publisher->get_stats().connects);
+    const auto& published = f.mqtt.get_published();
+    TEST_ASSERT_EQUAL_STRING("brewery/f1/status", published[0].topic.c_str());
+    uint32_t last_ts = 0;
+    int replayed = 0;
+    for (const auto& p : published) {
+        if (p.topic != "brewery/f1/sensors") continue;
+        uint32_t ts = (uint32_t)strtoul(p.payload.c_str() + 6, nullptr, 10);
+        TEST_ASSERT_TRUE(ts > last_ts);
+        last_ts = ts;
+        replayed++;
+    }
+    TEST_ASSERT_EQUAL(5, replayed);
+    TEST_ASSERT_EQUAL(5, f.count("fermenters"));
+    f.publisher->process();
+    TEST_ASSERT_EQUAL(0, f.publisher->get_spool().count());
+    TEST_ASSERT_EQUAL(0, f.publisher->get_spool().dropped());
+}
+
+void test_mqtt_publisher_fermenters_only_on_change() {
+    PublisherFixture f;
+    f.publisher->initialize();
+    f.publisher->process();
+    f.run(1000);
+    TEST_ASSERT_EQUAL(1, f.count("fermenters"));               // First batch
+
+    // Sensor and relay traffic move the state generation, not the fermenters
+    for (int i = 0; i < 3; i++) {
+        f.sample(18.0f + i);
+        f.state.set_relay_state(0, i % 2 == 0, f.time.millis());
+        f.run(1000);
+    }
+    TEST_ASSERT_EQUAL(3, f.count("sensors"));
+    TEST_ASSERT_EQUAL(1, f.count("fermenters"));
+
+    // Below payload precision is no change either
+    f.state.get_fermenter(1)->pid_output += 0.01f;
+    f.run(1000);
+    TEST_ASSERT_EQUAL(1, f.count("fermenters"));
+
+    f.state.set_fermenter_mode(1, FermenterMode::MANUAL);
+    f.run(1000);
+    TEST_ASSERT_EQUAL(2, f.count("fermenters"));
+    TEST_ASSERT_TRUE(f.mqtt.get_published().back().payload.find("\"mode\":\"MANUAL\"")
+                     != std::string::npos);
+}
+
+void test_mqtt_publisher_alarm_not_batched() {
+    PublisherFixture f;
+    f.publisher->initialize();
+    f.publisher->process();
+
+    Event alarm;
+    alarm.type = EventType::ALARM;
+    alarm.source_id = 1;
+    alarm.data.state = true;
+    f.events.publish(alarm);
+    alarm.source_id = 0;        // System alarm has no fermenter
+    f.events.publish(alarm);
+    f.run(10);
+
+    TEST_ASSERT_EQUAL(1, f.count("alarms"));
+    TEST_ASSERT_TRUE(f.mqtt.get_published().back().payload.find("\"fermenter\":1,\"active\":true")
+                     != std::string::npos);
+    TEST_ASSERT_EQUAL(0, f.count("sensors"));
+
+    f.publisher->stop();
+    TEST_ASSERT_FALSE(f.mqtt.is_connected());
+}
+
+void test_mqtt_publisher_escapes_and_counts_oversized_batches() {
+    PublisherFixture f;
+    f.state.register_relay("f1 \"glycol\"", RelayType::SOLENOID_NC);
+    f.publisher->initialize();
+    f.publisher->process();
+
+    // Names are escaped, so the payload stays valid JSON
+    f.state.set_relay_state(1, true, f.time.millis());
+    f.events.publish_relay_change(1, true, f.time.millis());
+    f.run(1000);
+    TEST_ASSERT_EQUAL(1, f.count("relays"));
+    for (const auto& p : f.mqtt.get_published()) {
+        if (p.topic != "brewery/f1/relays") continue;
+        TEST_ASSERT_TRUE(p.payload.find("\"name\":\"f1 \\\"glycol\\\"\"") != std::string::npos);
+    }
+
+    // Control characters escape to six bytes each: 32 such names overflow
+    // PAYLOAD_SIZE, and the batch is counted rather than sent cut off
+    char name[MAX_NAME_LENGTH];
+    for (uint8_t i = 2; i < MAX_SENSORS; i++) {
+        memset(name, 0x01, sizeof(name) - 1);
+        name[sizeof(name) - 1] = '\0';
+        snprintf(name, 3, "%02u", i);
+        name[2] = 0x01;
+        TEST_ASSERT_TRUE(f.state.register_sensor(name, "bar"));
+    }
+    f.events.publish_sensors_updated(0xFFFFFFFFu, f.time.millis());
+    f.run(1000);
+    TEST_ASSERT_EQUAL(0, f.count("sensors"));
+    TEST_ASSERT_EQUAL(1, f.publisher->get_stats().truncated);
+    TEST_ASSERT_EQUAL(0, f.publisher->get_stats().dropped);
+
+    // Next batch fits again
+    f.sample(19.0f);
+    f.run(1000);
+    TEST_ASSERT_EQUAL(1, f.count("sensors"));
+}
+
+// =============================================================================
+// Local broker (set MQTT_TEST_BROKER=host[:port], e.g. a local mosquitto)
+// =============================================================================
+
+void test_posix_mqtt_local_broker() {
+    const char* env = getenv("MQTT_TEST_BROKER");
+    if (!env || !env[0]) {
+        TEST_IGNORE_MESSAGE("MQTT_TEST_BROKER not set");
+    }
+    char host[64];
+    strncpy(host, env, sizeof(host) - 1);
+    host[sizeof(host) - 1] = '\0';
+    uint16_t port = 1883;
+    char* colon = strchr(host, ':');
+    if (colon) {
+        *colon = '\0';
+        port = (uint16_t)atoi(colon + 1);
+    }
+
+    hal::simulator::PosixMqtt client;
+    hal::simulator::SimulatorTime time;
+    StateManager state;
+    EventBus events;
+    MQTTConfig config;
+    strncpy(config.broker, host, sizeof(config.broker) - 1);
+    config.port = port;
+    strcpy(config.topic_prefix, "test/fermenter");
+    config.publish_interval_ms = 100;
+    state.register_sensor("temp", "°C");
+
+    MqttPublisher publisher(&client, &time, &state, &events, config, "fermenter-test");
+    TEST_ASSERT_TRUE(publisher.initialize());
+    for (int i = 0; i < 10; i++) {
+        state.update_sensor_filtered(0, 18.0f + i, 18.0f + i);
+        events.publish_sensors_updated(0x1, time.millis());
+        time.advance_millis(100);
+        publisher.process();
+    }
+
+    // Wait (real time) for the broker's PUBACKs
+    for (int i = 0; i < 200 && publisher.get_spool().count() > 0; i++) {
+        usleep(10000);
+        publisher.process();
+    }
+    TEST_ASSERT_TRUE(publisher.is_connected());
+    TEST_ASSERT_TRUE(publisher.get_stats().batches >= 10);     // Sensors, plus fermenters
+    TEST_ASSERT_EQUAL(0, publisher.get_spool().count());
+    TEST_ASSERT_EQUAL(publisher.get_stats().batches, publisher.get_stats().acked);
+}
+
+// =============================================================================
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+
+    // Spool tests
+    RUN_TEST(test_spool_keeps_order_until_acked);
+    RUN_TEST(test_spool_drops_oldest_when_full);
+    RUN_TEST(test_spool_rewind_resends_unacked);
+
+    // Publisher tests
+    RUN_TEST(test_mqtt_publisher_requires_broker);
+    RUN_TEST(test_mqtt_publisher_batches_per_interval);
+    RUN_TEST(test_mqtt_publisher_retries_unacked);
+    RUN_TEST(test_mqtt_publisher_spools_offline_and_replays);
+    RUN_TEST(test_mqtt_publisher_fermenters_only_on_change);
+    RUN_TEST(test_mqtt_publisher_alarm_not_batched);
+    RUN_TEST(test_mqtt_publisher_escapes_and_counts_oversized_batches);
+
+    // Broker test
+    RUN_TEST(test_posix_mqtt_local_broker);
+
+    return UNITY_END();
+}
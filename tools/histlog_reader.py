@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""
+History Log Reader - Decodes the "histlog" flash partition
+
+Reads a raw partition dump (or pulls one over USB with esptool) and streams
+the records in chronological order, either as CSV or as a binary record
+stream. Format: see include/modules/history_log.h
+
+Usage:
+  histlog_reader.py histlog.bin                  # CSV, last 14 days
+  histlog_reader.py --port /dev/ttyACM0 -o out.bin --format bin
+  histlog_reader.py histlog.bin --days 0         # Everything in the log
+"""
+
+import argparse
+import math
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+from datetime import datetime, timezone
+
+PARTITION_OFFSET = 0xC10000     # Must match partitions.csv
+PARTITION_SIZE = 0x3F0000
+
+BLOCK_SIZE = 256
+HEADER = struct.Struct("<HHII")   # magic, length, sequence, crc32
+BLOCK_MAGIC = 0x4C48
+RECORD_HEADER = struct.Struct("<BBI")
+
+RECORD_BOOT = 1
+RECORD_NAME = 2
+RECORD_SENSORS = 3
+RECORD_RELAY = 4
+RECORD_PLAN_STEP = 5
+TIME_UPTIME = 0x80
+
+STREAM_MAGIC = b"HLOG\x01"
+
+
+def read_blocks(data):
+    """Yield (sequence, payload) for every valid block, oldest first"""
+    blocks = []
+    for off in range(0, len(data) - BLOCK_SIZE + 1, BLOCK_SIZE):
+        magic, length, seq, crc = HEADER.unpack_from(data, off)
+        if magic != BLOCK_MAGIC or length > BLOCK_SIZE - HEADER.size:
+            continue
+        payload = data[off + HEADER.size:off + HEADER.size + length]
+        if zlib.crc32(data[off:off + 8] + payload) != crc:
+            continue
+        blocks.append((seq, off))
+    blocks.sort()
+    for seq, off in blocks:
+        _, length, _, _ = HEADER.unpack_from(data, off)
+        yield seq, data[off + HEADER.size:off + HEADER.size + length]
+
+
+def read_records(data):
+    """Yield (type, uptime_flag, timestamp, body) in log order"""
+    for _, payload in read_blocks(data):
+        off = 0
+        while off + RECORD_HEADER.size <= len(payload):
+            rtype, length, ts = RECORD_HEADER.unpack_from(payload, off)
+            body = payload[off + RECORD_HEADER.size:off + RECORD_HEADER.size + length]
+            if len(body) != length:
+                break
+            yield rtype & ~TIME_UPTIME, bool(rtype & TIME_UPTIME), ts, body
+            off += RECORD_HEADER.size + length
+
+
+def pull_partition(port):
+    """Read the partition over USB with esptool"""
+    fd, path = tempfile.mkstemp(suffix=".bin")
+    os.close(fd)
+    cmd = ["esptool.py", "--port", port, "read_flash",
+           hex(PARTITION_OFFSET), hex(PARTITION_SIZE), path]
+    print("Reading partition: " + " ".join(cmd), file=sys.stderr)
+    subprocess.run(cmd, check=True, stdout=sys.stderr)
+    with open(path, "rb") as f:
+        data = f.read()
+    os.unlink(path)
+    return data
+
+
+def format_time(ts, uptime):
+    if uptime:
+        return f"boot+{ts}s"
+    return datetime.fromtimestamp(ts, timezone.utc).strftime("%Y-%m-%dT%H:%M:%SZ")
+
+
+def write_csv(records, out):
+    sensor_names = {}
+    relay_names = {}
+    out.write("time,kind,name,value\n")
+    for rtype, uptime, ts, body in records:
+        t = format_time(ts, uptime)
+        if rtype == RECORD_BOOT:
+            out.write(f"{t},boot,,\n")
+        elif rtype == RECORD_NAME and len(body) >= 2:
+            names = sensor_names if body[0] == 0 else relay_names
+            names[body[1]] = body[2:].decode("utf-8", errors="replace")
+        elif rtype == RECORD_SENSORS and len(body) >= 1:
+            first = body[0]
+            for i in range((len(body) - 1) // 4):
+                (value,) = struct.unpack_from("<f", body, 1 + i * 4)
+                if math.isnan(value):
+                    continue
+                sid = first + i
+                out.write(f"{t},sensor,{sensor_names.get(sid, sid)},{value:.3f}\n")
+        elif rtype == RECORD_RELAY and len(body) >= 2:
+            out.write(f"{t},relay,{relay_names.get(body[0], body[0])},{body[1]}\n")
+        elif rtype == RECORD_PLAN_STEP and len(body) >= 2:
+            step = "" if body[1] == 0xFF else body[1]
+            out.write(f"{t},plan_step,fermenter_{body[0]},{step}\n")
+
+
+def write_binary(records, out):
+    """Normalized stream: magic, then records exactly as stored on flash"""
+    out.write(STREAM_MAGIC)
+    for rtype, uptime, ts, body in records:
+        out.write(RECORD_HEADER.pack(rtype | (TIME_UPTIME if uptime else 0), len(body), ts))
+        out.write(body)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the histlog flash partition")
+    parser.add_argument("dump", nargs="?", help="Partition dump file")
+    parser.add_argument("--port", help="Read the partition from a device with esptool")
+    parser.add_argument("--days", type=float, default=14,
+                        help="Only records from the last N days (0 = all, default 14)")
+    parser.add_argument("--format", choices=["csv", "bin"], default="csv")
+    parser.add_argument("-o", "--output", help="Output file (default stdout)")
+    args = parser.parse_args()
+
+    if args.port:
+        data = pull_partition(args.port)
+    elif args.dump:
+        with open(args.dump, "rb") as f:
+            data = f.read()
+    else:
+        parser.error("need a dump file or --port")
+
+    records = read_records(data)
+    if args.days > 0:
+        # Cut off relative to the newest wall-clock stamp in the log
+        newest = max((ts for _, uptime, ts, _ in read_records(data) if not uptime), default=0)
+        cutoff = newest - int(args.days * 86400)
+        records = (r for r in records if r[1] or r[2] >= cutoff)
+
+    if args.format == "bin":
+        out = open(args.output, "wb") if args.output else sys.stdout.buffer
+        write_binary(records, out)
+    else:
+        out = open(args.output, "w") if args.output else sys.stdout
+        write_csv(records, out)
+
+    if args.output:
+        out.close()
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except BrokenPipeError:
+        pass